@@ -0,0 +1,147 @@
+//=============================================================================
+// Header file with the binary layout of the Transfer Area as used by the
+// ROBO TX Controller firmware (ARM, 32-bit pointers).
+// The sizes in the comments of ROBO_TX_FW.h are checked at compile time
+// against this layout, so a compiler or a change of the headers which moves
+// a field cannot go unnoticed:
+//   - the blocks without pointers (TA_ABI_FIXED_xxx) have the same layout on
+//     every build, they are checked everywhere, also on 64-bit hosts, where
+//     they can be copied to and from the firmware image as is;
+//   - the blocks with pointers (TA_ABI_NATIVE_xxx) and the TA itself are
+//     checked when pointers are 32 bits, i.e. on the Controller. On a 64-bit
+//     host PGM_INFO.name, DISPLAY_FRAME.frame and the hook table have other
+//     sizes; Host/ta_wire.h has the firmware layout of these blocks,
+//     Host/ta_layout lists the offsets.
+//
+// The lists are X-macros: F(type, member, offset, size) for the fields,
+// S(type, size) for the structures.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __ROBO_TX_ABI_H__
+#define __ROBO_TX_ABI_H__
+
+#define TA_ABI_SIZE             1024        // size of one element of the TA array
+
+#define TA_ABI_OFFSETOF(type, member)   __builtin_offsetof(type, member)
+#define TA_ABI_SIZEOF(type, member)     sizeof(((type *)0)->member)
+
+// TRUE if the build has the pointer size of the firmware
+#define TA_ABI_IS_NATIVE        (__SIZEOF_POINTER__ == 4)
+
+
+// Structures with the same layout on every build
+#define TA_ABI_FIXED_SIZES(S) \
+    S(BT_STATUS,        8)      \
+    S(UNI_CONFIG,       4)      \
+    S(CNT_CONFIG,       4)      \
+    S(FT_VER,           4)      \
+    S(FT_VERSION,       16)     \
+    S(TA_INFO,          64)     \
+    S(TA_CONFIG,        88)     \
+    S(TA_INPUT,         68)     \
+    S(TA_OUTPUT,        44)     \
+    S(DISPLAY_MSG,      100)    \
+    S(TA_STATUS,        4)      \
+    S(TA_CHANGE,        8)      \
+    S(TA_TIMER,         12)
+
+// Fields with the same offset and size on every build
+#define TA_ABI_FIXED_FIELDS(F) \
+    F(TA_INFO,      device_name,                0,      17)     \
+    F(TA_INFO,      bt_addr,                    17,     18)     \
+    F(TA_INFO,      ta_array_start_addr,        36,     4)      \
+    F(TA_INFO,      pgm_area_start_addr,        40,     4)      \
+    F(TA_INFO,      pgm_area_size,              44,     4)      \
+    F(TA_INFO,      version,                    48,     16)     \
+    F(TA_STATE,     pgm_initialized,            0,      1)      \
+    F(TA_STATE,     dev_mode,                   8,      1)      \
+    F(TA_STATE,     id,                         9,      1)      \
+    F(TA_STATE,     info_id,                    10,     1)      \
+    F(TA_STATE,     config_id,                  11,     1)      \
+    F(TA_STATE,     ext_dev_connect_state,      12,     8)      \
+    F(TA_STATE,     btstatus,                   20,     64)     \
+    F(TA_STATE,     reserved_2,                 84,     8)      \
+    F(TA_CONFIG,    pgm_state_req,              0,      1)      \
+    F(TA_CONFIG,    motor,                      4,      4)      \
+    F(TA_CONFIG,    uni,                        8,      32)     \
+    F(TA_CONFIG,    cnt,                        40,     16)     \
+    F(TA_CONFIG,    reserved_2,                 56,     32)     \
+    F(TA_INPUT,     uni,                        0,      16)     \
+    F(TA_INPUT,     cnt_in,                     16,     8)      \
+    F(TA_INPUT,     counter,                    24,     8)      \
+    F(TA_INPUT,     display_button_left,        32,     2)      \
+    F(TA_INPUT,     display_button_right,       34,     2)      \
+    F(TA_INPUT,     cnt_resetted,               36,     8)      \
+    F(TA_INPUT,     motor_pos_reached,          44,     8)      \
+    F(TA_INPUT,     reserved,                   52,     16)     \
+    F(TA_OUTPUT,    cnt_reset_cmd_id,           0,      8)      \
+    F(TA_OUTPUT,    master,                     8,      4)      \
+    F(TA_OUTPUT,    duty,                       12,     16)     \
+    F(TA_OUTPUT,    distance,                   28,     8)      \
+    F(TA_OUTPUT,    motor_ex_cmd_id,            36,     8)      \
+    F(DISPLAY_MSG,  id,                         0,      1)      \
+    F(DISPLAY_MSG,  text,                       1,      99)     \
+    F(TA_DISPLAY,   display_msg,                0,      100)    \
+    F(TA_STATUS,    status,                     0,      1)      \
+    F(TA_STATUS,    iostatus,                   1,      1)      \
+    F(TA_STATUS,    ComErr,                     2,      2)
+
+// Structures which contain pointers
+#define TA_ABI_NATIVE_SIZES(S) \
+    S(PGM_INFO,         8)      \
+    S(DISPLAY_FRAME,    8)      \
+    S(TA_STATE,         100)    \
+    S(TA_DISPLAY,       108)    \
+    S(TA_HOOK_TABLE,    140)    \
+    S(TA,               TA_ABI_SIZE)
+
+// Pointers and the fields behind them
+#define TA_ABI_NATIVE_FIELDS(F) \
+    F(PGM_INFO,     name,                       0,      4)      \
+    F(PGM_INFO,     state,                      4,      1)      \
+    F(DISPLAY_FRAME, frame,                     0,      4)      \
+    F(DISPLAY_FRAME, id,                        4,      2)      \
+    F(DISPLAY_FRAME, is_pgm_master_of_display,  6,      2)      \
+    F(TA_STATE,     local_pgm,                  92,     8)      \
+    F(TA_DISPLAY,   display_frame,              100,    8)      \
+    F(TA,           info,                       0,      64)     \
+    F(TA,           state,                      64,     100)    \
+    F(TA,           config,                     164,    88)     \
+    F(TA,           input,                      252,    68)     \
+    F(TA,           output,                     320,    44)     \
+    F(TA,           display,                    364,    108)    \
+    F(TA,           status,                     472,    4)      \
+    F(TA,           change,                     476,    8)      \
+    F(TA,           timer,                      484,    12)     \
+    F(TA,           reserved_1,                 496,    28)     \
+    F(TA,           hook_table,                 524,    140)    \
+    F(TA,           reserved_2,                 664,    360)
+
+
+// Compile-time checks; a failing check is an error "size of array is negative"
+// naming the type and the field
+#define TA_ABI_ASSERT(cond, name)   typedef char ta_abi_##name[(cond) ? 1 : -1]
+
+#define TA_ABI_CHECK_SIZE(type, size) \
+    TA_ABI_ASSERT(sizeof(type) == (size), type);
+#define TA_ABI_CHECK_FIELD(type, member, offset, size) \
+    TA_ABI_ASSERT(TA_ABI_OFFSETOF(type, member) == (offset) && TA_ABI_SIZEOF(type, member) == (size), \
+        type##_##member);
+
+TA_ABI_FIXED_SIZES(TA_ABI_CHECK_SIZE)
+TA_ABI_FIXED_FIELDS(TA_ABI_CHECK_FIELD)
+
+#if TA_ABI_IS_NATIVE
+TA_ABI_NATIVE_SIZES(TA_ABI_CHECK_SIZE)
+TA_ABI_NATIVE_FIELDS(TA_ABI_CHECK_FIELD)
+#endif
+
+
+#endif // __ROBO_TX_ABI_H__
@@ -443,7 +443,7 @@ typedef struct
 
 
 // Hook table with pointers to the firmware functions,
-// that can be called by local program, 132 bytes
+// that can be called by local program, 140 bytes
 typedef struct
 {
     // Informs the calling program if it can still run (return TRUE) or should
@@ -573,4 +573,8 @@ typedef struct ta_s
 } TA;
 
 
+// Compile-time checks of the layout
+#include "ROBO_TX_ABI.h"
+
+
 #endif // __ROBO_TX_FW_H__
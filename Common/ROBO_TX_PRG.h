@@ -32,6 +32,7 @@
 
 #define MAX_FRAME_SIZE      1024  // maximum size of displayable frame (display buffer size)
 
+#undef  NULL
 #if defined(__cplusplus)
     #define NULL            0L
 #else
@@ -57,7 +58,6 @@ typedef unsigned char       UCHAR8;
 
 typedef unsigned char       BOOL8;      //  boolean variable (should be TRUE or FALSE)
 typedef unsigned short      BOOL16;     //  boolean variable (should be TRUE or FALSE)
-typedef unsigned long       BOOL32;     //  boolean variable (should be TRUE or FALSE)
 
 typedef signed char         INT8;
 typedef signed short        INT16;
@@ -65,7 +65,16 @@ typedef signed int          INT32;
 
 typedef unsigned char       UINT8;
 typedef unsigned short      UINT16;
+
+// On 64-bit hosts (LP64) long has 64 bits, there the 32-bit types are based
+// on int, so the Transfer Area keeps the layout of the firmware
+#if defined(__LP64__)
+typedef unsigned int        BOOL32;     //  boolean variable (should be TRUE or FALSE)
+typedef unsigned int        UINT32;
+#else
+typedef unsigned long       BOOL32;     //  boolean variable (should be TRUE or FALSE)
 typedef unsigned long       UINT32;
+#endif
 
 #include "ROBO_TX_FW.h"
 
@@ -81,6 +90,11 @@ enum bt_commands_e
     CMD_SEND
 };
 
+// The program functions are called from C (program dispatcher), also in C++ programs
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 extern UCHAR8 bt_address_table[BT_CNT_MAX][BT_ADDR_LEN];
 
 // At the beginning of the program code should be this structure
@@ -122,5 +136,9 @@ BOOL32 BtDisplayCommandStatus
     CHAR8 command_status
 );
 
+#ifdef __cplusplus
+}
+#endif
+
 
 #endif // __ROBO_TX_PRG_H__
@@ -9,7 +9,7 @@
 // free of any license obligations or authoring rights.
 //=============================================================================
 
-#include "ROBO_TX_PRG.H"
+#include "ROBO_TX_PRG.h"
 
 static char str[128];
 
@@ -2,6 +2,8 @@
 // Table of Bluetooth addresses of all ROBO TX Controllers which are used
 // for Bluetooth communicating programs. It should be adjusted to the concrete
 // set of ROBO TX Controllers, planned to be used for Bluetooth communication.
+// If the Bluetooth peer discovery (prg_bt_scan.c) is used, the table is
+// overwritten with the addresses of the discovered Controllers.
 //
 // Disclaimer - Exclusion of Liability
 //
@@ -11,7 +13,7 @@
 // free of any license obligations or authoring rights.
 //=============================================================================
 
-#include "ROBO_TX_PRG.H"
+#include "ROBO_TX_PRG.h"
 
 UCHAR8 bt_address_table[BT_CNT_MAX][BT_ADDR_LEN] =
 {
@@ -0,0 +1,331 @@
+//=============================================================================
+// Bluetooth peer discovery.
+// Collects the results of a Bluetooth inquiry scan (BT_SCAN_STATUS records)
+// into a table of ROBO TX Controllers sorted by Bluetooth address. When the
+// scan is finished, the Controller with the table index N gets the Bluetooth
+// channel N + 1 and its address is written to bt_address_table[N]. Because
+// the local Controller is also entered into the table, all Controllers which
+// see the same set of devices come to the same channel assignment, so programs
+// which use bt_address_table keep working without rebuilding after a hardware
+// swap.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "prg_bt_scan.h"
+
+static BT_SCAN_ENTRY table[BT_SCAN_TABLE_SIZE];
+static UINT32 table_count;
+static enum bt_scan_state_e scan_state;
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : BtAddrCompare
+ *
+ * Compares two Bluetooth addresses byte by byte.
+ *-----------------------------------------------------------------------------*/
+static int BtAddrCompare
+(
+    const UCHAR8 * a,
+    const UCHAR8 * b
+)
+{
+    int i;
+
+    for (i = 0; i < BT_ADDR_LEN; i++)
+    {
+        if (a[i] != b[i])
+        {
+            return (a[i] < b[i]) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : BtAddrFromStr
+ *
+ * Converts a string with the format "xx:xx:xx:xx:xx:xx" to a Bluetooth
+ * address. Returns FALSE if the string has a wrong format.
+ *-----------------------------------------------------------------------------*/
+static BOOL32 BtAddrFromStr
+(
+    const char * str,
+    UCHAR8 * bt_addr
+)
+{
+    int i, j;
+
+    for (i = 0; i < BT_ADDR_LEN; i++)
+    {
+        UCHAR8 byte = 0;
+
+        for (j = 0; j < 2; j++)
+        {
+            char c = *str++;
+
+            byte <<= 4;
+            if (c >= '0' && c <= '9')
+                byte |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+                byte |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                byte |= c - 'A' + 10;
+            else
+                return FALSE;
+        }
+        if (i < BT_ADDR_LEN - 1 && *str++ != ':')
+        {
+            return FALSE;
+        }
+        bt_addr[i] = byte;
+    }
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : BtScanInsert
+ *
+ * Inserts a device into the table keeping it sorted by Bluetooth address.
+ * An already known device only gets its name updated. When the table is
+ * full, the device with the highest address is dropped, so all Controllers
+ * keep the same BT_SCAN_TABLE_SIZE lowest addresses whatever the order of
+ * the scan results.
+ *-----------------------------------------------------------------------------*/
+static void BtScanInsert
+(
+    TA * p_ta,
+    const UCHAR8 * bt_addr,
+    const char * name,
+    BOOL8 is_own
+)
+{
+    UINT32 lo = 0, hi = table_count;
+
+    // Binary search of the insert position
+    while (lo < hi)
+    {
+        UINT32 mid = (lo + hi) / 2;
+        int cmp = BtAddrCompare(table[mid].bt_addr, bt_addr);
+
+        if (cmp == 0)
+        {
+            p_ta->hook_table.strncpy(table[mid].name, name, DEV_NAME_LEN_MAX);
+            return;
+        }
+        if (cmp < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (table_count >= BT_SCAN_TABLE_SIZE)
+    {
+        if (lo >= table_count)
+        {
+            return; // table is full of lower addresses, device is ignored
+        }
+        table_count--;
+    }
+
+    p_ta->hook_table.memmove(&table[lo + 1], &table[lo], (table_count - lo) * sizeof(table[0]));
+    p_ta->hook_table.memset(&table[lo], 0, sizeof(table[0]));
+    p_ta->hook_table.memcpy(table[lo].bt_addr, bt_addr, BT_ADDR_LEN);
+    p_ta->hook_table.strncpy(table[lo].name, name, DEV_NAME_LEN_MAX);
+    table[lo].is_own = is_own;
+    table_count++;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : BtScanAssignChannels
+ *
+ * Assigns the channels in the order of the table and writes the addresses
+ * to bt_address_table. The rows behind the table are cleared, so no address
+ * of an earlier scan is left in bt_address_table.
+ *-----------------------------------------------------------------------------*/
+static void BtScanAssignChannels
+(
+    TA * p_ta
+)
+{
+    UINT32 idx;
+
+    for (idx = 0; idx < table_count; idx++)
+    {
+        if (idx < BT_CNT_MAX)
+        {
+            table[idx].channel = (table[idx].is_own) ? BT_SCAN_NO_CHANNEL : idx + BT_CHAN_IDX_MIN;
+            p_ta->hook_table.memcpy(bt_address_table[idx], table[idx].bt_addr, BT_ADDR_LEN);
+        }
+        else
+        {
+            table[idx].channel = BT_SCAN_NO_CHANNEL;
+        }
+    }
+    for (; idx < BT_CNT_MAX; idx++)
+    {
+        p_ta->hook_table.memset(bt_address_table[idx], 0, BT_ADDR_LEN);
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : BtScanReset
+ *
+ * Clears the peer table and enters the local Controller into it.
+ *-----------------------------------------------------------------------------*/
+void BtScanReset
+(
+    TA * p_ta
+)
+{
+    UCHAR8 own_addr[BT_ADDR_LEN];
+
+    table_count = 0;
+    scan_state = BT_SCAN_IDLE;
+
+    if (BtAddrFromStr(p_ta->info.bt_addr, own_addr))
+    {
+        BtScanInsert(p_ta, own_addr, p_ta->info.device_name, TRUE);
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : BtScanUpdate
+ *
+ * Processes one inquiry scan status record. Returns TRUE when the scan
+ * is finished and the channels are assigned.
+ *-----------------------------------------------------------------------------*/
+BOOL32 BtScanUpdate
+(
+    TA * p_ta,
+    const BT_SCAN_STATUS * p_status
+)
+{
+    UINT32 idx;
+
+    switch (p_status->status)
+    {
+        case BT_INQUIRY_SCAN_START:
+            // Drop the devices of the previous scan, keep the own entry
+            for (idx = 0; idx < table_count; idx++)
+            {
+                if (table[idx].is_own)
+                {
+                    table[0] = table[idx];
+                    break;
+                }
+            }
+            table_count = (idx < table_count) ? 1 : 0;
+            scan_state = BT_SCAN_RUNNING;
+            break;
+
+        case BT_INQUIRY_SCAN_RESULT:
+            if (!p_ta->hook_table.strncmp(p_status->bt_name, BT_SCAN_NAME_PREFIX, BT_SCAN_NAME_PREFIX_LEN))
+            {
+                BtScanInsert(p_ta, p_status->bt_addr, p_status->bt_name, FALSE);
+            }
+            scan_state = BT_SCAN_RUNNING;
+            break;
+
+        case BT_INQUIRY_SCAN_TIMEOUT:
+        case BT_INQUIRY_SCAN_END:
+            BtScanAssignChannels(p_ta);
+            scan_state = BT_SCAN_DONE;
+            return TRUE;
+
+        default: // BT_INQUIRY_SCAN_NOT_POSSIBLE, BT_INQUIRY_SCAN_BUSY
+            break;
+    }
+    return FALSE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : BtScanGetState
+ *
+ * Returns the state of the discovery.
+ *-----------------------------------------------------------------------------*/
+enum bt_scan_state_e BtScanGetState(void)
+{
+    return scan_state;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : BtScanGetCount
+ *
+ * Returns the number of entries in the peer table.
+ *-----------------------------------------------------------------------------*/
+UINT32 BtScanGetCount(void)
+{
+    return table_count;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : BtScanGetEntry
+ *
+ * Returns the entry with the given index or NULL.
+ *-----------------------------------------------------------------------------*/
+const BT_SCAN_ENTRY * BtScanGetEntry
+(
+    UINT32 idx
+)
+{
+    return (idx < table_count) ? &table[idx] : NULL;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : BtScanGetAddress
+ *
+ * Returns the Bluetooth address assigned to the given channel or NULL.
+ *-----------------------------------------------------------------------------*/
+UCHAR8 * BtScanGetAddress
+(
+    UINT32 channel
+)
+{
+    UINT32 idx = channel - BT_CHAN_IDX_MIN;
+
+    if (scan_state != BT_SCAN_DONE || channel < BT_CHAN_IDX_MIN || channel > BT_CHAN_IDX_MAX ||
+        idx >= table_count || table[idx].is_own)
+    {
+        return NULL;
+    }
+    return table[idx].bt_addr;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : BtScanFindChannel
+ *
+ * Returns the channel assigned to the Controller with the given name.
+ *-----------------------------------------------------------------------------*/
+UINT32 BtScanFindChannel
+(
+    TA * p_ta,
+    const char * name
+)
+{
+    UINT32 idx;
+
+    for (idx = 0; idx < table_count; idx++)
+    {
+        if (!p_ta->hook_table.strcmp(table[idx].name, name))
+        {
+            return table[idx].channel;
+        }
+    }
+    return BT_SCAN_NO_CHANNEL;
+}
@@ -0,0 +1,105 @@
+//=============================================================================
+// Header file for the Bluetooth peer discovery module.
+// Collects the results of a Bluetooth inquiry scan into a sorted table of
+// ROBO TX Controllers and assigns Bluetooth channels to them, so that the
+// set of communicating Controllers does not have to be compiled into the
+// program.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __PRG_BT_SCAN_H__
+#define __PRG_BT_SCAN_H__
+
+#include "ROBO_TX_PRG.h"
+
+#define BT_SCAN_NAME_PREFIX     "ROBO TX-"  // only devices with this name prefix are collected
+#define BT_SCAN_NAME_PREFIX_LEN 8
+
+#define BT_SCAN_TABLE_SIZE      16          // max. number of Controllers in the table (own one included)
+
+#define BT_SCAN_NO_CHANNEL      0           // channel value of an entry without assigned channel
+
+
+// State of the discovery
+enum bt_scan_state_e
+{
+    BT_SCAN_IDLE = 0,       // no scan results were received yet
+    BT_SCAN_RUNNING,        // scan results are being collected
+    BT_SCAN_DONE            // scan is finished, channels are assigned
+};
+
+
+// Entry of the peer table, 28 bytes
+typedef struct
+{
+    UCHAR8          bt_addr[BT_ADDR_LEN];           // Bluetooth address
+    UINT8           channel;                        // assigned channel (1...8) or BT_SCAN_NO_CHANNEL
+    BOOL8           is_own;                         // TRUE = entry of the local Controller
+    char            name[DEV_NAME_LEN_MAX + 1];     // Controller name, "ROBO TX-xxxxxxxx"
+    char            reserved[3];
+} BT_SCAN_ENTRY;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// This function clears the peer table and enters the address of the local Controller
+// (taken from the info structure) into it
+void BtScanReset
+(
+    TA * p_ta
+);
+
+
+// This function processes one inquiry scan status record. Returns TRUE when the scan
+// is finished and the channels are assigned.
+BOOL32 BtScanUpdate
+(
+    TA * p_ta,
+    const BT_SCAN_STATUS * p_status
+);
+
+
+// Returns the state of the discovery, see enum bt_scan_state_e
+enum bt_scan_state_e BtScanGetState(void);
+
+
+// Returns the number of entries in the peer table (own Controller included)
+UINT32 BtScanGetCount(void);
+
+
+// Returns the entry with the given index (0...BtScanGetCount() - 1) or NULL
+const BT_SCAN_ENTRY * BtScanGetEntry
+(
+    UINT32 idx
+);
+
+
+// Returns the Bluetooth address assigned to the given channel (1...8) or NULL
+UCHAR8 * BtScanGetAddress
+(
+    UINT32 channel
+);
+
+
+// Returns the channel assigned to the Controller with the given name
+// (for example "ROBO TX-315") or BT_SCAN_NO_CHANNEL
+UINT32 BtScanFindChannel
+(
+    TA * p_ta,
+    const char * name
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // __PRG_BT_SCAN_H__
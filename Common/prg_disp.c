@@ -12,7 +12,7 @@
 // free of any license obligations or authoring rights.
 //=============================================================================
 
-#include "ROBO_TX_PRG.H"
+#include "ROBO_TX_PRG.h"
 
 
 static int PrgDisp
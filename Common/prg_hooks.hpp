@@ -0,0 +1,207 @@
+//=============================================================================
+// Header file for the C++ interface to the hook functions, for C++ programs.
+// Thin typed objects over TA_HOOK_TABLE of the local Transfer Area:
+//   - Controller   time and IsRunAllowed;
+//   - ConfigUpdate changes of TA_CONFIG; config_id is increased once when the
+//                  object goes out of scope (RAII), so it cannot be forgotten;
+//   - Display      pop-up messages;
+//   - BtChannel<n> Bluetooth channel n, checked at compile time;
+//   - I2cDevice<a, p> I2C device at address a with protocol byte p.
+// Every object holds only the pointer to the local Transfer Area, all member
+// functions are inline, so a call compiles to the same indirect call through
+// the hook table as the C code. Callbacks are template arguments: the
+// function pointer is a constant in the code, no table of context pointers
+// and no trampoline function is needed. Such callbacks must not be static
+// (C++98 template arguments need external linkage). Without a callback
+// argument the results go to the callback mailbox (prg_mbox.h).
+//
+//     BtChannel<1> bt(p_ta_array);
+//     bt.Send(msg, sizeof(msg));                  // result to MboxBtCallback
+//     bt.Send<SendDone>(msg, sizeof(msg));        // result to SendDone
+//
+// The objects are meant to be local variables of PrgInit/PrgTic: the startup
+// code of the programs does not run constructors of global objects. Same
+// rules as prg_wiring.hpp: C++98, no exceptions, no RTTI.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __PRG_HOOKS_HPP__
+#define __PRG_HOOKS_HPP__
+
+#include "ROBO_TX_PRG.h"
+#include "prg_i2c.h"
+#include "prg_mbox.h"
+#include "prg_wiring.hpp"
+
+
+// Local Controller
+class Controller
+{
+public:
+    explicit Controller(TA * p_ta_array) : p_ta(&p_ta_array[TA_LOCAL]) {}
+
+    TA * Ta() const { return p_ta; }
+
+    UINT32 TimeMs() const { return p_ta->hook_table.GetSystemTime(TIMER_UNIT_MILLISECONDS); }
+    UINT32 TimeUs() const { return p_ta->hook_table.GetSystemTime(TIMER_UNIT_MICROSECONDS); }
+
+    // FALSE: the program should return to the firmware immediately
+    BOOL32 IsRunAllowed() const { return p_ta->hook_table.IsRunAllowed(); }
+
+private:
+    TA * p_ta;
+};
+
+
+// Change of the configuration of one Controller
+//
+//     {
+//         ConfigUpdate cfg(&p_ta_array[TA_LOCAL]);
+//         cfg->motor[0] = TRUE;
+//     }   // config_id += 1
+class ConfigUpdate
+{
+public:
+    explicit ConfigUpdate(TA * p_ta) : p_ta(p_ta) {}
+    ~ConfigUpdate() { p_ta->state.config_id += 1; }
+
+    TA_CONFIG * operator->() const { return &p_ta->config; }
+    TA_CONFIG & operator*() const { return p_ta->config; }
+
+private:
+    ConfigUpdate(const ConfigUpdate &);         // not copyable, config_id would be increased twice
+    void operator=(const ConfigUpdate &);
+
+    TA * p_ta;
+};
+
+
+// Display of the local Controller
+class Display
+{
+public:
+    explicit Display(TA * p_ta_array) : p_ta(&p_ta_array[TA_LOCAL]) {}
+
+    // TRUE: the display is being refreshed, new output should wait
+    BOOL32 IsBusy() const { return p_ta->hook_table.IsDisplayBeingRefreshed(p_ta); }
+
+    void Show(const char * p_msg) const { p_ta->hook_table.DisplayMsg(p_ta, const_cast<char *>(p_msg)); }
+
+    // Removes all pop-up messages and shows the main frame
+    void Clear() const { p_ta->hook_table.DisplayMsg(p_ta, NULL); }
+
+    // Formats a message into buf (with sprintf of the firmware) and shows it
+    template <int N, class A>
+    void Show(char (&buf)[N], const char * p_fmt, A a) const
+    {
+        p_ta->hook_table.sprintf(buf, p_fmt, a);
+        Show(buf);
+    }
+
+    template <int N, class A, class B>
+    void Show(char (&buf)[N], const char * p_fmt, A a, B b) const
+    {
+        p_ta->hook_table.sprintf(buf, p_fmt, a, b);
+        Show(buf);
+    }
+
+    template <int N, class A, class B, class C>
+    void Show(char (&buf)[N], const char * p_fmt, A a, B b, C c) const
+    {
+        p_ta->hook_table.sprintf(buf, p_fmt, a, b, c);
+        Show(buf);
+    }
+
+private:
+    TA * p_ta;
+};
+
+
+// Bluetooth channel BT_CHAN_IDX_MIN...BT_CHAN_IDX_MAX. The results of the
+// commands go to the callback given as template argument, or to the mailbox.
+template <UINT32 CHANNEL>
+class BtChannel
+{
+    WIRING_CHECK(CHANNEL >= BT_CHAN_IDX_MIN && CHANNEL <= BT_CHAN_IDX_MAX, bt_channel_out_of_range);
+
+public:
+    explicit BtChannel(TA * p_ta_array) : p_ta(&p_ta_array[TA_LOCAL]) {}
+
+    const BT_STATUS & Status() const { return p_ta->state.btstatus[CHANNEL - BT_CHAN_IDX_MIN]; }
+    BOOL32 IsConnected() const { return Status().conn_state == BT_STATE_CONNECTED; }
+
+    template <P_CB_FUNC CB>
+    void Connect(UCHAR8 * p_addr) const { p_ta->hook_table.BtConnect(CHANNEL, p_addr, CB); }
+    void Connect(UCHAR8 * p_addr) const { Connect<MboxBtCallback>(p_addr); }
+
+    template <P_CB_FUNC CB>
+    void Disconnect() const { p_ta->hook_table.BtDisconnect(CHANNEL, CB); }
+    void Disconnect() const { Disconnect<MboxBtCallback>(); }
+
+    template <P_CB_FUNC CB>
+    void Listen(UCHAR8 * p_addr) const { p_ta->hook_table.BtStartListen(CHANNEL, p_addr, CB); }
+    void Listen(UCHAR8 * p_addr) const { Listen<MboxBtCallback>(p_addr); }
+
+    template <P_CB_FUNC CB>
+    void StopListen() const { p_ta->hook_table.BtStopListen(CHANNEL, CB); }
+    void StopListen() const { StopListen<MboxBtCallback>(); }
+
+    template <P_CB_FUNC CB>
+    void Send(const UCHAR8 * p_msg, UINT32 len) const
+    {
+        p_ta->hook_table.BtSend(CHANNEL, len, const_cast<UCHAR8 *>(p_msg), CB);
+    }
+    void Send(const UCHAR8 * p_msg, UINT32 len) const { Send<MboxBtCallback>(p_msg, len); }
+
+    template <P_RECV_CB_FUNC CB>
+    void StartReceive() const { p_ta->hook_table.BtStartReceive(CHANNEL, CB); }
+    void StartReceive() const { StartReceive<MboxBtReceiveCallback>(); }
+
+    template <P_RECV_CB_FUNC CB>
+    void StopReceive() const { p_ta->hook_table.BtStopReceive(CHANNEL, CB); }
+    void StopReceive() const { StopReceive<MboxBtReceiveCallback>(); }
+
+private:
+    TA * p_ta;
+};
+
+
+// I2C device with the 7-bit address DEVADDR, PROTOCOL is the protocol byte of
+// its registers (I2C_PROTO_xxx). Read and Write return the result of the hook
+// function, the results of the transfers go to the callback given as template
+// argument, or to the mailbox. For batches with retries see prg_i2c_dev.h.
+template <UCHAR8 DEVADDR, UCHAR8 PROTOCOL>
+class I2cDevice
+{
+    WIRING_CHECK(DEVADDR < 0x80, i2c_address_out_of_range);
+    WIRING_CHECK(I2C_PROTO_OFFSET_LEN(PROTOCOL) <= 2 && I2C_PROTO_DATA_LEN(PROTOCOL) >= 1 &&
+                 I2C_PROTO_DATA_LEN(PROTOCOL) <= 2, i2c_protocol_invalid);
+
+public:
+    enum { ADDR = DEVADDR };
+
+    explicit I2cDevice(TA * p_ta_array) : p_ta(&p_ta_array[TA_LOCAL]) {}
+
+    template <P_I2C_CB_FUNC CB>
+    UINT32 Read(UINT32 offset) const { return p_ta->hook_table.I2cRead(DEVADDR, offset, PROTOCOL, CB); }
+    UINT32 Read(UINT32 offset) const { return Read<MboxI2cCallback>(offset); }
+
+    template <P_I2C_CB_FUNC CB>
+    UINT32 Write(UINT32 offset, UINT16 data) const
+    {
+        return p_ta->hook_table.I2cWrite(DEVADDR, offset, data, PROTOCOL, CB);
+    }
+    UINT32 Write(UINT32 offset, UINT16 data) const { return Write<MboxI2cCallback>(offset, data); }
+
+private:
+    TA * p_ta;
+};
+
+
+#endif // __PRG_HOOKS_HPP__
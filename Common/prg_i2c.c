@@ -0,0 +1,226 @@
+//=============================================================================
+// I2C job engine.
+// The queue of jobs is changed in PrgTic only. The job at the head of the
+// queue is handed over to the callback context when it is started and comes
+// back when its state becomes I2C_JOB_FINISHED.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "prg_i2c.h"
+
+#define I2C_BARRIER()       __asm__ __volatile__ ("" : : : "memory")
+
+static I2C_JOB * p_head;            // running (or finished) job, followed by the queued ones
+static I2C_JOB * p_tail;
+static TA * p_ta_local;             // Transfer Area for the hook functions in the callback context
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cJobIssue
+ *
+ * Issues the next operation of the running job. Returns FALSE if the job is
+ * finished.
+ *-----------------------------------------------------------------------------*/
+static void I2cJobCallback(TA * p_ta_array, I2C_CB * p_data);
+
+static BOOL32 I2cJobIssue
+(
+    I2C_JOB * p_job
+)
+{
+    const I2C_OP * p_op;
+    UINT32 rc;
+
+    if (p_job->n_done >= p_job->n_ops)
+    {
+        return FALSE;
+    }
+    p_op = &p_job->p_ops[p_job->n_done];
+    if (p_op->is_write)
+    {
+        rc = p_ta_local->hook_table.I2cWrite(p_op->devaddr, p_op->offset, p_op->data,
+            p_op->protocol, I2cJobCallback);
+    }
+    else
+    {
+        rc = p_ta_local->hook_table.I2cRead(p_op->devaddr, p_op->offset, p_op->protocol, I2cJobCallback);
+    }
+    if (rc != 0)
+    {
+        p_job->status = I2C_NOT_ACCEPTED;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cJobFinish
+ *-----------------------------------------------------------------------------*/
+static void I2cJobFinish
+(
+    I2C_JOB * p_job
+)
+{
+    p_job->t_end_us = p_ta_local->hook_table.GetSystemTime(TIMER_UNIT_MICROSECONDS);
+    I2C_BARRIER();
+    p_job->state = I2C_JOB_FINISHED;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cJobCallback
+ *
+ * Stores the result of the operation and issues the next one, or the failed
+ * one again.
+ *-----------------------------------------------------------------------------*/
+static void I2cJobCallback
+(
+    TA * p_ta_array,
+    I2C_CB * p_data
+)
+{
+    I2C_JOB * p_job = p_head;
+
+    if (!p_job || p_job->state != I2C_JOB_RUNNING)
+    {
+        return;
+    }
+
+    if (p_data->status != I2C_SUCCESS)
+    {
+        p_job->status = p_data->status;
+        if (p_job->n_retries < p_job->retry_max)
+        {
+            p_job->n_retries++;
+            p_job->status = I2C_SUCCESS;
+            if (I2cJobIssue(p_job))
+            {
+                return;
+            }
+        }
+        I2cJobFinish(p_job);
+        return;
+    }
+    if (!p_job->p_ops[p_job->n_done].is_write)
+    {
+        p_job->p_ops[p_job->n_done].data = p_data->value;
+    }
+    p_job->n_done++;
+
+    if (!I2cJobIssue(p_job))
+    {
+        I2cJobFinish(p_job);
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cJobStart
+ *-----------------------------------------------------------------------------*/
+static void I2cJobStart
+(
+    I2C_JOB * p_job
+)
+{
+    p_job->status = I2C_SUCCESS;
+    p_job->n_done = 0;
+    p_job->n_retries = 0;
+    p_job->t_start_us = p_ta_local->hook_table.GetSystemTime(TIMER_UNIT_MICROSECONDS);
+    p_job->t_end_us = p_job->t_start_us;
+    I2C_BARRIER();
+    p_job->state = I2C_JOB_RUNNING;
+
+    if (!I2cJobIssue(p_job))
+    {
+        I2cJobFinish(p_job);
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cJobSubmit
+ *
+ * Appends a job to the queue.
+ *-----------------------------------------------------------------------------*/
+BOOL32 I2cJobSubmit
+(
+    I2C_JOB * p_job
+)
+{
+    if (p_job->state != I2C_JOB_IDLE)
+    {
+        return FALSE;
+    }
+    p_job->p_next = NULL;
+    p_job->state = I2C_JOB_QUEUED;
+    if (p_tail)
+    {
+        p_tail->p_next = p_job;
+    }
+    else
+    {
+        p_head = p_job;
+    }
+    p_tail = p_job;
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cJobPoll
+ *
+ * Completes the finished job and starts the next one.
+ *-----------------------------------------------------------------------------*/
+void I2cJobPoll
+(
+    TA * p_ta_array
+)
+{
+    I2C_JOB * p_job;
+
+    p_ta_local = &p_ta_array[TA_LOCAL];
+
+    while ((p_job = p_head) != NULL)
+    {
+        if (p_job->state == I2C_JOB_RUNNING)
+        {
+            return;
+        }
+        if (p_job->state == I2C_JOB_QUEUED)
+        {
+            // The job may finish at once if the firmware does not accept the command
+            I2cJobStart(p_job);
+            continue;
+        }
+
+        // Finished: unlink and complete, the completion function may submit the job again
+        I2C_BARRIER();
+        p_head = p_job->p_next;
+        if (!p_head)
+        {
+            p_tail = NULL;
+        }
+        p_job->p_next = NULL;
+        p_job->state = I2C_JOB_IDLE;
+        if (p_job->Done)
+        {
+            p_job->Done(p_ta_array, p_job);
+        }
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cJobIsIdle
+ *-----------------------------------------------------------------------------*/
+BOOL32 I2cJobIsIdle(void)
+{
+    return p_head == NULL;
+}
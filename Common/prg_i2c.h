@@ -0,0 +1,122 @@
+//=============================================================================
+// Header file for the I2C job engine.
+// An I2C job is a sequence of I2C operations (reads and writes), which is
+// executed as one batch: the next operation is issued directly from the
+// callback of the previous one, so the bus does not stay idle until the
+// next program tick. Jobs are submitted and completed in PrgTic (I2cJobPoll);
+// a running job is owned by the callback context until it is finished, so
+// the program and the callbacks never change the same data at the same
+// time.
+//
+// A failed operation is issued again right away as long as the retry budget
+// of the job (retry_max) is not used up; the job fails with the status of
+// the operation otherwise.
+//
+// Protocol byte of the I2C hook functions (as used by the demo programs):
+//   bits 0-1: number of offset (register address) bytes
+//   bits 2-3: number of data bytes
+//   bit  5:   fast mode (400 kHz), otherwise standard mode (100 kHz)
+//   bit  7:   always set
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __PRG_I2C_H__
+#define __PRG_I2C_H__
+
+#include "ROBO_TX_PRG.h"
+
+#define I2C_PROTO_BASE          0x80
+#define I2C_PROTO_OFFSET_0      0x00    // no offset byte
+#define I2C_PROTO_OFFSET_1      0x01    // one offset byte
+#define I2C_PROTO_DATA_1        0x04    // one data byte
+#define I2C_PROTO_DATA_2        0x08    // two data bytes
+#define I2C_PROTO_FAST          0x20    // 400 kHz
+
+#define I2C_PROTO_OFFSET_LEN(protocol)  ((protocol) & 0x03)
+#define I2C_PROTO_DATA_LEN(protocol)    (((protocol) >> 2) & 0x03)
+
+#define I2C_NOT_ACCEPTED        0x80    // job status: the firmware did not accept the command
+
+
+// Operation of a job
+typedef struct
+{
+    UCHAR8          devaddr;        // 7-bit device address
+    UCHAR8          protocol;       // see I2C_PROTO_xxx
+    BOOL8           is_write;
+    UCHAR8          reserved;
+    UINT16          offset;         // register address
+    UINT16          data;           // value to write / value read
+} I2C_OP;
+
+
+// State of a job
+enum i2c_job_state_e
+{
+    I2C_JOB_IDLE = 0,       // not submitted or completed
+    I2C_JOB_QUEUED,         // waiting for the bus
+    I2C_JOB_RUNNING,        // operations are being executed (owned by the callback context)
+    I2C_JOB_FINISHED        // executed, waiting for I2cJobPoll
+};
+
+
+struct i2c_job_s;
+
+// Completion function, called from I2cJobPoll
+typedef void (*P_I2C_JOB_DONE)(TA * p_ta_array, struct i2c_job_s * p_job);
+
+
+// Job. The first part is set by the owner, the rest is maintained by the engine.
+typedef struct i2c_job_s
+{
+    I2C_OP        * p_ops;
+    UINT32          n_ops;
+    P_I2C_JOB_DONE  Done;           // may be NULL
+    void          * p_ctx;          // context of the owner
+    UINT32          retry_max;      // retry budget: max. number of retries of failed operations per execution
+
+    struct i2c_job_s * p_next;
+    volatile UINT16 state;          // see enum i2c_job_state_e
+    UINT16          status;         // I2C_SUCCESS, status of the failed operation or I2C_NOT_ACCEPTED
+    UINT32          n_done;         // number of successfully executed operations
+    UINT32          n_retries;      // number of retries of the last execution
+    UINT32          t_start_us;     // time of issuing the first operation
+    UINT32          t_end_us;       // time of the completion of the last operation
+} I2C_JOB;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// This function appends a job to the queue of the bus. Returns FALSE if the job
+// is still submitted.
+BOOL32 I2cJobSubmit
+(
+    I2C_JOB * p_job
+);
+
+
+// This function completes the finished job (calls its completion function) and
+// starts the next queued one. Should be called at the beginning of PrgTic.
+void I2cJobPoll
+(
+    TA * p_ta_array
+);
+
+
+// Returns TRUE if no job is queued or running
+BOOL32 I2cJobIsIdle(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // __PRG_I2C_H__
@@ -0,0 +1,362 @@
+//=============================================================================
+// I2C device layer.
+// The operations of a batch are collected directly in the I2C job of the
+// device; op_reg remembers the register of each operation, so the results
+// can be stored in the cache when the job is completed. Multi-byte values
+// are transferred with the most significant byte first.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "prg_i2c_dev.h"
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cDevFailed
+ *
+ * Counts a failed batch and takes the device off the bus after too many
+ * failures in a row or a failed probe.
+ *-----------------------------------------------------------------------------*/
+static void I2cDevFailed
+(
+    I2C_DEV * p_dev
+)
+{
+    if (p_dev->fail_count < 0xFF)
+    {
+        p_dev->fail_count++;
+    }
+    if (p_dev->health != I2C_DEV_HEALTH_PROBE && p_dev->fail_count < I2C_DEV_FAIL_MAX)
+    {
+        return;
+    }
+
+    // Exponential back-off
+    if (!p_dev->backoff_ms)
+    {
+        p_dev->backoff_ms = I2C_DEV_BACKOFF_MIN_MS;
+    }
+    else if (p_dev->backoff_ms < I2C_DEV_BACKOFF_MAX_MS)
+    {
+        p_dev->backoff_ms *= 2;
+        if (p_dev->backoff_ms > I2C_DEV_BACKOFF_MAX_MS)
+        {
+            p_dev->backoff_ms = I2C_DEV_BACKOFF_MAX_MS;
+        }
+    }
+    p_dev->health = I2C_DEV_HEALTH_OFF;
+    p_dev->off_until_ms = p_dev->p_ta->hook_table.GetSystemTime(TIMER_UNIT_MILLISECONDS) + p_dev->backoff_ms;
+    p_dev->n_trips++;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cDevDone
+ *
+ * Completion function of the I2C job: stores the results in the cache.
+ *-----------------------------------------------------------------------------*/
+static void I2cDevDone
+(
+    TA * p_ta_array,
+    I2C_JOB * p_job
+)
+{
+    I2C_DEV * p_dev = (I2C_DEV *)p_job->p_ctx;
+    UINT32 idx;
+
+    if (p_dev->is_blocked)
+    {
+        // The batch was not executed
+        p_dev->is_blocked = FALSE;
+        p_dev->status = I2C_DEV_OFFLINE;
+        p_dev->n_ops = 0;
+        if (p_dev->Done)
+        {
+            p_dev->Done(p_ta_array, p_dev);
+        }
+        return;
+    }
+    p_dev->n_retries += p_job->n_retries;
+
+    for (idx = 0; idx < p_job->n_done; idx++)
+    {
+        const I2C_OP * p_op = &p_dev->ops[idx];
+        UINT32 reg = p_dev->op_reg[idx];
+
+        if (!p_op->is_write && I2C_PROTO_DATA_LEN(p_op->protocol) > I2C_PROTO_DATA_LEN(p_dev->p_desc->p_regs[reg].protocol))
+        {
+            // Merged read of two 8-bit registers
+            p_dev->cache[reg] = p_op->data >> 8;
+            p_dev->cache[reg + 1] = p_op->data & 0xFF;
+            p_dev->cache_valid |= 3UL << reg;
+        }
+        else
+        {
+            p_dev->cache[reg] = p_op->data;
+            p_dev->cache_valid |= 1UL << reg;
+        }
+    }
+    if (p_job->status != I2C_SUCCESS)
+    {
+        p_dev->cache_valid = 0;
+        p_dev->n_failed++;
+        I2cDevFailed(p_dev);
+    }
+    else if (p_job->n_ops)
+    {
+        // An empty batch tells nothing about the device
+        p_dev->health = I2C_DEV_HEALTH_OK;
+        p_dev->fail_count = 0;
+        p_dev->backoff_ms = 0;
+    }
+
+    p_dev->status = p_job->status;
+    p_dev->n_ops = 0;
+    if (p_dev->Done)
+    {
+        p_dev->Done(p_ta_array, p_dev);
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cDevInit
+ *-----------------------------------------------------------------------------*/
+void I2cDevInit
+(
+    I2C_DEV * p_dev,
+    TA * p_ta_array,
+    const I2C_DEV_DESC * p_desc,
+    UCHAR8 devaddr,
+    P_I2C_DEV_DONE Done,
+    void * p_ctx
+)
+{
+    p_dev->p_desc = p_desc;
+    p_dev->devaddr = devaddr;
+    p_dev->n_ops = 0;
+    p_dev->status = I2C_SUCCESS;
+    p_dev->Done = Done;
+    p_dev->p_ctx = p_ctx;
+    p_dev->p_ta = &p_ta_array[TA_LOCAL];
+    p_dev->cache_valid = 0;
+
+    p_dev->health = I2C_DEV_HEALTH_OK;
+    p_dev->fail_count = 0;
+    p_dev->is_blocked = FALSE;
+    p_dev->backoff_ms = 0;
+    p_dev->off_until_ms = 0;
+
+    p_dev->n_batches = 0;
+    p_dev->n_failed = 0;
+    p_dev->n_retries = 0;
+    p_dev->n_blocked = 0;
+    p_dev->n_trips = 0;
+    p_dev->n_merged = 0;
+    p_dev->n_skipped = 0;
+
+    p_dev->job.p_ops = p_dev->ops;
+    p_dev->job.n_ops = 0;
+    p_dev->job.retry_max = I2C_DEV_RETRY_MAX;
+    p_dev->job.Done = I2cDevDone;
+    p_dev->job.p_ctx = p_dev;
+    p_dev->job.state = I2C_JOB_IDLE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cDevAddOp
+ *-----------------------------------------------------------------------------*/
+static BOOL32 I2cDevAddOp
+(
+    I2C_DEV * p_dev,
+    UINT32 reg,
+    BOOL32 is_write,
+    UINT16 value
+)
+{
+    const I2C_REG * p_reg = &p_dev->p_desc->p_regs[reg];
+    I2C_OP * p_op;
+
+    if (p_dev->n_ops >= I2C_DEV_OPS_MAX)
+    {
+        return FALSE;
+    }
+    p_op = &p_dev->ops[p_dev->n_ops];
+    p_dev->op_reg[p_dev->n_ops] = (UCHAR8)reg;
+    p_dev->n_ops++;
+
+    p_op->devaddr = p_dev->devaddr;
+    p_op->is_write = is_write;
+    if (p_reg->flags & I2C_REG_CMD)
+    {
+        p_op->protocol = (p_reg->protocol & ~0x03) | I2C_PROTO_OFFSET_0;
+        p_op->offset = 0;
+        p_op->data = p_reg->offset;
+    }
+    else
+    {
+        p_op->protocol = p_reg->protocol;
+        p_op->offset = p_reg->offset;
+        p_op->data = value;
+    }
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cDevRead
+ *-----------------------------------------------------------------------------*/
+BOOL32 I2cDevRead
+(
+    I2C_DEV * p_dev,
+    UINT32 reg,
+    UINT32 n
+)
+{
+    const I2C_REG * p_regs = p_dev->p_desc->p_regs;
+
+    if (p_dev->job.state != I2C_JOB_IDLE || reg + n > p_dev->p_desc->n_regs)
+    {
+        return FALSE;
+    }
+
+    while (n--)
+    {
+        I2C_OP * p_last = (p_dev->n_ops) ? &p_dev->ops[p_dev->n_ops - 1] : NULL;
+
+        // Merge with the read of the previous register
+        if (p_last && !p_last->is_write && (p_dev->p_desc->flags & I2C_DEV_AUTOINC) &&
+            p_dev->op_reg[p_dev->n_ops - 1] + 1 == reg &&
+            p_regs[reg].offset == p_last->offset + 1 && p_regs[reg].protocol == p_last->protocol &&
+            I2C_PROTO_DATA_LEN(p_regs[reg].protocol) == 1 &&
+            !(p_regs[reg].flags & I2C_REG_CMD))
+        {
+            p_last->protocol = (p_last->protocol & ~0x0C) | I2C_PROTO_DATA_2;
+            p_dev->n_merged++;
+        }
+        else if (!I2cDevAddOp(p_dev, reg, FALSE, 0))
+        {
+            return FALSE;
+        }
+        reg++;
+    }
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cDevWrite
+ *-----------------------------------------------------------------------------*/
+BOOL32 I2cDevWrite
+(
+    I2C_DEV * p_dev,
+    UINT32 reg,
+    UINT16 value
+)
+{
+    const I2C_REG * p_reg;
+
+    if (p_dev->job.state != I2C_JOB_IDLE || reg >= p_dev->p_desc->n_regs)
+    {
+        return FALSE;
+    }
+    p_reg = &p_dev->p_desc->p_regs[reg];
+
+    if (!(p_reg->flags & (I2C_REG_VOLATILE | I2C_REG_CMD)) &&
+        (p_dev->cache_valid & (1UL << reg)) && p_dev->cache[reg] == value)
+    {
+        p_dev->n_skipped++;
+        return TRUE;
+    }
+    return I2cDevAddOp(p_dev, reg, TRUE, value);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cDevSubmit
+ *-----------------------------------------------------------------------------*/
+BOOL32 I2cDevSubmit
+(
+    I2C_DEV * p_dev
+)
+{
+    UINT32 now;
+
+    if (p_dev->job.state != I2C_JOB_IDLE)
+    {
+        return FALSE;
+    }
+
+    p_dev->job.retry_max = I2C_DEV_RETRY_MAX;
+    if (p_dev->health == I2C_DEV_HEALTH_OFF)
+    {
+        now = p_dev->p_ta->hook_table.GetSystemTime(TIMER_UNIT_MILLISECONDS);
+        if ((INT32)(now - p_dev->off_until_ms) < 0)
+        {
+            // Completed as empty job, the driver is informed as usual
+            p_dev->is_blocked = TRUE;
+            p_dev->n_ops = 0;
+            p_dev->n_blocked++;
+        }
+        else
+        {
+            p_dev->health = I2C_DEV_HEALTH_PROBE;
+        }
+    }
+    if (p_dev->health == I2C_DEV_HEALTH_PROBE)
+    {
+        p_dev->job.retry_max = 0;
+    }
+
+    p_dev->job.n_ops = p_dev->n_ops;
+    if (!I2cJobSubmit(&p_dev->job))
+    {
+        p_dev->is_blocked = FALSE;
+        return FALSE;
+    }
+    p_dev->n_batches++;
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cDevIsIdle
+ *-----------------------------------------------------------------------------*/
+BOOL32 I2cDevIsIdle
+(
+    const I2C_DEV * p_dev
+)
+{
+    return p_dev->job.state == I2C_JOB_IDLE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cDevGet
+ *-----------------------------------------------------------------------------*/
+UINT16 I2cDevGet
+(
+    const I2C_DEV * p_dev,
+    UINT32 reg
+)
+{
+    return p_dev->cache[reg];
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cDevInvalidate
+ *-----------------------------------------------------------------------------*/
+void I2cDevInvalidate
+(
+    I2C_DEV * p_dev
+)
+{
+    p_dev->cache_valid = 0;
+}
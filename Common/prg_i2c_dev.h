@@ -0,0 +1,201 @@
+//=============================================================================
+// Header file for the I2C device layer.
+// A device type is described by a const table of its registers: register
+// address (or command code), protocol byte (number of offset and data
+// bytes, bus speed) and access flags. A driver collects the register reads
+// and writes of one update in a batch and submits it as one I2C job:
+//   - reads of adjacent 8-bit registers are merged into one 16-bit read if
+//     the device increments the register address itself (I2C_DEV_AUTOINC);
+//   - the last known value of each register is cached, and writes of the
+//     cached value are skipped (except for volatile and command registers).
+// After a failed job the whole cache of the device is invalidated, because
+// the state of the device is not known any more (it may have been reset).
+//
+// Error recovery: failed operations are retried up to I2C_DEV_RETRY_MAX
+// times per batch (transient errors). After I2C_DEV_FAIL_MAX failed batches
+// in a row the device is taken off the bus (circuit breaker open): its
+// batches complete with the status I2C_DEV_OFFLINE without bus access. When
+// the back-off time has passed, the next batch is executed as a probe
+// without retries; if it succeeds the device is back, otherwise it is taken
+// off the bus again for twice the time (up to I2C_DEV_BACKOFF_MAX_MS).
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __PRG_I2C_DEV_H__
+#define __PRG_I2C_DEV_H__
+
+#include "prg_i2c.h"
+
+#define I2C_DEV_REGS_MAX        32      // max. number of registers of a device type
+#define I2C_DEV_OPS_MAX         16      // max. number of operations of a batch
+
+// Register flags
+#define I2C_REG_READ            0x01
+#define I2C_REG_WRITE           0x02
+#define I2C_REG_RW              (I2C_REG_READ | I2C_REG_WRITE)
+#define I2C_REG_VOLATILE        0x04    // changed by the device, writes are never skipped
+#define I2C_REG_CMD             0x08    // command: the address is written as data byte without offset
+
+// Device type flags
+#define I2C_DEV_AUTOINC         0x01    // sequential reads of 8-bit registers
+
+// Error recovery
+#define I2C_DEV_RETRY_MAX       2       // retries per batch
+#define I2C_DEV_FAIL_MAX        3       // failed batches in a row which take the device off the bus
+#define I2C_DEV_BACKOFF_MIN_MS  100
+#define I2C_DEV_BACKOFF_MAX_MS  10000
+
+#define I2C_DEV_OFFLINE         0x81    // batch status: not executed, the device is off the bus
+
+
+// Health of a device
+enum i2c_dev_health_e
+{
+    I2C_DEV_HEALTH_OK = 0,      // batches are executed
+    I2C_DEV_HEALTH_OFF,         // off the bus until off_until_ms
+    I2C_DEV_HEALTH_PROBE        // the next batch decides
+};
+
+
+// Register
+typedef struct
+{
+    UINT16          offset;         // register address / command code
+    UCHAR8          protocol;       // see I2C_PROTO_xxx
+    UCHAR8          flags;          // see I2C_REG_xxx
+} I2C_REG;
+
+
+// Device type
+typedef struct
+{
+    const char    * name;
+    const I2C_REG * p_regs;
+    UCHAR8          n_regs;
+    UCHAR8          flags;          // see I2C_DEV_xxx
+} I2C_DEV_DESC;
+
+
+struct i2c_dev_s;
+
+// Completion function of a batch, called from I2cJobPoll
+typedef void (*P_I2C_DEV_DONE)(TA * p_ta_array, struct i2c_dev_s * p_dev);
+
+
+// Device. All fields are maintained by the layer.
+typedef struct i2c_dev_s
+{
+    const I2C_DEV_DESC * p_desc;
+    UCHAR8          devaddr;
+    UCHAR8          n_ops;          // operations of the batch being collected / executed
+    UINT16          status;         // status of the last batch
+    P_I2C_DEV_DONE  Done;
+    void          * p_ctx;          // context of the driver
+    TA            * p_ta;           // local Transfer Area, for the time
+
+    UINT16          cache[I2C_DEV_REGS_MAX];
+    UINT32          cache_valid;    // bit n: cache[n] is valid
+
+    // Health
+    UCHAR8          health;         // see enum i2c_dev_health_e
+    UCHAR8          fail_count;     // failed batches in a row
+    BOOL8           is_blocked;     // the submitted batch is not executed
+    UCHAR8          reserved;
+    UINT32          backoff_ms;     // current back-off time
+    UINT32          off_until_ms;
+
+    // Counters
+    UINT32          n_batches;
+    UINT32          n_failed;       // failed batches
+    UINT32          n_retries;      // retried operations
+    UINT32          n_blocked;      // batches not executed, because the device was off the bus
+    UINT32          n_trips;        // number of times the device was taken off the bus
+    UINT32          n_merged;       // reads saved by merging
+    UINT32          n_skipped;      // writes saved by the cache
+
+    UCHAR8          op_reg[I2C_DEV_OPS_MAX];    // first register of each operation
+    I2C_OP          ops[I2C_DEV_OPS_MAX];
+    I2C_JOB         job;
+} I2C_DEV;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// This function initializes a device with an empty cache and good health
+void I2cDevInit
+(
+    I2C_DEV * p_dev,
+    TA * p_ta_array,
+    const I2C_DEV_DESC * p_desc,
+    UCHAR8 devaddr,
+    P_I2C_DEV_DONE Done,
+    void * p_ctx
+);
+
+
+// This function adds the read of n registers starting with reg to the batch.
+// Returns FALSE if the batch is full or the previous batch is not completed yet.
+BOOL32 I2cDevRead
+(
+    I2C_DEV * p_dev,
+    UINT32 reg,
+    UINT32 n
+);
+
+
+// This function adds a register write to the batch, unless the register is
+// known to have the value already. Returns FALSE if the batch is full or the
+// previous batch is not completed yet.
+BOOL32 I2cDevWrite
+(
+    I2C_DEV * p_dev,
+    UINT32 reg,
+    UINT16 value
+);
+
+
+// This function submits the batch (it may be empty, then it completes in the
+// next I2cJobPoll). If the device is off the bus the batch is dropped and
+// completes with the status I2C_DEV_OFFLINE. Returns FALSE if the previous
+// batch is not completed yet.
+BOOL32 I2cDevSubmit
+(
+    I2C_DEV * p_dev
+);
+
+
+// Returns TRUE if no batch is submitted
+BOOL32 I2cDevIsIdle
+(
+    const I2C_DEV * p_dev
+);
+
+
+// Returns the cached value of a register
+UINT16 I2cDevGet
+(
+    const I2C_DEV * p_dev,
+    UINT32 reg
+);
+
+
+// This function marks all cached values as unknown
+void I2cDevInvalidate
+(
+    I2C_DEV * p_dev
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // __PRG_I2C_DEV_H__
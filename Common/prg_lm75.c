@@ -0,0 +1,302 @@
+//=============================================================================
+// Driver of the LM75 class temperature sensors.
+// The differences of the sensor types are described by tables: the
+// registers (LM75) or commands (DS1631) for the I2C device layer, the bits
+// of the configuration register and the conversion time. Both register
+// tables have the same order, so the driver uses the same register indices
+// for all types.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "prg_lm75.h"
+
+// Register indices
+#define LM75_REG_TEMP       0
+#define LM75_REG_CONFIG     1
+#define LM75_REG_HIGH       2
+#define LM75_REG_LOW        3
+#define LM75_REG_START      4       // start convert command (DS1631 only)
+
+#define LM75_PROTO_REG8     (I2C_PROTO_BASE | I2C_PROTO_OFFSET_1 | I2C_PROTO_DATA_1)
+#define LM75_PROTO_REG16    (I2C_PROTO_BASE | I2C_PROTO_OFFSET_1 | I2C_PROTO_DATA_2)
+
+
+static const I2C_REG lm75_regs[] =
+{
+    { 0x00, LM75_PROTO_REG16, I2C_REG_READ | I2C_REG_VOLATILE },
+    { 0x01, LM75_PROTO_REG8,  I2C_REG_RW },
+    { 0x03, LM75_PROTO_REG16, I2C_REG_RW },     // TOS
+    { 0x02, LM75_PROTO_REG16, I2C_REG_RW }      // THYST
+};
+
+static const I2C_REG ds1631_regs[] =
+{
+    { 0xAA, LM75_PROTO_REG16, I2C_REG_READ | I2C_REG_VOLATILE },
+    { 0xAC, LM75_PROTO_REG8,  I2C_REG_RW },
+    { 0xA1, LM75_PROTO_REG16, I2C_REG_RW },     // TH
+    { 0xA2, LM75_PROTO_REG16, I2C_REG_RW },     // TL
+    { 0x51, LM75_PROTO_REG8,  I2C_REG_WRITE | I2C_REG_CMD }
+};
+
+
+// Description of a sensor type
+typedef struct
+{
+    I2C_DEV_DESC    dev;
+    UCHAR8          cfg_pol;        // polarity bit of the configuration register
+    UCHAR8          cfg_res_shift;  // position of the resolution bits, 0 = fixed resolution
+    UCHAR8          eeprom_ms;      // write time of the configuration registers, 0 = no EEPROM
+    UINT16          conv_ms;        // conversion time at 9 bit
+} LM75_DESC;
+
+static const LM75_DESC lm75_desc[LM75_KIND_COUNT] =
+{
+    // LM75: one shot and continuous mode are selected by the shutdown bit (0)
+    { { "LM75", lm75_regs, sizeof(lm75_regs) / sizeof(lm75_regs[0]), 0 }, 0x04, 0, 0, 100 },
+
+    // DS1631: continuous mode is selected by the 1SHOT bit (0) and started by
+    // the start convert command
+    { { "DS1631", ds1631_regs, sizeof(ds1631_regs) / sizeof(ds1631_regs[0]), 0 }, 0x02, 2, 10, 94 }
+};
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Lm75GetConversionTime
+ *-----------------------------------------------------------------------------*/
+UINT32 Lm75GetConversionTime
+(
+    UCHAR8 kind,
+    UCHAR8 resolution
+)
+{
+    const LM75_DESC * p_desc = &lm75_desc[kind];
+
+    if (!p_desc->cfg_res_shift || resolution <= 9)
+    {
+        return p_desc->conv_ms;
+    }
+    return p_desc->conv_ms << (resolution - 9);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Lm75Done
+ *
+ * Completion function of the batch.
+ *-----------------------------------------------------------------------------*/
+static void Lm75Done
+(
+    TA * p_ta_array,
+    I2C_DEV * p_dev
+)
+{
+    LM75 * p_lm75 = (LM75 *)p_dev->p_ctx;
+
+    p_lm75->status = p_dev->status;
+    if (p_dev->status != I2C_SUCCESS)
+    {
+        // The configuration is written completely again
+        p_lm75->config_step = 0;
+        p_lm75->state = LM75_STATE_CONFIG;
+        if (p_dev->status != I2C_DEV_OFFLINE)
+        {
+            p_lm75->n_errors++;
+        }
+        return;
+    }
+
+    if (p_lm75->state == LM75_STATE_CONFIG)
+    {
+        if (p_lm75->config_step < lm75_desc[p_lm75->kind].dev.n_regs)
+        {
+            return;
+        }
+
+        // The first sample is read after the first conversion
+        p_lm75->state = LM75_STATE_RUN;
+        p_lm75->next_ms += p_lm75->config.period_ms;
+        return;
+    }
+
+    p_lm75->temp = (INT16)I2cDevGet(p_dev, LM75_REG_TEMP);
+    p_lm75->n_samples++;
+    p_lm75->is_new = TRUE;
+
+    if (p_lm75->temp >= p_lm75->config.high)
+    {
+        p_lm75->alarm = TRUE;
+    }
+    else if (p_lm75->temp < p_lm75->config.low)
+    {
+        p_lm75->alarm = FALSE;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Lm75Init
+ *-----------------------------------------------------------------------------*/
+void Lm75Init
+(
+    LM75 * p_lm75,
+    TA * p_ta_array,
+    UCHAR8 kind,
+    UCHAR8 devaddr,
+    const LM75_CONFIG * p_config
+)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+    const LM75_DESC * p_desc;
+
+    p_ta->hook_table.memset(p_lm75, 0, sizeof(*p_lm75));
+    p_lm75->kind = (kind < LM75_KIND_COUNT) ? kind : LM75_KIND_LM75;
+    p_lm75->devaddr = devaddr;
+    p_lm75->config = *p_config;
+    p_lm75->state = LM75_STATE_CONFIG;
+    p_desc = &lm75_desc[p_lm75->kind];
+
+    if (p_desc->cfg_res_shift)
+    {
+        if (p_lm75->config.resolution < 9)
+        {
+            p_lm75->config.resolution = 9;
+        }
+        else if (p_lm75->config.resolution > 12)
+        {
+            p_lm75->config.resolution = 12;
+        }
+        p_lm75->cfg |= (p_lm75->config.resolution - 9) << p_desc->cfg_res_shift;
+    }
+    else
+    {
+        p_lm75->config.resolution = 9;
+    }
+    if (p_lm75->config.alarm_high)
+    {
+        p_lm75->cfg |= p_desc->cfg_pol;
+    }
+    if (!p_lm75->config.period_ms)
+    {
+        p_lm75->config.period_ms = Lm75GetConversionTime(p_lm75->kind, p_lm75->config.resolution);
+    }
+
+    I2cDevInit(&p_lm75->dev, p_ta_array, &p_desc->dev, devaddr, Lm75Done, p_lm75);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Lm75AddConfig
+ *
+ * Adds the write of the next configuration register to the batch.
+ *-----------------------------------------------------------------------------*/
+static void Lm75AddConfig
+(
+    LM75 * p_lm75
+)
+{
+    UINT32 reg = p_lm75->config_step++;
+
+    switch (reg)
+    {
+        case LM75_REG_CONFIG:
+            I2cDevWrite(&p_lm75->dev, reg, p_lm75->cfg);
+            break;
+        case LM75_REG_HIGH:
+            I2cDevWrite(&p_lm75->dev, reg, p_lm75->config.high);
+            break;
+        case LM75_REG_LOW:
+            I2cDevWrite(&p_lm75->dev, reg, p_lm75->config.low);
+            break;
+        case LM75_REG_START:
+            I2cDevWrite(&p_lm75->dev, reg, 0);
+            break;
+        default:
+            break;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Lm75Tick
+ *
+ * Submits the next batch when it is due.
+ *-----------------------------------------------------------------------------*/
+void Lm75Tick
+(
+    LM75 * p_lm75,
+    TA * p_ta_array
+)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+    const LM75_DESC * p_desc = &lm75_desc[p_lm75->kind];
+    UINT32 now;
+
+    if (!I2cDevIsIdle(&p_lm75->dev))
+    {
+        return;
+    }
+    now = p_ta->hook_table.GetSystemTime(TIMER_UNIT_MILLISECONDS);
+    if ((INT32)(now - p_lm75->next_ms) < 0)
+    {
+        return;
+    }
+
+    // No batches while the device is off the bus, the next one is the probe
+    if (p_lm75->dev.health == I2C_DEV_HEALTH_OFF && (INT32)(now - p_lm75->dev.off_until_ms) < 0)
+    {
+        p_lm75->status = I2C_DEV_OFFLINE;
+        p_lm75->next_ms = p_lm75->dev.off_until_ms;
+        return;
+    }
+
+    if (p_lm75->state == LM75_STATE_CONFIG)
+    {
+        // The temperature register is not written
+        if (p_lm75->config_step == LM75_REG_TEMP)
+        {
+            p_lm75->config_step++;
+        }
+        if (p_desc->eeprom_ms)
+        {
+            // One register per batch, the sensor is busy while writing its EEPROM
+            Lm75AddConfig(p_lm75);
+            p_lm75->next_ms = now + p_desc->eeprom_ms;
+        }
+        else
+        {
+            while (p_lm75->config_step < p_desc->dev.n_regs)
+            {
+                Lm75AddConfig(p_lm75);
+            }
+            p_lm75->next_ms = now;
+        }
+    }
+    else
+    {
+        // Register address and data in one transaction
+        I2cDevRead(&p_lm75->dev, LM75_REG_TEMP, 1);
+        p_lm75->next_ms = now + p_lm75->config.period_ms;
+    }
+    I2cDevSubmit(&p_lm75->dev);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Lm75IsNew
+ *-----------------------------------------------------------------------------*/
+BOOL32 Lm75IsNew
+(
+    LM75 * p_lm75
+)
+{
+    BOOL32 is_new = p_lm75->is_new;
+
+    p_lm75->is_new = FALSE;
+    return is_new;
+}
@@ -0,0 +1,136 @@
+//=============================================================================
+// Header file for the driver of the LM75 class temperature sensors.
+// Supported are the LM75 (register based) and the DS1631 (command based,
+// also DS1621/DS1731). Up to 8 sensors can be connected to the bus with the
+// addresses LM75_ADDR_MIN...LM75_ADDR_MAX.
+//
+// The driver configures the sensor once for continuous conversion with the
+// given resolution and alarm thresholds, and then reads the temperature
+// with one I2C transaction per sample (register address and data in one
+// command), every conversion time by default. The alarm is evaluated like
+// the alarm output of the sensor: it is set when the temperature reaches
+// the high threshold and cleared when it falls below the low threshold.
+//
+// Temperatures are fixed point values in 1/256 C, the format of the
+// temperature registers (LM75_C(25) = 25 C).
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __PRG_LM75_H__
+#define __PRG_LM75_H__
+
+#include "prg_i2c_dev.h"
+
+#define LM75_ADDR_MIN           0x48
+#define LM75_ADDR_MAX           0x4F
+#define LM75_SENSORS_MAX        (LM75_ADDR_MAX - LM75_ADDR_MIN + 1)
+
+// Converts whole degrees into the fixed point format
+#define LM75_C(c)               ((INT16)((c) * 256))
+
+
+// Sensor types
+enum lm75_kind_e
+{
+    LM75_KIND_LM75 = 0,
+    LM75_KIND_DS1631,
+    LM75_KIND_COUNT
+};
+
+
+// State of the driver
+enum lm75_state_e
+{
+    LM75_STATE_CONFIG = 0,      // configuration is written
+    LM75_STATE_RUN              // temperature is read
+};
+
+
+// Configuration
+typedef struct
+{
+    UCHAR8          resolution;     // 9...12 bit (LM75: always 9 bit)
+    BOOL8           alarm_high;     // TRUE = alarm output active high
+    UINT16          period_ms;      // 0 = conversion time
+    INT16           high;           // alarm threshold (LM75: TOS, DS1631: TH)
+    INT16           low;            // alarm release threshold (LM75: THYST, DS1631: TL)
+} LM75_CONFIG;
+
+
+// Driver state. All fields are read-only for the program.
+typedef struct
+{
+    UCHAR8          kind;           // see enum lm75_kind_e
+    UCHAR8          devaddr;
+    UCHAR8          state;          // see enum lm75_state_e
+    BOOL8           alarm;
+    LM75_CONFIG     config;
+
+    INT16           temp;           // last sample
+    UINT16          status;         // status of the last batch
+    UINT32          n_samples;
+    UINT32          n_errors;       // failed batches, not counting the time off the bus
+
+    // Internal
+    BOOL8           is_new;
+    UCHAR8          config_step;    // number of written configuration registers
+    UCHAR8          cfg;            // value of the configuration register
+    UCHAR8          reserved;
+    UINT32          next_ms;
+    I2C_DEV         dev;
+} LM75;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// This function initializes the driver of the sensor at devaddr. The configuration
+// is written in the first call of Lm75Tick.
+void Lm75Init
+(
+    LM75 * p_lm75,
+    TA * p_ta_array,
+    UCHAR8 kind,
+    UCHAR8 devaddr,
+    const LM75_CONFIG * p_config
+);
+
+
+// This function submits the next batch when it is due. Should be called every
+// tick after I2cJobPoll. While the device layer keeps the sensor off the bus
+// nothing is submitted and status is I2C_DEV_OFFLINE; the first batch after
+// the back-off time is the probe.
+void Lm75Tick
+(
+    LM75 * p_lm75,
+    TA * p_ta_array
+);
+
+
+// Returns TRUE once after each new sample
+BOOL32 Lm75IsNew
+(
+    LM75 * p_lm75
+);
+
+
+// Returns the conversion time of the sensor in ms
+UINT32 Lm75GetConversionTime
+(
+    UCHAR8 kind,
+    UCHAR8 resolution
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // __PRG_LM75_H__
@@ -0,0 +1,232 @@
+//=============================================================================
+// Callback mailbox.
+// Single-producer/single-consumer ring of callback results: the producer is
+// the firmware (callback context), the consumer is PrgTic. Each side writes
+// only its own index, a message is published by advancing the head index
+// after it has been written completely.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "prg_mbox.h"
+
+#if (MBOX_SIZE & (MBOX_SIZE - 1)) != 0
+#error MBOX_SIZE must be a power of 2
+#endif
+
+static MBOX_MSG ring[MBOX_SIZE];
+static volatile UINT32 head;        // written by the producer only
+static volatile UINT32 tail;        // written by the consumer only
+static MBOX_STATS stats;            // written by the producer only
+static UINT32 msg_time_us;          // arrival time of the message being handed over
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : MboxAlloc
+ *
+ * Returns the entry for the next message or NULL if the mailbox is full.
+ *-----------------------------------------------------------------------------*/
+static MBOX_MSG * MboxAlloc
+(
+    TA * p_ta_array,
+    UINT16 type
+)
+{
+    UINT32 count = head - tail;
+    MBOX_MSG * p_msg;
+
+    if (count >= MBOX_SIZE)
+    {
+        stats.dropped++;
+        return NULL;
+    }
+    if (count + 1 > stats.high_water)
+    {
+        stats.high_water = count + 1;
+    }
+    p_msg = &ring[head & (MBOX_SIZE - 1)];
+    p_msg->time_us = p_ta_array[TA_LOCAL].hook_table.GetSystemTime(TIMER_UNIT_MICROSECONDS);
+    p_msg->type = type;
+    return p_msg;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : MboxPublish
+ *-----------------------------------------------------------------------------*/
+static void MboxPublish(void)
+{
+    MBOX_BARRIER();
+    head = head + 1;
+    stats.posted++;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : MboxBtCallback
+ *-----------------------------------------------------------------------------*/
+void MboxBtCallback
+(
+    TA * p_ta_array,
+    BT_CB * p_data
+)
+{
+    MBOX_MSG * p_msg = MboxAlloc(p_ta_array, MBOX_MSG_BT);
+
+    if (p_msg)
+    {
+        p_msg->data.bt = *p_data;
+        MboxPublish();
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : MboxBtReceiveCallback
+ *-----------------------------------------------------------------------------*/
+void MboxBtReceiveCallback
+(
+    TA * p_ta_array,
+    BT_RECV_CB * p_data
+)
+{
+    MBOX_MSG * p_msg = MboxAlloc(p_ta_array, MBOX_MSG_BT_RECV);
+
+    if (p_msg)
+    {
+        p_msg->data.bt_recv = *p_data;
+        MboxPublish();
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : MboxI2cCallback
+ *-----------------------------------------------------------------------------*/
+void MboxI2cCallback
+(
+    TA * p_ta_array,
+    I2C_CB * p_data
+)
+{
+    MBOX_MSG * p_msg = MboxAlloc(p_ta_array, MBOX_MSG_I2C);
+
+    if (p_msg)
+    {
+        p_msg->data.i2c = *p_data;
+        MboxPublish();
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : MboxGet
+ *
+ * Takes the oldest message from the mailbox.
+ *-----------------------------------------------------------------------------*/
+BOOL32 MboxGet
+(
+    MBOX_MSG * p_msg
+)
+{
+    UINT32 t = tail;
+
+    if (head == t)
+    {
+        return FALSE;
+    }
+    MBOX_BARRIER();
+    *p_msg = ring[t & (MBOX_SIZE - 1)];
+    MBOX_BARRIER();
+    tail = t + 1;
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : MboxDrain
+ *
+ * Hands the waiting messages over to the program callbacks.
+ *-----------------------------------------------------------------------------*/
+UINT32 MboxDrain
+(
+    TA * p_ta_array,
+    const MBOX_HANDLERS * p_handlers,
+    UINT32 max_msgs
+)
+{
+    UINT32 n = head - tail;
+    UINT32 i;
+    MBOX_MSG msg;
+
+    if (max_msgs && n > max_msgs)
+    {
+        n = max_msgs;
+    }
+    for (i = 0; i < n && MboxGet(&msg); i++)
+    {
+        msg_time_us = msg.time_us;
+        switch (msg.type)
+        {
+            case MBOX_MSG_BT:
+                if (p_handlers->bt)
+                {
+                    p_handlers->bt(p_ta_array, &msg.data.bt);
+                }
+                break;
+
+            case MBOX_MSG_BT_RECV:
+                if (p_handlers->bt_recv)
+                {
+                    p_handlers->bt_recv(p_ta_array, &msg.data.bt_recv);
+                }
+                break;
+
+            case MBOX_MSG_I2C:
+                if (p_handlers->i2c)
+                {
+                    p_handlers->i2c(p_ta_array, &msg.data.i2c);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+    return i;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : MboxGetMsgTime
+ *-----------------------------------------------------------------------------*/
+UINT32 MboxGetMsgTime(void)
+{
+    return msg_time_us;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : MboxGetCount
+ *-----------------------------------------------------------------------------*/
+UINT32 MboxGetCount(void)
+{
+    return head - tail;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : MboxGetStats
+ *-----------------------------------------------------------------------------*/
+void MboxGetStats
+(
+    MBOX_STATS * p_stats
+)
+{
+    *p_stats = stats;
+}
@@ -0,0 +1,142 @@
+//=============================================================================
+// Header file for the callback mailbox.
+// The firmware calls the Bluetooth and I2C callback functions of a program
+// outside of PrgTic. With the mailbox the program passes MboxBtCallback,
+// MboxBtReceiveCallback and MboxI2cCallback to the hook functions instead of
+// its own callbacks. They only copy the callback data into a single-producer/
+// single-consumer ring, and PrgTic calls MboxDrain, which hands the results
+// over to the program callbacks in the order of their arrival. So the program
+// callbacks run in the context of PrgTic: they may change the program state
+// and issue new commands without races, and the time spent in the firmware
+// callback context stays short and constant. Each message carries the time
+// of its arrival (MboxGetMsgTime), because the program callback runs up to
+// one tick later.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __PRG_MBOX_H__
+#define __PRG_MBOX_H__
+
+#include "ROBO_TX_PRG.h"
+
+#ifndef MBOX_SIZE
+#define MBOX_SIZE           16      // number of mailbox entries, must be a power of 2
+#endif
+
+// Compiler barrier between writing a message and publishing it. The Controller
+// has a single core, so no memory barrier instruction is needed.
+#define MBOX_BARRIER()      __asm__ __volatile__ ("" : : : "memory")
+
+
+// Kinds of messages
+enum mbox_msg_e
+{
+    MBOX_MSG_BT = 1,        // result of a Bluetooth command, BT_CB
+    MBOX_MSG_BT_RECV,       // result of BtStartReceive/BtStopReceive or received message, BT_RECV_CB
+    MBOX_MSG_I2C            // result of an I2C command, I2C_CB
+};
+
+
+// Mailbox entry, 28 bytes
+typedef struct
+{
+    UINT32          time_us;                // arrival time, GetSystemTime(TIMER_UNIT_MICROSECONDS)
+    UINT16          type;                   // see enum mbox_msg_e
+    union
+    {
+        BT_CB       bt;
+        BT_RECV_CB  bt_recv;
+        I2C_CB      i2c;
+    } data;
+} MBOX_MSG;
+
+
+// Program callbacks the messages are handed over to by MboxDrain (NULL = drop)
+typedef struct
+{
+    P_CB_FUNC       bt;
+    P_RECV_CB_FUNC  bt_recv;
+    P_I2C_CB_FUNC   i2c;
+} MBOX_HANDLERS;
+
+
+// Statistics
+typedef struct
+{
+    UINT32          posted;                 // number of posted messages
+    UINT32          dropped;                // number of messages lost because the mailbox was full
+    UINT32          high_water;             // max. number of messages waiting in the mailbox
+} MBOX_STATS;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Callback functions to be passed to the hook functions of the firmware
+void MboxBtCallback
+(
+    TA * p_ta_array,
+    BT_CB * p_data
+);
+
+void MboxBtReceiveCallback
+(
+    TA * p_ta_array,
+    BT_RECV_CB * p_data
+);
+
+void MboxI2cCallback
+(
+    TA * p_ta_array,
+    I2C_CB * p_data
+);
+
+
+// This function hands the waiting messages over to the program callbacks in the order
+// of their arrival. Messages which arrive meanwhile (for example as a result of
+// a command issued by a program callback) are left for the next call.
+// max_msgs limits the number of handled messages (0 = no limit).
+// Returns the number of handled messages.
+UINT32 MboxDrain
+(
+    TA * p_ta_array,
+    const MBOX_HANDLERS * p_handlers,
+    UINT32 max_msgs
+);
+
+
+// Takes the oldest message from the mailbox. Returns FALSE if the mailbox is empty.
+BOOL32 MboxGet
+(
+    MBOX_MSG * p_msg
+);
+
+
+// Returns the arrival time (us) of the message MboxDrain is handing over,
+// to be called by the program callbacks
+UINT32 MboxGetMsgTime(void);
+
+
+// Returns the number of waiting messages
+UINT32 MboxGetCount(void);
+
+
+// Returns the statistics of the mailbox
+void MboxGetStats
+(
+    MBOX_STATS * p_stats
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // __PRG_MBOX_H__
@@ -0,0 +1,216 @@
+//=============================================================================
+// Static memory arena and object pools.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "prg_mem.h"
+
+static UCHAR8 arena[PRG_ARENA_SIZE] __attribute__ ((aligned (PRG_MEM_ALIGN)));
+static MEM_STATS arena_stats = {PRG_ARENA_SIZE, 0, 0, 0};
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : ArenaAlloc
+ *
+ * Takes size bytes from the arena.
+ *-----------------------------------------------------------------------------*/
+void * ArenaAlloc
+(
+    UINT32 size
+)
+{
+    void * p;
+
+    if (size > PRG_ARENA_SIZE - arena_stats.used ||
+        (size = PRG_MEM_ALIGN_UP(size)) > PRG_ARENA_SIZE - arena_stats.used)
+    {
+        arena_stats.failed++;
+        return NULL;
+    }
+    p = &arena[arena_stats.used];
+    arena_stats.used += size;
+    if (arena_stats.used > arena_stats.high_water)
+    {
+        arena_stats.high_water = arena_stats.used;
+    }
+    return p;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : ArenaGetMark
+ *-----------------------------------------------------------------------------*/
+UINT32 ArenaGetMark(void)
+{
+    return arena_stats.used;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : ArenaRelease
+ *
+ * Gives back all memory taken after the mark.
+ *-----------------------------------------------------------------------------*/
+void ArenaRelease
+(
+    UINT32 mark
+)
+{
+    if (mark < arena_stats.used)
+    {
+        arena_stats.used = mark;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : ArenaGetStats
+ *-----------------------------------------------------------------------------*/
+void ArenaGetStats
+(
+    MEM_STATS * p_stats
+)
+{
+    *p_stats = arena_stats;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PoolInit
+ *
+ * Takes the memory of the objects from the arena and builds the free list.
+ *-----------------------------------------------------------------------------*/
+BOOL32 PoolInit
+(
+    POOL * p_pool,
+    const char * name,
+    UINT32 obj_size,
+    UINT32 n_objs
+)
+{
+    UINT32 i;
+
+    p_pool->name = name;
+    p_pool->p_free = NULL;
+    p_pool->obj_size = PRG_MEM_ALIGN_UP((obj_size < sizeof(void *)) ? sizeof(void *) : obj_size);
+    p_pool->stats.size = 0;
+    p_pool->stats.used = 0;
+    p_pool->stats.high_water = 0;
+    p_pool->stats.failed = 0;
+
+    if (n_objs > PRG_ARENA_SIZE / p_pool->obj_size ||
+        (p_pool->p_mem = ArenaAlloc(n_objs * p_pool->obj_size)) == NULL)
+    {
+        p_pool->p_mem = NULL;
+        return FALSE;
+    }
+    p_pool->stats.size = n_objs;
+
+    // Build the free list, lowest address first
+    for (i = n_objs; i > 0; i--)
+    {
+        void ** p_obj = (void **)(p_pool->p_mem + (i - 1) * p_pool->obj_size);
+
+        *p_obj = p_pool->p_free;
+        p_pool->p_free = p_obj;
+    }
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PoolAlloc
+ *
+ * Allocates an object.
+ *-----------------------------------------------------------------------------*/
+void * PoolAlloc
+(
+    POOL * p_pool
+)
+{
+    void ** p_obj = p_pool->p_free;
+
+    if (!p_obj)
+    {
+        p_pool->stats.failed++;
+        return NULL;
+    }
+    p_pool->p_free = *p_obj;
+    if (++p_pool->stats.used > p_pool->stats.high_water)
+    {
+        p_pool->stats.high_water = p_pool->stats.used;
+    }
+    return p_obj;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PoolFree
+ *
+ * Returns an object to the pool.
+ *-----------------------------------------------------------------------------*/
+void PoolFree
+(
+    POOL * p_pool,
+    void * p_obj
+)
+{
+    if (p_obj)
+    {
+        *(void **)p_obj = p_pool->p_free;
+        p_pool->p_free = p_obj;
+        p_pool->stats.used--;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PoolContains
+ *-----------------------------------------------------------------------------*/
+BOOL32 PoolContains
+(
+    const POOL * p_pool,
+    const void * p_obj
+)
+{
+    const UCHAR8 * p = p_obj;
+
+    return p_pool->p_mem && p >= p_pool->p_mem &&
+           p < p_pool->p_mem + p_pool->stats.size * p_pool->obj_size &&
+           (UINT32)(p - p_pool->p_mem) % p_pool->obj_size == 0;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : MemFormatStats
+ *
+ * Formats the statistics of the arena and of the given pools.
+ *-----------------------------------------------------------------------------*/
+void MemFormatStats
+(
+    TA * p_ta,
+    char * str,
+    POOL * const * p_pools,
+    UINT32 n_pools
+)
+{
+    UINT32 i;
+
+    str += p_ta->hook_table.sprintf(str, "arena %lu/%lu max %lu fail %lu",
+        (unsigned long)arena_stats.used, (unsigned long)arena_stats.size,
+        (unsigned long)arena_stats.high_water, (unsigned long)arena_stats.failed);
+    for (i = 0; i < n_pools; i++)
+    {
+        const MEM_STATS * p = &p_pools[i]->stats;
+
+        str += p_ta->hook_table.sprintf(str, "\n%s %lu/%lu max %lu fail %lu",
+            p_pools[i]->name, (unsigned long)p->used, (unsigned long)p->size,
+            (unsigned long)p->high_water, (unsigned long)p->failed);
+    }
+}
@@ -0,0 +1,142 @@
+//=============================================================================
+// Header file for the static memory arena and the object pools.
+// Programs have no heap: the arena is a statically allocated block of
+// PRG_ARENA_SIZE bytes in the program memory, from which memory is taken by
+// advancing a pointer. Memory which is needed for the whole run of the
+// program (object pools, buffers of modules) is taken in PrgInit. Temporary
+// memory can be taken after ArenaGetMark and given back with ArenaRelease.
+//
+// An object pool is a fixed number of equally sized objects, taken from the
+// arena once. Objects are allocated and freed in O(1) through a free list
+// without fragmentation. The arena and the pools are not protected against
+// the callbacks of the firmware, which interrupt PrgTic: use them in PrgInit
+// and PrgTic only. Callbacks pass their data to PrgTic through the callback
+// mailbox (prg_mbox.h), and the program callbacks called by MboxDrain or
+// I2cJobPoll run in PrgTic and may use the pools.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __PRG_MEM_H__
+#define __PRG_MEM_H__
+
+#include "ROBO_TX_PRG.h"
+
+#ifndef PRG_ARENA_SIZE
+#define PRG_ARENA_SIZE      0x4000  // size of the arena in bytes, can be defined when the common
+                                    // library is built
+#endif
+
+#define PRG_MEM_ALIGN       8       // alignment of all memory taken from the arena
+
+#define PRG_MEM_ALIGN_UP(size)  (((size) + PRG_MEM_ALIGN - 1) & ~(PRG_MEM_ALIGN - 1))
+
+// Typed allocation from a pool
+#define POOL_ALLOC(p_pool, type)    ((type *)PoolAlloc(p_pool))
+
+
+// Statistics of the arena or of a pool
+typedef struct
+{
+    UINT32          size;           // arena: bytes, pool: objects
+    UINT32          used;           // currently used bytes/objects
+    UINT32          high_water;     // max. number of used bytes/objects
+    UINT32          failed;         // number of failed allocations
+} MEM_STATS;
+
+
+// Object pool
+typedef struct pool_s
+{
+    const char    * name;
+    UCHAR8        * p_mem;          // objects
+    void          * p_free;         // first free object, a free object holds the pointer to the next one
+    UINT32          obj_size;       // size of an object, aligned to PRG_MEM_ALIGN
+    MEM_STATS       stats;
+} POOL;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Takes size bytes from the arena. Returns NULL if the arena is exhausted.
+void * ArenaAlloc
+(
+    UINT32 size
+);
+
+
+// Returns the current fill level of the arena, to be passed to ArenaRelease
+UINT32 ArenaGetMark(void);
+
+
+// Gives back all memory taken from the arena after ArenaGetMark returned the mark
+void ArenaRelease
+(
+    UINT32 mark
+);
+
+
+// Returns the statistics of the arena
+void ArenaGetStats
+(
+    MEM_STATS * p_stats
+);
+
+
+// Takes the memory of n_objs objects of obj_size bytes from the arena and builds
+// the pool. Returns FALSE if the arena is exhausted.
+BOOL32 PoolInit
+(
+    POOL * p_pool,
+    const char * name,
+    UINT32 obj_size,
+    UINT32 n_objs
+);
+
+
+// Allocates an object. Returns NULL if all objects are in use.
+void * PoolAlloc
+(
+    POOL * p_pool
+);
+
+
+// Returns an object to the pool
+void PoolFree
+(
+    POOL * p_pool,
+    void * p_obj
+);
+
+
+// Returns TRUE if p_obj is an object of the pool
+BOOL32 PoolContains
+(
+    const POOL * p_pool,
+    const void * p_obj
+);
+
+
+// Formats the statistics of the arena and of the given pools into str (one line per
+// entry, "name used/size max high_water fail failed"), e.g. for DisplayMsg
+void MemFormatStats
+(
+    TA * p_ta,
+    char * str,
+    POOL * const * p_pools,
+    UINT32 n_pools
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // __PRG_MEM_H__
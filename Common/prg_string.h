@@ -0,0 +1,158 @@
+//=============================================================================
+// Header file with inline replacements of the memory functions of the hook
+// table.
+// The functions of the hook table are called indirectly, so the compiler can
+// neither inline them nor specialize them for a constant size, and a copy of
+// two bytes costs a full call into the firmware. The functions below copy,
+// set and compare small blocks inline (with word accesses when both pointers
+// are word aligned) and call the hook function only for blocks larger than
+// PRG_STRING_INLINE_MAX bytes.
+//
+// The copies are explicit loops, also for constant sizes: __builtin_memcpy is
+// not used, because arm-elf-gcc expands it inline only for word aligned
+// operands and calls memcpy of the C library otherwise, and the fields of the
+// Bluetooth messages (msg[1], msg[4]) are not aligned. With a constant size
+// the compiler unrolls the loops and drops the word loop when the size is
+// below 4 bytes. Whether a call site of a program is really expanded inline
+// can be seen in the .asm file of the module (no "bl memcpy").
+//
+// There are no inline string functions: their length is not known in advance,
+// and a byte loop in the program was not faster than the hook function in the
+// measurements with bench_string.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __PRG_STRING_H__
+#define __PRG_STRING_H__
+
+#include "ROBO_TX_PRG.h"
+
+#ifndef PRG_STRING_INLINE_MAX
+#define PRG_STRING_INLINE_MAX   32  // larger blocks are handled by the hook functions
+#endif
+
+
+#define PRG_IS_WORD_ALIGNED(a, b)   (((((unsigned long)(a)) | ((unsigned long)(b))) & 3) == 0)
+
+#define PRG_INLINE              static inline __attribute__ ((always_inline))
+
+// 32-bit word which may alias any other type
+typedef unsigned int __attribute__ ((may_alias)) PRG_WORD32;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PrgMemcpy
+ *-----------------------------------------------------------------------------*/
+PRG_INLINE void * PrgMemcpy
+(
+    TA * p_ta,
+    void * s1,
+    const void * s2,
+    UINT32 n
+)
+{
+    UCHAR8 * d = s1;
+    const UCHAR8 * s = s2;
+
+    if (n > PRG_STRING_INLINE_MAX)
+    {
+        return p_ta->hook_table.memcpy(s1, s2, n);
+    }
+    if (PRG_IS_WORD_ALIGNED(d, s))
+    {
+        for (; n >= 4; n -= 4, d += 4, s += 4)
+        {
+            *(PRG_WORD32 *)d = *(const PRG_WORD32 *)s;
+        }
+    }
+    while (n--)
+    {
+        *d++ = *s++;
+    }
+    return s1;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PrgMemset
+ *-----------------------------------------------------------------------------*/
+PRG_INLINE void * PrgMemset
+(
+    TA * p_ta,
+    void * s,
+    INT32 c,
+    UINT32 n
+)
+{
+    UCHAR8 * d = s;
+
+    if (n > PRG_STRING_INLINE_MAX)
+    {
+        return p_ta->hook_table.memset(s, c, n);
+    }
+    if (PRG_IS_WORD_ALIGNED(d, 0))
+    {
+        PRG_WORD32 w = (UCHAR8)c * 0x01010101U;
+
+        for (; n >= 4; n -= 4, d += 4)
+        {
+            *(PRG_WORD32 *)d = w;
+        }
+    }
+    while (n--)
+    {
+        *d++ = (UCHAR8)c;
+    }
+    return s;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PrgMemcmp
+ *-----------------------------------------------------------------------------*/
+PRG_INLINE INT32 PrgMemcmp
+(
+    TA * p_ta,
+    const void * s1,
+    const void * s2,
+    UINT32 n
+)
+{
+    const UCHAR8 * a = s1;
+    const UCHAR8 * b = s2;
+
+    if (n > PRG_STRING_INLINE_MAX)
+    {
+        return p_ta->hook_table.memcmp(s1, s2, n);
+    }
+    if (PRG_IS_WORD_ALIGNED(a, b))
+    {
+        // Skip the equal words, the first different word is compared byte by byte
+        for (; n >= 4 && *(const PRG_WORD32 *)a == *(const PRG_WORD32 *)b; n -= 4, a += 4, b += 4)
+            ;
+    }
+    for (; n; n--, a++, b++)
+    {
+        if (*a != *b)
+        {
+            return *a - *b;
+        }
+    }
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __PRG_STRING_H__
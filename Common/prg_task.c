@@ -0,0 +1,200 @@
+//=============================================================================
+// Task registry.
+// The registered tasks are kept in an array sorted by priority. The time of
+// the registry is the number of program ticks (CALL_CYCLE_MS each), so a task
+// with the period of 10 ms is called every 10th tick.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "prg_task.h"
+
+static TASK * tasks[TASK_MAX];
+static UINT32 task_count;
+static UINT32 time_ms;
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaskReset
+ *
+ * Removes all tasks, so they can be registered again.
+ *-----------------------------------------------------------------------------*/
+void TaskReset(void)
+{
+    UINT32 idx;
+
+    for (idx = 0; idx < task_count; idx++)
+    {
+        tasks[idx]->state = TASK_IDLE;
+        tasks[idx] = NULL;
+    }
+    task_count = 0;
+    time_ms = 0;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaskRegister
+ *
+ * Inserts the task behind all tasks with the same or a higher priority.
+ *-----------------------------------------------------------------------------*/
+BOOL32 TaskRegister
+(
+    TASK * p_task
+)
+{
+    UINT32 pos;
+
+    if (task_count >= TASK_MAX || p_task->state != TASK_IDLE || !p_task->Tick)
+    {
+        return FALSE;
+    }
+
+    for (pos = task_count; pos > 0 && tasks[pos - 1]->priority > p_task->priority; pos--)
+    {
+        tasks[pos] = tasks[pos - 1];
+    }
+    tasks[pos] = p_task;
+    task_count++;
+
+    if (!p_task->period_ms)
+    {
+        p_task->period_ms = 1;
+    }
+    p_task->state = TASK_READY;
+    p_task->next_ms = p_task->phase_ms % p_task->period_ms;
+    p_task->n_ticks = 0;
+    p_task->n_deferred = 0;
+    p_task->rc = TASK_RC_RUN;
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaskStart
+ *
+ * Calls the init functions of all registered tasks.
+ *-----------------------------------------------------------------------------*/
+void TaskStart
+(
+    TA * p_ta_array,
+    int ta_count
+)
+{
+    UINT32 idx;
+
+    time_ms = 0;
+    for (idx = 0; idx < task_count; idx++)
+    {
+        if (tasks[idx]->Init)
+        {
+            tasks[idx]->Init(p_ta_array, ta_count);
+        }
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaskTickAll
+ *
+ * Calls the tick functions of the due tasks.
+ *-----------------------------------------------------------------------------*/
+int TaskTickAll
+(
+    TA * p_ta_array,
+    int ta_count
+)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+    BOOL32 is_running = FALSE;
+    BOOL32 is_allowed = TRUE;
+    BOOL32 is_called = FALSE;
+    UINT32 idx;
+
+    for (idx = 0; idx < task_count; idx++)
+    {
+        TASK * p_task = tasks[idx];
+
+        if (p_task->state != TASK_READY && p_task->state != TASK_DEFERRED)
+        {
+            continue;
+        }
+        is_running = TRUE;
+
+        // The time difference is evaluated as signed value, so the wrap-around of the
+        // time is handled correctly
+        if (p_task->state == TASK_READY && (INT32)(time_ms - p_task->next_ms) < 0)
+        {
+            continue;
+        }
+
+        // The first due task is always called, so that a program can not be starved
+        // by the firmware completely
+        if (is_allowed && is_called && !p_ta->hook_table.IsRunAllowed())
+        {
+            is_allowed = FALSE;
+        }
+        if (!is_allowed)
+        {
+            if (p_task->state == TASK_READY)
+            {
+                p_task->state = TASK_DEFERRED;
+                p_task->n_deferred++;
+            }
+            continue;
+        }
+
+        p_task->rc = p_task->Tick(p_ta_array, ta_count);
+        p_task->n_ticks++;
+        is_called = TRUE;
+
+        // The next tick keeps the phase even if this one was deferred
+        do
+        {
+            p_task->next_ms += p_task->period_ms;
+        } while ((INT32)(time_ms - p_task->next_ms) >= 0);
+
+        if (p_task->rc == TASK_RC_RUN)
+        {
+            p_task->state = TASK_READY;
+        }
+        else if (p_task->rc == TASK_RC_DONE)
+        {
+            p_task->state = TASK_DONE;
+        }
+        else
+        {
+            p_task->state = TASK_ERROR;
+            return p_task->rc;
+        }
+    }
+
+    time_ms += CALL_CYCLE_MS;
+    return (is_running) ? TASK_RC_RUN : TASK_RC_DONE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaskGetTime
+ *-----------------------------------------------------------------------------*/
+UINT32 TaskGetTime(void)
+{
+    return time_ms;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaskGet
+ *-----------------------------------------------------------------------------*/
+TASK * TaskGet
+(
+    UINT32 idx
+)
+{
+    return (idx < task_count) ? tasks[idx] : NULL;
+}
@@ -0,0 +1,140 @@
+//=============================================================================
+// Header file for the task registry.
+// The firmware calls exactly one program entry (PrgDisp -> PrgInit/PrgTic).
+// With the task registry a program is composed of independent modules
+// (tasks), each with its own init and tick function, a priority and a tick
+// period. PrgInit clears the registry, registers the tasks and calls
+// TaskStart, PrgTic returns the result of TaskTickAll:
+//
+//     void PrgInit(TA * p_ta_array, int ta_count)
+//     {
+//         TaskReset();
+//         TaskRegister(&motor_task);
+//         TaskRegister(&lamp_task);
+//         TaskStart(p_ta_array, ta_count);
+//     }
+//
+//     int PrgTic(TA * p_ta_array, int ta_count)
+//     {
+//         return TaskTickAll(p_ta_array, ta_count);
+//     }
+//
+// In each 1 ms tick the due tasks are called in the order of their priority.
+// When the firmware does not allow the program to run any longer
+// (IsRunAllowed returns FALSE), the remaining due tasks are deferred to the
+// next tick; the first due task of a tick is always called.
+// The registry and the task descriptors are static: TaskReset clears them
+// when the program is started again without being loaded again.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __PRG_TASK_H__
+#define __PRG_TASK_H__
+
+#include "ROBO_TX_PRG.h"
+
+#define TASK_MAX            16      // max. number of registered tasks
+
+#define TASK_RC_RUN         0x7FFF  // return code of a tick function: call the task further
+#define TASK_RC_DONE        0       // return code of a tick function: task is finished
+                                    // any other value is an error code and stops the program
+
+#define TASK_PRIO_HIGH      0
+#define TASK_PRIO_NORMAL    8
+#define TASK_PRIO_LOW       15
+
+
+// State of a task
+enum task_state_e
+{
+    TASK_IDLE = 0,          // not registered
+    TASK_READY,             // waiting for the next period
+    TASK_DEFERRED,          // due, but deferred to the next tick because IsRunAllowed returned FALSE
+    TASK_DONE,              // finished (tick function returned TASK_RC_DONE)
+    TASK_ERROR              // stopped with an error code
+};
+
+
+typedef void (*P_TASK_INIT)(TA * p_ta_array, int ta_count);
+typedef int  (*P_TASK_TICK)(TA * p_ta_array, int ta_count);
+
+
+// Task descriptor, defined statically by the module. The first part is set by
+// the module, the rest is maintained by the registry.
+typedef struct task_s
+{
+    const char    * name;
+    P_TASK_INIT     Init;           // called once by TaskStart, may be NULL
+    P_TASK_TICK     Tick;           // called every period_ms, returns TASK_RC_RUN, TASK_RC_DONE or an error code
+    UINT8           priority;       // TASK_PRIO_HIGH (0)...TASK_PRIO_LOW (15)
+    UINT8           reserved;
+    UINT16          period_ms;      // tick period, for example 1, 10 or 100 ms
+    UINT16          phase_ms;       // offset of the first tick (0...period_ms - 1), spreads tasks
+                                    // of the same period over several ticks
+
+    UINT16          state;          // see enum task_state_e
+    UINT32          next_ms;        // time of the next tick
+    UINT32          n_ticks;        // number of calls of the tick function
+    UINT32          n_deferred;     // number of ticks the task was deferred
+    int             rc;             // last return code of the tick function
+} TASK;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// This function removes all tasks from the registry and sets them to TASK_IDLE
+void TaskReset(void);
+
+
+// This function adds a task to the registry. Tasks of the same priority are
+// called in the order of their registration. Returns FALSE if the registry is full
+// or the task is already registered.
+BOOL32 TaskRegister
+(
+    TASK * p_task
+);
+
+
+// This function calls the init functions of all registered tasks, in the order
+// of their priority
+void TaskStart
+(
+    TA * p_ta_array,
+    int ta_count
+);
+
+
+// This function calls the tick functions of the due tasks. Returns TASK_RC_RUN while
+// at least one task is running, TASK_RC_DONE when all tasks are finished, or the
+// error code of a task (the program is then stopped by the firmware).
+int TaskTickAll
+(
+    TA * p_ta_array,
+    int ta_count
+);
+
+
+// Returns the number of program ticks since TaskStart
+UINT32 TaskGetTime(void);
+
+
+// Returns the registered task with the given index (in the order of priority) or NULL
+TASK * TaskGet
+(
+    UINT32 idx
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // __PRG_TASK_H__
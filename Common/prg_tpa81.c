@@ -0,0 +1,431 @@
+//=============================================================================
+// Driver of the thermopile array TPA81.
+// A reading is one batch of 9 register reads (ambient and pixels), which the
+// device layer merges into 5 transactions; in the sweep mode the batch also
+// writes the next servo position, so the servo moves while the program waits
+// for the next period. The search of the hot spot works on a copy of the map,
+// because the next sweep starts to update the map while the search runs. The
+// copies are allocated and freed in PrgTic (Tpa81Done and the work queue).
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "prg_tpa81.h"
+
+static const I2C_REG tpa81_regs[TPA81_REGS] =
+{
+    { TPA81_REG_CMD,            TPA81_PROTOCOL, I2C_REG_RW },
+    { TPA81_REG_AMBIENT,        TPA81_PROTOCOL, I2C_REG_READ },
+    { TPA81_REG_PIXEL + 0,      TPA81_PROTOCOL, I2C_REG_READ },
+    { TPA81_REG_PIXEL + 1,      TPA81_PROTOCOL, I2C_REG_READ },
+    { TPA81_REG_PIXEL + 2,      TPA81_PROTOCOL, I2C_REG_READ },
+    { TPA81_REG_PIXEL + 3,      TPA81_PROTOCOL, I2C_REG_READ },
+    { TPA81_REG_PIXEL + 4,      TPA81_PROTOCOL, I2C_REG_READ },
+    { TPA81_REG_PIXEL + 5,      TPA81_PROTOCOL, I2C_REG_READ },
+    { TPA81_REG_PIXEL + 6,      TPA81_PROTOCOL, I2C_REG_READ },
+    { TPA81_REG_PIXEL + 7,      TPA81_PROTOCOL, I2C_REG_READ }
+};
+
+static POOL map_pool;
+
+static const I2C_DEV_DESC tpa81_desc =
+{
+    /* name     */ "TPA81",
+    /* p_regs   */ tpa81_regs,
+    /* n_regs   */ TPA81_REGS,
+    /* flags    */ I2C_DEV_AUTOINC
+};
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Tpa81Interpolate
+ *
+ * Returns the offset of the maximum of the parabola through the values
+ * l, c, r (at -1, 0, +1) in 1/256 pixel, c has to be the largest value.
+ *-----------------------------------------------------------------------------*/
+static INT32 Tpa81Interpolate
+(
+    INT32 l,
+    INT32 c,
+    INT32 r
+)
+{
+    INT32 denom = l - 2 * c + r;
+    INT32 offset;
+
+    if (denom >= 0)
+    {
+        return 0;   // flat
+    }
+    offset = ((l - r) * (TPA81_POS_ONE / 2)) / denom;
+    if (offset > TPA81_POS_ONE / 2)
+    {
+        offset = TPA81_POS_ONE / 2;
+    }
+    else if (offset < -TPA81_POS_ONE / 2)
+    {
+        offset = -TPA81_POS_ONE / 2;
+    }
+    return offset;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Tpa81SubPixel
+ *
+ * Returns the position of the maximum max of n values (with the distance
+ * stride) in 1/256 steps.
+ *-----------------------------------------------------------------------------*/
+static INT16 Tpa81SubPixel
+(
+    const INT16 * p_val,
+    UINT32 n,
+    UINT32 stride,
+    UINT32 max
+)
+{
+    INT32 pos = max * TPA81_POS_ONE;
+
+    if (max > 0 && max < n - 1)
+    {
+        pos += Tpa81Interpolate(p_val[(max - 1) * stride], p_val[max * stride], p_val[(max + 1) * stride]);
+    }
+    return (INT16)pos;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Tpa81FindMax
+ *
+ * Returns the index of the largest of n values.
+ *-----------------------------------------------------------------------------*/
+static UINT32 Tpa81FindMax
+(
+    const INT16 * p_val,
+    UINT32 n
+)
+{
+    UINT32 idx, max = 0;
+
+    for (idx = 1; idx < n; idx++)
+    {
+        if (p_val[idx] > p_val[max])
+        {
+            max = idx;
+        }
+    }
+    return max;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Tpa81Filter
+ *
+ * Low pass filter: t += (new - t) / 2^shift
+ *-----------------------------------------------------------------------------*/
+static INT16 Tpa81Filter
+(
+    INT16 t,
+    UCHAR8 raw,
+    UCHAR8 shift,
+    BOOL32 is_valid
+)
+{
+    INT32 val = (INT32)raw << TPA81_FIX_SHIFT;
+
+    if (!is_valid)
+    {
+        return (INT16)val;
+    }
+    return (INT16)(t + ((val - t) >> shift));
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Tpa81NextPos
+ *
+ * Returns the servo position after pos, the sweep turns at both ends.
+ *-----------------------------------------------------------------------------*/
+static UCHAR8 Tpa81NextPos
+(
+    const TPA81 * p_tpa,
+    UCHAR8 pos
+)
+{
+    if (p_tpa->servo_dir > 0)
+    {
+        return (pos < TPA81_SERVO_STEPS - 1) ? pos + 1 : pos - 1;
+    }
+    return (pos > 0) ? pos - 1 : pos + 1;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Tpa81SearchStep
+ *
+ * Step of the search of the hot spot: one column of the map.
+ *-----------------------------------------------------------------------------*/
+static BOOL32 Tpa81SearchStep
+(
+    TA * p_ta_array,
+    WORK * p_work
+)
+{
+    TPA81 * p_tpa = (TPA81 *)p_work->p_data;
+    const INT16 * p_map = &p_tpa->p_search_map[0][0];
+    UINT32 idx = p_work->pos * TPA81_PIXELS;
+    UINT32 end = idx + TPA81_PIXELS;
+
+    for (; idx < end; idx++)
+    {
+        if (p_map[idx] > p_map[p_tpa->search_max])
+        {
+            p_tpa->search_max = idx;
+        }
+    }
+    return ++p_work->pos >= TPA81_SERVO_STEPS;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Tpa81SearchDone
+ *
+ * Completion of the search: sub-pixel position of the hot spot.
+ *-----------------------------------------------------------------------------*/
+static void Tpa81SearchDone
+(
+    TA * p_ta_array,
+    WORK * p_work
+)
+{
+    TPA81 * p_tpa = (TPA81 *)p_work->p_data;
+    UINT32 col = p_tpa->search_max / TPA81_PIXELS;
+    UINT32 row = p_tpa->search_max % TPA81_PIXELS;
+
+    p_tpa->map_hot.col = Tpa81SubPixel(&p_tpa->p_search_map[0][row], TPA81_SERVO_STEPS, TPA81_PIXELS, col);
+    p_tpa->map_hot.row = Tpa81SubPixel(p_tpa->p_search_map[col], TPA81_PIXELS, 1, row);
+    p_tpa->map_hot.temp = p_tpa->p_search_map[col][row];
+    p_tpa->search_ticks = p_work->n_ticks;
+    p_tpa->n_searches++;
+
+    PoolFree(&map_pool, p_tpa->p_search_map);
+    p_tpa->p_search_map = NULL;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Tpa81Done
+ *
+ * Completion function of the batch, processes the reading.
+ *-----------------------------------------------------------------------------*/
+static void Tpa81Done
+(
+    TA * p_ta_array,
+    I2C_DEV * p_dev
+)
+{
+    TPA81 * p_tpa = (TPA81 *)p_dev->p_ctx;
+    UINT32 idx;
+
+    p_tpa->status = p_dev->status;
+    if (p_dev->status != I2C_SUCCESS)
+    {
+        // The servo position is written again before the next reading
+        p_tpa->servo_set = FALSE;
+        p_tpa->n_errors++;
+        return;
+    }
+
+    // Servo positioning only
+    if (!p_tpa->batch_read)
+    {
+        p_tpa->servo_set = TRUE;
+        return;
+    }
+
+    p_tpa->ambient = (UCHAR8)I2cDevGet(p_dev, TPA81_REG_AMBIENT);
+    for (idx = 0; idx < TPA81_PIXELS; idx++)
+    {
+        p_tpa->raw[idx] = (UCHAR8)I2cDevGet(p_dev, TPA81_REG_PIXEL + idx);
+    }
+    p_tpa->frame_us = p_dev->job.t_end_us - p_dev->job.t_start_us;
+    p_tpa->n_frames++;
+    p_tpa->is_new = TRUE;
+
+    if (p_tpa->batch_sweep)
+    {
+        // Sweep: the reading belongs to the column servo_pos of the map
+        INT16 * p_col = p_tpa->map[p_tpa->servo_pos];
+
+        for (idx = 0; idx < TPA81_PIXELS; idx++)
+        {
+            p_col[idx] = Tpa81Filter(p_col[idx], p_tpa->raw[idx], p_tpa->filter_shift, p_tpa->map_valid);
+        }
+
+        if ((p_tpa->servo_dir > 0 && p_tpa->servo_pos == TPA81_SERVO_STEPS - 1) ||
+            (p_tpa->servo_dir < 0 && p_tpa->servo_pos == 0))
+        {
+            // Sweep complete: search the hot spot of the map
+            p_tpa->map_valid = TRUE;
+            p_tpa->n_sweeps++;
+            if (p_tpa->search.state == WORK_IDLE &&
+                (p_tpa->p_search_map = PoolAlloc(&map_pool)) != NULL)
+            {
+                p_ta_array[TA_LOCAL].hook_table.memcpy(p_tpa->p_search_map, p_tpa->map, sizeof(p_tpa->map));
+                p_tpa->search_max = 0;
+                WorkSubmit(&p_tpa->search);
+            }
+            else
+            {
+                p_tpa->n_search_skipped++;
+            }
+            p_tpa->servo_dir = -p_tpa->servo_dir;
+        }
+        p_tpa->servo_pos = (UCHAR8)I2cDevGet(p_dev, TPA81_REG_CMD);
+    }
+    else
+    {
+        BOOL32 is_valid = (p_tpa->n_frames > 1);
+
+        for (idx = 0; idx < TPA81_PIXELS; idx++)
+        {
+            p_tpa->pixel[idx] = Tpa81Filter(p_tpa->pixel[idx], p_tpa->raw[idx], p_tpa->filter_shift, is_valid);
+        }
+        idx = Tpa81FindMax(p_tpa->pixel, TPA81_PIXELS);
+        p_tpa->hot.row = Tpa81SubPixel(p_tpa->pixel, TPA81_PIXELS, 1, idx);
+        p_tpa->hot.temp = p_tpa->pixel[idx];
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Tpa81Init
+ *-----------------------------------------------------------------------------*/
+void Tpa81Init
+(
+    TPA81 * p_tpa,
+    TA * p_ta_array,
+    UCHAR8 devaddr,
+    UINT16 period_ms,
+    UCHAR8 filter_shift
+)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+
+    p_ta->hook_table.memset(p_tpa, 0, sizeof(*p_tpa));
+    p_tpa->devaddr = devaddr;
+    p_tpa->period_ms = (period_ms) ? period_ms : TPA81_PERIOD_MS;
+    p_tpa->filter_shift = filter_shift;
+    p_tpa->servo_dir = 1;
+    p_tpa->search.name = "TPA81 hot spot";
+    p_tpa->search.Step = Tpa81SearchStep;
+    p_tpa->search.Done = Tpa81SearchDone;
+    p_tpa->search.p_data = p_tpa;
+
+    // The pool of the map copies is shared by all drivers
+    if (!map_pool.p_mem)
+    {
+        PoolInit(&map_pool, "TPA81 map", sizeof(p_tpa->map), TPA81_SEARCH_MAPS);
+    }
+
+    I2cDevInit(&p_tpa->dev, p_ta_array, &tpa81_desc, devaddr, Tpa81Done, p_tpa);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Tpa81SetSweep
+ *-----------------------------------------------------------------------------*/
+void Tpa81SetSweep
+(
+    TPA81 * p_tpa,
+    BOOL32 is_sweep
+)
+{
+    if (is_sweep && !p_tpa->sweep)
+    {
+        // The new sweep starts at position 0
+        p_tpa->servo_pos = 0;
+        p_tpa->servo_dir = 1;
+        p_tpa->servo_set = FALSE;
+        p_tpa->map_valid = FALSE;
+    }
+    p_tpa->sweep = (is_sweep) ? TRUE : FALSE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Tpa81Tick
+ *
+ * Submits the next batch when it is due.
+ *-----------------------------------------------------------------------------*/
+void Tpa81Tick
+(
+    TPA81 * p_tpa,
+    TA * p_ta_array
+)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+    UINT32 now;
+
+    if (!I2cDevIsIdle(&p_tpa->dev))
+    {
+        return;
+    }
+    now = p_ta->hook_table.GetSystemTime(TIMER_UNIT_MILLISECONDS);
+    if ((INT32)(now - p_tpa->next_ms) < 0)
+    {
+        return;
+    }
+
+    p_tpa->batch_read = !(p_tpa->sweep && !p_tpa->servo_set);
+    p_tpa->batch_sweep = p_tpa->sweep && p_tpa->servo_set;
+    if (!p_tpa->batch_read)
+    {
+        // Move the servo to the start position and wait until it is there
+        I2cDevWrite(&p_tpa->dev, TPA81_REG_CMD, p_tpa->servo_pos);
+        p_tpa->next_ms = now + TPA81_SETTLE_MS;
+    }
+    else
+    {
+        I2cDevRead(&p_tpa->dev, TPA81_REG_AMBIENT, 1 + TPA81_PIXELS);
+        if (p_tpa->batch_sweep)
+        {
+            I2cDevWrite(&p_tpa->dev, TPA81_REG_CMD, Tpa81NextPos(p_tpa, p_tpa->servo_pos));
+            p_tpa->next_ms = now + ((p_tpa->period_ms > TPA81_SETTLE_MS) ? p_tpa->period_ms : TPA81_SETTLE_MS);
+        }
+        else
+        {
+            p_tpa->next_ms = now + p_tpa->period_ms;
+        }
+    }
+    I2cDevSubmit(&p_tpa->dev);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Tpa81IsNew
+ *-----------------------------------------------------------------------------*/
+BOOL32 Tpa81IsNew
+(
+    TPA81 * p_tpa
+)
+{
+    BOOL32 is_new = p_tpa->is_new;
+
+    p_tpa->is_new = FALSE;
+    return is_new;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Tpa81GetMapPool
+ *-----------------------------------------------------------------------------*/
+POOL * Tpa81GetMapPool(void)
+{
+    return &map_pool;
+}
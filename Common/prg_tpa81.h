@@ -0,0 +1,169 @@
+//=============================================================================
+// Header file for the driver of the thermopile array TPA81.
+// The TPA81 measures the ambient temperature and the temperatures of 8 pixels
+// arranged in a vertical column. It can also drive a servo (register 0), so
+// the column can be swept horizontally over a panorama.
+//
+// The driver reads the ambient temperature and the pixels in one batch of
+// the I2C device layer (see prg_i2c_dev.h) every period (100 ms = 10 Hz by default), low pass filters
+// each pixel and locates the hot spot with sub-pixel resolution. In the sweep
+// mode the servo is moved one step after each reading, and the readings are
+// collected in a map of TPA81_SERVO_STEPS x TPA81_PIXELS pixels. After each
+// sweep the hot spot of the map is searched by a job of the work queue (see
+// prg_work.h), one column per step, so a program which uses the sweep mode
+// has to call WorkRun at the end of PrgTic. The search works on a copy of the
+// map from a pool of TPA81_SEARCH_MAPS maps (see prg_mem.h), which is shared
+// by all drivers of the program and taken from the arena by the first Tpa81Init.
+//
+// Temperatures are fixed point values in 1/16 C (TPA81_FIX_ONE = 1 C),
+// positions are fixed point values in 1/256 pixel (TPA81_POS_ONE = 1 pixel).
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __PRG_TPA81_H__
+#define __PRG_TPA81_H__
+
+#include "prg_i2c_dev.h"
+#include "prg_mem.h"
+#include "prg_work.h"
+
+#define TPA81_ADDR              0x68    // 7-bit address (0xD0 in the data sheet)
+
+#define TPA81_REG_CMD           0x00    // read: software revision, write: servo position
+#define TPA81_REG_AMBIENT       0x01
+#define TPA81_REG_PIXEL         0x02    // pixels 1...8 in the registers 2...9
+#define TPA81_REGS              (TPA81_REG_PIXEL + 8)
+
+// One offset byte, one data byte, 400 kHz
+#define TPA81_PROTOCOL          (I2C_PROTO_BASE | I2C_PROTO_FAST | I2C_PROTO_DATA_1 | I2C_PROTO_OFFSET_1)
+
+#define TPA81_PIXELS            8
+#define TPA81_SERVO_STEPS       32      // servo positions 0...31
+
+#define TPA81_PERIOD_MS         100     // default period of the readings
+#define TPA81_SETTLE_MS         40      // time for the servo move and a new reading
+#define TPA81_FILTER_SHIFT      2       // default filter weight of a new reading: 1/4
+
+#ifndef TPA81_SEARCH_MAPS
+#define TPA81_SEARCH_MAPS       2       // number of map copies for running searches, all drivers
+#endif
+
+#define TPA81_FIX_SHIFT         4
+#define TPA81_FIX_ONE           (1 << TPA81_FIX_SHIFT)
+#define TPA81_POS_ONE           256
+
+// Converts a fixed point temperature into whole degrees
+#define TPA81_FIX_TO_C(t)       ((t) >> TPA81_FIX_SHIFT)
+
+
+// Hot spot
+typedef struct
+{
+    INT16           col;            // servo position in 1/256 steps (sweep mode only)
+    INT16           row;            // pixel in 1/256 pixel, 0 = pixel 1
+    INT16           temp;           // temperature of the hottest pixel
+} TPA81_HOTSPOT;
+
+
+// Driver state. All fields are read-only for the program.
+typedef struct
+{
+    UCHAR8          devaddr;
+    UCHAR8          filter_shift;   // weight of a new reading: 1/2^filter_shift (0 = no filter)
+    UINT16          period_ms;
+
+    // Last reading
+    UCHAR8          ambient;        // C
+    UCHAR8          raw[TPA81_PIXELS];  // C
+    UINT16          status;         // status of the last I2C job
+    UINT32          n_frames;       // number of successful readings
+    UINT32          n_errors;       // number of failed readings
+    UINT32          frame_us;       // bus time of the last reading
+
+    // Fixed mode (no sweep): filtered pixels and the hot spot of the column
+    INT16           pixel[TPA81_PIXELS];
+    TPA81_HOTSPOT   hot;
+
+    // Sweep mode: filtered map and its hot spot, updated by the search after each sweep
+    BOOL8           sweep;
+    UCHAR8          servo_pos;      // position of the last reading
+    INT8            servo_dir;      // +1 / -1
+    UCHAR8          map_valid;      // TRUE after the first complete sweep
+    INT16           map[TPA81_SERVO_STEPS][TPA81_PIXELS];
+    TPA81_HOTSPOT   map_hot;
+    UINT32          n_sweeps;
+    UINT32          n_searches;     // number of finished searches of the hot spot
+    UINT32          n_search_skipped;   // sweeps without search: the previous one was still running
+                                        // or no map copy was free
+    UINT32          search_ticks;   // number of ticks of the last search
+
+    // Search of the hot spot: job of the work queue on a copy of the map
+    WORK            search;
+    UINT32          search_max;     // index of the largest value so far
+    INT16        (* p_search_map)[TPA81_PIXELS];   // copy of the map from the pool, NULL = none
+
+    // Internal
+    BOOL8           is_new;         // TRUE after a new reading, reset by Tpa81IsNew
+    BOOL8           servo_set;      // TRUE if the servo has been moved to servo_pos
+    BOOL8           batch_read;     // the batch reads the sensor
+    BOOL8           batch_sweep;    // the batch moves the servo to the next position
+    UINT32          next_ms;
+    I2C_DEV         dev;
+} TPA81;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// This function initializes the driver. period_ms = 0 selects TPA81_PERIOD_MS.
+void Tpa81Init
+(
+    TPA81 * p_tpa,
+    TA * p_ta_array,
+    UCHAR8 devaddr,
+    UINT16 period_ms,
+    UCHAR8 filter_shift
+);
+
+
+// This function starts (is_sweep = TRUE) or stops the sweep mode. When the sweep
+// is stopped the servo stays at its current position.
+void Tpa81SetSweep
+(
+    TPA81 * p_tpa,
+    BOOL32 is_sweep
+);
+
+
+// This function starts the next reading when it is due. Should be called every
+// tick after I2cJobPoll.
+void Tpa81Tick
+(
+    TPA81 * p_tpa,
+    TA * p_ta_array
+);
+
+
+// Returns TRUE once after each new reading
+BOOL32 Tpa81IsNew
+(
+    TPA81 * p_tpa
+);
+
+
+// Returns the pool of the map copies, e.g. for MemFormatStats
+POOL * Tpa81GetMapPool(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // __PRG_TPA81_H__
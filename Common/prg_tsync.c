@@ -0,0 +1,297 @@
+//=============================================================================
+// Time synchronization of ROBO TX Controllers.
+// The offset of a sample is computed as (t3 - t4) + delay / 2, which is the
+// same as the NTP formula, but the intermediate values stay small although
+// the clocks of two Controllers may differ by more than 2^31 us. The drift
+// correction needs a 64-bit product; the division by the drift unit is a
+// shift.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "prg_tsync.h"
+
+// Difference of two times modulo 2^32
+#define TSYNC_DIFF(a, b)        ((INT32)((a) - (b)))
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TsyncPut32
+ *-----------------------------------------------------------------------------*/
+static void TsyncPut32
+(
+    UCHAR8 * p_buf,
+    UINT32 value
+)
+{
+    p_buf[0] = (UCHAR8)value;
+    p_buf[1] = (UCHAR8)(value >> 8);
+    p_buf[2] = (UCHAR8)(value >> 16);
+    p_buf[3] = (UCHAR8)(value >> 24);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TsyncGet32
+ *-----------------------------------------------------------------------------*/
+static UINT32 TsyncGet32
+(
+    const UCHAR8 * p_buf
+)
+{
+    return (UINT32)p_buf[0] | ((UINT32)p_buf[1] << 8) | ((UINT32)p_buf[2] << 16) | ((UINT32)p_buf[3] << 24);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TsyncCorrection
+ *
+ * Returns the drift correction of the offset elapsed_us after the anchor.
+ *-----------------------------------------------------------------------------*/
+static INT32 TsyncCorrection
+(
+    const TSYNC * p_sync,
+    INT32 elapsed_us
+)
+{
+    return (INT32)(((signed long long)elapsed_us * p_sync->drift) / (1 << TSYNC_DRIFT_SHIFT));
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TsyncEstimate
+ *
+ * Makes a new estimate from the best sample of a round.
+ *-----------------------------------------------------------------------------*/
+static void TsyncEstimate
+(
+    TSYNC * p_sync
+)
+{
+    INT32 elapsed_us;
+    INT32 drift;
+
+    if (p_sync->state == TSYNC_STATE_INIT)
+    {
+        p_sync->base_us = p_sync->best_local_us;
+        p_sync->base_offset_us = p_sync->best_offset_us;
+        p_sync->state = TSYNC_STATE_OFFSET;
+    }
+    else
+    {
+        elapsed_us = TSYNC_DIFF(p_sync->best_local_us, p_sync->base_us);
+        if (elapsed_us >= TSYNC_DRIFT_BASE_US)
+        {
+            drift = (INT32)(((signed long long)TSYNC_DIFF(p_sync->best_offset_us, p_sync->base_offset_us) *
+                (1 << TSYNC_DRIFT_SHIFT)) / elapsed_us);
+            if (drift > TSYNC_DRIFT_MAX)
+            {
+                drift = TSYNC_DRIFT_MAX;
+            }
+            else if (drift < -TSYNC_DRIFT_MAX)
+            {
+                drift = -TSYNC_DRIFT_MAX;
+            }
+
+            if (p_sync->state == TSYNC_STATE_OFFSET)
+            {
+                p_sync->drift = drift;
+                p_sync->state = TSYNC_STATE_SYNCED;
+            }
+            else
+            {
+                p_sync->drift += (drift - p_sync->drift) / (1 << TSYNC_DRIFT_GAIN);
+            }
+            p_sync->base_us = p_sync->best_local_us;
+            p_sync->base_offset_us = p_sync->best_offset_us;
+        }
+    }
+
+    // Once the drift is known, the measured offset is weighted against the predicted one
+    if (p_sync->state == TSYNC_STATE_SYNCED)
+    {
+        UINT32 predicted_us = (UINT32)p_sync->offset_us +
+            TsyncCorrection(p_sync, TSYNC_DIFF(p_sync->best_local_us, p_sync->anchor_us));
+
+        p_sync->offset_us = (INT32)(predicted_us + TSYNC_DIFF(p_sync->best_offset_us, predicted_us) /
+            (1 << TSYNC_OFFSET_GAIN));
+    }
+    else
+    {
+        p_sync->offset_us = p_sync->best_offset_us;
+    }
+    p_sync->anchor_us = p_sync->best_local_us;
+    p_sync->error_us = p_sync->best_delay_us / 2;
+    p_sync->n_estimates++;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TsyncInit
+ *-----------------------------------------------------------------------------*/
+void TsyncInit
+(
+    TSYNC * p_sync,
+    BOOL32 is_reference
+)
+{
+    p_sync->state = (is_reference) ? TSYNC_STATE_SYNCED : TSYNC_STATE_INIT;
+    p_sync->is_reference = (is_reference) ? TRUE : FALSE;
+    p_sync->n_samples = 0;
+    p_sync->reserved = 0;
+    p_sync->best_local_us = 0;
+    p_sync->best_offset_us = 0;
+    p_sync->best_delay_us = 0;
+    p_sync->anchor_us = 0;
+    p_sync->offset_us = 0;
+    p_sync->drift = 0;
+    p_sync->error_us = 0;
+    p_sync->base_us = 0;
+    p_sync->base_offset_us = 0;
+    p_sync->n_requests = 0;
+    p_sync->n_replies = 0;
+    p_sync->n_dropped = 0;
+    p_sync->n_estimates = 0;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TsyncPutRequest
+ *-----------------------------------------------------------------------------*/
+UINT32 TsyncPutRequest
+(
+    TSYNC * p_sync,
+    UINT32 now_us,
+    UCHAR8 * p_buf
+)
+{
+    TsyncPut32(p_buf, now_us);
+    p_sync->n_requests++;
+    return TSYNC_REQ_LEN;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TsyncPutReply
+ *-----------------------------------------------------------------------------*/
+UINT32 TsyncPutReply
+(
+    TSYNC * p_sync,
+    const UCHAR8 * p_req,
+    UINT32 recv_us,
+    UINT32 now_us,
+    UCHAR8 * p_buf
+)
+{
+    // t1 is copied first, so p_req may point to p_buf
+    TsyncPut32(&p_buf[0], TsyncGet32(p_req));
+    TsyncPut32(&p_buf[4], recv_us);
+    TsyncPut32(&p_buf[8], now_us);
+    p_sync->n_requests++;
+    return TSYNC_RSP_LEN;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TsyncHandleReply
+ *-----------------------------------------------------------------------------*/
+BOOL32 TsyncHandleReply
+(
+    TSYNC * p_sync,
+    const UCHAR8 * p_rsp,
+    UINT32 recv_us
+)
+{
+    UINT32 t1 = TsyncGet32(&p_rsp[0]);
+    UINT32 t2 = TsyncGet32(&p_rsp[4]);
+    UINT32 t3 = TsyncGet32(&p_rsp[8]);
+    INT32 round_trip_us = TSYNC_DIFF(recv_us, t1);
+    INT32 hold_us = TSYNC_DIFF(t3, t2);
+    UINT32 delay_us;
+
+    // A reply to an old request (or garbage) is recognized by its round trip time
+    if (p_sync->is_reference || round_trip_us < 0 || round_trip_us > TSYNC_DELAY_MAX_US ||
+        hold_us < 0 || hold_us > round_trip_us)
+    {
+        p_sync->n_dropped++;
+        return FALSE;
+    }
+    delay_us = (UINT32)(round_trip_us - hold_us);
+    p_sync->n_replies++;
+
+    if (!p_sync->n_samples || delay_us < p_sync->best_delay_us)
+    {
+        p_sync->best_local_us = t1 + (UINT32)round_trip_us / 2;
+        p_sync->best_offset_us = TSYNC_DIFF(t3, recv_us) + (INT32)(delay_us / 2);
+        p_sync->best_delay_us = delay_us;
+    }
+    if (++p_sync->n_samples < TSYNC_ROUND)
+    {
+        return FALSE;
+    }
+    p_sync->n_samples = 0;
+    TsyncEstimate(p_sync);
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TsyncIsSynced
+ *-----------------------------------------------------------------------------*/
+BOOL32 TsyncIsSynced
+(
+    const TSYNC * p_sync
+)
+{
+    return p_sync->state != TSYNC_STATE_INIT;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TsyncLocalToShared
+ *-----------------------------------------------------------------------------*/
+UINT32 TsyncLocalToShared
+(
+    const TSYNC * p_sync,
+    UINT32 local_us
+)
+{
+    return local_us + p_sync->offset_us + TsyncCorrection(p_sync, TSYNC_DIFF(local_us, p_sync->anchor_us));
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TsyncSharedToLocal
+ *
+ * The drift correction is computed for the local time without correction;
+ * the error of this is the drift squared and negligible.
+ *-----------------------------------------------------------------------------*/
+UINT32 TsyncSharedToLocal
+(
+    const TSYNC * p_sync,
+    UINT32 shared_us
+)
+{
+    UINT32 local_us = shared_us - p_sync->offset_us;
+
+    return local_us - TsyncCorrection(p_sync, TSYNC_DIFF(local_us, p_sync->anchor_us));
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TsyncIsDue
+ *-----------------------------------------------------------------------------*/
+BOOL32 TsyncIsDue
+(
+    const TSYNC * p_sync,
+    UINT32 local_us,
+    UINT32 shared_us
+)
+{
+    return TSYNC_DIFF(TsyncLocalToShared(p_sync, local_us), shared_us) >= 0;
+}
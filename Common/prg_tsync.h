@@ -0,0 +1,175 @@
+//=============================================================================
+// Header file for the time synchronization of ROBO TX Controllers.
+// Every Controller counts GetSystemTime(TIMER_UNIT_MICROSECONDS) from its own
+// power-on with its own crystal, so the times of two Controllers differ by
+// an offset which changes slowly (drift, up to some 10 ppm). One Controller
+// is the reference, its time is the shared time; the others (followers)
+// estimate their offset and drift to the reference and convert between
+// their local time and the shared time. So programs on several Controllers
+// can schedule an action at a common tick instead of adding a safety margin
+// for the Bluetooth latency.
+//
+// The time stamps are carried in the messages the programs exchange anyway
+// (request/reply over Bluetooth), as in NTP:
+//   request  (follower -> reference)  t1 = send time of the follower
+//   reply    (reference -> follower)  t1 | t2 = receive time, t3 = send time of the reference
+// The follower takes the receive time t4 of the reply and gets one sample:
+//   offset = ((t2 - t1) + (t3 - t4)) / 2,  delay = (t4 - t1) - (t3 - t2)
+// The error of a sample is at most delay / 2, the unknown asymmetry of the
+// Bluetooth latency. Of TSYNC_ROUND samples only the one with the smallest
+// delay is used (most Bluetooth jitter is added queueing time). The drift is
+// measured between estimates at least TSYNC_DRIFT_BASE_US apart and
+// smoothed. Receive times should be taken from the callback context, i.e.
+// MboxGetMsgTime of the callback mailbox.
+//
+// Times are 32-bit microseconds, which wrap after 71 minutes; all differences
+// are computed modulo 2^32, so they are correct for intervals < 35 minutes.
+// Multi-byte values in the stamps are little endian.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __PRG_TSYNC_H__
+#define __PRG_TSYNC_H__
+
+#include "ROBO_TX_PRG.h"
+
+#define TSYNC_REQ_LEN           4           // length of the stamp in a request
+#define TSYNC_RSP_LEN           12          // length of the stamp in a reply
+
+#define TSYNC_ROUND             8           // samples per estimate
+#define TSYNC_DELAY_MAX_US      500000      // samples with a longer round trip are dropped
+#define TSYNC_DRIFT_BASE_US     20000000    // min. time between the estimates a drift is measured from
+#define TSYNC_DRIFT_SHIFT       24          // drift unit: 2^-24 (0.06 ppm)
+#define TSYNC_DRIFT_MAX         (200 << (TSYNC_DRIFT_SHIFT - 20))   // about 200 ppm
+#define TSYNC_DRIFT_GAIN        2           // weight of a new drift measurement: 2^-TSYNC_DRIFT_GAIN
+#define TSYNC_OFFSET_GAIN       2           // weight of a new offset measurement, once the drift is known
+
+
+// Synchronization state
+enum tsync_state_e
+{
+    TSYNC_STATE_INIT = 0,       // follower, no estimate yet
+    TSYNC_STATE_OFFSET,         // offset known, drift not yet measured
+    TSYNC_STATE_SYNCED          // offset and drift known (always for the reference)
+};
+
+
+// Time synchronization of one Controller
+typedef struct
+{
+    UCHAR8          state;          // see enum tsync_state_e
+    BOOL8           is_reference;
+    UCHAR8          n_samples;      // samples of the current round
+    UCHAR8          reserved;
+
+    // Best sample of the current round
+    UINT32          best_local_us;  // local time of the sample (middle of the round trip)
+    INT32           best_offset_us;
+    UINT32          best_delay_us;
+
+    // Estimate: shared time = local time + offset + (local time - anchor) * drift
+    UINT32          anchor_us;      // local time of the last estimate
+    INT32           offset_us;      // shared time - local time at anchor_us
+    INT32           drift;          // change of the offset per local us, 2^-TSYNC_DRIFT_SHIFT
+    UINT32          error_us;       // max. error of the last estimate
+    UINT32          base_us;        // local time of the estimate the next drift is measured from
+    INT32           base_offset_us;
+
+    // Counters
+    UINT32          n_requests;     // stamps of requests (follower) or replies (reference)
+    UINT32          n_replies;      // used samples
+    UINT32          n_dropped;      // implausible samples
+    UINT32          n_estimates;
+} TSYNC;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// This function initializes the synchronization. The reference is synchronized
+// from the start, its shared time is its local time.
+void TsyncInit
+(
+    TSYNC * p_sync,
+    BOOL32 is_reference
+);
+
+
+// Follower: writes the stamp of a request (TSYNC_REQ_LEN bytes) to p_buf.
+// now_us is the local time right before the message is sent.
+// Returns the length of the stamp.
+UINT32 TsyncPutRequest
+(
+    TSYNC * p_sync,
+    UINT32 now_us,
+    UCHAR8 * p_buf
+);
+
+
+// Reference: writes the stamp of the reply (TSYNC_RSP_LEN bytes) to p_buf.
+// p_req is the stamp of the request, recv_us its receive time, now_us the
+// local time right before the reply is sent. Returns the length of the stamp.
+UINT32 TsyncPutReply
+(
+    TSYNC * p_sync,
+    const UCHAR8 * p_req,
+    UINT32 recv_us,
+    UINT32 now_us,
+    UCHAR8 * p_buf
+);
+
+
+// Follower: takes the sample of a reply received at recv_us. Returns TRUE if
+// a new estimate was made.
+BOOL32 TsyncHandleReply
+(
+    TSYNC * p_sync,
+    const UCHAR8 * p_rsp,
+    UINT32 recv_us
+);
+
+
+// Returns TRUE if the shared time is known
+BOOL32 TsyncIsSynced
+(
+    const TSYNC * p_sync
+);
+
+
+// Converts a local time to the shared time
+UINT32 TsyncLocalToShared
+(
+    const TSYNC * p_sync,
+    UINT32 local_us
+);
+
+
+// Converts a shared time to the local time
+UINT32 TsyncSharedToLocal
+(
+    const TSYNC * p_sync,
+    UINT32 shared_us
+);
+
+
+// Returns TRUE if the shared time shared_us has been reached at the local time local_us
+BOOL32 TsyncIsDue
+(
+    const TSYNC * p_sync,
+    UINT32 local_us,
+    UINT32 shared_us
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // __PRG_TSYNC_H__
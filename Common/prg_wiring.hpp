@@ -0,0 +1,384 @@
+//=============================================================================
+// Header file for the wiring of a model, for C++ programs.
+// The motors, outputs and inputs of a model and the Transfer Area (Controller)
+// each of them is connected to are described as types; a device type knows
+// its Transfer Area index, PWM channels, universal input and counter as
+// compile-time constants, so its accessors compile to a fixed address and no
+// index arithmetic is left at run time:
+//
+//     typedef EncoderMotor<TA_LOCAL, 1>   Lift;       // M1, counter C1
+//     typedef Output<TA_EXT_1, 3>         Lamp;       // O3 of Extension 1
+//     typedef Button<TA_LOCAL, 8>         Start;      // I8
+//     typedef Wiring<Lift, Lamp, Start>   Model;
+//
+//     Model::Configure(p_ta_array);       // in PrgInit
+//     Lift::Run(p_ta_array, DUTY_MAX);    // in PrgTic
+//
+// Miswiring is a compile error: a motor or input number out of range
+// (N_MOTOR, N_PWM_CHAN, N_UNI, N_CNT), a Transfer Area index out of range,
+// two devices on the same PWM channel (e.g. motor M1 and output O2),
+// universal input or counter of the same Controller, or a motor following a
+// master on another Controller. The compiler names the failed check
+// ("incomplete type WiringCheck<false, ...::pwm_channel_used_twice>").
+//
+// Only C++98 is used (the target compiler is gcc 4.4), and nothing needs the
+// C++ run-time library: no exceptions, no RTTI, no objects. The startup code
+// of the programs does not run constructors of global objects.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __PRG_WIRING_HPP__
+#define __PRG_WIRING_HPP__
+
+#include "ROBO_TX_PRG.h"
+
+
+// Compile-time check: the size of WiringCheck<false, NAME> is not known
+template <bool, class NAME> struct WiringCheck;
+template <class NAME> struct WiringCheck<true, NAME> { enum { OK = 1 }; };
+
+#define WIRING_CHECK(cond, name)    struct name; enum { name##_ok = sizeof(WiringCheck<(cond), name>) }
+
+
+// Transfer Area index
+template <int TA_IDX>
+struct WiringTa
+{
+    WIRING_CHECK(TA_IDX >= TA_LOCAL && TA_IDX < TA_COUNT, ta_index_out_of_range);
+
+    enum { TA_INDEX = TA_IDX };
+
+    static TA * Get(TA * p_ta_array)
+    {
+        return &p_ta_array[TA_IDX];
+    }
+};
+
+
+// Placeholder for unused devices of a Wiring
+struct NoDevice
+{
+    enum
+    {
+        TA_INDEX = -1,
+        PWM_MASK = 0,
+        UNI_MASK = 0,
+        CNT_MASK = 0
+    };
+
+    static void Configure(TA *) {}
+};
+
+
+// Motor output M1...M4 (PWM channels 2n-2 and 2n-1)
+template <int TA_IDX, int NUMBER>
+struct Motor : WiringTa<TA_IDX>
+{
+    WIRING_CHECK(NUMBER >= 1 && NUMBER <= N_MOTOR, motor_number_out_of_range);
+    WIRING_CHECK(2 * NUMBER <= N_PWM_CHAN, motor_pwm_channel_out_of_range);
+
+    enum
+    {
+        IDX      = NUMBER - 1,
+        PWM_FWD  = 2 * IDX,
+        PWM_REV  = 2 * IDX + 1,
+        PWM_MASK = 3 << (2 * IDX),
+        UNI_MASK = 0,
+        CNT_MASK = 0
+    };
+
+    static void Configure(TA * p_ta_array)
+    {
+        p_ta_array[TA_IDX].config.motor[IDX] = TRUE;
+    }
+
+    // duty > 0: forward, duty < 0: backward
+    static void Run(TA * p_ta_array, INT16 duty)
+    {
+        p_ta_array[TA_IDX].output.duty[PWM_FWD] = (duty > 0) ? duty : 0;
+        p_ta_array[TA_IDX].output.duty[PWM_REV] = (duty < 0) ? -duty : 0;
+    }
+
+    static void Stop(TA * p_ta_array)
+    {
+        p_ta_array[TA_IDX].output.duty[PWM_FWD] = 0;
+        p_ta_array[TA_IDX].output.duty[PWM_REV] = 0;
+    }
+};
+
+
+// Checks a master/slave pair of motors
+template <class SLAVE, class MASTER>
+struct WiringFollowCheck
+{
+    WIRING_CHECK((int)MASTER::TA_INDEX == (int)SLAVE::TA_INDEX, master_on_other_controller);
+    WIRING_CHECK((int)MASTER::IDX != (int)SLAVE::IDX, motor_follows_itself);
+
+    enum { OK = 1 };
+};
+
+
+// Motor with encoder on the counter of the same number, for the extended
+// motor control (distance and synchronization)
+template <int TA_IDX, int NUMBER>
+struct EncoderMotor : Motor<TA_IDX, NUMBER>
+{
+    WIRING_CHECK(NUMBER <= N_CNT, motor_counter_out_of_range);
+
+    enum
+    {
+        IDX      = NUMBER - 1,
+        CNT_MASK = 1 << IDX
+    };
+
+    static INT16 Counter(TA * p_ta_array)
+    {
+        return p_ta_array[TA_IDX].input.counter[IDX];
+    }
+
+    static void ResetCounter(TA * p_ta_array)
+    {
+        p_ta_array[TA_IDX].input.cnt_resetted[IDX] = FALSE;
+        p_ta_array[TA_IDX].output.cnt_reset_cmd_id[IDX]++;
+    }
+
+    static BOOL32 IsCounterReset(TA * p_ta_array)
+    {
+        return p_ta_array[TA_IDX].input.cnt_resetted[IDX];
+    }
+
+    // Runs the motor until the counter reaches distance
+    static void Move(TA * p_ta_array, INT16 duty, UINT16 distance)
+    {
+        Motor<TA_IDX, NUMBER>::Run(p_ta_array, duty);
+        p_ta_array[TA_IDX].output.distance[IDX] = distance;
+        p_ta_array[TA_IDX].input.motor_pos_reached[IDX] = FALSE;
+        p_ta_array[TA_IDX].output.motor_ex_cmd_id[IDX]++;
+    }
+
+    static BOOL32 IsPosReached(TA * p_ta_array)
+    {
+        return p_ta_array[TA_IDX].input.motor_pos_reached[IDX];
+    }
+
+    // Synchronizes the motor with a master motor of the same Controller
+    // (set before Move of both motors)
+    template <class MASTER>
+    static void Follow(TA * p_ta_array)
+    {
+        enum { check = WiringFollowCheck<EncoderMotor, MASTER>::OK };
+
+        p_ta_array[TA_IDX].output.master[IDX] = MASTER::IDX + 1;
+    }
+
+    static void Unfollow(TA * p_ta_array)
+    {
+        p_ta_array[TA_IDX].output.master[IDX] = 0;
+    }
+};
+
+
+// Single output O1...O8, for example a lamp
+template <int TA_IDX, int NUMBER>
+struct Output : WiringTa<TA_IDX>
+{
+    WIRING_CHECK(NUMBER >= 1 && NUMBER <= N_PWM_CHAN, output_number_out_of_range);
+
+    enum
+    {
+        PWM      = NUMBER - 1,
+        PWM_MASK = 1 << PWM,
+        UNI_MASK = 0,
+        CNT_MASK = 0
+    };
+
+    static void Configure(TA * p_ta_array)
+    {
+        p_ta_array[TA_IDX].config.motor[PWM / 2] = FALSE;
+    }
+
+    static void Set(TA * p_ta_array, INT16 duty)
+    {
+        p_ta_array[TA_IDX].output.duty[PWM] = duty;
+    }
+
+    static void On(TA * p_ta_array)
+    {
+        p_ta_array[TA_IDX].output.duty[PWM] = DUTY_MAX;
+    }
+
+    static void Off(TA * p_ta_array)
+    {
+        p_ta_array[TA_IDX].output.duty[PWM] = 0;
+    }
+};
+
+
+// Universal input I1...I8 in one of the modes of enum InputMode
+template <int TA_IDX, int NUMBER, int MODE, bool DIGITAL>
+struct UniInput : WiringTa<TA_IDX>
+{
+    WIRING_CHECK(NUMBER >= 1 && NUMBER <= N_UNI, input_number_out_of_range);
+    WIRING_CHECK(MODE == MODE_U || MODE == MODE_R || MODE == MODE_ULTRASONIC, input_mode_invalid);
+    WIRING_CHECK(MODE != MODE_ULTRASONIC || !DIGITAL, ultrasonic_input_is_digital);
+
+    enum
+    {
+        IDX      = NUMBER - 1,
+        PWM_MASK = 0,
+        UNI_MASK = 1 << IDX,
+        CNT_MASK = 0
+    };
+
+    static void Configure(TA * p_ta_array)
+    {
+        p_ta_array[TA_IDX].config.uni[IDX].mode = MODE;
+        p_ta_array[TA_IDX].config.uni[IDX].digital = DIGITAL;
+    }
+
+    static INT16 Value(TA * p_ta_array)
+    {
+        return p_ta_array[TA_IDX].input.uni[IDX];
+    }
+};
+
+
+// Push button or switch ("Digital 5 kOhm")
+template <int TA_IDX, int NUMBER>
+struct Button : UniInput<TA_IDX, NUMBER, MODE_R, true>
+{
+    static BOOL32 IsPressed(TA * p_ta_array)
+    {
+        return p_ta_array[TA_IDX].input.uni[NUMBER - 1] != 0;
+    }
+};
+
+
+// Ultrasonic distance sensor, Value is the distance in cm
+template <int TA_IDX, int NUMBER>
+struct Ultrasonic : UniInput<TA_IDX, NUMBER, MODE_ULTRASONIC, false>
+{
+};
+
+
+// Counter input C1...C4 without motor
+template <int TA_IDX, int NUMBER>
+struct CounterInput : WiringTa<TA_IDX>
+{
+    WIRING_CHECK(NUMBER >= 1 && NUMBER <= N_CNT, counter_number_out_of_range);
+
+    enum
+    {
+        IDX      = NUMBER - 1,
+        PWM_MASK = 0,
+        UNI_MASK = 0,
+        CNT_MASK = 1 << IDX
+    };
+
+    static void Configure(TA *) {}
+
+    static INT16 Value(TA * p_ta_array)
+    {
+        return p_ta_array[TA_IDX].input.counter[IDX];
+    }
+};
+
+
+// Channels of a device on one Transfer Area
+template <class DEV, int TA_IDX>
+struct WiringMasks
+{
+    enum
+    {
+        IS_ON    = ((int)DEV::TA_INDEX == TA_IDX),
+        PWM_MASK = (IS_ON) ? (int)DEV::PWM_MASK : 0,
+        UNI_MASK = (IS_ON) ? (int)DEV::UNI_MASK : 0,
+        CNT_MASK = (IS_ON) ? (int)DEV::CNT_MASK : 0
+    };
+};
+
+
+// Checks the channels of all devices on the Transfer Areas TA_IDX...TA_COUNT - 1.
+// The masks of devices on different channels have no common bits, so their
+// sum is equal to their bitwise or.
+template <class D1, class D2, class D3, class D4, class D5, class D6, class D7, class D8, int TA_IDX>
+struct WiringCheckTa
+{
+    typedef WiringMasks<D1, TA_IDX> M1;
+    typedef WiringMasks<D2, TA_IDX> M2;
+    typedef WiringMasks<D3, TA_IDX> M3;
+    typedef WiringMasks<D4, TA_IDX> M4;
+    typedef WiringMasks<D5, TA_IDX> M5;
+    typedef WiringMasks<D6, TA_IDX> M6;
+    typedef WiringMasks<D7, TA_IDX> M7;
+    typedef WiringMasks<D8, TA_IDX> M8;
+
+    WIRING_CHECK((M1::PWM_MASK + M2::PWM_MASK + M3::PWM_MASK + M4::PWM_MASK +
+                  M5::PWM_MASK + M6::PWM_MASK + M7::PWM_MASK + M8::PWM_MASK) ==
+                 (M1::PWM_MASK | M2::PWM_MASK | M3::PWM_MASK | M4::PWM_MASK |
+                  M5::PWM_MASK | M6::PWM_MASK | M7::PWM_MASK | M8::PWM_MASK), pwm_channel_used_twice);
+    WIRING_CHECK((M1::UNI_MASK + M2::UNI_MASK + M3::UNI_MASK + M4::UNI_MASK +
+                  M5::UNI_MASK + M6::UNI_MASK + M7::UNI_MASK + M8::UNI_MASK) ==
+                 (M1::UNI_MASK | M2::UNI_MASK | M3::UNI_MASK | M4::UNI_MASK |
+                  M5::UNI_MASK | M6::UNI_MASK | M7::UNI_MASK | M8::UNI_MASK), input_used_twice);
+    WIRING_CHECK((M1::CNT_MASK + M2::CNT_MASK + M3::CNT_MASK + M4::CNT_MASK +
+                  M5::CNT_MASK + M6::CNT_MASK + M7::CNT_MASK + M8::CNT_MASK) ==
+                 (M1::CNT_MASK | M2::CNT_MASK | M3::CNT_MASK | M4::CNT_MASK |
+                  M5::CNT_MASK | M6::CNT_MASK | M7::CNT_MASK | M8::CNT_MASK), counter_used_twice);
+
+    enum
+    {
+        IS_USED = M1::IS_ON || M2::IS_ON || M3::IS_ON || M4::IS_ON ||
+                  M5::IS_ON || M6::IS_ON || M7::IS_ON || M8::IS_ON,
+        TA_MASK = (IS_USED << TA_IDX) | WiringCheckTa<D1, D2, D3, D4, D5, D6, D7, D8, TA_IDX + 1>::TA_MASK
+    };
+};
+
+template <class D1, class D2, class D3, class D4, class D5, class D6, class D7, class D8>
+struct WiringCheckTa<D1, D2, D3, D4, D5, D6, D7, D8, TA_COUNT>
+{
+    enum { TA_MASK = 0 };
+};
+
+
+// Wiring of a model: up to 8 devices
+template <class D1, class D2 = NoDevice, class D3 = NoDevice, class D4 = NoDevice,
+          class D5 = NoDevice, class D6 = NoDevice, class D7 = NoDevice, class D8 = NoDevice>
+struct Wiring
+{
+    // Bit n: Transfer Area n is used
+    enum { TA_MASK = WiringCheckTa<D1, D2, D3, D4, D5, D6, D7, D8, TA_LOCAL>::TA_MASK };
+
+    // Configures the outputs and inputs of all devices and informs the firmware
+    // of each Controller used
+    static void Configure(TA * p_ta_array)
+    {
+        int idx;
+
+        D1::Configure(p_ta_array);
+        D2::Configure(p_ta_array);
+        D3::Configure(p_ta_array);
+        D4::Configure(p_ta_array);
+        D5::Configure(p_ta_array);
+        D6::Configure(p_ta_array);
+        D7::Configure(p_ta_array);
+        D8::Configure(p_ta_array);
+
+        for (idx = TA_LOCAL; idx < TA_COUNT; idx++)
+        {
+            if (TA_MASK & (1 << idx))
+            {
+                p_ta_array[idx].state.config_id += 1;
+            }
+        }
+    }
+};
+
+
+#endif // __PRG_WIRING_HPP__
@@ -0,0 +1,162 @@
+//=============================================================================
+// Work queue.
+// The queued jobs form a singly linked list, the first job is the one being
+// worked on. Jobs are linked through the job structures themselves, so the
+// queue needs no memory of its own.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "prg_work.h"
+
+static WORK * p_head;
+static WORK * p_tail;
+static UINT32 work_count;
+static UINT32 run_tick;     // number of calls of WorkRun
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : WorkSubmit
+ *
+ * Appends a job to the queue.
+ *-----------------------------------------------------------------------------*/
+BOOL32 WorkSubmit
+(
+    WORK * p_work
+)
+{
+    if (p_work->state == WORK_QUEUED || !p_work->Step)
+    {
+        return FALSE;
+    }
+
+    p_work->pos = 0;
+    p_work->n_steps = 0;
+    p_work->n_ticks = 0;
+    p_work->run_tick = 0;
+    p_work->p_next = NULL;
+    p_work->state = WORK_QUEUED;
+
+    if (p_tail)
+    {
+        p_tail->p_next = p_work;
+    }
+    else
+    {
+        p_head = p_work;
+    }
+    p_tail = p_work;
+    work_count++;
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : WorkRemove
+ *
+ * Unlinks a job from the queue.
+ *-----------------------------------------------------------------------------*/
+static void WorkRemove
+(
+    WORK * p_work,
+    WORK * p_prev
+)
+{
+    if (p_prev)
+    {
+        p_prev->p_next = p_work->p_next;
+    }
+    else
+    {
+        p_head = p_work->p_next;
+    }
+    if (p_tail == p_work)
+    {
+        p_tail = p_prev;
+    }
+    p_work->p_next = NULL;
+    p_work->state = WORK_IDLE;
+    work_count--;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : WorkCancel
+ *
+ * Removes a job from the queue.
+ *-----------------------------------------------------------------------------*/
+BOOL32 WorkCancel
+(
+    WORK * p_work
+)
+{
+    WORK * p_prev = NULL;
+    WORK * p;
+
+    for (p = p_head; p; p_prev = p, p = p->p_next)
+    {
+        if (p == p_work)
+        {
+            WorkRemove(p_work, p_prev);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : WorkRun
+ *
+ * Executes steps of the queued jobs as long as the firmware allows.
+ *-----------------------------------------------------------------------------*/
+UINT32 WorkRun
+(
+    TA * p_ta_array,
+    UINT32 max_steps
+)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+    UINT32 n_steps = 0;
+
+    run_tick++;
+    while (p_head && (!max_steps || n_steps < max_steps) && p_ta->hook_table.IsRunAllowed())
+    {
+        WORK * p_work = p_head;
+        BOOL32 is_done;
+
+        if (p_work->run_tick != run_tick)
+        {
+            p_work->run_tick = run_tick;
+            p_work->n_ticks++;
+        }
+        is_done = p_work->Step(p_ta_array, p_work);
+        p_work->n_steps++;
+        n_steps++;
+
+        // The job may have been cancelled by its own step function
+        if (is_done && p_head == p_work)
+        {
+            WorkRemove(p_work, NULL);
+            if (p_work->Done)
+            {
+                p_work->Done(p_ta_array, p_work);
+            }
+        }
+    }
+    return n_steps;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : WorkGetCount
+ *-----------------------------------------------------------------------------*/
+UINT32 WorkGetCount(void)
+{
+    return work_count;
+}
@@ -0,0 +1,101 @@
+//=============================================================================
+// Header file for the work queue.
+// A program has to return from PrgTic within its time slot, and it has to
+// return immediately when the firmware function IsRunAllowed returns FALSE.
+// Longer computations (image analysis, path planning, rendering) are
+// therefore split into jobs, which are executed step by step: the step
+// function does a small, bounded piece of the work, keeps its progress in
+// the job and returns TRUE when the job is finished. WorkRun executes the
+// steps of the queued jobs in the order of their submission as long as
+// IsRunAllowed returns TRUE, and continues in the next tick where it left.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __PRG_WORK_H__
+#define __PRG_WORK_H__
+
+#include "ROBO_TX_PRG.h"
+
+
+// State of a job
+enum work_state_e
+{
+    WORK_IDLE = 0,          // not queued (never submitted, finished or cancelled)
+    WORK_QUEUED             // waiting in the queue or partly done
+};
+
+
+struct work_s;
+
+// Step function: does the next piece of the work. Returns TRUE when the job is finished.
+typedef BOOL32 (*P_WORK_STEP)(TA * p_ta_array, struct work_s * p_work);
+
+// Completion function, called from WorkRun after the last step
+typedef void (*P_WORK_DONE)(TA * p_ta_array, struct work_s * p_work);
+
+
+// Job, usually defined statically by the module. The first part is set by the
+// module, the rest is maintained by the queue.
+typedef struct work_s
+{
+    const char    * name;
+    P_WORK_STEP     Step;
+    P_WORK_DONE     Done;           // may be NULL
+    void          * p_data;         // data of the job
+    UINT32          pos;            // progress of the job, set to 0 by WorkSubmit, free for the step function
+
+    struct work_s * p_next;
+    UINT16          state;          // see enum work_state_e
+    UINT16          reserved;
+    UINT32          n_steps;        // number of steps of the last/current run
+    UINT32          n_ticks;        // number of ticks (calls of WorkRun) of the last/current run
+    UINT32          run_tick;       // WorkRun call in which the job was worked on last
+} WORK;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// This function appends a job to the queue. The progress (pos) is set to 0.
+// Returns FALSE if the job is already queued.
+BOOL32 WorkSubmit
+(
+    WORK * p_work
+);
+
+
+// This function removes a job from the queue without calling its completion function.
+// Returns FALSE if the job is not queued.
+BOOL32 WorkCancel
+(
+    WORK * p_work
+);
+
+
+// This function executes steps of the queued jobs until the queue is empty,
+// IsRunAllowed returns FALSE or max_steps steps are done (0 = no limit).
+// IsRunAllowed is checked before each step. Should be called at the end of PrgTic.
+// Returns the number of executed steps.
+UINT32 WorkRun
+(
+    TA * p_ta_array,
+    UINT32 max_steps
+);
+
+
+// Returns the number of queued jobs
+UINT32 WorkGetCount(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // __PRG_WORK_H__
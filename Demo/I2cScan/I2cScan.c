@@ -0,0 +1,358 @@
+//=============================================================================
+// Demo program "I2cScan.c".
+//
+// Can be run under control of the ROBO TX Controller
+// firmware in download (local) mode.
+// This example scans the I2C bus and measures the timing of the I2C
+// commands of the firmware:
+//   - every 7-bit address 0x08...0x77 (the addresses 0x00...0x07 and
+//     0x78...0x7F are reserved) is probed with a 1 byte read; a device
+//     is found if the read succeeds;
+//   - on the first device found the program executes BENCH_XFERS reads
+//     with each protocol variant (offset 0/1 byte, data 1/2 bytes,
+//     100/400 kHz) back to back, the next read is issued from the callback
+//     of the previous one.
+// The completion latency of every command is measured with
+// GetSystemTime(TIMER_UNIT_MICROSECONDS). The results are displayed page
+// by page, every 3000ms the next page. Only reads are used, so the
+// registers of the devices are not changed.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "ROBO_TX_PRG.h"
+#include "prg_i2c.h"
+
+#define ADDR_FIRST      0x08
+#define ADDR_LAST       0x77
+#define BENCH_XFERS     200
+#define PAGE_MS         3000
+
+#define BARRIER()       __asm__ __volatile__ ("" : : : "memory")
+
+// Protocol variants of the benchmark
+static const UCHAR8 protocols[] =
+{
+    I2C_PROTO_BASE | I2C_PROTO_OFFSET_0 | I2C_PROTO_DATA_1,
+    I2C_PROTO_BASE | I2C_PROTO_OFFSET_1 | I2C_PROTO_DATA_1,
+    I2C_PROTO_BASE | I2C_PROTO_OFFSET_0 | I2C_PROTO_DATA_2,
+    I2C_PROTO_BASE | I2C_PROTO_OFFSET_1 | I2C_PROTO_DATA_2,
+    I2C_PROTO_BASE | I2C_PROTO_FAST | I2C_PROTO_OFFSET_0 | I2C_PROTO_DATA_1,
+    I2C_PROTO_BASE | I2C_PROTO_FAST | I2C_PROTO_OFFSET_1 | I2C_PROTO_DATA_1,
+    I2C_PROTO_BASE | I2C_PROTO_FAST | I2C_PROTO_OFFSET_0 | I2C_PROTO_DATA_2,
+    I2C_PROTO_BASE | I2C_PROTO_FAST | I2C_PROTO_OFFSET_1 | I2C_PROTO_DATA_2
+};
+
+#define N_PROTOCOLS     (sizeof(protocols) / sizeof(protocols[0]))
+
+// Timing of a series of commands
+typedef struct
+{
+    UINT32 n_ok;
+    UINT32 n_err;
+    UINT32 lat_min;         // us
+    UINT32 lat_max;
+    UINT32 lat_sum;
+    UINT32 t_start;         // us
+    UINT32 t_end;
+} XFER_STATS;
+
+static enum
+{
+    SCAN_START,
+    SCAN_WAIT,
+    BENCH_START,
+    BENCH_WAIT,
+    LOOP_CLEAR_PREV_SCREEN,
+    LOOP_DISP_RESULT,
+    LOOP_WAIT_NEXT_ACTION
+} stage;
+
+unsigned int ticks;
+unsigned int next_action=0;
+
+// Results
+static UCHAR8 found[ADDR_LAST + 1];
+static UINT32 n_found;
+static UCHAR8 bench_addr;
+static XFER_STATS ack_stats;            // probes of existing devices
+static XFER_STATS nack_stats;           // probes of free addresses
+static XFER_STATS bench_stats[N_PROTOCOLS];
+
+// State of the running series, changed by the callback
+static TA * p_ta_local;
+static UCHAR8 cur_addr;
+static UINT32 cur_proto;
+static UINT32 cur_n;
+static UINT32 t_issue;
+static volatile BOOL8 is_done;
+
+static unsigned int page;
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : StatsAdd
+ *-----------------------------------------------------------------------------*/
+static void StatsAdd
+(
+    XFER_STATS * p_stats,
+    BOOL32 is_ok,
+    UINT32 lat
+)
+{
+    if (!is_ok)
+    {
+        p_stats->n_err++;
+    }
+    else
+    {
+        p_stats->n_ok++;
+    }
+    if (p_stats->n_ok + p_stats->n_err == 1 || lat < p_stats->lat_min)
+    {
+        p_stats->lat_min = lat;
+    }
+    if (lat > p_stats->lat_max)
+    {
+        p_stats->lat_max = lat;
+    }
+    p_stats->lat_sum += lat;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Issue
+ *
+ * Issues the next read of the series. Returns FALSE if the firmware does not
+ * accept the command.
+ *-----------------------------------------------------------------------------*/
+static void I2cCallback(TA * p_ta_array, I2C_CB * p_data);
+
+static BOOL32 Issue(void)
+{
+    UCHAR8 addr = (stage == SCAN_WAIT) ? cur_addr : bench_addr;
+    UCHAR8 protocol = (stage == SCAN_WAIT) ? protocols[0] : protocols[cur_proto];
+
+    t_issue = p_ta_local->hook_table.GetSystemTime(TIMER_UNIT_MICROSECONDS);
+    return p_ta_local->hook_table.I2cRead(addr, 0, protocol, I2cCallback) == 0;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : I2cCallback
+ *
+ * This callback function is called to inform the program about result (status)
+ * of execution of any I2c command. It records the latency and issues the next
+ * command of the series.
+ *-----------------------------------------------------------------------------*/
+static void I2cCallback
+(
+    TA * p_ta_array,
+    I2C_CB * p_data
+)
+{
+    UINT32 now = p_ta_local->hook_table.GetSystemTime(TIMER_UNIT_MICROSECONDS);
+    BOOL32 is_ok = (p_data->status == I2C_SUCCESS);
+    BOOL32 is_last;
+
+    if (stage == SCAN_WAIT)
+    {
+        StatsAdd((is_ok) ? &ack_stats : &nack_stats, TRUE, now - t_issue);
+        if (is_ok)
+        {
+            found[cur_addr] = TRUE;
+        }
+        is_last = (cur_addr == ADDR_LAST);
+        cur_addr++;
+    }
+    else
+    {
+        StatsAdd(&bench_stats[cur_proto], is_ok, now - t_issue);
+        bench_stats[cur_proto].t_end = now;
+        is_last = (++cur_n >= BENCH_XFERS);
+    }
+
+    if (is_last || !Issue())
+    {
+        BARRIER();
+        is_done = TRUE;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : DisplayPage
+ *
+ * Formats the result page idx, returns FALSE if there is no such page.
+ *-----------------------------------------------------------------------------*/
+static BOOL32 DisplayPage
+(
+    TA * p_ta,
+    unsigned int idx,
+    char * str
+)
+{
+    const XFER_STATS * p_stats;
+    int len, addr, n, dt;
+
+    if (idx == 0)
+    {
+        len = p_ta->hook_table.sprintf(str, "%d devices:", (int)n_found);
+        for (addr = ADDR_FIRST, n = 0; addr <= ADDR_LAST && n < 8; addr++)
+        {
+            if (found[addr])
+            {
+                len += p_ta->hook_table.sprintf(&str[len], " %02X", addr);
+                n++;
+            }
+        }
+        p_ta->hook_table.sprintf(&str[len], "\nACK %d us\nNACK %d us",
+            (ack_stats.n_ok) ? (int)(ack_stats.lat_sum / ack_stats.n_ok) : 0,
+            (nack_stats.n_ok) ? (int)(nack_stats.lat_sum / nack_stats.n_ok) : 0);
+        return TRUE;
+    }
+    if (!n_found || idx > N_PROTOCOLS)
+    {
+        return FALSE;
+    }
+
+    p_stats = &bench_stats[idx - 1];
+    n = p_stats->n_ok + p_stats->n_err;
+    dt = p_stats->t_end - p_stats->t_start;
+    p_ta->hook_table.sprintf(str, "%02X prot. %02X: %d err\n%d cmd/s, %d B/s\nlat. %d/%d/%d us",
+        bench_addr, protocols[idx - 1], (int)p_stats->n_err,
+        (dt > 0) ? (int)((UINT32)n * 1000000 / dt) : 0,
+        (dt > 0) ? (int)(p_stats->n_ok * I2C_PROTO_DATA_LEN(protocols[idx - 1]) * 1000000 / dt) : 0,
+        (int)p_stats->lat_min, (n) ? (int)(p_stats->lat_sum / n) : 0, (int)p_stats->lat_max);
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PrgInit
+ *
+ * This it the program initialization.
+ * It is called once.
+ *-----------------------------------------------------------------------------*/
+void PrgInit
+(
+    TA * p_ta_array,    // pointer to the array of transfer areas
+    int ta_count        // number of transfer areas in array (equal to TA_COUNT)
+)
+{
+    p_ta_local = &p_ta_array[TA_LOCAL];
+
+    ticks = 0;
+    page = 0;
+    stage = SCAN_START;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PrgTic
+ *
+ * This is the main function of this program.
+ * It is called every tic (1 ms) realtime.
+ *-----------------------------------------------------------------------------*/
+int PrgTic
+(
+    TA * p_ta_array,    // pointer to the array of transfer areas
+    int ta_count        // number of transfer areas in array (equal to TA_COUNT)
+)
+{
+    int rc = 0x7FFF; // return code: 0x7FFF - program should be further called by the firmware;
+                     //              0      - program should be normally stopped by the firmware;
+                     //              any other value is considered by the firmware as an error code
+                     //              and the program is stopped.
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+    unsigned int addr;
+
+    char str[128];
+
+    ticks++;
+
+    switch(stage)
+    {
+        case SCAN_START:
+            cur_addr = ADDR_FIRST;
+            is_done = FALSE;
+            stage++;
+            if (!Issue())
+            {
+                is_done = TRUE;
+            }
+            return rc;
+
+        case SCAN_WAIT:
+        case BENCH_WAIT:
+            if (!is_done)
+            {
+                return rc;
+            }
+            BARRIER();
+            if (stage == SCAN_WAIT)
+            {
+                for (addr = ADDR_FIRST; addr <= ADDR_LAST; addr++)
+                {
+                    if (found[addr] && !n_found++)
+                    {
+                        bench_addr = addr;
+                    }
+                }
+                cur_proto = 0;
+                stage = (n_found) ? BENCH_START : LOOP_CLEAR_PREV_SCREEN;
+            }
+            else
+            {
+                cur_proto++;
+                stage = (cur_proto < N_PROTOCOLS) ? BENCH_START : LOOP_CLEAR_PREV_SCREEN;
+            }
+            return rc;
+
+        case BENCH_START:
+            cur_n = 0;
+            is_done = FALSE;
+            stage++;
+            bench_stats[cur_proto].t_start = p_ta->hook_table.GetSystemTime(TIMER_UNIT_MICROSECONDS);
+            if (!Issue())
+            {
+                is_done = TRUE;
+            }
+            return rc;
+
+        case LOOP_CLEAR_PREV_SCREEN:
+            p_ta->hook_table.DisplayMsg(p_ta, NULL);  // clear previous Msg output
+            next_action = ticks + 20;
+            stage++;
+            return rc;
+
+        case LOOP_DISP_RESULT:
+            if(ticks >= next_action)  // wait for previous Msg output to be cleared
+            {
+                if (!DisplayPage(p_ta, page, str))
+                {
+                    page = 0;
+                    DisplayPage(p_ta, page, str);
+                }
+                page++;
+                p_ta->hook_table.DisplayMsg(p_ta, str);
+                next_action = ticks + PAGE_MS;
+                stage++;
+            }
+            return rc;
+
+        case LOOP_WAIT_NEXT_ACTION:
+            if(ticks >= next_action)
+            {
+                stage = LOOP_CLEAR_PREV_SCREEN;
+            }
+            return rc;
+    }
+
+    return rc;
+}
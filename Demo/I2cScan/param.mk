@@ -0,0 +1,2 @@
+PROJ = I2CSCAN
+OBJS = I2CSCAN.o
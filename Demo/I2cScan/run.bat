@@ -0,0 +1,2 @@
+@echo off
+..\..\bin\_exec_cmd ..\..\bin run %1
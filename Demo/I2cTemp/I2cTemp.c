@@ -4,8 +4,12 @@
 // Can be run under control of the ROBO TX Controller
 // firmware in download (local) mode.
 // This example shows how to sense the temperature with the I2C temperature
-// sensor DS1631. After writing some initialisation bytes the program enters
-// a loop updating the measured value for the temperature every 1000ms.
+// sensors DS1631 and LM75. The driver (prg_lm75.c) configures the sensors
+// for continuous conversion and reads them at the conversion rate; the
+// program displays the measured values every 1000ms. The alarm of a sensor
+// (above 40 C, released below 10 C) is marked with "!". A sensor which does
+// not answer is shown as "---", and as "offline" while the device layer
+// keeps it off the bus, with the number of failed probes since.
 //
 // Disclaimer - Exclusion of Liability
 //
@@ -16,24 +20,33 @@
 //=============================================================================
 
 #include "ROBO_TX_PRG.h"
+#include "prg_lm75.h"
 
-#define LIGHT_ON        DUTY_MAX
-#define LIGHT_OFF       0
+// Connected sensors, up to LM75_SENSORS_MAX
+static const struct
+{
+    UCHAR8 kind;
+    UCHAR8 devaddr;
+} sensor_list[] =
+{
+    { LM75_KIND_DS1631, 0x4F },
+    { LM75_KIND_LM75,   0x4A }      // not connected in the simulator: offline, probed with back-off
+};
+
+#define N_SENSORS       (sizeof(sensor_list) / sizeof(sensor_list[0]))
+#define LINE_LEN_MAX    32      // longest line of a sensor: "XX: offline, -2147483648 probes\n"
+
+static const LM75_CONFIG sensor_config =
+{
+    /* resolution   */ 12,
+    /* alarm_high   */ TRUE,
+    /* period_ms    */ 0,
+    /* high         */ LM75_C(40),
+    /* low          */ LM75_C(10)
+};
 
 static enum
 {
-    INIT_1,
-    WAIT_1,
-    INIT_2,
-    WAIT_2,
-    INIT_3,
-    WAIT_3,
-    INIT_4,
-    WAIT_4,
-    LOOP_WRITE,
-    LOOP_WRITE_WAIT,
-    LOOP_READ,
-    LOOP_READ_WAIT,
     LOOP_CLEAR_PREV_SCREEN,
     LOOP_DISP_RESULT,
     LOOP_WAIT_NEXT_ACTION
@@ -41,28 +54,9 @@ static enum
 
 unsigned int ticks;
 unsigned int next_action=0;
-UINT16 status=0;
-UINT16 value=0;
 
-/*-----------------------------------------------------------------------------
- * Function Name       : I2cCallback
- *
- * This callback function is called to inform the program about result (status)
- * of execution of any I2c command.
- *-----------------------------------------------------------------------------*/
-static void I2cCallback
-(
-    TA * p_ta_array,
-    I2C_CB * p_data
-)
-{
-    //TA * p_ta = &p_ta_array[TA_LOCAL];
+static LM75 sensors[N_SENSORS];
 
-    status = p_data->status;
-    value  = p_data->value;
-
-    stage++;
-}
 
 /*-----------------------------------------------------------------------------
  * Function Name       : PrgInit
@@ -76,10 +70,15 @@ void PrgInit
     int ta_count        // number of transfer areas in array (equal to TA_COUNT)
 )
 {
-    //TA * p_ta = &p_ta_array[TA_LOCAL];
+    unsigned int idx;
+
+    for (idx = 0; idx < N_SENSORS; idx++)
+    {
+        Lm75Init(&sensors[idx], p_ta_array, sensor_list[idx].kind, sensor_list[idx].devaddr, &sensor_config);
+    }
 
     ticks = 0;
-    stage = INIT_1;
+    stage = LOOP_CLEAR_PREV_SCREEN;
 }
 
 
@@ -101,99 +100,71 @@ int PrgTic
                      //              and the program is stopped.
     TA * p_ta = &p_ta_array[TA_LOCAL];
 
-    char str[64];
-    int fraction=0;
-    unsigned char temp=0;
-    char sign = ' ';
-    
-    ticks++;
-    
-    while(1)
+    char str[LM75_SENSORS_MAX * LINE_LEN_MAX + 1];
+    unsigned int idx, len;
+    INT16 temp;
+    char sign;
+
+    // Complete the finished I2C job and start the next ones
+    I2cJobPoll(p_ta_array);
+    for (idx = 0; idx < N_SENSORS; idx++)
     {
-        switch(stage)
-        {
-            case INIT_1:
-                p_ta->hook_table.I2cWrite (0x4F, 0xAC, 0x02, 0x85, I2cCallback);
-                stage++;
-                return rc;
-
-            case WAIT_1:  
-            case WAIT_2:  
-            case WAIT_3:  
-            case WAIT_4:  
-                // waiting for callback
-                return rc;
-                
-            case INIT_2:    
-                p_ta->hook_table.I2cWrite (0x4F, 0xA1, 0x2800, 0x89, I2cCallback);
-                stage++;    
-                return rc;
-
-            case INIT_3:    
-                p_ta->hook_table.I2cWrite (0x4F, 0xA2, 0x0A00, 0x89, I2cCallback);
-                stage++;
-                return rc;
+        Lm75Tick(&sensors[idx], p_ta_array);
+    }
 
-            case INIT_4:    
-                p_ta->hook_table.I2cWrite (0x4F, 0x00, 0x51, 0x84, I2cCallback);
-                stage++;
-                return rc;
-                
-            case LOOP_WRITE:
-                p_ta->hook_table.I2cWrite (0x4F, 0x00, 0xAA, 0x84, I2cCallback);
-                stage++;
-                return rc;
-                
-            case LOOP_WRITE_WAIT:
-                // waiting for callback    
-                return rc;
-
-            case LOOP_READ:
-                p_ta->hook_table.I2cRead (0x4F, 0x00, 0x88, I2cCallback);
-                stage++;
-                return rc;
-                
-            case LOOP_READ_WAIT:
-                // waiting for callback    
-                return rc;
-                
-            case LOOP_CLEAR_PREV_SCREEN:
-                p_ta->hook_table.DisplayMsg(p_ta, NULL);  // clear previous Msg output
-                next_action = ticks + 20;
-                stage++;
-                return rc;
-                
-            case LOOP_DISP_RESULT:
-                if(ticks >= next_action)  // wait for previous Msg output to be cleared
+    ticks++;
+
+    switch(stage)
+    {
+        case LOOP_CLEAR_PREV_SCREEN:
+            p_ta->hook_table.DisplayMsg(p_ta, NULL);  // clear previous Msg output
+            next_action = ticks + 20;
+            stage++;
+            return rc;
+
+        case LOOP_DISP_RESULT:
+            if(ticks >= next_action)  // wait for previous Msg output to be cleared
+            {
+                len = 0;
+                for (idx = 0; idx < N_SENSORS; idx++)
                 {
-                    if(value & 0x0080) fraction = 5;
-                    else fraction = 0; 
-                    if(value & 0x8000) 
+                    LM75 * p_lm75 = &sensors[idx];
+
+                    if (p_lm75->status == I2C_DEV_OFFLINE)
                     {
-                        sign = '-';
-                        temp = value >> 8;
-                        temp = ~temp;
-                    }    
-                    else 
+                        len += p_ta->hook_table.sprintf(&str[len], "%02X: offline, %d probes\n", p_lm75->devaddr,
+                                                        (int)p_lm75->dev.n_trips - 1);
+                        continue;
+                    }
+                    if (p_lm75->status != I2C_SUCCESS || !p_lm75->n_samples)
                     {
-                        sign = '+';
-                        temp = value >> 8;
-                    }    
-                    p_ta->hook_table.sprintf(str, "Temperature: %c%d,%d C", sign, temp, fraction);
-                    p_ta->hook_table.DisplayMsg(p_ta, str);
-                    next_action = ticks + 1000;
-                    stage++;
-                }
-                return rc;    
-                
-            case LOOP_WAIT_NEXT_ACTION:
-                if(ticks >= next_action)
-                {
-                    stage = LOOP_WRITE;
+                        len += p_ta->hook_table.sprintf(&str[len], "%02X: ---\n", p_lm75->devaddr);
+                        continue;
+                    }
+                    temp = p_lm75->temp;
+                    sign = '+';
+                    if (temp < 0)
+                    {
+                        sign = '-';
+                        temp = -temp;
+                    }
+                    len += p_ta->hook_table.sprintf(&str[len], "%02X: %c%d,%d C%s\n", p_lm75->devaddr,
+                                                    sign, temp / 256, (temp % 256) * 10 / 256,
+                                                    (p_lm75->alarm) ? " !" : "");
                 }
-                return rc;  
-        }
-    }    
+                p_ta->hook_table.DisplayMsg(p_ta, str);
+                next_action = ticks + 1000;
+                stage++;
+            }
+            return rc;
+
+        case LOOP_WAIT_NEXT_ACTION:
+            if(ticks >= next_action)
+            {
+                stage = LOOP_CLEAR_PREV_SCREEN;
+            }
+            return rc;
+    }
 
     return rc;
 }
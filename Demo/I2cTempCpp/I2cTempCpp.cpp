@@ -0,0 +1,182 @@
+//=============================================================================
+// Demo program "I2C temperature sensors, C++ hook objects".
+//
+// Can be run under control of the ROBO TX Controller
+// firmware in download (local) mode.
+// Same as I2cTemp, but written with the objects of prg_hooks.hpp, and the
+// C modules (prg_i2c.c, prg_lm75.c) are called from C++. The program shows
+// the same pop-up messages as I2cTemp: a trace recorded with sim_I2cTemp
+// replays without mismatches with sim_I2cTempCpp.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "ROBO_TX_PRG.h"
+#include "prg_hooks.hpp"
+#include "prg_lm75.h"
+
+// Connected sensors, up to LM75_SENSORS_MAX
+static const struct
+{
+    UCHAR8 kind;
+    UCHAR8 devaddr;
+} sensor_list[] =
+{
+    { LM75_KIND_DS1631, 0x4F },
+    { LM75_KIND_LM75,   0x4A }      // not connected in the simulator: offline, probed with back-off
+};
+
+#define N_SENSORS       (sizeof(sensor_list) / sizeof(sensor_list[0]))
+#define LINE_LEN_MAX    32      // longest line of a sensor: "XX: offline, -2147483648 probes\n"
+
+static const LM75_CONFIG sensor_config =
+{
+    /* resolution   */ 12,
+    /* alarm_high   */ TRUE,
+    /* period_ms    */ 0,
+    /* high         */ LM75_C(40),
+    /* low          */ LM75_C(10)
+};
+
+enum
+{
+    LOOP_CLEAR_PREV_SCREEN,
+    LOOP_DISP_RESULT,
+    LOOP_WAIT_NEXT_ACTION
+};
+
+static int stage;
+static unsigned int ticks;
+static unsigned int next_action;
+
+static LM75 sensors[N_SENSORS];
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FormatSensor
+ *
+ * Appends the line of one sensor to the message, returns its length.
+ *-----------------------------------------------------------------------------*/
+static int FormatSensor
+(
+    const Controller & ctrl,
+    const LM75 & sensor,
+    char * p_str
+)
+{
+    INT16 temp = sensor.temp;
+    char sign = '+';
+
+    if (sensor.status == I2C_DEV_OFFLINE)
+    {
+        return ctrl.Ta()->hook_table.sprintf(p_str, "%02X: offline, %d probes\n", sensor.devaddr,
+                                             (int)sensor.dev.n_trips - 1);
+    }
+    if (sensor.status != I2C_SUCCESS || !sensor.n_samples)
+    {
+        return ctrl.Ta()->hook_table.sprintf(p_str, "%02X: ---\n", sensor.devaddr);
+    }
+    if (temp < 0)
+    {
+        sign = '-';
+        temp = -temp;
+    }
+    return ctrl.Ta()->hook_table.sprintf(p_str, "%02X: %c%d,%d C%s\n", sensor.devaddr,
+                                         sign, temp / 256, (temp % 256) * 10 / 256,
+                                         (sensor.alarm) ? " !" : "");
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PrgInit
+ *
+ * This it the program initialization.
+ * It is called once.
+ *-----------------------------------------------------------------------------*/
+void PrgInit
+(
+    TA * p_ta_array,    // pointer to the array of transfer areas
+    int ta_count        // number of transfer areas in array (equal to TA_COUNT)
+)
+{
+    unsigned int idx;
+
+    for (idx = 0; idx < N_SENSORS; idx++)
+    {
+        Lm75Init(&sensors[idx], p_ta_array, sensor_list[idx].kind, sensor_list[idx].devaddr, &sensor_config);
+    }
+
+    ticks = 0;
+    next_action = 0;
+    stage = LOOP_CLEAR_PREV_SCREEN;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PrgTic
+ *
+ * This is the main function of this program.
+ * It is called every tic (1 ms) realtime.
+ *-----------------------------------------------------------------------------*/
+int PrgTic
+(
+    TA * p_ta_array,    // pointer to the array of transfer areas
+    int ta_count        // number of transfer areas in array (equal to TA_COUNT)
+)
+{
+    int rc = 0x7FFF; // return code: 0x7FFF - program should be further called by the firmware;
+                     //              0      - program should be normally stopped by the firmware;
+                     //              any other value is considered by the firmware as an error code
+                     //              and the program is stopped.
+    Controller ctrl(p_ta_array);
+    Display display(p_ta_array);
+
+    char str[LM75_SENSORS_MAX * LINE_LEN_MAX + 1];
+    unsigned int idx, len;
+
+    // Complete the finished I2C job and start the next ones
+    I2cJobPoll(p_ta_array);
+    for (idx = 0; idx < N_SENSORS; idx++)
+    {
+        Lm75Tick(&sensors[idx], p_ta_array);
+    }
+
+    ticks++;
+
+    switch(stage)
+    {
+        case LOOP_CLEAR_PREV_SCREEN:
+            display.Clear();  // clear previous Msg output
+            next_action = ticks + 20;
+            stage++;
+            return rc;
+
+        case LOOP_DISP_RESULT:
+            if(ticks >= next_action)  // wait for previous Msg output to be cleared
+            {
+                len = 0;
+                for (idx = 0; idx < N_SENSORS; idx++)
+                {
+                    len += FormatSensor(ctrl, sensors[idx], &str[len]);
+                }
+                display.Show(str);
+                next_action = ticks + 1000;
+                stage++;
+            }
+            return rc;
+
+        case LOOP_WAIT_NEXT_ACTION:
+            if(ticks >= next_action)
+            {
+                stage = LOOP_CLEAR_PREV_SCREEN;
+            }
+            return rc;
+    }
+
+    return rc;
+}
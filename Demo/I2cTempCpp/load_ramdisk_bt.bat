@@ -0,0 +1,2 @@
+@echo off
+call load_ramdisk.bat COM14
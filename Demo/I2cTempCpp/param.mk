@@ -0,0 +1,2 @@
+PROJ = I2cTempCpp
+OBJS = I2cTempCpp.o
@@ -4,8 +4,13 @@
 // Can be run under control of the ROBO TX Controller
 // firmware in download (local) mode.
 // This example shows how to sense the temperature sensor array (thermopile) of
-// the I2C thermopile sensor TPA81. After some initialisation the program enters
-// a loop updating the measured values for the sensors every 1000ms.
+// the I2C thermopile sensor TPA81. The driver (prg_tpa81.c) reads the sensor
+// every 100ms and tracks the hot spot; the program displays the measured
+// values every 1000ms. While the button connected to the input I8 is pressed,
+// the driver sweeps the servo of the TPA81 and displays the hot spot of the
+// panorama. The hot spot is searched after each sweep by a job of the work
+// queue (prg_work.c), which runs in the rest of each tick and is continued in
+// the next tick when the firmware needs the processor.
 //
 // Disclaimer - Exclusion of Liability
 //
@@ -16,32 +21,14 @@
 //=============================================================================
 
 #include "ROBO_TX_PRG.h"
+#include "prg_tpa81.h"
+#include "prg_work.h"
 
-#define LIGHT_ON        DUTY_MAX
-#define LIGHT_OFF       0
+#define BUTTON_NUMBER   8
+#define BUTTON_IDX      (BUTTON_NUMBER - 1)
 
 static enum
 {
-    INIT_1,
-    WAIT_1,
-    LOOP_READ_AMB,
-    LOOP_READ_AMB_WAIT,
-    LOOP_READ_P1,
-    LOOP_READ_P1_WAIT,
-    LOOP_READ_P2,
-    LOOP_READ_P2_WAIT,
-    LOOP_READ_P3,
-    LOOP_READ_P3_WAIT,
-    LOOP_READ_P4,
-    LOOP_READ_P4_WAIT,
-    LOOP_READ_P5,
-    LOOP_READ_P5_WAIT,
-    LOOP_READ_P6,
-    LOOP_READ_P6_WAIT,
-    LOOP_READ_P7,
-    LOOP_READ_P7_WAIT,
-    LOOP_READ_P8,
-    LOOP_READ_P8_WAIT,
     LOOP_CLEAR_PREV_SCREEN,
     LOOP_DISP_RESULT,
     LOOP_WAIT_NEXT_ACTION
@@ -49,40 +36,9 @@ static enum
 
 unsigned int ticks;
 unsigned int next_action=0;
-UINT16 status=0;
-UINT16 value=0;
-unsigned char amb=0;
-unsigned char p[8]={0,0,0,0,0,0,0,0};
-unsigned char pidx=255;
 
-/*-----------------------------------------------------------------------------
- * Function Name       : I2cCallback
- *
- * This callback function is called to inform the program about result (status)
- * of execution of any I2c command.
- *-----------------------------------------------------------------------------*/
-static void I2cCallback
-(
-    TA * p_ta_array,
-    I2C_CB * p_data
-)
-{
-    //TA * p_ta = &p_ta_array[TA_LOCAL];
+static TPA81 tpa;
 
-    status = p_data->status;
-    value  = p_data->value;
-    
-    if(pidx == 128)
-    {
-        amb = (unsigned char)value;
-    }
-    else if(pidx != 255)
-    {
-        p[pidx] = (unsigned char)value;
-    }    
-
-    stage++;
-}
 
 /*-----------------------------------------------------------------------------
  * Function Name       : PrgInit
@@ -96,10 +52,17 @@ void PrgInit
     int ta_count        // number of transfer areas in array (equal to TA_COUNT)
 )
 {
-    //TA * p_ta = &p_ta_array[TA_LOCAL];
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+
+    // Configure button input to "Digital 5 kOhm" mode
+    p_ta->config.uni[BUTTON_IDX].mode = MODE_R;
+    p_ta->config.uni[BUTTON_IDX].digital = TRUE;
+    p_ta->state.config_id += 1;
+
+    Tpa81Init(&tpa, p_ta_array, TPA81_ADDR, TPA81_PERIOD_MS, TPA81_FILTER_SHIFT);
 
     ticks = 0;
-    stage = INIT_1;
+    stage = LOOP_CLEAR_PREV_SCREEN;
 }
 
 
@@ -121,114 +84,67 @@ int PrgTic
                      //              and the program is stopped.
     TA * p_ta = &p_ta_array[TA_LOCAL];
 
-    char str[64];
-    
+    char str[128];
+    const TPA81_HOTSPOT * p_hot;
+
+    // Complete the finished I2C job and start the next reading of the sensor
+    I2cJobPoll(p_ta_array);
+    Tpa81SetSweep(&tpa, p_ta->input.uni[BUTTON_IDX]);
+    Tpa81Tick(&tpa, p_ta_array);
+
     ticks++;
-    
-    while(1)
+
+    switch(stage)
     {
-        switch(stage)
-        {
-            case INIT_1:
-                p_ta->hook_table.I2cRead (0x68, 0x00, 0xA5, I2cCallback);
-                stage++;
-                return rc;
-
-            case WAIT_1:  
-                // waiting for callback
-                return rc;
-                
-            case LOOP_READ_AMB:    
-                p_ta->hook_table.I2cRead (0x68, 0x01, 0xA5, I2cCallback);
-                pidx = 128;
-                stage++;    
-                return rc;
-
-            case LOOP_READ_P1:    
-                p_ta->hook_table.I2cRead (0x68, 0x02, 0xA5, I2cCallback);
-                pidx = 0;
-                stage++;    
-                return rc;
-
-            case LOOP_READ_P2:    
-                p_ta->hook_table.I2cRead (0x68, 0x03, 0xA5, I2cCallback);
-                pidx = 1;
-                stage++;    
-                return rc;
-
-            case LOOP_READ_P3:    
-                p_ta->hook_table.I2cRead (0x68, 0x04, 0xA5, I2cCallback);
-                pidx = 2;
-                stage++;    
-                return rc;
-
-            case LOOP_READ_P4:    
-                p_ta->hook_table.I2cRead (0x68, 0x05, 0xA5, I2cCallback);
-                pidx = 3;
-                stage++;    
-                return rc;
-
-            case LOOP_READ_P5:    
-                p_ta->hook_table.I2cRead (0x68, 0x06, 0xA5, I2cCallback);
-                pidx = 4;
-                stage++;    
-                return rc;
-
-            case LOOP_READ_P6:    
-                p_ta->hook_table.I2cRead (0x68, 0x07, 0xA5, I2cCallback);
-                pidx = 5;
-                stage++;    
-                return rc;
-
-            case LOOP_READ_P7:    
-                p_ta->hook_table.I2cRead (0x68, 0x08, 0xA5, I2cCallback);
-                pidx = 6;
-                stage++;    
-                return rc;
-
-            case LOOP_READ_P8:    
-                p_ta->hook_table.I2cRead (0x68, 0x09, 0xA5, I2cCallback);
-                pidx = 7;
-                stage++;    
-                return rc;
-
-            case LOOP_READ_AMB_WAIT:    
-            case LOOP_READ_P1_WAIT:    
-            case LOOP_READ_P2_WAIT:    
-            case LOOP_READ_P3_WAIT:    
-            case LOOP_READ_P4_WAIT:    
-            case LOOP_READ_P5_WAIT:    
-            case LOOP_READ_P6_WAIT:    
-            case LOOP_READ_P7_WAIT:    
-            case LOOP_READ_P8_WAIT:    
-                // waiting for callback
-                return rc;
-
-            case LOOP_CLEAR_PREV_SCREEN:
-                p_ta->hook_table.DisplayMsg(p_ta, NULL);  // clear previous Msg output
-                next_action = ticks + 20;
-                stage++;
-                return rc;
-                
-            case LOOP_DISP_RESULT:
-                if(ticks >= next_action)  // wait for previous Msg output to be cleared
+        case LOOP_CLEAR_PREV_SCREEN:
+            p_ta->hook_table.DisplayMsg(p_ta, NULL);  // clear previous Msg output
+            next_action = ticks + 20;
+            stage++;
+            break;
+
+        case LOOP_DISP_RESULT:
+            if(ticks >= next_action)  // wait for previous Msg output to be cleared
+            {
+                if(tpa.status != I2C_SUCCESS)
+                {
+                    p_ta->hook_table.sprintf(str, "TPA81: I2C error %d\n%d readings, %d errors",
+                                                  tpa.status, tpa.n_frames, tpa.n_errors);
+                }
+                else if(tpa.sweep)
                 {
-                    p_ta->hook_table.sprintf(str, "Amb.Temp.: %d C\n%d, %d, %d, %d\n%d, %d, %d, %d", 
-                                                  amb, p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7]);
-                    p_ta->hook_table.DisplayMsg(p_ta, str);
-                    next_action = ticks + 1000;
-                    stage++;
+                    p_hot = &tpa.map_hot;
+                    p_ta->hook_table.sprintf(str, "Sweep %d, pos. %d\nHot spot: %d C\nat %d/256, %d/256\n"
+                                                  "Search %d: %d ticks",
+                                                  tpa.n_sweeps, tpa.servo_pos, TPA81_FIX_TO_C(p_hot->temp),
+                                                  p_hot->col, p_hot->row, tpa.n_searches, tpa.search_ticks);
                 }
-                return rc;    
-                
-            case LOOP_WAIT_NEXT_ACTION:
-                if(ticks >= next_action)
+                else
                 {
-                    stage = LOOP_READ_AMB;
+                    p_hot = &tpa.hot;
+                    p_ta->hook_table.sprintf(str, "Amb.Temp.: %d C\n%d, %d, %d, %d\n%d, %d, %d, %d\nHot: %d C at %d/256",
+                                                  tpa.ambient,
+                                                  TPA81_FIX_TO_C(tpa.pixel[0]), TPA81_FIX_TO_C(tpa.pixel[1]),
+                                                  TPA81_FIX_TO_C(tpa.pixel[2]), TPA81_FIX_TO_C(tpa.pixel[3]),
+                                                  TPA81_FIX_TO_C(tpa.pixel[4]), TPA81_FIX_TO_C(tpa.pixel[5]),
+                                                  TPA81_FIX_TO_C(tpa.pixel[6]), TPA81_FIX_TO_C(tpa.pixel[7]),
+                                                  TPA81_FIX_TO_C(p_hot->temp), p_hot->row);
                 }
-                return rc;  
-        }
-    }    
+                p_ta->hook_table.DisplayMsg(p_ta, str);
+                next_action = ticks + 1000;
+                stage++;
+            }
+            break;
+
+        case LOOP_WAIT_NEXT_ACTION:
+            if(ticks >= next_action)
+            {
+                stage = LOOP_CLEAR_PREV_SCREEN;
+            }
+            break;
+    }
+
+    // Search of the hot spot in the rest of the tick
+    WorkRun(p_ta_array, 0);
 
     return rc;
 }
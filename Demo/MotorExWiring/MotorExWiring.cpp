@@ -0,0 +1,97 @@
+//=============================================================================
+// Demo program "Extended motor control mode with two motors, C++ wiring".
+//
+// Can be run under control of the ROBO TX Controller
+// firmware in download (local) mode.
+// Same as MotorEx_2M_Master, but the wiring of the model is described
+// with the types of prg_wiring.hpp, so all Transfer Area indexes and PWM
+// channels are resolved and checked at compile time.
+// Continuously starts two synchronized motors with changing rotation directions.
+// Motors are connected to outputs M1 and M2. Pulses from the motors are
+// calculated by the counters C1 and C2. The motors are stopped and rotation
+// direction is changed after both counters reach the value of 200.
+// The lamp connected to output O1 of Extension 1 shows the direction.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "ROBO_TX_PRG.h"
+#include "prg_wiring.hpp"
+
+#define DISTANCE    200
+
+// Wiring of the model
+typedef EncoderMotor<TA_LOCAL, 1>                   MasterMotor;
+typedef EncoderMotor<TA_LOCAL, 2>                   SlaveMotor;
+typedef Output<TA_EXT_1, 1>                         DirectionLamp;
+typedef Wiring<MasterMotor, SlaveMotor, DirectionLamp>  Model;
+
+static BOOL32 rotation_direction;
+static BOOL32 prev_rotation_direction;
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PrgInit
+ *
+ * This it the program initialization.
+ * It is called once.
+ *-----------------------------------------------------------------------------*/
+void PrgInit
+(
+    TA * p_ta_array,    // pointer to the array of transfer areas
+    int ta_count        // number of transfer areas in array (equal to TA_COUNT)
+)
+{
+    // Configure the outputs and inform firmware that configuration was changed
+    Model::Configure(p_ta_array);
+
+    rotation_direction = FALSE;
+    prev_rotation_direction = !rotation_direction;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PrgTic
+ *
+ * This is the main function of this program.
+ * It is called every tic (1 ms) realtime.
+ *-----------------------------------------------------------------------------*/
+int PrgTic
+(
+    TA * p_ta_array,    // pointer to the array of transfer areas
+    int ta_count        // number of transfer areas in array (equal to TA_COUNT)
+)
+{
+    int rc = 0x7FFF; // return code: 0x7FFF - program should be further called by the firmware;
+                     //              0      - program should be normally stopped by the firmware;
+                     //              any other value is considered by the firmware as an error code
+                     //              and the program is stopped.
+
+    if (rotation_direction != prev_rotation_direction)
+    {
+        INT16 duty = (rotation_direction) ? DUTY_MAX : -DUTY_MAX;
+
+        // Link slave motor to master motor
+        SlaveMotor::Follow<MasterMotor>(p_ta_array);
+
+        // Both motors should run until their counters reach DISTANCE
+        MasterMotor::Move(p_ta_array, duty, DISTANCE);
+        SlaveMotor::Move(p_ta_array, duty, DISTANCE);
+
+        DirectionLamp::Set(p_ta_array, (rotation_direction) ? DUTY_MAX : 0);
+
+        prev_rotation_direction = rotation_direction;
+    }
+
+    if (MasterMotor::IsPosReached(p_ta_array) && SlaveMotor::IsPosReached(p_ta_array))
+    {
+        rotation_direction = !rotation_direction;
+    }
+
+    return rc;
+}
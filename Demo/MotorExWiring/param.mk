@@ -0,0 +1,2 @@
+PROJ = MotorExWiring
+OBJS = MotorExWiring.o
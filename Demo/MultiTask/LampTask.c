@@ -0,0 +1,95 @@
+//=============================================================================
+// Lamp task of the demo program "Multi task".
+// The lamp, connected to the output O8, blinks depending on the distance
+// to the ultrasonic sensor, connected to the input I1 (the same as in the
+// demo program "Warning light"). The task is called every 10 ms.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "ROBO_TX_PRG.h"
+#include "MultiTask.h"
+
+#define LIGHT_ON    DUTY_MAX
+#define LIGHT_OFF   0
+
+#define LAMP_IDX    7
+#define SENSOR_IDX  0
+
+static bool is_light_on;
+static UINT32 ticks;        // number of 10 ms ticks since the last change of the lamp
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : LampInit
+ *-----------------------------------------------------------------------------*/
+static void LampInit
+(
+    TA * p_ta_array,
+    int ta_count
+)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+
+    // Configure input I1 to "Ultrasonic sensor" mode
+    p_ta->config.uni[SENSOR_IDX].mode = MODE_ULTRASONIC;
+
+    // Inform firmware that configuration was changed
+    p_ta->state.config_id += 1;
+
+    is_light_on = FALSE;
+    ticks = 0;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : LampTick
+ *-----------------------------------------------------------------------------*/
+static int LampTick
+(
+    TA * p_ta_array,
+    int ta_count
+)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+    INT16 distance = p_ta->input.uni[SENSOR_IDX];
+    UINT32 interval;
+
+    // Set flash interval (in 10 ms ticks) dependent on distance
+    interval = (distance > 20) ? 0  :           // no interval, light is always off
+               (distance > 15) ? 75 :           // interval 750 ms
+               (distance > 10) ? 50 :           // interval 500 ms
+               (distance > 5)  ? 25 : 10;       // interval 250 ms or 100 ms
+
+    if (interval == 0)
+    {
+        is_light_on = FALSE;
+        ticks = 0;
+    }
+    else if (++ticks >= interval)
+    {
+        is_light_on = !is_light_on;
+        ticks = 0;
+    }
+
+    // Switch the lamp on/off
+    p_ta->output.duty[LAMP_IDX] = (is_light_on) ? LIGHT_ON : LIGHT_OFF;
+    return TASK_RC_RUN;
+}
+
+
+TASK lamp_task =
+{
+    /* name         */ "Lamp",
+    /* Init         */ LampInit,
+    /* Tick         */ LampTick,
+    /* priority     */ TASK_PRIO_NORMAL,
+    /* reserved     */ 0,
+    /* period_ms    */ 10,
+    /* phase_ms     */ 5
+};
@@ -0,0 +1,98 @@
+//=============================================================================
+// Motor task of the demo program "Multi task".
+// Runs the motor, connected to the outputs M1, until the counter C1
+// reaches the value of 1000, then the task is finished.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "ROBO_TX_PRG.h"
+#include "MultiTask.h"
+
+#define MOTOR_NUMBER    1
+#define MOTOR_IDX       (MOTOR_NUMBER - 1)
+
+#define MOTOR_DISTANCE  1000
+
+static enum {RESET_COUNTER, RUN, OFF} stage;
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : MotorInit
+ *-----------------------------------------------------------------------------*/
+static void MotorInit
+(
+    TA * p_ta_array,
+    int ta_count
+)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+
+    // Configure motor output to be used as a motor output
+    p_ta->config.motor[MOTOR_IDX] = TRUE;
+
+    // Inform firmware that configuration was changed
+    p_ta->state.config_id += 1;
+
+    // Reset counter
+    p_ta->input.cnt_resetted[MOTOR_IDX] = FALSE;
+    p_ta->output.cnt_reset_cmd_id[MOTOR_IDX]++;
+
+    stage = RESET_COUNTER;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : MotorTick
+ *-----------------------------------------------------------------------------*/
+static int MotorTick
+(
+    TA * p_ta_array,
+    int ta_count
+)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+
+    switch (stage)
+    {
+        case RESET_COUNTER:
+            if (p_ta->input.cnt_resetted[MOTOR_IDX]) // wait until counter is resetted
+            {
+                // Switch motor on
+                p_ta->output.duty[2 * MOTOR_IDX + 0] = DUTY_MAX;
+                p_ta->output.duty[2 * MOTOR_IDX + 1] = 0;
+                stage = RUN;
+            }
+            break;
+
+        case RUN:
+            if (p_ta->input.counter[MOTOR_IDX] >= MOTOR_DISTANCE)
+            {
+                // Switch motor off
+                p_ta->output.duty[2 * MOTOR_IDX + 0] = 0;
+                stage = OFF;
+            }
+            break;
+
+        case OFF:
+            return TASK_RC_DONE;
+    }
+    return TASK_RC_RUN;
+}
+
+
+TASK motor_task =
+{
+    /* name         */ "Motor",
+    /* Init         */ MotorInit,
+    /* Tick         */ MotorTick,
+    /* priority     */ TASK_PRIO_HIGH,
+    /* reserved     */ 0,
+    /* period_ms    */ 1,
+    /* phase_ms     */ 0
+};
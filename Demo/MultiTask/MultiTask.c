@@ -0,0 +1,61 @@
+//=============================================================================
+// Demo program "Multi task".
+//
+// Can be run under control of the ROBO TX Controller
+// firmware in download (local) mode.
+// Composes the program of two independent tasks by means of the task
+// registry: the motor task runs the motor, connected to the outputs M1,
+// until the counter C1 reaches the value of 1000; the lamp task lets the
+// lamp, connected to the output O8, blink depending on the distance to the
+// ultrasonic sensor, connected to the input I1.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "ROBO_TX_PRG.h"
+#include "MultiTask.h"
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PrgInit
+ *
+ * This it the program initialization.
+ * It is called once.
+ *-----------------------------------------------------------------------------*/
+void PrgInit
+(
+    TA * p_ta_array,    // pointer to the array of transfer areas
+    int ta_count        // number of transfer areas in array (equal to TA_COUNT)
+)
+{
+    TaskReset();
+    TaskRegister(&motor_task);
+    TaskRegister(&lamp_task);
+
+    TaskStart(p_ta_array, ta_count);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PrgTic
+ *
+ * This is the main function of this program.
+ * It is called every tic (1 ms) realtime.
+ *-----------------------------------------------------------------------------*/
+int PrgTic
+(
+    TA * p_ta_array,    // pointer to the array of transfer areas
+    int ta_count        // number of transfer areas in array (equal to TA_COUNT)
+)
+{
+    // return code: 0x7FFF - program should be further called by the firmware;
+    //              0      - program should be normally stopped by the firmware
+    //                       (all tasks are finished);
+    //              any other value is an error code of a task
+    return TaskTickAll(p_ta_array, ta_count);
+}
@@ -0,0 +1,26 @@
+//=============================================================================
+// Header file of the demo program "Multi task".
+// Tasks of the program, each one defined in its own module.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __MULTI_TASK_H__
+#define __MULTI_TASK_H__
+
+#include "prg_task.h"
+
+// Motor M1 runs until the counter C1 reaches 1000 (period 1 ms), see MotorTask.c
+extern TASK motor_task;
+
+// Lamp O8 blinks depending on the distance to the ultrasonic sensor I1
+// (period 10 ms), see LampTask.c
+extern TASK lamp_task;
+
+
+#endif // __MULTI_TASK_H__
@@ -0,0 +1,2 @@
+@echo off
+..\..\bin\_load_flash ..\..\bin %1
@@ -0,0 +1,2 @@
+PROJ = MultiTask
+OBJS = MultiTask.o MotorTask.o LampTask.o
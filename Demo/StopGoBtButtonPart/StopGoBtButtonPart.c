@@ -8,6 +8,11 @@
 // the input I8. Pulses from the motor are calculated by the
 // counter C1 on other ROBO TX Controller. The motor is
 // stopped after the counter reaches the value of 1000.
+// The time of the other ROBO TX Controller is the shared
+// time (prg_tsync.h). A start of the motor is scheduled
+// START_LEAD_MS ahead on the shared time, and the lamp
+// connected to output O1 is switched on in the same tick,
+// independent of the Bluetooth latency.
 //
 // Disclaimer - Exclusion of Liability
 //
@@ -18,10 +23,17 @@
 //=============================================================================
 
 #include "ROBO_TX_PRG.h"
+#include "prg_mbox.h"
+#include "prg_string.h"
+#include "prg_tsync.h"
 
 #define MOTOR_NUMBER    1
 #define BUTTON_NUMBER   8
 #define BUTTON_IDX      (BUTTON_NUMBER - 1)
+#define LAMP_NUMBER     1
+#define LAMP_IDX        (LAMP_NUMBER - 1)
+
+#define START_LEAD_MS   100     // time between the button press and the start of the motor
 
 #define BT_CHANNEL      1
 
@@ -49,12 +61,18 @@ static CHAR8 receive_command_status;
 static bool was_receive;
 static char str[128];
 
+static TSYNC tsync;             // follower, the other ROBO TX Controller is the reference
+static INT16 duty_req;          // requested motor duty
+static BOOL32 is_timed;         // duty_req is applied at start_at
+static UINT32 start_at;         // shared time
+
 
 /*-----------------------------------------------------------------------------
  * Function Name       : BtCallback
  *
  * This callback function is called to inform the program about result (status)
  * of execution of any Bluetooth command except BtStartReceive command.
+ * It is called from PrgTic via the callback mailbox.
  *-----------------------------------------------------------------------------*/
 static void BtCallback
 (
@@ -71,7 +89,7 @@ static void BtCallback
  *
  * This callback function is called to inform the program about result (status)
  * of execution of BtStartReceive command. It is also called when a message
- * arrives via Bluetooth.
+ * arrives via Bluetooth. It is called from PrgTic via the callback mailbox.
  *-----------------------------------------------------------------------------*/
 static void BtReceiveCallback
 (
@@ -87,14 +105,19 @@ static void BtReceiveCallback
         UCHAR8 counter;
 
         // Format of a received message should be:
-        // byte 0  : counter number(1...N_CNT)
-        // byte 1-2: counter value(0...0xFFFF)
+        // byte 0   : counter number(1...N_CNT)
+        // byte 1-2 : counter value(0...0xFFFF)
+        // byte 3-14: time stamp of the reply (TsyncPutReply)
         counter = p_data->msg[0];
         if (counter >= 1 && counter <= N_CNT)
         {
-            p_ta->hook_table.memcpy(&remote_counter_value, &p_data->msg[1],
+            PrgMemcpy(p_ta, &remote_counter_value, &p_data->msg[1],
                 sizeof(remote_counter_value));
         }
+        if (p_data->msg_len >= 3 + TSYNC_RSP_LEN)
+        {
+            TsyncHandleReply(&tsync, &p_data->msg[3], MboxGetMsgTime());
+        }
     }
     else
     {
@@ -103,6 +126,15 @@ static void BtReceiveCallback
 }
 
 
+// Program callbacks of the callback mailbox
+static const MBOX_HANDLERS mbox_handlers =
+{
+    /* bt       */ BtCallback,
+    /* bt_recv  */ BtReceiveCallback,
+    /* i2c      */ NULL
+};
+
+
 /*-----------------------------------------------------------------------------
  * Function Name       : PrgInit
  *
@@ -130,11 +162,15 @@ void PrgInit
 
     remote_counter_value = 0;
 
+    duty_req = 0;
+    is_timed = FALSE;
+    TsyncInit(&tsync, FALSE);
+
     // Connect to the controller with bt_address via Bluetooth channel BT_CHANNEL
     stage = CONNECT;
     command = CMD_CONNECT;
     command_status = -1;
-    p_ta->hook_table.BtConnect(BT_CHANNEL, bt_address, BtCallback);
+    p_ta->hook_table.BtConnect(BT_CHANNEL, bt_address, MboxBtCallback);
 }
 
 
@@ -155,6 +191,14 @@ int PrgTic
                      //              any other value is considered by the firmware as an error code
                      //              and the program is stopped.
     TA * p_ta = &p_ta_array[TA_LOCAL];
+    UINT32 now_us = p_ta->hook_table.GetSystemTime(TIMER_UNIT_MICROSECONDS);
+
+    // Handle the results of the Bluetooth commands and the received messages
+    MboxDrain(p_ta_array, &mbox_handlers, 0);
+
+    // The lamp is switched on in the tick the other ROBO TX Controller starts the motor
+    p_ta->output.duty[LAMP_IDX] = (duty_req && (!is_timed || TsyncIsDue(&tsync, now_us, start_at))) ?
+        DUTY_MAX : 0;
 
     switch (stage)
     {
@@ -174,7 +218,7 @@ int PrgTic
                         // Start receive from Bluetooth channel BT_CHANNEL
                         command = CMD_START_RECEIVE;
                         receive_command_status = -1;
-                        p_ta->hook_table.BtStartReceive(BT_CHANNEL, BtReceiveCallback);
+                        p_ta->hook_table.BtStartReceive(BT_CHANNEL, MboxBtReceiveCallback);
                     }
                     timer = 0;
                 }
@@ -239,7 +283,7 @@ int PrgTic
                 }
                 else
                 {
-                    UCHAR8 msg[3];
+                    UCHAR8 msg[8 + TSYNC_REQ_LEN];
                     INT16 duty;
 
                     was_receive = FALSE;
@@ -279,15 +323,28 @@ int PrgTic
                         }
                     }
 
+                    // A start is scheduled START_LEAD_MS ahead on the shared time,
+                    // a stop is executed at once
+                    if (duty != duty_req)
+                    {
+                        is_timed = (duty && TsyncIsSynced(&tsync)) ? TRUE : FALSE;
+                        start_at = TsyncLocalToShared(&tsync, now_us) + START_LEAD_MS * 1000;
+                        duty_req = duty;
+                    }
+
                     // Prepare BT message
                     msg[0] = MOTOR_NUMBER;                                 // motor number
-                    p_ta->hook_table.memcpy(&msg[1], &duty, sizeof(duty)); // motor duty
+                    PrgMemcpy(p_ta, &msg[1], &duty, sizeof(duty)); // motor duty
+                    msg[3] = (UCHAR8)is_timed;                             // duty is applied at start_at
+                    PrgMemcpy(p_ta, &msg[4], &start_at, 4);               // shared time
+                    TsyncPutRequest(&tsync, p_ta->hook_table.GetSystemTime(TIMER_UNIT_MICROSECONDS),
+                        &msg[8]);                                          // time stamp of the request
 
                     // Send BT message
                     stage = (stage != PAUSE_3) ? SEND_REQUEST : stage;
                     command = CMD_SEND;
                     command_status = -1;
-                    p_ta->hook_table.BtSend(BT_CHANNEL, sizeof(msg), msg, BtCallback);
+                    p_ta->hook_table.BtSend(BT_CHANNEL, sizeof(msg), msg, MboxBtCallback);
                 }
             }
             break;
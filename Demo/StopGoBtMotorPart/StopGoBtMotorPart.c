@@ -8,6 +8,11 @@
 // ROBO TX Controller. Pulses from the motor are calculated
 // by the counter C1. The motor is stopped after the counter
 // reaches the value of 1000.
+// The time of this ROBO TX Controller is the shared time
+// (prg_tsync.h); the replies carry the time stamps the other
+// ROBO TX Controller synchronizes its time with. A start of
+// the motor requested for a shared time is executed in that
+// tick.
 //
 // Disclaimer - Exclusion of Liability
 //
@@ -18,6 +23,9 @@
 //=============================================================================
 
 #include "ROBO_TX_PRG.h"
+#include "prg_mbox.h"
+#include "prg_string.h"
+#include "prg_tsync.h"
 
 #define MOTOR_NUMBER    1
 #define MOTOR_IDX       (MOTOR_NUMBER - 1)
@@ -44,12 +52,19 @@ static enum bt_commands_e command;
 static CHAR8 command_status;
 static CHAR8 receive_command_status;
 
+static TSYNC tsync;             // reference
+static BOOL32 is_pending;       // pending_duty is applied at pending_at
+static UCHAR8 pending_chan;      // PWM channel of the motor
+static INT16 pending_duty;
+static UINT32 pending_at;       // shared time
+
 
 /*-----------------------------------------------------------------------------
  * Function Name       : BtCallback
  *
  * This callback function is called to inform the program about result (status)
  * of execution of any Bluetooth command except BtStartReceive command.
+ * It is called from PrgTic via the callback mailbox.
  *-----------------------------------------------------------------------------*/
 static void BtCallback
 (
@@ -66,7 +81,7 @@ static void BtCallback
  *
  * This callback function is called to inform the program about result (status)
  * of execution of BtStartReceive command. It is also called when a message
- * arrives via Bluetooth.
+ * arrives via Bluetooth. It is called from PrgTic via the callback mailbox.
  *-----------------------------------------------------------------------------*/
 static void BtReceiveCallback
 (
@@ -80,31 +95,54 @@ static void BtReceiveCallback
         UCHAR8 motor;
         UCHAR8 pwm_chan;
         INT16 duty;
-        UCHAR8 msg[3];
+        UCHAR8 msg[3 + TSYNC_RSP_LEN];
+        UINT32 msg_len = 3;
         INT16 counter;
 
         // Format of a received message should be:
         // byte 0  : motor number(1...N_MOTOR)
         // byte 1-2: motor duty(DUTY_MIN...DUTY_MAX)
+        // optional:
+        // byte 3  : 1 - duty is applied at the shared time of bytes 4-7, 0 - at once
+        // byte 4-7: shared time
+        // byte 8-11: time stamp of the request (TsyncPutRequest)
         motor = p_data->msg[0];
         if (motor >= 1 && motor <= N_MOTOR)
         {
             pwm_chan = (motor - 1) * 2;
-            p_ta->hook_table.memcpy(&duty, &p_data->msg[1], sizeof(duty));
+            PrgMemcpy(p_ta, &duty, &p_data->msg[1], sizeof(duty));
             if (duty >= DUTY_MIN && duty <= DUTY_MAX)
             {
-                p_ta->output.duty[pwm_chan] = duty;
-                p_ta->output.duty[pwm_chan + 1] = 0;
+                is_pending = FALSE;
+                if (p_data->msg_len >= 8 && p_data->msg[3])
+                {
+                    is_pending = TRUE;
+                    pending_chan = pwm_chan;
+                    pending_duty = duty;
+                    pending_at = 0;
+                    PrgMemcpy(p_ta, &pending_at, &p_data->msg[4], 4);
+                }
+                else
+                {
+                    p_ta->output.duty[pwm_chan] = duty;
+                    p_ta->output.duty[pwm_chan + 1] = 0;
+                }
             }
 
             // Prepare reply BT message
             msg[0] = motor;                                              // counter number
             counter = p_ta->input.counter[motor - 1];
-            p_ta->hook_table.memcpy(&msg[1], &counter, sizeof(counter)); // counter value
+            PrgMemcpy(p_ta, &msg[1], &counter, sizeof(counter)); // counter value
+            if (p_data->msg_len >= 8 + TSYNC_REQ_LEN)
+            {
+                // Time stamp of the reply
+                msg_len += TsyncPutReply(&tsync, &p_data->msg[8], MboxGetMsgTime(),
+                    p_ta->hook_table.GetSystemTime(TIMER_UNIT_MICROSECONDS), &msg[3]);
+            }
 
             // Send BT message
             command_status = -1;
-            p_ta->hook_table.BtSend(BT_CHANNEL, sizeof(msg), msg, BtCallback);
+            p_ta->hook_table.BtSend(BT_CHANNEL, msg_len, msg, MboxBtCallback);
         }
     }
     else
@@ -114,6 +152,15 @@ static void BtReceiveCallback
 }
 
 
+// Program callbacks of the callback mailbox
+static const MBOX_HANDLERS mbox_handlers =
+{
+    /* bt       */ BtCallback,
+    /* bt_recv  */ BtReceiveCallback,
+    /* i2c      */ NULL
+};
+
+
 /*-----------------------------------------------------------------------------
  * Function Name       : PrgInit
  *
@@ -138,11 +185,14 @@ void PrgInit
     p_ta->input.cnt_resetted[MOTOR_IDX] = FALSE;
     p_ta->output.cnt_reset_cmd_id[MOTOR_IDX]++;
 
+    is_pending = FALSE;
+    TsyncInit(&tsync, TRUE);
+
     // Start listen to the controller with bt_address via Bluetooth channel BT_CHANNEL
     stage = START_LISTEN;
     command = CMD_START_LISTEN;
     command_status = -1;
-    p_ta->hook_table.BtStartListen(BT_CHANNEL, bt_address, BtCallback);
+    p_ta->hook_table.BtStartListen(BT_CHANNEL, bt_address, MboxBtCallback);
 }
 
 
@@ -164,6 +214,9 @@ int PrgTic
                      //              and the program is stopped.
     TA * p_ta = &p_ta_array[TA_LOCAL];
 
+    // Handle the results of the Bluetooth commands and the received messages
+    MboxDrain(p_ta_array, &mbox_handlers, 0);
+
     switch (stage)
     {
         case START_LISTEN:
@@ -210,7 +263,7 @@ int PrgTic
                         // Start receive from Bluetooth channel BT_CHANNEL
                         command = CMD_START_RECEIVE;
                         receive_command_status = -1;
-                        p_ta->hook_table.BtStartReceive(BT_CHANNEL, BtReceiveCallback);
+                        p_ta->hook_table.BtStartReceive(BT_CHANNEL, MboxBtReceiveCallback);
                     }
                     command_status = -1;
                     timer = 0;
@@ -268,6 +321,15 @@ int PrgTic
             }
 
         case RECEIVE:
+            // Start of the motor at the requested shared time
+            if (is_pending && TsyncIsDue(&tsync, p_ta->hook_table.GetSystemTime(TIMER_UNIT_MICROSECONDS),
+                pending_at))
+            {
+                p_ta->output.duty[pending_chan] = pending_duty;
+                p_ta->output.duty[pending_chan + 1] = 0;
+                is_pending = FALSE;
+            }
+
             if (command_status >= 0)
             {
                 if (command_status != BT_SUCCESS)
@@ -277,6 +339,7 @@ int PrgTic
 
                     // Stop the motor
                     p_ta->output.duty[MOTOR_IDX * 2] = 0;
+                    is_pending = FALSE;
 
                     // Reset counter to be prepared for the next time when
                     // other controller connects to us again
@@ -0,0 +1,363 @@
+@=============================================================================
+@ Self-check of the ARM interpreter (ftx_arm.c) and of the firmware of the
+@ image runner (ftx_armrun.c), written as a program image for the ROBO TX
+@ Controller. There is no C compiler for ARM on the build host, so it is
+@ written in assembler; "make check-arm" assembles it into a .bin file and
+@ runs it with ftx_armrun.
+@
+@ The first tick runs the checks of selftest: flags, multiplications, clz,
+@ saturating and halfword arithmetic, the load and store variants with
+@ rotated and signed loads, shifts by registers, rrx, sbc/rsc, swp, ldm/stm,
+@ bl/blx and the hook functions strlen, sprintf, strcmp and GetSystemTime.
+@ If a check fails the program stops with the return code
+@   number of the check | r0 << 8
+@ otherwise it starts an I2C read of the LM75 at 0x48 and runs on: every
+@ tick sums 0..99 and every 1000th tick shows a pop-up message with the
+@ value of the I2C callback. A wrong sum stops the program with 99.
+@
+@ The offsets of the hook table are those of the firmware (ROBO_TX_ABI.h).
+@ bl is written as .word, so the image needs no relocations.
+@
+@ Disclaimer - Exclusion of Liability
+@
+@ This software is distributed in the hope that it will be useful, but WITHOUT
+@ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+@ FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+@ free of any license obligations or authoring rights.
+@=============================================================================
+
+    .syntax unified
+    .arm
+
+@ reg = address of sym, position independent
+    .macro ladr reg, sym
+    ldr \reg, 9f
+    add \reg, pc, \reg
+    b 8f
+9:  .word \sym - 9b
+8:
+    .endm
+    .text
+@ prg_code_intro: PRG_MAGIC, TA_VERSION, entry at PRG_MEM_START
+intro:
+    .word 0x336699AA
+    .word 0x08010101
+    .word PrgDisp - intro + 0x30700000
+
+@ Offsets in the TA: hook_table and its functions
+
+    .equ HOOK, 524
+    .equ H_GETTIME, HOOK + 1*4
+    .equ H_DISPLAY, HOOK + 2*4
+    .equ H_I2CREAD, HOOK + 12*4
+    .equ H_SPRINTF, HOOK + 14*4
+    .equ H_STRCMP, HOOK + 23*4
+    .equ H_STRLEN, HOOK + 29*4
+    .equ H_MEMSET, HOOK + 18*4
+
+@ r0 = TA array, r1 = count
+PrgDisp:
+    push {r4-r11, lr}
+    mov r4, r0
+    ladr r6, vars
+    ldr r0, [r6]            @ tick counter
+    cmp r0, #0
+    bne steady
+    .word 0xEB000000 | (((selftest - . - 8) >> 2) & 0xFFFFFF)
+    cmp r0, #0
+    bne done                @ failed test number as rc
+    @ I2C read LM75 0x48, offset 0, protocol 0x89
+    mov r0, #0x48
+    mov r1, #0
+    mov r2, #0x89
+    ladr r3, i2c_done
+    ldr ip, [r4, #H_I2CREAD]
+    blx ip
+steady:
+    ldr r0, [r6]
+    add r0, r0, #1
+    str r0, [r6]
+    @ every 1000 ticks: sprintf + DisplayMsg
+    ldr r1, =1000
+    .word 0xEB000000 | (((udiv - . - 8) >> 2) & 0xFFFFFF)
+    cmp r1, #0
+    bne 1f
+    mov r2, r0              @ seconds
+    ldr r3, [r6, #4]        @ i2c value
+    ladr r0, buf
+    ladr r1, fmt
+    ldr ip, [r4, #H_SPRINTF]
+    blx ip
+    mov r0, r4
+    ladr r1, buf
+    ldr ip, [r4, #H_DISPLAY]
+    blx ip
+1:
+    @ some work: sum of 0..99 into r0
+    mov r0, #0
+    mov r1, #100
+2:  subs r1, r1, #1
+    add r0, r0, r1
+    bne 2b
+    ldr r1, =4950
+    cmp r0, r1
+    movne r0, #99
+    bne done
+    ldr r0, =0x7FFF
+done:
+    pop {r4-r11, pc}
+
+i2c_done:                   @ r0 = TA, r1 = I2C_CB*
+    ladr r2, vars
+    ldrh r3, [r1]
+    str r3, [r2, #4]
+    ldr r3, [r2, #8]
+    add r3, r3, #1
+    str r3, [r2, #8]
+    bx lr
+
+@ unsigned r0 / r1 -> r0 quotient, r1 remainder
+udiv:
+    mov r2, #0              @ quotient
+    mov r3, #1
+    cmp r1, #0
+    beq 3f
+1:  cmp r1, r0
+    movls r1, r1, lsl #1
+    movls r3, r3, lsl #1
+    bls 1b
+2:  cmp r0, r1
+    subcs r0, r0, r1
+    addcs r2, r2, r3
+    movs r3, r3, lsr #1
+    mov r1, r1, lsr #1
+    bne 2b
+3:  mov r1, r0
+    mov r0, r2
+    bx lr
+
+@ returns 0 or the number of the failed test
+selftest:
+    push {r4-r11, lr}
+    mov r11, #1
+    mvn r0, #0
+    adds r1, r0, #1
+    bcc fail
+    bne fail
+    add r11, r11, #1        @ 2
+    mov r0, #1
+    cmp r0, #2
+    bge fail
+    bcs fail
+    add r11, r11, #1        @ 3
+    mvn r0, #0
+    umull r2, r3, r0, r0
+    cmp r2, #1
+    bne fail
+    mvn r1, #1
+    cmp r3, r1
+    bne fail
+    add r11, r11, #1        @ 4
+    mvn r0, #1              @ -2
+    mov r1, #3
+    smull r2, r3, r0, r1
+    mvn r5, #5
+    cmp r2, r5
+    bne fail
+    cmn r3, #1
+    bne fail
+    add r11, r11, #1        @ 5
+    mov r0, #3
+    mov r1, #4
+    mov r2, #5
+    mla r3, r0, r1, r2
+    cmp r3, #17
+    bne fail
+    add r11, r11, #1        @ 6
+    mov r0, #0x10000
+    clz r1, r0
+    cmp r1, #15
+    bne fail
+    mov r0, #0
+    clz r1, r0
+    cmp r1, #32
+    bne fail
+    add r11, r11, #1        @ 7
+    mvn r0, #0x80000000
+    mov r1, #1
+    qadd r2, r0, r1
+    cmp r2, r0
+    bne fail
+    mrs r3, cpsr
+    tst r3, #0x08000000
+    beq fail
+    add r11, r11, #1        @ 8
+    ldr r0, =0x0003FFFF     @ bottom -1, top 3
+    ldr r1, =0x00050003     @ bottom 3, top 5
+    smulbb r2, r0, r1       @ -1 * 3
+    mvn r3, #2
+    cmp r2, r3
+    bne fail
+    smultt r2, r0, r1       @ 3 * 5
+    cmp r2, #15
+    bne fail
+    add r11, r11, #1        @ 9
+    ladr r5, data
+    ldrh r0, [r5]           @ 0x2211
+    ldr r1, =0x2211
+    cmp r0, r1
+    bne fail
+    ldrsb r0, [r5, #3]      @ 0x84 -> -124
+    mvn r1, #123
+    cmp r0, r1
+    bne fail
+    ldrsh r0, [r5, #2]      @ 0x8433 -> 0xFFFF8433
+    ldr r1, =0xFFFF8433
+    cmp r0, r1
+    bne fail
+    ldr r0, [r5, #1]        @ unaligned: word 0x84332211 rotated by 8
+    ldr r1, =0x11843322
+    cmp r0, r1
+    bne fail
+    add r11, r11, #1        @ 10
+    ladr r5, scratch
+    ldr r2, =0x12345678
+    ldr r3, =0x9ABCDEF0
+    strd r2, r3, [r5]
+    mov r2, #0
+    mov r3, #0
+    ldrd r6, r7, [r5]
+    ldr r0, =0x12345678
+    cmp r6, r0
+    bne fail
+    ldr r0, =0x9ABCDEF0
+    cmp r7, r0
+    bne fail
+    mov r0, #0xAB
+    strh r0, [r5, #2]
+    ldr r1, [r5]
+    ldr r0, =0x00AB5678
+    cmp r1, r0
+    bne fail
+    add r11, r11, #1        @ 11
+    mov r0, #1
+    mov r2, #33
+    lsl r3, r0, r2
+    cmp r3, #0
+    bne fail
+    mov r2, #32
+    movs r3, r0, lsl r2     @ carry = bit 0 = 1, result 0
+    bcc fail
+    bne fail
+    mvn r0, #0xF
+    asr r1, r0, #2
+    mvn r2, #3
+    cmp r1, r2
+    bne fail
+    add r11, r11, #1        @ 12
+    mov r0, #3
+    cmp r0, #0              @ sets C
+    movs r1, r0, rrx        @ 0x80000001, C=1
+    bcc fail
+    ldr r2, =0x80000001
+    cmp r1, r2
+    bne fail
+    add r11, r11, #1        @ 13
+    mov r0, #0
+    cmp r0, #1              @ C = 0 (borrow)
+    mov r1, #10
+    mov r2, #3
+    sbc r3, r1, r2          @ 10 - 3 - 1 = 6
+    cmp r3, #6
+    bne fail
+    rsc r3, r2, r1          @ after cmp r3,#6: C=1 -> 10 - 3 = 7
+    cmp r3, #7
+    bne fail
+    add r11, r11, #1        @ 14
+    ladr r5, scratch
+    mov r0, #0x55
+    str r0, [r5]
+    mov r1, #0x66
+    swp r2, r1, [r5]
+    cmp r2, #0x55
+    bne fail
+    ldr r2, [r5]
+    cmp r2, #0x66
+    bne fail
+    add r11, r11, #1        @ 15
+    mov r0, #1000
+    mov r1, #7
+    .word 0xEB000000 | (((udiv - . - 8) >> 2) & 0xFFFFFF)
+    cmp r0, #142
+    bne fail
+    cmp r1, #6
+    bne fail
+    ladr ip, udiv
+    mov r0, #99
+    mov r1, #10
+    blx ip
+    cmp r0, #9
+    bne fail
+    add r11, r11, #1        @ 16
+    @ stm/ldm variants
+    ladr r5, scratch
+    mov r0, #1
+    mov r1, #2
+    mov r2, #3
+    stmib r5, {r0-r2}
+    ldmda r5!, {r6-r8}      @ vars+8..scratch, only has to run
+    ladr r5, scratch
+    ldmib r5, {r6-r8}
+    cmp r6, #1
+    cmpeq r7, #2
+    cmpeq r8, #3
+    bne fail
+    add r11, r11, #1        @ 17
+    @ hooks: strlen, sprintf, strcmp
+    ladr r0, hello
+    ldr ip, [r4, #H_STRLEN]
+    blx ip
+    cmp r0, #5
+    bne fail
+    ladr r0, buf
+    ladr r1, fmt2
+    mov r2, #42
+    mvn r3, #6              @ -7
+    ladr ip, hello
+    push {ip}
+    mov ip, #255
+    push {ip}               @ stack: 255, hello  -> args: %x then %s
+    ldr ip, [r4, #H_SPRINTF]
+    blx ip
+    add sp, sp, #8
+    cmp r0, #21
+    bne fail
+    ladr r0, buf
+    ladr r1, expect2
+    ldr ip, [r4, #H_STRCMP]
+    blx ip
+    cmp r0, #0
+    bne fail
+    add r11, r11, #1        @ 18
+    mov r0, #1
+    ldr ip, [r4, #H_GETTIME]
+    blx ip
+    cmp r0, #0              @ ms at first tick
+    bne fail
+    mov r0, #0
+    pop {r4-r11, pc}
+fail:
+    orr r0, r11, r0, lsl #8
+    pop {r4-r11, pc}
+
+    .ltorg
+    .align 2
+vars:   .word 0, 0, 0
+data:   .word 0x84332211
+scratch: .word 0, 0, 0, 0, 0
+hello:  .asciz "hello"
+fmt:    .asciz "t=%d s lm75=0x%04x"
+fmt2:   .asciz "%d|%5d|%-4x|%s|%%"
+expect2: .asciz "42|   -7|ff  |hello|%"
+    .align 2
+buf:    .space 128
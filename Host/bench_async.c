@@ -0,0 +1,151 @@
+//=============================================================================
+// Benchmark of the asynchronous online mode runtime.
+//
+// Compares the cycle rate of an application which alternates computing and
+// Transfer Area exchange (serialized) with the same application running on
+// top of the I/O thread of ftx_async.c. The computation is emulated by a
+// busy loop, the Controller by the loopback device with a reply delay.
+//
+//   bench_async [-n cycles] [-c compute us] [-d reply delay us] [tty]
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ftx_async.h"
+#include "ftx_loopback.h"
+
+static FTX_ONLINE ftx;
+static FTX_ASYNC async;
+static FTX_LOOPBACK loopback;
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : NowUs
+ *-----------------------------------------------------------------------------*/
+static double NowUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Compute
+ *
+ * Emulated application computation, returns a new motor duty.
+ *-----------------------------------------------------------------------------*/
+static INT16 Compute
+(
+    const TA_INPUT * p_input,
+    UINT32 compute_us
+)
+{
+    double t_end = NowUs() + compute_us;
+    volatile UINT32 x = p_input->counter[0];
+
+    while (NowUs() < t_end)
+    {
+        x = x * 1103515245 + 12345;
+    }
+    return (INT16)(x % (DUTY_MAX + 1));
+}
+
+
+int main
+(
+    int argc,
+    char ** argv
+)
+{
+    const char * dev = NULL;
+    UINT32 compute_us = 200, delay_us = 200;
+    int n = 2000, i, opt, rc;
+    double t0, t_serial, t_async;
+    FTX_SNAPSHOT snap;
+
+    while ((opt = getopt(argc, argv, "n:c:d:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': n = atoi(optarg); break;
+            case 'c': compute_us = atoi(optarg); break;
+            case 'd': delay_us = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-n cycles] [-c compute us] [-d reply delay us] [tty]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind < argc)
+    {
+        dev = argv[optind];
+    }
+    if (!dev)
+    {
+        if (FtxLoopbackStart(&loopback, delay_us, FTX_AREA_MASK_ALL) != FTX_OK)
+        {
+            fprintf(stderr, "cannot start loopback device\n");
+            return 1;
+        }
+        dev = loopback.dev;
+    }
+
+    // Serialized: exchange, then compute
+    rc = FtxOnlineOpen(&ftx, dev, 0);
+    t0 = NowUs();
+    for (i = 0; i < n && rc == FTX_OK; i++)
+    {
+        rc = FtxOnlineExchange(&ftx, FTX_AREA_MASK_ALL);
+        ftx.ta[TA_LOCAL].output.duty[0] = Compute(&ftx.ta[TA_LOCAL].input, compute_us);
+    }
+    t_serial = NowUs() - t0;
+    FtxOnlineClose(&ftx);
+    if (rc != FTX_OK)
+    {
+        fprintf(stderr, "serialized exchange failed, rc = %d\n", rc);
+        return 1;
+    }
+
+    // Asynchronous: the I/O thread exchanges while the application computes
+    rc = FtxAsyncOpen(&async, dev, 0, FTX_AREA_MASK_ALL, 0);
+    if (rc == FTX_OK)
+    {
+        rc = FtxAsyncStart(&async);
+    }
+    if (rc != FTX_OK)
+    {
+        fprintf(stderr, "cannot start I/O thread, rc = %d\n", rc);
+        return 1;
+    }
+    t0 = NowUs();
+    for (i = 0; i < n; i++)
+    {
+        FtxAsyncReadInput(&async, &snap);
+        FtxAsyncOutput(&async, TA_LOCAL)->duty[0] = Compute(&snap.input[TA_LOCAL], compute_us);
+        FtxAsyncPublish(&async, TA_LOCAL);
+    }
+    t_async = NowUs() - t0;
+    FtxAsyncClose(&async);
+
+    printf("compute %u us, reply delay %u us, %d cycles\n", (unsigned)compute_us, (unsigned)delay_us, n);
+    printf("serialized   cycles/s %9.1f\n", n / (t_serial / 1e6));
+    printf("async        cycles/s %9.1f  (I/O cycles %u, errors %u)\n", n / (t_async / 1e6),
+        atomic_load(&async.n_cycles), atomic_load(&async.n_errors));
+
+    if (dev == loopback.dev)
+    {
+        FtxLoopbackStop(&loopback);
+    }
+    return 0;
+}
@@ -0,0 +1,274 @@
+//=============================================================================
+// Benchmark of the C++ interface to the hook functions (prg_hooks.hpp)
+// against the same sequences written in C as in the demos.
+//
+// Built as a program for the simulator (see the Makefile). The hook functions
+// used are replaced by stubs which only count the calls, so the times are the
+// cost of the calling code itself. Each sequence is put into a section of its
+// own, so the size of the section is the code size of the function without
+// alignment. Runs all measurements in the first tick and stops.
+//
+//   bench_hooks
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <stdio.h>
+#include <time.h>
+
+#include "prg_hooks.hpp"
+
+#define BENCH_LOOPS     5000000
+
+// Function in the section bench_<name>, its size is __stop_bench_<name> - __start_bench_<name>
+#define BENCH_FUNC(name)    __attribute__ ((noinline, section ("bench_" #name)))
+#define BENCH_SIZE(name)    extern char __start_bench_##name[], __stop_bench_##name[];
+#define BENCH_SIZEOF(name)  ((unsigned)(__stop_bench_##name - __start_bench_##name))
+
+#define BT_CHANNEL      1
+#define LM75_ADDR       0x48
+#define LM75_PROTOCOL   (I2C_PROTO_BASE | I2C_PROTO_OFFSET_1 | I2C_PROTO_DATA_2)
+
+extern "C"
+{
+    BENCH_SIZE(BtReplyC)    BENCH_SIZE(BtReplyCpp)
+    BENCH_SIZE(ConfigC)     BENCH_SIZE(ConfigCpp)
+    BENCH_SIZE(I2cC)        BENCH_SIZE(I2cCpp)
+}
+
+static TA_HOOK_TABLE saved_hooks;
+static volatile UINT32 n_calls;
+static volatile UINT32 sink;
+static UCHAR8 msg[8];
+static char text[32];
+
+
+//-----------------------------------------------------------------------------
+// Stubs of the hook functions
+//-----------------------------------------------------------------------------
+
+static BOOL32 StubIsDisplayBeingRefreshed(TA * p_ta)
+{
+    return n_calls & 1;
+}
+
+static void StubDisplayMsg(TA * p_ta, char * p_msg)
+{
+    n_calls++;
+}
+
+static INT32 StubSprintf(char * s, const char * format, ...)
+{
+    n_calls++;
+    return 0;
+}
+
+static void StubBtSend(UINT32 channel, UINT32 len, UCHAR8 * p_msg, P_CB_FUNC p_cb_func)
+{
+    n_calls++;
+}
+
+static void StubBtStartReceive(UINT32 channel, P_RECV_CB_FUNC p_cb_func)
+{
+    n_calls++;
+}
+
+static UINT32 StubI2cRead(UCHAR8 devaddr, UINT32 offset, UCHAR8 protocol, P_I2C_CB_FUNC p_cb_func)
+{
+    n_calls++;
+    return 0;
+}
+
+static UINT32 StubI2cWrite(UCHAR8 devaddr, UINT32 offset, UINT16 data, UCHAR8 protocol, P_I2C_CB_FUNC p_cb_func)
+{
+    n_calls++;
+    return 0;
+}
+
+// Callbacks passed as template arguments need external linkage (C++98)
+void TempDone(TA * p_ta, I2C_CB * p_cb)
+{
+    sink += p_cb->value;
+}
+
+
+//-----------------------------------------------------------------------------
+// Sequences in C
+//-----------------------------------------------------------------------------
+
+// Reply to a Bluetooth command and status on the display, as in StopGoBtMotorPart
+BENCH_FUNC(BtReplyC) static void BtReplyC(TA * p_ta_array, UINT32 i)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+
+    if (p_ta->state.btstatus[BT_CHANNEL - 1].conn_state == BT_STATE_CONNECTED)
+    {
+        msg[0] = (UCHAR8)i;
+        p_ta->hook_table.BtSend(BT_CHANNEL, sizeof(msg), msg, MboxBtCallback);
+    }
+    if (!p_ta->hook_table.IsDisplayBeingRefreshed(p_ta))
+    {
+        p_ta->hook_table.sprintf(text, "Cmd %d", (int)i);
+        p_ta->hook_table.DisplayMsg(p_ta, text);
+    }
+}
+
+// Change of the configuration, as in the Motor demos
+BENCH_FUNC(ConfigC) static void ConfigC(TA * p_ta_array, UINT32 i)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+
+    p_ta->config.motor[0] = (i & 1) ? TRUE : FALSE;
+    p_ta->config.uni[0].mode = MODE_R;
+    p_ta->state.config_id += 1;
+}
+
+// Temperature read and write of the limit, as in the I2C demos
+BENCH_FUNC(I2cC) static void I2cC(TA * p_ta_array, UINT32 i)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+
+    sink += p_ta->hook_table.I2cRead(LM75_ADDR, 0, LM75_PROTOCOL, TempDone);
+    sink += p_ta->hook_table.I2cWrite(LM75_ADDR, 3, (UINT16)i, LM75_PROTOCOL, MboxI2cCallback);
+}
+
+
+//-----------------------------------------------------------------------------
+// Sequences in C++
+//-----------------------------------------------------------------------------
+
+BENCH_FUNC(BtReplyCpp) static void BtReplyCpp(TA * p_ta_array, UINT32 i)
+{
+    BtChannel<BT_CHANNEL> bt(p_ta_array);
+    Display display(p_ta_array);
+
+    if (bt.IsConnected())
+    {
+        msg[0] = (UCHAR8)i;
+        bt.Send(msg, sizeof(msg));
+    }
+    if (!display.IsBusy())
+    {
+        display.Show(text, "Cmd %d", (int)i);
+    }
+}
+
+BENCH_FUNC(ConfigCpp) static void ConfigCpp(TA * p_ta_array, UINT32 i)
+{
+    ConfigUpdate cfg(&p_ta_array[TA_LOCAL]);
+
+    cfg->motor[0] = (i & 1) ? TRUE : FALSE;
+    cfg->uni[0].mode = MODE_R;
+}
+
+BENCH_FUNC(I2cCpp) static void I2cCpp(TA * p_ta_array, UINT32 i)
+{
+    I2cDevice<LM75_ADDR, LM75_PROTOCOL> lm75(p_ta_array);
+
+    sink += lm75.Read<TempDone>(0);
+    sink += lm75.Write(3, (UINT16)i);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : NowNs
+ *-----------------------------------------------------------------------------*/
+static double NowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Bench
+ *
+ * Measures the C and the C++ variant of a sequence alternately, best of 5.
+ *-----------------------------------------------------------------------------*/
+static void Bench
+(
+    const char * name,
+    TA * p_ta_array,
+    void (*p_func_c)(TA *, UINT32),
+    void (*p_func_cpp)(TA *, UINT32),
+    unsigned size_c,
+    unsigned size_cpp
+)
+{
+    double t_c = 0.0, t_cpp = 0.0;
+    UINT32 calls_c, calls_cpp;
+    int run;
+
+    for (run = 0; run < 5; run++)
+    {
+        double t0;
+        UINT32 i;
+
+        n_calls = 0;
+        t0 = NowNs();
+        for (i = 0; i < BENCH_LOOPS; i++)
+        {
+            p_func_c(p_ta_array, i);
+        }
+        t0 = NowNs() - t0;
+        t_c = (run == 0 || t0 < t_c) ? t0 : t_c;
+        calls_c = n_calls;
+
+        n_calls = 0;
+        t0 = NowNs();
+        for (i = 0; i < BENCH_LOOPS; i++)
+        {
+            p_func_cpp(p_ta_array, i);
+        }
+        t0 = NowNs() - t0;
+        t_cpp = (run == 0 || t0 < t_cpp) ? t0 : t_cpp;
+        calls_cpp = n_calls;
+    }
+
+    printf("%-20s C %5.2f ns %4u bytes  C++ %5.2f ns %4u bytes  %+5.1f%%%s\n", name,
+        t_c / BENCH_LOOPS, size_c, t_cpp / BENCH_LOOPS, size_cpp, (t_cpp - t_c) * 100.0 / t_c,
+        (calls_c == calls_cpp) ? "" : "  (hook calls differ!)");
+}
+
+
+void PrgInit
+(
+    TA * p_ta_array,
+    int ta_count
+)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+
+    saved_hooks = p_ta->hook_table;
+    p_ta->hook_table.IsDisplayBeingRefreshed = StubIsDisplayBeingRefreshed;
+    p_ta->hook_table.DisplayMsg = StubDisplayMsg;
+    p_ta->hook_table.sprintf = StubSprintf;
+    p_ta->hook_table.BtSend = StubBtSend;
+    p_ta->hook_table.BtStartReceive = StubBtStartReceive;
+    p_ta->hook_table.I2cRead = StubI2cRead;
+    p_ta->hook_table.I2cWrite = StubI2cWrite;
+
+    p_ta->state.btstatus[BT_CHANNEL - 1].conn_state = BT_STATE_CONNECTED;
+}
+
+
+int PrgTic
+(
+    TA * p_ta_array,
+    int ta_count
+)
+{
+    Bench("BT reply + display", p_ta_array, BtReplyC, BtReplyCpp, BENCH_SIZEOF(BtReplyC), BENCH_SIZEOF(BtReplyCpp));
+    Bench("config change", p_ta_array, ConfigC, ConfigCpp, BENCH_SIZEOF(ConfigC), BENCH_SIZEOF(ConfigCpp));
+    Bench("I2C read + write", p_ta_array, I2cC, I2cCpp, BENCH_SIZEOF(I2cC), BENCH_SIZEOF(I2cCpp));
+
+    p_ta_array[TA_LOCAL].hook_table = saved_hooks;
+    return 0;
+}
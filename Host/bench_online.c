@@ -0,0 +1,185 @@
+//=============================================================================
+// Benchmark of the online mode client library.
+//
+// Runs the Transfer Area exchange against the loopback device (or against a
+// real Controller if a tty is given) and reports round-trips per second and
+// latency, once with all 9 Transfer Areas in one round-trip and once with
+// one round-trip per Transfer Area.
+//
+//   bench_online [-n exchanges] [-d reply delay us] [-b baud] [tty]
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ftx_online.h"
+#include "ftx_loopback.h"
+
+static FTX_ONLINE ftx;
+static FTX_LOOPBACK loopback;
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : NowUs
+ *-----------------------------------------------------------------------------*/
+static double NowUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : CompareDouble
+ *-----------------------------------------------------------------------------*/
+static int CompareDouble
+(
+    const void * a,
+    const void * b
+)
+{
+    double d = *(const double *)a - *(const double *)b;
+
+    return (d > 0) - (d < 0);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : RunBench
+ *
+ * Makes n cycles, each cycle exchanges all Transfer Areas either in one
+ * round-trip (batched) or in one round-trip per area.
+ *-----------------------------------------------------------------------------*/
+static int RunBench
+(
+    const char * name,
+    int n,
+    BOOL32 batched
+)
+{
+    double * lat = malloc(n * sizeof(double));
+    double t_start, t_total, sum = 0;
+    int i, idx, rc = FTX_OK;
+
+    if (!lat)
+    {
+        return FTX_ERR_PARAM;
+    }
+
+    t_start = NowUs();
+    for (i = 0; i < n && rc == FTX_OK; i++)
+    {
+        double t0 = NowUs();
+
+        ftx.ta[TA_LOCAL].output.duty[0] = (INT16)(i & DUTY_MAX);
+        if (batched)
+        {
+            rc = FtxOnlineExchange(&ftx, FTX_AREA_MASK_ALL);
+        }
+        else
+        {
+            for (idx = 0; idx < TA_COUNT && rc == FTX_OK; idx++)
+            {
+                rc = FtxOnlineExchange(&ftx, FTX_AREA_MASK(idx));
+            }
+        }
+        lat[i] = NowUs() - t0;
+        sum += lat[i];
+    }
+    t_total = NowUs() - t_start;
+
+    if (rc != FTX_OK)
+    {
+        fprintf(stderr, "%s: exchange failed after %d cycles, rc = %d\n", name, i, rc);
+    }
+    else
+    {
+        qsort(lat, n, sizeof(double), CompareDouble);
+        printf("%-10s cycles %7d  cycles/s %9.1f  latency us: min %8.1f  avg %8.1f  p99 %8.1f  max %8.1f\n",
+            name, n, n / (t_total / 1e6), lat[0], sum / n, lat[(int)(n * 0.99)], lat[n - 1]);
+    }
+    free(lat);
+    return rc;
+}
+
+
+int main
+(
+    int argc,
+    char ** argv
+)
+{
+    const char * dev = NULL;
+    UINT32 delay_us = 0, baud = 0;
+    int n = 10000, opt, rc;
+
+    while ((opt = getopt(argc, argv, "n:d:b:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': n = atoi(optarg); break;
+            case 'd': delay_us = atoi(optarg); break;
+            case 'b': baud = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-n exchanges] [-d reply delay us] [-b baud] [tty]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind < argc)
+    {
+        dev = argv[optind];
+    }
+    if (n <= 0)
+    {
+        n = 1;
+    }
+
+    if (!dev)
+    {
+        if (FtxLoopbackStart(&loopback, delay_us, FTX_AREA_MASK_ALL) != FTX_OK)
+        {
+            fprintf(stderr, "cannot start loopback device\n");
+            return 1;
+        }
+        dev = loopback.dev;
+    }
+
+    rc = FtxOnlineOpen(&ftx, dev, baud);
+    if (rc == FTX_OK)
+    {
+        rc = FtxOnlineGetInfo(&ftx);
+    }
+    if (rc == FTX_OK)
+    {
+        printf("device %s: %s, TA version %08lX\n", dev, ftx.ta[TA_LOCAL].info.device_name,
+            (unsigned long)ftx.ta[TA_LOCAL].info.version.ta.abcd);
+        rc = RunBench("batched", n, TRUE);
+    }
+    if (rc == FTX_OK)
+    {
+        rc = RunBench("per-area", n / TA_COUNT + 1, FALSE);
+    }
+    if (rc != FTX_OK)
+    {
+        fprintf(stderr, "online mode error %d\n", rc);
+    }
+
+    FtxOnlineClose(&ftx);
+    if (dev == loopback.dev)
+    {
+        FtxLoopbackStop(&loopback);
+    }
+    return (rc == FTX_OK) ? 0 : 1;
+}
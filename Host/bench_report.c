@@ -0,0 +1,369 @@
+//=============================================================================
+// Benchmark report.
+//
+// Collects the result lines of the benchmarks (bench_report.h) from stdin
+// into one JSON document, with the best result of repeated runs of a
+// benchmark, and compares the results with a baseline, which is a document
+// written by this tool before:
+//
+//   <benchmarks> | bench_report [-o report] [-b baseline] [-t tolerance %] [-s slack]
+//
+//   -o     writes the document to the file (default: stdout)
+//   -b     compares with the baseline
+//   -t     allowed increase of a value relative to the baseline (default 30 %)
+//   -s     allowed absolute increase of a value (default 0, in the unit of
+//          the result)
+//
+// The noise of a result is the distance of the upper quartile of its
+// repeated runs from the best one. A single slow run does not change it,
+// and on a quiet machine it is small, so the check gets tighter there. The
+// document keeps the noise next to the best value. Returns 1 if a result is
+// worse than the baseline by more than the tolerance and by more than the
+// slack plus the noise of both, if a result of the baseline is missing, or
+// if a value of the baseline is 0 or below its noise: such a benchmark
+// measures nothing but noise and has to be changed.
+// Run the benchmarks repeatedly (make bench: BENCH_REPEAT) to get the noise.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench_report.h"
+
+#define RESULTS_MAX         256
+#define REPEAT_MAX          32
+#define LINE_LEN_MAX        256
+
+// One benchmark result
+typedef struct
+{
+    char            name[BENCH_NAME_LEN_MAX];
+    char            unit[BENCH_UNIT_LEN_MAX];
+    double          value;          // best of the repeated runs
+    double          noise;          // upper quartile - best of the repeated runs
+    double          runs[REPEAT_MAX];
+    unsigned        n_runs;
+} RESULT;
+
+typedef struct
+{
+    RESULT          result[RESULTS_MAX];
+    unsigned        count;
+} RESULT_SET;
+
+static RESULT_SET current, baseline;
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : ParseResult
+ *
+ * Parses one result line, of a benchmark or of a document with the noise.
+ * Returns 0 if the line is no result line.
+ *-----------------------------------------------------------------------------*/
+static int ParseResult
+(
+    const char * p_line,
+    RESULT * p_result
+)
+{
+    double noise = 0.0;
+    int n = 0;
+
+    while (*p_line == ' ' || *p_line == '\t')
+    {
+        p_line++;
+    }
+    // %63[^\"] and %15[^\"] follow BENCH_NAME_LEN_MAX and BENCH_UNIT_LEN_MAX
+    if (sscanf(p_line, "{\"name\": \"%63[^\"]\", \"unit\": \"%15[^\"]\", \"value\": %lf%n",
+        p_result->name, p_result->unit, &p_result->value, &n) != 3 || n == 0)
+    {
+        return 0;
+    }
+    p_line += n;
+    n = 0;
+    if (sscanf(p_line, "}%n", &n) != 0 || n == 0)
+    {
+        if (sscanf(p_line, ", \"noise\": %lf}%n", &noise, &n) != 1 || n == 0)
+        {
+            return 0;
+        }
+    }
+    p_result->noise = noise;
+    return 1;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : CompareValues
+ *-----------------------------------------------------------------------------*/
+static int CompareValues
+(
+    const void * p_a,
+    const void * p_b
+)
+{
+    double a = *(const double *)p_a;
+    double b = *(const double *)p_b;
+
+    return (a > b) - (a < b);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : ReadResults
+ *
+ * Reads all result lines of the stream. Of the results of repeated runs of a
+ * benchmark the best (lowest) is kept, with the noise of the runs. Returns
+ * the number of results.
+ *-----------------------------------------------------------------------------*/
+static unsigned ReadResults
+(
+    FILE * p_file,
+    RESULT_SET * p_set
+)
+{
+    char line[LINE_LEN_MAX];
+    RESULT result;
+    RESULT * p_result;
+    unsigned i;
+
+    while (fgets(line, sizeof(line), p_file))
+    {
+        if (!ParseResult(line, &result))
+        {
+            continue;
+        }
+        for (i = 0; i < p_set->count && strcmp(p_set->result[i].name, result.name) != 0; i++)
+        {
+        }
+        if (i == RESULTS_MAX)
+        {
+            fprintf(stderr, "too many results, %s ignored\n", result.name);
+            continue;
+        }
+        p_result = &p_set->result[i];
+        if (i == p_set->count)
+        {
+            *p_result = result;
+            p_result->n_runs = 0;
+            p_set->count++;
+        }
+        if (p_result->n_runs < REPEAT_MAX)
+        {
+            p_result->runs[p_result->n_runs++] = result.value;
+        }
+    }
+
+    for (i = 0; i < p_set->count; i++)
+    {
+        p_result = &p_set->result[i];
+        qsort(p_result->runs, p_result->n_runs, sizeof(p_result->runs[0]), CompareValues);
+        p_result->value = p_result->runs[0];
+        p_result->noise += p_result->runs[p_result->n_runs * 3 / 4] - p_result->runs[0];
+    }
+    return p_set->count;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FindResult
+ *-----------------------------------------------------------------------------*/
+static const RESULT * FindResult
+(
+    const RESULT_SET * p_set,
+    const char * p_name
+)
+{
+    unsigned i;
+
+    for (i = 0; i < p_set->count; i++)
+    {
+        if (strcmp(p_set->result[i].name, p_name) == 0)
+        {
+            return &p_set->result[i];
+        }
+    }
+    return NULL;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : IsNoiseOnly
+ *
+ * Returns TRUE if the value is 0 or below its noise, so it can not be
+ * compared.
+ *-----------------------------------------------------------------------------*/
+static int IsNoiseOnly
+(
+    const RESULT * p_result
+)
+{
+    return p_result->value <= 0.0 || p_result->value < p_result->noise;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : WriteResults
+ *
+ * Writes the document, one result per line so the baseline can be read
+ * back and diffs of it are readable. Warns about the values which can not
+ * be compared.
+ *-----------------------------------------------------------------------------*/
+static void WriteResults
+(
+    FILE * p_file,
+    const RESULT_SET * p_set
+)
+{
+    unsigned i;
+
+    fprintf(p_file, "{\n  \"results\": [\n");
+    for (i = 0; i < p_set->count; i++)
+    {
+        fprintf(p_file, "    {\"name\": \"%s\", \"unit\": \"%s\", \"value\": %.2f, \"noise\": %.2f}%s\n",
+            p_set->result[i].name, p_set->result[i].unit, p_set->result[i].value,
+            p_set->result[i].noise, (i + 1 < p_set->count) ? "," : "");
+    }
+    fprintf(p_file, "  ]\n}\n");
+    for (i = 0; i < p_set->count; i++)
+    {
+        if (IsNoiseOnly(&p_set->result[i]))
+        {
+            fprintf(stderr, "%s: %.2f is noise only (noise %.2f)\n", p_set->result[i].name, p_set->result[i].value,
+                p_set->result[i].noise);
+        }
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Compare
+ *
+ * Compares the results with the baseline, prints one line per result to
+ * stderr. Returns the number of regressions.
+ *-----------------------------------------------------------------------------*/
+static unsigned Compare
+(
+    const RESULT_SET * p_set,
+    const RESULT_SET * p_base,
+    double tolerance,
+    double slack
+)
+{
+    const RESULT * p_cur;
+    const RESULT * p_ref;
+    unsigned n_fail = 0;
+    unsigned i;
+    double noise;
+    int is_worse;
+
+    fprintf(stderr, "%-40s %12s %12s %8s %8s\n", "benchmark", "baseline", "current", "noise", "change");
+    for (i = 0; i < p_base->count; i++)
+    {
+        p_ref = &p_base->result[i];
+        p_cur = FindResult(p_set, p_ref->name);
+        if (!p_cur)
+        {
+            fprintf(stderr, "%-40s %12.2f %12s %8s %8s MISSING\n", p_ref->name, p_ref->value, "-", "", "");
+            n_fail++;
+            continue;
+        }
+        if (IsNoiseOnly(p_ref))
+        {
+            fprintf(stderr, "%-40s %12.2f %12.2f %8.2f %8s NOISE ONLY\n", p_ref->name, p_ref->value, p_cur->value,
+                p_ref->noise, "");
+            n_fail++;
+            continue;
+        }
+        noise = p_cur->noise + p_ref->noise;
+        is_worse = p_cur->value > p_ref->value * (1.0 + tolerance / 100.0) &&
+                   p_cur->value > p_ref->value + slack + noise;
+        n_fail += (is_worse) ? 1 : 0;
+        fprintf(stderr, "%-40s %12.2f %12.2f %8.2f %+7.1f%%%s\n", p_ref->name, p_ref->value, p_cur->value, noise,
+            (p_cur->value - p_ref->value) * 100.0 / p_ref->value,
+            (is_worse) ? " REGRESSION" : "");
+    }
+    for (i = 0; i < p_set->count; i++)
+    {
+        if (!FindResult(p_base, p_set->result[i].name))
+        {
+            fprintf(stderr, "%-40s %12s %12.2f %8.2f %8s new\n", p_set->result[i].name, "-",
+                p_set->result[i].value, p_set->result[i].noise, "");
+        }
+    }
+    fprintf(stderr, "# %u of %u results worse than the baseline (tolerance %.0f %%, slack %.2f)\n", n_fail,
+        p_base->count, tolerance, slack);
+    return n_fail;
+}
+
+
+int main
+(
+    int argc,
+    char ** argv
+)
+{
+    const char * p_report_name = NULL;
+    const char * p_base_name = NULL;
+    double tolerance = 30.0;
+    double slack = 0.0;
+    FILE * p_file;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:b:t:s:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'o': p_report_name = optarg; break;
+            case 'b': p_base_name = optarg; break;
+            case 't': tolerance = atof(optarg); break;
+            case 's': slack = atof(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-o report] [-b baseline] [-t tolerance %%] [-s slack]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    if (ReadResults(stdin, &current) == 0)
+    {
+        fprintf(stderr, "no benchmark results\n");
+        return 2;
+    }
+
+    if (!p_report_name)
+    {
+        WriteResults(stdout, &current);
+    }
+    else if ((p_file = fopen(p_report_name, "w")) != NULL)
+    {
+        WriteResults(p_file, &current);
+        fclose(p_file);
+    }
+    else
+    {
+        perror(p_report_name);
+        return 2;
+    }
+
+    if (!p_base_name)
+    {
+        return 0;
+    }
+    if ((p_file = fopen(p_base_name, "r")) == NULL)
+    {
+        perror(p_base_name);
+        return 2;
+    }
+    ReadResults(p_file, &baseline);
+    fclose(p_file);
+
+    return (Compare(&current, &baseline, tolerance, slack)) ? 1 : 0;
+}
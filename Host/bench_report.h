@@ -0,0 +1,30 @@
+//=============================================================================
+// Header file of the benchmark results.
+// Benchmarks print each result as one line of JSON to stdout:
+//   {"name": "<group>.<benchmark>", "unit": "ns", "value": 12.34}
+// Other lines of their output are ignored. bench_report collects the result
+// lines into one JSON document and compares it with a stored baseline (see
+// "make bench" in the Makefile).
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __BENCH_REPORT_H__
+#define __BENCH_REPORT_H__
+
+#include <stdio.h>
+
+#define BENCH_NAME_LEN_MAX      64
+#define BENCH_UNIT_LEN_MAX      16
+
+// Prints one result line; lower values are better
+#define BENCH_RESULT(name, unit, value) \
+    printf("{\"name\": \"%s\", \"unit\": \"%s\", \"value\": %.2f}\n", (name), (unit), (double)(value))
+
+
+#endif // __BENCH_REPORT_H__
@@ -0,0 +1,147 @@
+//=============================================================================
+// Benchmark of the common runtime of the programs:
+//   - runtime.dispatch            PrgDisp: a tick through prg_code_intro.entry,
+//                                 with a PrgTic which returns at once;
+//   - runtime.bt_status_display   BtDisplayCommandStatus (string building
+//                                 with the sprintf of the hook table);
+//   - runtime.mbox_delivery       one Bluetooth message through the callback
+//                                 mailbox, from MboxBtReceiveCallback to the
+//                                 program callback called by MboxDrain.
+//
+// Built as a program for the simulator (see the Makefile), so the hook
+// functions are called through the hook table of the Transfer Area exactly
+// as on the Controller. Runs all measurements in the first tick and stops.
+// Prints the results as benchmark results (bench_report.h): the instructions
+// per operation, counted by single-stepping (ftx_icount.h).
+//
+//   bench_runtime
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include "bench_report.h"
+#include "ftx_icount.h"
+#include "prg_mbox.h"
+
+#define BENCH_LOOPS     100
+#define MBOX_BATCH      8           // messages per MboxDrain
+
+typedef int (*P_PRG_ENTRY)(TA * p_ta_array, int ta_count);
+
+extern const struct prg_code_intro_s prg_code_intro;
+
+static BOOL32 in_bench;
+static volatile UINT32 sink;
+static UCHAR8 bt_address[BT_ADDR_LEN] = {0x00, 0x13, 0x7B, 0x11, 0x22, 0x33};
+
+
+// Instructions per operation, counted over BENCH_LOOPS operations after a
+// first one (which may resolve the library functions it calls)
+#define BENCH_COUNT(p_result, op)                                           \
+    do                                                                      \
+    {                                                                       \
+        UINT32 i = 0;                                                       \
+                                                                            \
+        op;                                                                 \
+        FtxICountStart();                                                   \
+        for (i = 0; i < BENCH_LOOPS; i++)                                   \
+        {                                                                   \
+            op;                                                             \
+        }                                                                   \
+        *(p_result) = (double)FtxICountStop() / BENCH_LOOPS;                \
+    } while (0)
+
+
+static void BenchRecvHandler
+(
+    TA * p_ta_array,
+    BT_RECV_CB * p_data
+)
+{
+    sink += p_data->msg[0];
+}
+
+static const MBOX_HANDLERS bench_handlers =
+{
+    /* bt       */ NULL,
+    /* bt_recv  */ BenchRecvHandler,
+    /* i2c      */ NULL
+};
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : MboxBatch
+ *
+ * Posts MBOX_BATCH messages as the firmware does and hands them over to the
+ * program callback.
+ *-----------------------------------------------------------------------------*/
+static UINT32 MboxBatch
+(
+    TA * p_ta_array,
+    BT_RECV_CB * p_recv
+)
+{
+    UINT32 i;
+
+    for (i = 0; i < MBOX_BATCH; i++)
+    {
+        p_recv->msg[0] = (UCHAR8)i;
+        MboxBtReceiveCallback(p_ta_array, p_recv);
+    }
+    return MboxDrain(p_ta_array, &bench_handlers, 0);
+}
+
+
+void PrgInit
+(
+    TA * p_ta_array,
+    int ta_count
+)
+{
+    if (FtxICountOpen() != FTX_OK)
+    {
+        printf("cannot count the instructions of the benchmarks\n");
+    }
+}
+
+
+int PrgTic
+(
+    TA * p_ta_array,
+    int ta_count
+)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+    P_PRG_ENTRY p_entry = (P_PRG_ENTRY)prg_code_intro.entry;
+    BT_RECV_CB recv;
+    double n;
+
+    // Nested calls of the dispatch measurement
+    if (in_bench)
+    {
+        return 0x7FFF;
+    }
+    in_bench = TRUE;
+
+    BENCH_COUNT(&n, sink += p_entry(p_ta_array, ta_count));
+    BENCH_RESULT("runtime.dispatch", "insn", n);
+
+    BENCH_COUNT(&n, sink += BtDisplayCommandStatus(p_ta, bt_address, 1 + (i & 7), (enum bt_commands_e)(CMD_CONNECT + i % 7),
+        (CHAR8)(i % 17)));
+    BENCH_RESULT("runtime.bt_status_display", "insn", n);
+
+    p_ta->hook_table.memset(&recv, 0, sizeof(recv));
+    recv.chan_idx = 1;
+    recv.status = BT_MSG_INDICATION;
+    recv.msg_len = 3;
+    BENCH_COUNT(&n, sink += MboxBatch(p_ta_array, &recv));
+    BENCH_RESULT("runtime.mbox_delivery", "insn", n / MBOX_BATCH);
+
+    in_bench = FALSE;
+    return 0;
+}
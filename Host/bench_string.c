@@ -0,0 +1,135 @@
+//=============================================================================
+// Benchmark of the inline memory functions (prg_string.h)
+// against the functions of the hook table.
+//
+// Built as a program for the simulator (see the Makefile), so the hook
+// functions are called through the hook table of the Transfer Area exactly
+// as on the Controller. Runs all measurements in the first tick and stops.
+//
+//   bench_string
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <stdio.h>
+#include <time.h>
+
+#include "prg_string.h"
+
+#define BENCH_LOOPS     2000000
+#define BENCH_BUF_SIZE  1024
+
+static UCHAR8 src[BENCH_BUF_SIZE] __attribute__ ((aligned (8)));
+static UCHAR8 dst[BENCH_BUF_SIZE] __attribute__ ((aligned (8)));
+static volatile UINT32 sink;
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : NowNs
+ *-----------------------------------------------------------------------------*/
+static double NowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+static void Report
+(
+    const char * name,
+    double t_hook,
+    double t_inline
+)
+{
+    printf("%-28s hook %6.2f ns  inline %6.2f ns  %5.1fx\n", name, t_hook / BENCH_LOOPS,
+        t_inline / BENCH_LOOPS, t_inline ? t_hook / t_inline : 0.0);
+}
+
+
+// Measures one operation through the hook table and inline. The offset (i & 7)
+// keeps the compiler from hoisting the operation out of the loop.
+#define BENCH(name, hook_op, inline_op)                                     \
+    do                                                                      \
+    {                                                                       \
+        double t0, t_hook, t_inline;                                        \
+        UINT32 i;                                                           \
+                                                                            \
+        t0 = NowNs();                                                       \
+        for (i = 0; i < BENCH_LOOPS; i++)                                   \
+        {                                                                   \
+            hook_op;                                                        \
+        }                                                                   \
+        t_hook = NowNs() - t0;                                              \
+        t0 = NowNs();                                                       \
+        for (i = 0; i < BENCH_LOOPS; i++)                                   \
+        {                                                                   \
+            inline_op;                                                      \
+            __asm__ __volatile__ ("" : : : "memory");                       \
+        }                                                                   \
+        t_inline = NowNs() - t0;                                            \
+        Report(name, t_hook, t_inline);                                     \
+    } while (0)
+
+
+void PrgInit
+(
+    TA * p_ta_array,
+    int ta_count
+)
+{
+    UINT32 i;
+
+    for (i = 0; i < BENCH_BUF_SIZE; i++)
+    {
+        src[i] = (UCHAR8)(i * 7);
+    }
+}
+
+
+int PrgTic
+(
+    TA * p_ta_array,
+    int ta_count
+)
+{
+    TA * p_ta = &p_ta_array[TA_LOCAL];
+    INT16 value;
+    UINT32 n;
+
+    // Copy of a counter value out of a Bluetooth message, as in StopGoBtMotorPart
+    BENCH("memcpy 2 (const, unaligned)",
+        p_ta->hook_table.memcpy(&value, &src[1 + (i & 7)], sizeof(value)); sink += value,
+        PrgMemcpy(p_ta, &value, &src[1 + (i & 7)], sizeof(value)); sink += value);
+
+    BENCH("memcpy 16 (const, aligned)",
+        p_ta->hook_table.memcpy(&dst[(i & 7) * 8], src, 16),
+        PrgMemcpy(p_ta, &dst[(i & 7) * 8], src, 16));
+
+    for (n = 4; n <= 64; n *= 4)
+    {
+        char name[40];
+        volatile UINT32 size = n;   // size not known at compile time
+
+        sprintf(name, "memcpy %u (variable)", (unsigned)n);
+        BENCH(name,
+            p_ta->hook_table.memcpy(&dst[(i & 7) * 8], src, size),
+            PrgMemcpy(p_ta, &dst[(i & 7) * 8], src, size));
+    }
+
+    BENCH("memset 16 (const)",
+        p_ta->hook_table.memset(&dst[(i & 7) * 8], i, 16),
+        PrgMemset(p_ta, &dst[(i & 7) * 8], i, 16));
+
+    BENCH("memcmp 6 (Bluetooth address)",
+        sink += p_ta->hook_table.memcmp(&src[i & 7], &src[(i & 7) + 8], BT_ADDR_LEN),
+        sink += PrgMemcmp(p_ta, &src[i & 7], &src[(i & 7) + 8], BT_ADDR_LEN));
+
+    return 0;
+}
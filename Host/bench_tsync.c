@@ -0,0 +1,184 @@
+//=============================================================================
+// Benchmark of the time synchronization (Common/prg_tsync.c).
+//
+// Simulates a follower and a reference Controller whose clocks differ by an
+// offset and a drift, connected by a Bluetooth link whose latency is a base
+// latency plus an exponentially distributed jitter per direction. As in
+// StopGoBtButtonPart/StopGoBtMotorPart the follower sends the next request
+// one tick after it has received a reply. Per minute the error of the shared
+// time on the follower is printed, compared with the error of a start
+// command without synchronization (the one-way latency, which is the safety
+// margin a program has to add otherwise).
+//
+//   bench_tsync [-d drift ppm] [-b base latency us] [-j jitter us] [-a asymmetry us] [-t s] [-s seed]
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "prg_tsync.h"
+
+#define REF_START_US        3000000000.0    // reference clock at the start, wraps after 21 minutes
+#define FOLLOWER_START_US   5000000.0
+#define HOLD_MAX_US         1000            // the reference replies in the next tick
+#define WINDOW_S            60
+#define WINDOW_MAX          20000           // samples per window
+
+static double drift_ppm = 30;
+static double base_us = 10000;
+static double jitter_us = 5000;
+static double asym_us = 0;
+static UINT32 seed = 1;
+
+static double err_sync[WINDOW_MAX];
+static double err_naive[WINDOW_MAX];
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Random
+ *
+ * Uniform random number in (0, 1), xorshift32.
+ *-----------------------------------------------------------------------------*/
+static double Random(void)
+{
+    seed ^= seed << 13;
+    seed ^= (seed >> 17) & 0x7FFF;
+    seed ^= seed << 5;
+    seed &= 0xFFFFFFFF;
+    return ((seed >> 8) + 0.5) / 16777216.0;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Latency
+ *-----------------------------------------------------------------------------*/
+static double Latency(void)
+{
+    return base_us - jitter_us * log(Random());
+}
+
+
+// Clocks of the Controllers at the true time t (us), 32-bit as GetSystemTime
+static UINT32 FollowerClock(double t)
+{
+    return (UINT32)fmod(FOLLOWER_START_US + t, 4294967296.0);
+}
+
+static UINT32 RefClock(double t)
+{
+    return (UINT32)fmod(REF_START_US + t * (1 + drift_ppm * 1e-6), 4294967296.0);
+}
+
+
+static int CompareDouble
+(
+    const void * a,
+    const void * b
+)
+{
+    double d = *(const double *)a - *(const double *)b;
+
+    return (d > 0) - (d < 0);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Percentile
+ *-----------------------------------------------------------------------------*/
+static double Percentile
+(
+    double * p_values,
+    UINT32 n,
+    double p
+)
+{
+    return (n) ? p_values[(UINT32)(p * (n - 1))] : 0;
+}
+
+
+int main
+(
+    int argc,
+    char ** argv
+)
+{
+    TSYNC follower, reference;
+    UCHAR8 msg[TSYNC_RSP_LEN];
+    double t = 0, t_end = 600e6, t_window = WINDOW_S * 1e6;
+    double t_recv, t_send;
+    UINT32 n = 0, n_exchanges = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:b:j:a:t:s:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'd': drift_ppm = atof(optarg); break;
+            case 'b': base_us = atof(optarg); break;
+            case 'j': jitter_us = atof(optarg); break;
+            case 'a': asym_us = atof(optarg); break;
+            case 't': t_end = atof(optarg) * 1e6; break;
+            case 's': seed = atoi(optarg) | 1; break;
+            default:
+                fprintf(stderr, "usage: %s [-d drift ppm] [-b base latency us] [-j jitter us] [-a asymmetry us] "
+                    "[-t s] [-s seed]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    TsyncInit(&follower, FALSE);
+    TsyncInit(&reference, TRUE);
+    printf("drift %.1f ppm, latency %.0f us + exp(%.0f us), asymmetry %.0f us\n", drift_ppm, base_us, jitter_us,
+        asym_us);
+    printf("%6s %6s %9s | %-25s | %-25s\n", "t/s", "est.", "drift/ppm", "error synced p50/p99/max us",
+        "error unsynced p50/max us");
+
+    while (t < t_end)
+    {
+        UINT32 follower_now;
+        double one_way_us = Latency() + asym_us;
+
+        // Request, reply in the next tick of the reference and the reply
+        TsyncPutRequest(&follower, FollowerClock(t), msg);
+        t_recv = t + one_way_us;
+        t_send = t_recv + HOLD_MAX_US * Random();
+        TsyncPutReply(&reference, msg, RefClock(t_recv), RefClock(t_send), msg);
+        t = t_send + Latency();
+        TsyncHandleReply(&follower, msg, FollowerClock(t));
+        n_exchanges++;
+
+        // Error of the shared time now, and of a start command sent now without synchronization
+        if (TsyncIsSynced(&follower) && n < WINDOW_MAX)
+        {
+            follower_now = FollowerClock(t);
+            err_sync[n] = fabs((double)(INT32)(TsyncLocalToShared(&follower, follower_now) - RefClock(t)));
+            err_naive[n] = one_way_us;
+            n++;
+        }
+
+        if (t >= t_window)
+        {
+            qsort(err_sync, n, sizeof(double), CompareDouble);
+            qsort(err_naive, n, sizeof(double), CompareDouble);
+            printf("%6.0f %6u %9.2f | %7.0f %8.0f %8.0f | %11.0f %12.0f\n", t_window / 1e6,
+                (unsigned)follower.n_estimates, follower.drift * 1e6 / (1 << TSYNC_DRIFT_SHIFT),
+                Percentile(err_sync, n, 0.5), Percentile(err_sync, n, 0.99), Percentile(err_sync, n, 1),
+                Percentile(err_naive, n, 0.5), Percentile(err_naive, n, 1));
+            n = 0;
+            t_window += WINDOW_S * 1e6;
+        }
+        t += CALL_CYCLE_MS * 1000;
+    }
+    printf("%u exchanges, %u samples dropped, estimated error bound %u us\n", (unsigned)n_exchanges,
+        (unsigned)follower.n_dropped, (unsigned)follower.error_us);
+    return 0;
+}
@@ -0,0 +1,274 @@
+//=============================================================================
+// Check of the Bluetooth peer discovery (Common/prg_bt_scan.c).
+//
+// Feeds the records of the scan-status model of the simulator (FtxSimBtScan)
+// into the module, as the local Controller and as each of its peers, and
+// checks that
+//   - only ROBO TX Controllers are collected, sorted by Bluetooth address;
+//   - all Controllers which see the same devices, in any order, come to the
+//     same channel assignment;
+//   - bt_address_table holds exactly the addresses of the last scan, also
+//     after a rescan which finds fewer devices;
+//   - a scan which ends by timeout assigns the channels as well;
+//   - with more Controllers than the table holds, the ones with the lowest
+//     addresses are kept, in any order of the scan results.
+//
+//   check_bt_scan
+//
+// Returns 1 if a check fails.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ftx_sim.h"
+#include "prg_bt_scan.h"
+
+#define N_CONTROLLERS   4
+#define SCAN_LEN_MAX    (BT_SCAN_TABLE_SIZE + 8)
+#define MANY_PEERS      (BT_SCAN_TABLE_SIZE + 4)
+
+// The native program entry of the simulator is not used, only its hook table
+const struct prg_code_intro_s prg_code_intro =
+{
+    /* magic            */ PRG_MAGIC,
+    /* ta_version       */ {TA_VERSION},
+    /* entry            */ 0
+};
+
+// Controllers in range, in the order of their discovery, and a device which is no Controller
+static const FTX_SIM_BT_PEER devices[] =
+{
+    {{0x00, 0x13, 0x7B, 0x5E, 0x20, 0x07}, "ROBO TX-SORTER"},
+    {{0x00, 0x1A, 0x7D, 0xDA, 0x71, 0x13}, "Phone"},
+    {{0x00, 0x13, 0x7B, 0x11, 0x22, 0x33}, "ROBO TX-GATE"},
+    {{0x00, 0x13, 0x7B, 0x5E, 0x00, 0x41}, "ROBO TX-CRANE"},
+    {{0x00, 0x13, 0x7B, 0x02, 0x00, 0x10}, "ROBO TX-BELT"}
+};
+#define N_DEVICES       (sizeof(devices) / sizeof(devices[0]))
+
+static FTX_SIM sim;
+static UINT32 n_failed;
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Check
+ *-----------------------------------------------------------------------------*/
+static void Check
+(
+    BOOL32 ok,
+    const char * p_what
+)
+{
+    if (!ok)
+    {
+        printf("FAILED: %s\n", p_what);
+        n_failed++;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Become
+ *
+ * Makes the Controller devices[own] the local one and resets the discovery.
+ *-----------------------------------------------------------------------------*/
+static void Become
+(
+    UINT32 own
+)
+{
+    TA * p_ta = &sim.ta[TA_LOCAL];
+
+    snprintf(p_ta->info.device_name, sizeof(p_ta->info.device_name), "%s", devices[own].name);
+    p_ta->hook_table.BtAddrToStr((UCHAR8 *)devices[own].bt_addr, p_ta->info.bt_addr);
+    BtScanReset(p_ta);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Scan
+ *
+ * Runs one scan of the local Controller devices[own] which finds the devices
+ * of the mask (bit i = devices[i]), starting with the device first. Returns
+ * the result of the last BtScanUpdate.
+ *-----------------------------------------------------------------------------*/
+static BOOL32 Scan
+(
+    UINT32 own,
+    UINT32 mask,
+    UINT32 first,
+    UINT32 end_status
+)
+{
+    FTX_SIM_BT_PEER peers[N_DEVICES];
+    BT_SCAN_STATUS status[SCAN_LEN_MAX];
+    UINT32 n_peers = 0, n, i;
+    BOOL32 done = FALSE;
+
+    for (i = 0; i < N_DEVICES; i++)
+    {
+        UINT32 dev = (first + i) % N_DEVICES;
+
+        if (dev != own && (mask & (1 << dev)))
+        {
+            peers[n_peers++] = devices[dev];
+        }
+    }
+    n = FtxSimBtScan(peers, n_peers, end_status, status, SCAN_LEN_MAX);
+    for (i = 0; i < n; i++)
+    {
+        done = BtScanUpdate(&sim.ta[TA_LOCAL], &status[i]);
+    }
+    return done;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : CheckTable
+ *
+ * Checks the table and bt_address_table against the Controllers of the mask.
+ *-----------------------------------------------------------------------------*/
+static void CheckTable
+(
+    UINT32 mask,
+    const char * p_what
+)
+{
+    const BT_SCAN_ENTRY * p_prev = NULL;
+    UINT32 n_ctrl = 0, idx, dev;
+    char what[128];
+
+    for (dev = 0; dev < N_DEVICES; dev++)
+    {
+        n_ctrl += ((mask & (1 << dev)) && strncmp(devices[dev].name, BT_SCAN_NAME_PREFIX,
+            BT_SCAN_NAME_PREFIX_LEN) == 0) ? 1 : 0;
+    }
+    snprintf(what, sizeof(what), "%s: number of Controllers", p_what);
+    Check(BtScanGetCount() == n_ctrl, what);
+
+    for (idx = 0; idx < BtScanGetCount(); idx++)
+    {
+        const BT_SCAN_ENTRY * p_entry = BtScanGetEntry(idx);
+
+        snprintf(what, sizeof(what), "%s: entry %u sorted", p_what, (unsigned)idx);
+        Check(!p_prev || memcmp(p_prev->bt_addr, p_entry->bt_addr, BT_ADDR_LEN) < 0, what);
+        snprintf(what, sizeof(what), "%s: entry %u name", p_what, (unsigned)idx);
+        Check(strncmp(p_entry->name, BT_SCAN_NAME_PREFIX, BT_SCAN_NAME_PREFIX_LEN) == 0, what);
+        snprintf(what, sizeof(what), "%s: entry %u channel", p_what, (unsigned)idx);
+        Check(p_entry->channel == ((p_entry->is_own) ? BT_SCAN_NO_CHANNEL : idx + BT_CHAN_IDX_MIN), what);
+        p_prev = p_entry;
+    }
+
+    for (idx = 0; idx < BT_CNT_MAX; idx++)
+    {
+        static const UCHAR8 none[BT_ADDR_LEN];
+        const BT_SCAN_ENTRY * p_entry = BtScanGetEntry(idx);
+
+        snprintf(what, sizeof(what), "%s: bt_address_table[%u]", p_what, (unsigned)idx);
+        Check(memcmp(bt_address_table[idx], (p_entry) ? p_entry->bt_addr : none, BT_ADDR_LEN) == 0, what);
+    }
+}
+
+
+int main(void)
+{
+    char assignment[N_CONTROLLERS][BT_CNT_MAX][BT_ADDR_LEN];
+    UINT32 all = (1 << N_DEVICES) - 1;
+    UINT32 own, ch;
+    static const UINT32 ctrl[N_CONTROLLERS] = {0, 2, 3, 4};
+
+    FtxSimInit(&sim, NULL, NULL);
+
+    // Every Controller scans, the devices are found in a different order each time
+    for (own = 0; own < N_CONTROLLERS; own++)
+    {
+        Become(ctrl[own]);
+        Check(Scan(ctrl[own], all, own, BT_INQUIRY_SCAN_END), "scan done");
+        Check(BtScanGetState() == BT_SCAN_DONE, "state done");
+        CheckTable(all, "full scan");
+        memcpy(assignment[own], bt_address_table, sizeof(assignment[own]));
+        if (own > 0)
+        {
+            Check(memcmp(assignment[own], assignment[0], sizeof(assignment[own])) == 0, "same assignment");
+        }
+        for (ch = BT_CHAN_IDX_MIN; ch <= BT_CHAN_IDX_MAX; ch++)
+        {
+            const BT_SCAN_ENTRY * p_entry = BtScanGetEntry(ch - BT_CHAN_IDX_MIN);
+            UCHAR8 * p_addr = BtScanGetAddress(ch);
+
+            Check((p_entry && !p_entry->is_own) ? (p_addr == p_entry->bt_addr) : (p_addr == NULL),
+                "address of channel");
+            if (p_entry)
+            {
+                Check(BtScanFindChannel(&sim.ta[TA_LOCAL], p_entry->name) == p_entry->channel, "channel of name");
+            }
+        }
+    }
+
+    // Rescan which finds fewer devices: the rows of the lost ones are cleared
+    own = 0;
+    Become(ctrl[own]);
+    Scan(ctrl[own], all, 0, BT_INQUIRY_SCAN_END);
+    Check(Scan(ctrl[own], (1 << ctrl[own]) | (1 << 4), 0, BT_INQUIRY_SCAN_END), "rescan done");
+    CheckTable((1 << ctrl[own]) | (1 << 4), "rescan");
+
+    // Scan which ends by timeout
+    Check(Scan(ctrl[own], all, 3, BT_INQUIRY_SCAN_TIMEOUT), "timeout done");
+    CheckTable(all, "timeout");
+
+    // A busy scanner does not finish the scan
+    {
+        BT_SCAN_STATUS busy;
+
+        memset(&busy, 0, sizeof(busy));
+        busy.status = BT_INQUIRY_SCAN_BUSY;
+        Check(!BtScanUpdate(&sim.ta[TA_LOCAL], &busy), "busy not done");
+    }
+
+    // More Controllers than the table holds, found in ascending and in descending order:
+    // the lowest addresses are kept (the local Controller has a higher one)
+    {
+        FTX_SIM_BT_PEER many[MANY_PEERS], peers[MANY_PEERS];
+        BT_SCAN_STATUS status[SCAN_LEN_MAX];
+        UINT32 order, idx, n;
+
+        for (idx = 0; idx < MANY_PEERS; idx++)
+        {
+            static const UCHAR8 base[BT_ADDR_LEN] = {0x00, 0x13, 0x7B, 0x00, 0x00, 0x00};
+
+            memcpy(many[idx].bt_addr, base, BT_ADDR_LEN);
+            many[idx].bt_addr[BT_ADDR_LEN - 1] = (UCHAR8)(idx + 1);
+            snprintf(many[idx].name, sizeof(many[idx].name), "%sP%02u", BT_SCAN_NAME_PREFIX, (unsigned)idx);
+        }
+        for (order = 0; order < 2; order++)
+        {
+            for (idx = 0; idx < MANY_PEERS; idx++)
+            {
+                peers[idx] = many[(order) ? MANY_PEERS - 1 - idx : idx];
+            }
+            Become(ctrl[0]);
+            n = FtxSimBtScan(peers, MANY_PEERS, BT_INQUIRY_SCAN_END, status, SCAN_LEN_MAX);
+            for (idx = 0; idx < n; idx++)
+            {
+                BtScanUpdate(&sim.ta[TA_LOCAL], &status[idx]);
+            }
+            Check(BtScanGetCount() == BT_SCAN_TABLE_SIZE, "full table: number of Controllers");
+            for (idx = 0; idx < BtScanGetCount(); idx++)
+            {
+                Check(memcmp(BtScanGetEntry(idx)->bt_addr, many[idx].bt_addr, BT_ADDR_LEN) == 0,
+                    "full table: lowest addresses");
+            }
+        }
+    }
+
+    printf("check_bt_scan: %s\n", (n_failed) ? "FAILED" : "ok");
+    return (n_failed) ? 1 : 0;
+}
@@ -0,0 +1,177 @@
+//=============================================================================
+// Check of the differential load of the program loader (ftx_loader.c).
+//
+// Loads a sequence of images into a loopback stand-in with a manifest cache
+// and checks that the program memory holds each image afterwards and that
+//   - the first load sends the whole image;
+//   - an unchanged image sends nothing;
+//   - code inserted into or removed from the middle of the image sends only
+//     the chunks around the change, the chunks behind it are copied by the
+//     Controller;
+//   - a Controller whose program memory was cleared gets the whole image.
+//
+//   check_loader
+//
+// Returns 1 if a check fails.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ftx_loader.h"
+#include "ftx_loopback.h"
+
+#define IMAGE_SIZE      (150 * 1024)
+#define IMAGE_MAX       (IMAGE_SIZE + 1024)
+#define CHANGE_OFFSET   60000
+
+static FTX_LOOPBACK loopback;
+static FTX_LINK ctrl_link;
+static UCHAR8 image[IMAGE_MAX];
+static UINT32 image_size;
+static UINT32 n_failed;
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Check
+ *-----------------------------------------------------------------------------*/
+static void Check
+(
+    BOOL32 ok,
+    const char * p_what
+)
+{
+    if (!ok)
+    {
+        printf("FAILED: %s\n", p_what);
+        n_failed++;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Fill
+ *
+ * Fills a part of the image with pseudo random bytes.
+ *-----------------------------------------------------------------------------*/
+static void Fill
+(
+    UCHAR8 * p,
+    UINT32 len,
+    UINT32 seed
+)
+{
+    while (len--)
+    {
+        seed = seed * 1103515245 + 12345;
+        *p++ = (UCHAR8)(seed >> 16);
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Load
+ *
+ * Loads the image and checks the program memory of the stand-in. Returns the
+ * number of data bytes sent.
+ *-----------------------------------------------------------------------------*/
+static UINT32 Load
+(
+    const char * cache_dir,
+    const char * p_what,
+    FTX_LOAD_STAT * p_stat
+)
+{
+    FTX_LOAD_PARAM param;
+    char what[128];
+    int rc;
+
+    memset(&param, 0, sizeof(param));
+    param.cache_dir = cache_dir;
+    rc = FtxLoad(&ctrl_link, "check.bin", image, image_size, &param, p_stat);
+    snprintf(what, sizeof(what), "%s: load, error %d", p_what, rc);
+    Check(rc == FTX_OK, what);
+    snprintf(what, sizeof(what), "%s: program memory", p_what);
+    Check(memcmp(loopback.p_prg_mem, image, image_size) == 0, what);
+    printf("%-10s %6u bytes, %3u of %3u chunks sent, %3u moved, %6u bytes in %3u requests\n", p_what,
+        (unsigned)image_size, (unsigned)p_stat->n_sent, (unsigned)p_stat->n_chunks, (unsigned)p_stat->n_moved,
+        (unsigned)p_stat->n_bytes, (unsigned)p_stat->n_requests);
+    return p_stat->n_bytes;
+}
+
+
+int main(void)
+{
+    char cache_dir[] = "/tmp/check_loader.XXXXXX";
+    char path[sizeof(cache_dir) + 64];
+    FTX_LOAD_STAT stat;
+    UINT32 n;
+
+    if (!mkdtemp(cache_dir) || FtxLoopbackStart(&loopback, 0, 0) != FTX_OK ||
+        FtxLinkOpen(&ctrl_link, loopback.dev, 0) != FTX_OK)
+    {
+        printf("check_loader: cannot start the loopback device\n");
+        return 1;
+    }
+
+    // Program header and code
+    image_size = IMAGE_SIZE;
+    image[0] = (UCHAR8)PRG_MAGIC;
+    image[1] = (UCHAR8)(PRG_MAGIC >> 8);
+    image[2] = (UCHAR8)(PRG_MAGIC >> 16);
+    image[3] = (UCHAR8)(PRG_MAGIC >> 24);
+    image[4] = (UCHAR8)TA_VERSION;
+    image[5] = (UCHAR8)(TA_VERSION >> 8);
+    image[6] = (UCHAR8)(TA_VERSION >> 16);
+    image[7] = (UCHAR8)(TA_VERSION >> 24);
+    Fill(&image[FTX_LOAD_HEADER_LEN], image_size - FTX_LOAD_HEADER_LEN, 1);
+
+    n = Load(cache_dir, "first", &stat);
+    Check(n == image_size && !stat.is_diff, "first: whole image");
+
+    n = Load(cache_dir, "unchanged", &stat);
+    Check(n == 0 && stat.n_requests == 0 && stat.is_diff, "unchanged: nothing sent");
+
+    // A function grows by 100 bytes, everything behind it moves
+    memmove(&image[CHANGE_OFFSET + 100], &image[CHANGE_OFFSET], image_size - CHANGE_OFFSET);
+    Fill(&image[CHANGE_OFFSET], 100, 2);
+    image_size += 100;
+    n = Load(cache_dir, "insert", &stat);
+    Check(n <= 100 + 2 * FTX_LOAD_CHUNK_MAX && stat.n_moved > 0, "insert: changed chunks only");
+
+    // A function shrinks by 40 bytes
+    memmove(&image[CHANGE_OFFSET / 2], &image[CHANGE_OFFSET / 2 + 40], image_size - CHANGE_OFFSET / 2 - 40);
+    image_size -= 40;
+    n = Load(cache_dir, "remove", &stat);
+    Check(n <= 2 * FTX_LOAD_CHUNK_MAX && stat.n_moved > 0, "remove: changed chunks only");
+
+    // One byte changes in place
+    image[CHANGE_OFFSET * 2] ^= 0x5A;
+    n = Load(cache_dir, "patch", &stat);
+    Check(n <= 2 * FTX_LOAD_CHUNK_MAX && stat.n_moved == 0, "patch: changed chunks only");
+
+    // The RAM disk was cleared, the manifest is out of date
+    memset(loopback.p_prg_mem, 0, PRG_MEM_SIZE);
+    n = Load(cache_dir, "cleared", &stat);
+    Check(n >= image_size && !stat.is_diff, "cleared: whole image");
+
+    FtxLinkClose(&ctrl_link);
+    FtxLoopbackStop(&loopback);
+    snprintf(path, sizeof(path), "rm -rf %s", cache_dir);
+    if (system(path) != 0)
+    {
+        printf("cannot remove %s\n", cache_dir);
+    }
+
+    printf("check_loader: %s\n", (n_failed) ? "FAILED" : "ok");
+    return (n_failed) ? 1 : 0;
+}
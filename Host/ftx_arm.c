@@ -0,0 +1,1285 @@
+//=============================================================================
+// ARM instruction set interpreter (ARMv5TE, ARM state, user mode).
+//
+// Cycle estimate (ARM9E-S, memory without wait states):
+//   data processing                    1, +1 with a shift by register
+//   multiply MUL/MLA                   2, long multiply 3, +2 with flags
+//   halfword multiply                  1, SMLALxy 2
+//   load and store of one register     1, LDRD/STRD and SWP 2
+//   load and store multiple            number of registers, at least 2
+//   any write of the PC                +2 (pipeline refill), loads +2 more
+//   result latency                     +1 for word loads and multiplies,
+//                                      +2 for byte and halfword loads, if
+//                                      the next instruction uses the result
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <string.h>
+
+#include "ftx_arm.h"
+
+#define BIT(insn, n)            (((insn) >> (n)) & 1)
+#define FIELD(insn, lo, len)    (((insn) >> (lo)) & ((1u << (len)) - 1))
+
+#define ROR32(value, n)         (((value) >> (n)) | ((value) << ((32 - (n)) & 31)))
+
+
+/*-----------------------------------------------------------------------------
+ * Memory
+ *-----------------------------------------------------------------------------*/
+static const FTX_ARM_REGION * FindRegion
+(
+    const FTX_ARM * p_arm,
+    UINT32 addr,
+    UINT32 len
+)
+{
+    const FTX_ARM_REGION * p_region;
+    UINT32 i;
+
+    for (i = 0; i < p_arm->n_regions; i++)
+    {
+        p_region = &p_arm->region[i];
+        if (addr - p_region->base < p_region->size && len <= p_region->size - (addr - p_region->base))
+        {
+            return p_region;
+        }
+    }
+    return NULL;
+}
+
+static UCHAR8 * Access
+(
+    FTX_ARM * p_arm,
+    UINT32 addr,
+    UINT32 len,
+    BOOL32 is_write
+)
+{
+    const FTX_ARM_REGION * p_region = p_arm->p_data;
+
+    if (!p_region || addr - p_region->base >= p_region->size || len > p_region->size - (addr - p_region->base))
+    {
+        p_region = FindRegion(p_arm, addr, len);
+    }
+    if (!p_region || (is_write && !p_region->writable))
+    {
+        if (p_arm->result == FTX_ARM_OK)
+        {
+            p_arm->result = FTX_ARM_ERR_ACCESS;
+            p_arm->fault_addr = addr;
+        }
+        return NULL;
+    }
+    p_arm->p_data = p_region;
+    return p_region->p_mem + (addr - p_region->base);
+}
+
+static UINT32 GetLe
+(
+    const UCHAR8 * p,
+    UINT32 size
+)
+{
+    switch (size)
+    {
+        case 1:     return p[0];
+        case 2:     return p[0] | (p[1] << 8);
+        default:    return p[0] | (p[1] << 8) | (p[2] << 16) | ((UINT32)p[3] << 24);
+    }
+}
+
+static UINT32 Load
+(
+    FTX_ARM * p_arm,
+    UINT32 addr,
+    UINT32 size
+)
+{
+    UCHAR8 * p = Access(p_arm, addr, size, FALSE);
+
+    p_arm->count.loads++;
+    return (p) ? GetLe(p, size) : 0;
+}
+
+static void Store
+(
+    FTX_ARM * p_arm,
+    UINT32 addr,
+    UINT32 value,
+    UINT32 size
+)
+{
+    UCHAR8 * p = Access(p_arm, addr, size, TRUE);
+
+    p_arm->count.stores++;
+    if (p)
+    {
+        p[0] = (UCHAR8)value;
+        if (size >= 2)
+        {
+            p[1] = (UCHAR8)(value >> 8);
+        }
+        if (size == 4)
+        {
+            p[2] = (UCHAR8)(value >> 16);
+            p[3] = (UCHAR8)(value >> 24);
+        }
+    }
+}
+
+// Word load from an unaligned address: the word is rotated (ARMv5)
+static UINT32 LoadWord
+(
+    FTX_ARM * p_arm,
+    UINT32 addr
+)
+{
+    UINT32 value = Load(p_arm, addr & ~3u, 4);
+
+    return ROR32(value, (addr & 3) * 8);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Registers and flags
+ *-----------------------------------------------------------------------------*/
+static UINT32 GetReg
+(
+    FTX_ARM * p_arm,
+    UINT32 n
+)
+{
+    p_arm->read_mask |= 1u << n;
+    return p_arm->r[n];
+}
+
+static void SetReg
+(
+    FTX_ARM * p_arm,
+    UINT32 n,
+    UINT32 value
+)
+{
+    if (n == FTX_ARM_PC)
+    {
+        p_arm->next_pc = value & ~3u;
+    }
+    else
+    {
+        p_arm->r[n] = value;
+    }
+}
+
+// Write of the PC by BX, BLX and loads: bit 0 selects the Thumb state
+static void SetPcInterworking
+(
+    FTX_ARM * p_arm,
+    UINT32 value
+)
+{
+    if (value & 1)
+    {
+        p_arm->result = FTX_ARM_ERR_THUMB;
+        p_arm->fault_addr = value;
+        return;
+    }
+    p_arm->next_pc = value & ~3u;
+}
+
+static void SetNz
+(
+    FTX_ARM * p_arm,
+    UINT32 value
+)
+{
+    p_arm->n = value >> 31;
+    p_arm->z = (value == 0);
+}
+
+static void SetLatency
+(
+    FTX_ARM * p_arm,
+    UINT32 mask,
+    UINT32 cycles
+)
+{
+    p_arm->load_mask = mask;
+    p_arm->load_latency = cycles;
+}
+
+static BOOL32 ConditionPassed
+(
+    const FTX_ARM * p_arm,
+    UINT32 cond
+)
+{
+    switch (cond)
+    {
+        case 0x0:   return p_arm->z;                                    // EQ
+        case 0x1:   return !p_arm->z;                                   // NE
+        case 0x2:   return p_arm->c;                                    // CS
+        case 0x3:   return !p_arm->c;                                   // CC
+        case 0x4:   return p_arm->n;                                    // MI
+        case 0x5:   return !p_arm->n;                                   // PL
+        case 0x6:   return p_arm->v;                                    // VS
+        case 0x7:   return !p_arm->v;                                   // VC
+        case 0x8:   return p_arm->c && !p_arm->z;                       // HI
+        case 0x9:   return !p_arm->c || p_arm->z;                       // LS
+        case 0xA:   return p_arm->n == p_arm->v;                        // GE
+        case 0xB:   return p_arm->n != p_arm->v;                        // LT
+        case 0xC:   return !p_arm->z && p_arm->n == p_arm->v;           // GT
+        case 0xD:   return p_arm->z || p_arm->n != p_arm->v;            // LE
+        default:    return TRUE;                                        // AL
+    }
+}
+
+static UINT32 Saturate
+(
+    FTX_ARM * p_arm,
+    int64_t value
+)
+{
+    if (value > INT32_MAX)
+    {
+        p_arm->q = 1;
+        return 0x7FFFFFFF;
+    }
+    if (value < INT32_MIN)
+    {
+        p_arm->q = 1;
+        return 0x80000000;
+    }
+    return (UINT32)value;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Shifter
+ *-----------------------------------------------------------------------------*/
+// Shift with the semantics of a shift by register (amount 0...255)
+static UINT32 Shift
+(
+    UINT32 value,
+    UINT32 type,
+    UINT32 amount,
+    UINT32 c_in,
+    UINT32 * p_c
+)
+{
+    *p_c = c_in;
+    if (amount == 0)
+    {
+        return value;
+    }
+    switch (type)
+    {
+        case 0: // LSL
+            if (amount < 32)
+            {
+                *p_c = (value >> (32 - amount)) & 1;
+                return value << amount;
+            }
+            *p_c = (amount == 32) ? value & 1 : 0;
+            return 0;
+
+        case 1: // LSR
+            if (amount < 32)
+            {
+                *p_c = (value >> (amount - 1)) & 1;
+                return value >> amount;
+            }
+            *p_c = (amount == 32) ? value >> 31 : 0;
+            return 0;
+
+        case 2: // ASR
+            if (amount < 32)
+            {
+                *p_c = (value >> (amount - 1)) & 1;
+                return (UINT32)((int32_t)value >> amount);
+            }
+            *p_c = value >> 31;
+            return (value >> 31) ? 0xFFFFFFFF : 0;
+
+        default: // ROR
+            amount &= 31;
+            value = ROR32(value, amount);
+            *p_c = value >> 31;
+            return value;
+    }
+}
+
+// Register operand shifted by an immediate (bits 11-0 of data processing and loads)
+static UINT32 ShiftImm
+(
+    FTX_ARM * p_arm,
+    UINT32 insn,
+    UINT32 * p_c
+)
+{
+    UINT32 type = FIELD(insn, 5, 2);
+    UINT32 amount = FIELD(insn, 7, 5);
+    UINT32 value = GetReg(p_arm, FIELD(insn, 0, 4));
+
+    if (amount == 0)
+    {
+        if (type == 1 || type == 2)
+        {
+            amount = 32;
+        }
+        else if (type == 3)
+        {
+            *p_c = value & 1; // RRX
+            return (p_arm->c << 31) | (value >> 1);
+        }
+    }
+    return Shift(value, type, amount, p_arm->c, p_c);
+}
+
+// Second operand of data processing
+static UINT32 Operand2
+(
+    FTX_ARM * p_arm,
+    UINT32 insn,
+    UINT32 * p_c
+)
+{
+    UINT32 rm, value, amount;
+
+    if (BIT(insn, 25))
+    {
+        UINT32 rot = FIELD(insn, 8, 4) * 2;
+
+        value = ROR32(insn & 0xFF, rot);
+        *p_c = (rot) ? value >> 31 : p_arm->c;
+        return value;
+    }
+    if (!BIT(insn, 4))
+    {
+        return ShiftImm(p_arm, insn, p_c);
+    }
+
+    // Shift by register: one more cycle, the PC reads 4 bytes further
+    p_arm->count.cycles++;
+    rm = FIELD(insn, 0, 4);
+    amount = GetReg(p_arm, FIELD(insn, 8, 4)) & 0xFF;
+    value = GetReg(p_arm, rm) + ((rm == FTX_ARM_PC) ? 4 : 0);
+    return Shift(value, FIELD(insn, 5, 2), amount, p_arm->c, p_c);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Instructions
+ *-----------------------------------------------------------------------------*/
+static void Undefined
+(
+    FTX_ARM * p_arm
+)
+{
+    p_arm->result = FTX_ARM_ERR_UNDEF;
+}
+
+static void DataProcessing
+(
+    FTX_ARM * p_arm,
+    UINT32 insn
+)
+{
+    UINT32 op = FIELD(insn, 21, 4);
+    UINT32 rn = FIELD(insn, 16, 4);
+    UINT32 rd = FIELD(insn, 12, 4);
+    UINT32 a = 0, b, res, c;
+    UINT32 c_out, v_out = p_arm->v;
+    uint64_t wide;
+
+    b = Operand2(p_arm, insn, &c_out);
+    if (op != 0xD && op != 0xF) // MOV and MVN have no first operand
+    {
+        a = GetReg(p_arm, rn) + ((rn == FTX_ARM_PC && !BIT(insn, 25) && BIT(insn, 4)) ? 4 : 0);
+    }
+
+    switch (op)
+    {
+        case 0x0: case 0x8: res = a & b; break;                     // AND, TST
+        case 0x1: case 0x9: res = a ^ b; break;                     // EOR, TEQ
+        case 0xC:           res = a | b; break;                     // ORR
+        case 0xD:           res = b; break;                         // MOV
+        case 0xE:           res = a & ~b; break;                    // BIC
+        case 0xF:           res = ~b; break;                        // MVN
+
+        case 0x2: case 0xA:                                         // SUB, CMP
+            res = a - b;
+            c_out = (a >= b);
+            v_out = ((a ^ b) & (a ^ res)) >> 31;
+            break;
+        case 0x3:                                                   // RSB
+            res = b - a;
+            c_out = (b >= a);
+            v_out = ((b ^ a) & (b ^ res)) >> 31;
+            break;
+        case 0x4: case 0xB:                                         // ADD, CMN
+            wide = (uint64_t)a + b;
+            res = (UINT32)wide;
+            c_out = (UINT32)(wide >> 32);
+            v_out = (~(a ^ b) & (a ^ res)) >> 31;
+            break;
+        case 0x5:                                                   // ADC
+            wide = (uint64_t)a + b + p_arm->c;
+            res = (UINT32)wide;
+            c_out = (UINT32)(wide >> 32);
+            v_out = (~(a ^ b) & (a ^ res)) >> 31;
+            break;
+        case 0x6:                                                   // SBC
+            c = !p_arm->c;
+            res = a - b - c;
+            c_out = ((uint64_t)a >= (uint64_t)b + c);
+            v_out = ((a ^ b) & (a ^ res)) >> 31;
+            break;
+        default:                                                    // RSC
+            c = !p_arm->c;
+            res = b - a - c;
+            c_out = ((uint64_t)b >= (uint64_t)a + c);
+            v_out = ((b ^ a) & (b ^ res)) >> 31;
+            break;
+    }
+
+    if (BIT(insn, 20))
+    {
+        // With the PC as destination the flags would come from the SPSR,
+        // which does not exist in user mode: they are left unchanged
+        if (rd != FTX_ARM_PC || (op >= 0x8 && op <= 0xB))
+        {
+            SetNz(p_arm, res);
+            p_arm->c = c_out;
+            p_arm->v = v_out;
+        }
+    }
+    if (op < 0x8 || op > 0xB)
+    {
+        SetReg(p_arm, rd, res);
+    }
+}
+
+static void Multiply
+(
+    FTX_ARM * p_arm,
+    UINT32 insn
+)
+{
+    UINT32 rd_hi = FIELD(insn, 16, 4);
+    UINT32 rd_lo = FIELD(insn, 12, 4);
+    UINT32 rs = GetReg(p_arm, FIELD(insn, 8, 4));
+    UINT32 rm = GetReg(p_arm, FIELD(insn, 0, 4));
+    BOOL32 set_flags = BIT(insn, 20);
+    uint64_t wide;
+    UINT32 res;
+
+    if (!BIT(insn, 23))
+    {
+        // MUL, MLA: Rd is bits 19-16, Rn bits 15-12
+        res = rm * rs;
+        if (BIT(insn, 21))
+        {
+            res += GetReg(p_arm, rd_lo);
+        }
+        SetReg(p_arm, rd_hi, res);
+        if (set_flags)
+        {
+            SetNz(p_arm, res);
+        }
+        p_arm->count.cycles += (set_flags) ? 3 : 1;
+        SetLatency(p_arm, 1u << rd_hi, 1);
+        return;
+    }
+
+    // UMULL, UMLAL, SMULL, SMLAL
+    if (BIT(insn, 22))
+    {
+        wide = (uint64_t)((int64_t)(int32_t)rm * (int32_t)rs);
+    }
+    else
+    {
+        wide = (uint64_t)rm * rs;
+    }
+    if (BIT(insn, 21))
+    {
+        wide += ((uint64_t)GetReg(p_arm, rd_hi) << 32) | GetReg(p_arm, rd_lo);
+    }
+    SetReg(p_arm, rd_lo, (UINT32)wide);
+    SetReg(p_arm, rd_hi, (UINT32)(wide >> 32));
+    if (set_flags)
+    {
+        p_arm->n = (UINT32)(wide >> 63);
+        p_arm->z = (wide == 0);
+    }
+    p_arm->count.cycles += (set_flags) ? 4 : 2;
+    SetLatency(p_arm, (1u << rd_lo) | (1u << rd_hi), 1);
+}
+
+static void Swap
+(
+    FTX_ARM * p_arm,
+    UINT32 insn
+)
+{
+    UINT32 addr = GetReg(p_arm, FIELD(insn, 16, 4));
+    UINT32 value = GetReg(p_arm, FIELD(insn, 0, 4));
+    UINT32 rd = FIELD(insn, 12, 4);
+    UINT32 tmp;
+
+    if (BIT(insn, 22))
+    {
+        tmp = Load(p_arm, addr, 1);
+        Store(p_arm, addr, value, 1);
+    }
+    else
+    {
+        tmp = LoadWord(p_arm, addr);
+        Store(p_arm, addr & ~3u, value, 4);
+    }
+    SetReg(p_arm, rd, tmp);
+    p_arm->count.cycles++;
+    SetLatency(p_arm, 1u << rd, 1);
+}
+
+// LDRH, STRH, LDRSB, LDRSH, LDRD, STRD
+static void LoadStoreExtra
+(
+    FTX_ARM * p_arm,
+    UINT32 insn
+)
+{
+    UINT32 rn = FIELD(insn, 16, 4);
+    UINT32 rd = FIELD(insn, 12, 4);
+    UINT32 sh = FIELD(insn, 5, 2);
+    BOOL32 is_load = BIT(insn, 20);
+    UINT32 base, offset, addr, value = 0;
+
+    offset = (BIT(insn, 22)) ? (FIELD(insn, 8, 4) << 4) | FIELD(insn, 0, 4) : GetReg(p_arm, FIELD(insn, 0, 4));
+    base = GetReg(p_arm, rn);
+    offset = (BIT(insn, 23)) ? offset : 0 - offset;
+    addr = (BIT(insn, 24)) ? base + offset : base;
+
+    if (!is_load && sh != 1)
+    {
+        // LDRD (sh 2) and STRD (sh 3) of an even register pair
+        if (rd & 1)
+        {
+            Undefined(p_arm);
+            return;
+        }
+        if (sh == 2)
+        {
+            value = Load(p_arm, addr & ~3u, 4);
+            SetReg(p_arm, rd + 1, Load(p_arm, (addr & ~3u) + 4, 4));
+            SetLatency(p_arm, 1u << (rd + 1), 1);
+        }
+        else
+        {
+            Store(p_arm, addr & ~3u, GetReg(p_arm, rd), 4);
+            Store(p_arm, (addr & ~3u) + 4, GetReg(p_arm, rd + 1), 4);
+        }
+        p_arm->count.cycles++;
+    }
+    else if (!is_load)
+    {
+        Store(p_arm, addr & ~1u, GetReg(p_arm, rd), 2);
+    }
+    else
+    {
+        switch (sh)
+        {
+            case 1:     value = Load(p_arm, addr & ~1u, 2); break;
+            case 2:     value = (UINT32)(int32_t)(int8_t)Load(p_arm, addr, 1); break;
+            default:    value = (UINT32)(int32_t)(int16_t)Load(p_arm, addr & ~1u, 2); break;
+        }
+        SetLatency(p_arm, 1u << rd, 2);
+    }
+
+    if (!BIT(insn, 24) || BIT(insn, 21))
+    {
+        SetReg(p_arm, rn, base + offset);
+    }
+    if (is_load || sh == 2)
+    {
+        SetReg(p_arm, rd, value);   // after the write back: a loaded base register keeps the loaded value
+    }
+}
+
+// LDR, STR, LDRB, STRB
+static void LoadStore
+(
+    FTX_ARM * p_arm,
+    UINT32 insn
+)
+{
+    UINT32 rn = FIELD(insn, 16, 4);
+    UINT32 rd = FIELD(insn, 12, 4);
+    BOOL32 is_byte = BIT(insn, 22);
+    UINT32 base, offset, addr, value, c;
+
+    offset = (BIT(insn, 25)) ? ShiftImm(p_arm, insn, &c) : FIELD(insn, 0, 12);
+    base = GetReg(p_arm, rn);
+    offset = (BIT(insn, 23)) ? offset : 0 - offset;
+    addr = (BIT(insn, 24)) ? base + offset : base;
+
+    if (!BIT(insn, 20))
+    {
+        value = GetReg(p_arm, rd);
+        if (is_byte)
+        {
+            Store(p_arm, addr, value, 1);
+        }
+        else
+        {
+            Store(p_arm, addr & ~3u, value, 4);
+        }
+        if (!BIT(insn, 24) || BIT(insn, 21))
+        {
+            SetReg(p_arm, rn, base + offset);
+        }
+        return;
+    }
+
+    value = (is_byte) ? Load(p_arm, addr, 1) : LoadWord(p_arm, addr);
+    if (!BIT(insn, 24) || BIT(insn, 21))
+    {
+        SetReg(p_arm, rn, base + offset);
+    }
+    if (rd == FTX_ARM_PC)
+    {
+        SetPcInterworking(p_arm, value);
+        p_arm->count.cycles += 2;
+    }
+    else
+    {
+        SetReg(p_arm, rd, value);
+        SetLatency(p_arm, 1u << rd, (is_byte) ? 2 : 1);
+    }
+}
+
+// LDM, STM
+static void BlockTransfer
+(
+    FTX_ARM * p_arm,
+    UINT32 insn
+)
+{
+    UINT32 rn = FIELD(insn, 16, 4);
+    UINT32 list = FIELD(insn, 0, 16);
+    UINT32 n = __builtin_popcount(list);
+    UINT32 base, addr, new_base, last = 0;
+    UINT32 value[16];
+    UINT32 i;
+
+    if (n == 0 || BIT(insn, 22)) // user bank transfer and exception return are not supported
+    {
+        Undefined(p_arm);
+        return;
+    }
+
+    base = GetReg(p_arm, rn);
+    new_base = (BIT(insn, 23)) ? base + 4 * n : base - 4 * n;
+    addr = (BIT(insn, 23)) ? base : new_base;
+    if (BIT(insn, 24) == BIT(insn, 23))
+    {
+        addr += 4; // IB, DA
+    }
+    addr &= ~3u;
+    p_arm->count.cycles += ((n > 2) ? n : 2) - 1;
+
+    if (!BIT(insn, 20))
+    {
+        for (i = 0; i < 16; i++)
+        {
+            if (BIT(list, i))
+            {
+                Store(p_arm, addr, GetReg(p_arm, i), 4);
+                addr += 4;
+            }
+        }
+        if (BIT(insn, 21))
+        {
+            SetReg(p_arm, rn, new_base);
+        }
+        return;
+    }
+
+    for (i = 0; i < 16; i++)
+    {
+        if (BIT(list, i))
+        {
+            value[i] = Load(p_arm, addr, 4);
+            addr += 4;
+            last = i;
+        }
+    }
+    if (BIT(insn, 21))
+    {
+        SetReg(p_arm, rn, new_base);
+    }
+    for (i = 0; i < FTX_ARM_PC; i++)
+    {
+        if (BIT(list, i))
+        {
+            SetReg(p_arm, i, value[i]);
+        }
+    }
+    if (BIT(list, FTX_ARM_PC))
+    {
+        SetPcInterworking(p_arm, value[FTX_ARM_PC]);
+        p_arm->count.cycles += 2;
+    }
+    else
+    {
+        SetLatency(p_arm, 1u << last, 1);
+    }
+}
+
+static void Branch
+(
+    FTX_ARM * p_arm,
+    UINT32 insn
+)
+{
+    UINT32 offset = (UINT32)((int32_t)(insn << 8) >> 6);
+
+    if (BIT(insn, 24))
+    {
+        p_arm->r[FTX_ARM_LR] = p_arm->r[FTX_ARM_PC] - 4;
+    }
+    p_arm->next_pc = p_arm->r[FTX_ARM_PC] + offset;
+}
+
+static void Msr
+(
+    FTX_ARM * p_arm,
+    UINT32 insn,
+    UINT32 value
+)
+{
+    if (BIT(insn, 22)) // SPSR
+    {
+        Undefined(p_arm);
+        return;
+    }
+    // Only the flags can be written in user mode
+    if (BIT(insn, 19))
+    {
+        p_arm->n = value >> 31;
+        p_arm->z = (value >> 30) & 1;
+        p_arm->c = (value >> 29) & 1;
+        p_arm->v = (value >> 28) & 1;
+        p_arm->q = (value >> 27) & 1;
+    }
+}
+
+// Signed multiplies of halfwords (ARMv5TE)
+static void MultiplyHalf
+(
+    FTX_ARM * p_arm,
+    UINT32 insn
+)
+{
+    UINT32 rd = FIELD(insn, 16, 4);
+    UINT32 rn = FIELD(insn, 12, 4);
+    UINT32 rs = GetReg(p_arm, FIELD(insn, 8, 4));
+    UINT32 rm = GetReg(p_arm, FIELD(insn, 0, 4));
+    int32_t x = (int16_t)((BIT(insn, 5)) ? rm >> 16 : rm);
+    int32_t y = (int16_t)((BIT(insn, 6)) ? rs >> 16 : rs);
+    int64_t acc, res;
+    uint64_t wide;
+
+    switch (FIELD(insn, 21, 2))
+    {
+        case 0: // SMLAxy
+            acc = (int32_t)GetReg(p_arm, rn);
+            res = (int64_t)(x * y) + acc;
+            p_arm->q |= (res != (int32_t)res);
+            SetReg(p_arm, rd, (UINT32)res);
+            break;
+
+        case 1: // SMLAWy, SMULWy
+            res = ((int64_t)(int32_t)rm * y) >> 16;
+            if (!BIT(insn, 5))
+            {
+                res += (int32_t)GetReg(p_arm, rn);
+                p_arm->q |= (res != (int32_t)res);
+            }
+            SetReg(p_arm, rd, (UINT32)res);
+            break;
+
+        case 2: // SMLALxy
+            wide = ((uint64_t)GetReg(p_arm, rd) << 32) | GetReg(p_arm, rn);
+            wide += (uint64_t)(int64_t)(x * y);
+            SetReg(p_arm, rn, (UINT32)wide);
+            SetReg(p_arm, rd, (UINT32)(wide >> 32));
+            p_arm->count.cycles++;
+            SetLatency(p_arm, (1u << rd) | (1u << rn), 1);
+            return;
+
+        default: // SMULxy
+            SetReg(p_arm, rd, (UINT32)(x * y));
+            break;
+    }
+    SetLatency(p_arm, 1u << rd, 1);
+}
+
+// Miscellaneous instructions: data processing space with TST...CMN without flags
+static void Miscellaneous
+(
+    FTX_ARM * p_arm,
+    UINT32 insn
+)
+{
+    UINT32 op = FIELD(insn, 21, 2);
+    UINT32 rd = FIELD(insn, 12, 4);
+    UINT32 rm = FIELD(insn, 0, 4);
+    UINT32 value;
+    int64_t a, b;
+
+    if (BIT(insn, 7))
+    {
+        MultiplyHalf(p_arm, insn);
+        return;
+    }
+
+    switch (FIELD(insn, 4, 3))
+    {
+        case 0: // MRS, MSR
+            if (op & 1)
+            {
+                Msr(p_arm, insn, GetReg(p_arm, rm));
+            }
+            else if (op == 0)
+            {
+                SetReg(p_arm, rd, (p_arm->n << 31) | (p_arm->z << 30) | (p_arm->c << 29) | (p_arm->v << 28) |
+                    (p_arm->q << 27) | 0x10);
+            }
+            else
+            {
+                Undefined(p_arm);
+            }
+            break;
+
+        case 1: // BX, CLZ
+            if (op == 1)
+            {
+                SetPcInterworking(p_arm, GetReg(p_arm, rm));
+            }
+            else if (op == 3)
+            {
+                value = GetReg(p_arm, rm);
+                SetReg(p_arm, rd, (value) ? __builtin_clz(value) : 32);
+            }
+            else
+            {
+                Undefined(p_arm);
+            }
+            break;
+
+        case 3: // BLX
+            if (op == 1)
+            {
+                value = GetReg(p_arm, rm);
+                p_arm->r[FTX_ARM_LR] = p_arm->r[FTX_ARM_PC] - 4;
+                SetPcInterworking(p_arm, value);
+            }
+            else
+            {
+                Undefined(p_arm);
+            }
+            break;
+
+        case 5: // QADD, QSUB, QDADD, QDSUB
+            a = (int32_t)GetReg(p_arm, rm);
+            b = (int32_t)GetReg(p_arm, FIELD(insn, 16, 4));
+            if (op & 2)
+            {
+                b = (int32_t)Saturate(p_arm, 2 * b);
+            }
+            SetReg(p_arm, rd, Saturate(p_arm, (op & 1) ? a - b : a + b));
+            SetLatency(p_arm, 1u << rd, 1);
+            break;
+
+        default: // BKPT and undefined
+            Undefined(p_arm);
+            break;
+    }
+}
+
+static void Execute
+(
+    FTX_ARM * p_arm,
+    UINT32 insn
+)
+{
+    UINT32 cond = insn >> 28;
+
+    if (cond == 0xF)
+    {
+        if ((insn & 0x0D70F000) == 0x0550F000)
+        {
+            return; // PLD
+        }
+        p_arm->result = ((insn & 0x0E000000) == 0x0A000000) ? FTX_ARM_ERR_THUMB : FTX_ARM_ERR_UNDEF; // BLX <imm>
+        return;
+    }
+    if (!ConditionPassed(p_arm, cond))
+    {
+        return;
+    }
+
+    switch (FIELD(insn, 25, 3))
+    {
+        case 0:
+            if ((insn & 0x90) == 0x90)
+            {
+                if (insn & 0x60)
+                {
+                    LoadStoreExtra(p_arm, insn);
+                }
+                else if ((insn & 0x0FC000F0) == 0x00000090 || (insn & 0x0F8000F0) == 0x00800090)
+                {
+                    Multiply(p_arm, insn);
+                }
+                else if ((insn & 0x0FB00FF0) == 0x01000090)
+                {
+                    Swap(p_arm, insn);
+                }
+                else
+                {
+                    Undefined(p_arm);
+                }
+            }
+            else if ((insn & 0x01900000) == 0x01000000)
+            {
+                Miscellaneous(p_arm, insn);
+            }
+            else
+            {
+                DataProcessing(p_arm, insn);
+            }
+            break;
+
+        case 1:
+            if ((insn & 0x01900000) == 0x01000000)
+            {
+                if (BIT(insn, 21))
+                {
+                    Msr(p_arm, insn, ROR32(insn & 0xFF, FIELD(insn, 8, 4) * 2));
+                }
+                else
+                {
+                    Undefined(p_arm);
+                }
+            }
+            else
+            {
+                DataProcessing(p_arm, insn);
+            }
+            break;
+
+        case 3:
+            if (BIT(insn, 4))
+            {
+                Undefined(p_arm);
+                break;
+            }
+            // fall through
+        case 2:
+            LoadStore(p_arm, insn);
+            break;
+
+        case 4:
+            BlockTransfer(p_arm, insn);
+            break;
+
+        case 5:
+            Branch(p_arm, insn);
+            break;
+
+        default: // coprocessors, SWI
+            Undefined(p_arm);
+            break;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxArmInit
+ *-----------------------------------------------------------------------------*/
+void FtxArmInit
+(
+    FTX_ARM * p_arm,
+    FTX_ARM_TRAP p_trap,
+    void * p_user
+)
+{
+    memset(p_arm, 0, sizeof(*p_arm));
+    p_arm->Trap = p_trap;
+    p_arm->p_user = p_user;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxArmMap
+ *-----------------------------------------------------------------------------*/
+BOOL32 FtxArmMap
+(
+    FTX_ARM * p_arm,
+    UINT32 base,
+    UINT32 size,
+    void * p_mem,
+    BOOL32 writable
+)
+{
+    FTX_ARM_REGION * p_region;
+    UINT32 i;
+
+    if (p_arm->n_regions >= FTX_ARM_REGIONS_MAX || size == 0 || base + (size - 1) < base ||
+        base + (size - 1) >= FTX_ARM_TRAP_BASE)
+    {
+        return FALSE;
+    }
+    for (i = 0; i < p_arm->n_regions; i++)
+    {
+        p_region = &p_arm->region[i];
+        if (base < p_region->base + p_region->size && p_region->base < base + size)
+        {
+            return FALSE;
+        }
+    }
+
+    p_region = &p_arm->region[p_arm->n_regions++];
+    p_region->base = base;
+    p_region->size = size;
+    p_region->p_mem = p_mem;
+    p_region->writable = writable;
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxArmPtr / FtxArmStr / FtxArmAddr
+ *-----------------------------------------------------------------------------*/
+void * FtxArmPtr
+(
+    FTX_ARM * p_arm,
+    UINT32 addr,
+    UINT32 len
+)
+{
+    const FTX_ARM_REGION * p_region = FindRegion(p_arm, addr, (len) ? len : 1);
+
+    return (p_region) ? p_region->p_mem + (addr - p_region->base) : NULL;
+}
+
+char * FtxArmStr
+(
+    FTX_ARM * p_arm,
+    UINT32 addr
+)
+{
+    const FTX_ARM_REGION * p_region = FindRegion(p_arm, addr, 1);
+    char * p;
+
+    if (!p_region)
+    {
+        return NULL;
+    }
+    p = (char *)p_region->p_mem + (addr - p_region->base);
+    return (memchr(p, '\0', p_region->size - (addr - p_region->base))) ? p : NULL;
+}
+
+UINT32 FtxArmAddr
+(
+    FTX_ARM * p_arm,
+    const void * p
+)
+{
+    const FTX_ARM_REGION * p_region;
+    UINT32 i;
+
+    for (i = 0; i < p_arm->n_regions; i++)
+    {
+        p_region = &p_arm->region[i];
+        if ((const UCHAR8 *)p >= p_region->p_mem && (const UCHAR8 *)p < p_region->p_mem + p_region->size)
+        {
+            return p_region->base + (UINT32)((const UCHAR8 *)p - p_region->p_mem);
+        }
+    }
+    return 0;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxArmArg
+ *-----------------------------------------------------------------------------*/
+UINT32 FtxArmArg
+(
+    FTX_ARM * p_arm,
+    UINT32 idx
+)
+{
+    UCHAR8 * p;
+
+    if (idx < 4)
+    {
+        return p_arm->r[idx];
+    }
+    p = FtxArmPtr(p_arm, p_arm->r[FTX_ARM_SP] + 4 * (idx - 4), 4);
+    return (p) ? GetLe(p, 4) : 0;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxArmCall
+ *-----------------------------------------------------------------------------*/
+UINT32 FtxArmCall
+(
+    FTX_ARM * p_arm,
+    UINT32 addr,
+    const UINT32 * p_args,
+    UINT32 n_args,
+    UINT32 * p_ret
+)
+{
+    FTX_ARM saved = *p_arm;
+    uint64_t insns_max = (p_arm->insn_limit) ? p_arm->count.insns + p_arm->insn_limit : 0;
+    const FTX_ARM_REGION * p_region = p_arm->p_fetch;
+    UINT32 load_mask, load_latency;
+    UINT32 result, pc, insn, i;
+
+    for (i = 0; i < n_args && i < 4; i++)
+    {
+        p_arm->r[i] = p_args[i];
+    }
+    p_arm->r[FTX_ARM_LR] = FTX_ARM_RETURN;
+    p_arm->r[FTX_ARM_PC] = addr;
+    p_arm->result = FTX_ARM_OK;
+    p_arm->load_mask = 0;
+
+    while (p_arm->result == FTX_ARM_OK)
+    {
+        pc = p_arm->r[FTX_ARM_PC];
+
+        // Calls of the firmware
+        if (pc >= FTX_ARM_TRAP_BASE)
+        {
+            if (pc == FTX_ARM_RETURN)
+            {
+                break;
+            }
+            p_arm->fault_pc = pc;
+            if (!p_arm->Trap || (pc & 3))
+            {
+                p_arm->result = FTX_ARM_ERR_FETCH;
+                p_arm->fault_addr = pc;
+                break;
+            }
+            p_arm->count.traps++;
+            result = p_arm->Trap(p_arm, (pc - FTX_ARM_TRAP_BASE) / 4);
+            if (result != FTX_ARM_OK)
+            {
+                p_arm->result = result;
+                break;
+            }
+            p_arm->r[FTX_ARM_PC] = p_arm->r[FTX_ARM_LR] & ~3u;
+            p_arm->load_mask = 0;
+            continue;
+        }
+
+        if (!p_region || pc - p_region->base >= p_region->size || p_region->size - (pc - p_region->base) < 4)
+        {
+            p_region = FindRegion(p_arm, pc, 4);
+            p_arm->p_fetch = p_region;
+            if (!p_region || (pc & 3))
+            {
+                p_arm->result = FTX_ARM_ERR_FETCH;
+                p_arm->fault_addr = p_arm->fault_pc = pc;
+                break;
+            }
+        }
+        insn = GetLe(p_region->p_mem + (pc - p_region->base), 4);
+
+        p_arm->r[FTX_ARM_PC] = pc + 8;
+        p_arm->next_pc = pc + 4;
+        p_arm->read_mask = 0;
+        load_mask = p_arm->load_mask;
+        load_latency = p_arm->load_latency;
+        p_arm->load_mask = 0;
+        p_arm->count.insns++;
+        p_arm->count.cycles++;
+
+        Execute(p_arm, insn);
+
+        if (p_arm->read_mask & load_mask)
+        {
+            p_arm->count.cycles += load_latency;
+        }
+        if (p_arm->next_pc != pc + 4)
+        {
+            p_arm->count.cycles += 2;
+        }
+        if (p_arm->result != FTX_ARM_OK)
+        {
+            p_arm->fault_pc = pc;
+            break;
+        }
+        p_arm->r[FTX_ARM_PC] = p_arm->next_pc;
+        if (insns_max && p_arm->count.insns >= insns_max)
+        {
+            p_arm->result = FTX_ARM_ERR_LIMIT;
+            p_arm->fault_pc = p_arm->next_pc;
+        }
+    }
+
+    if (p_ret)
+    {
+        *p_ret = p_arm->r[0];
+    }
+    result = p_arm->result;
+
+    // Restore the state of the caller, keep the counters and the fault
+    memcpy(p_arm->r, saved.r, sizeof(p_arm->r));
+    p_arm->n = saved.n;
+    p_arm->z = saved.z;
+    p_arm->c = saved.c;
+    p_arm->v = saved.v;
+    p_arm->q = saved.q;
+    p_arm->result = saved.result;
+    p_arm->next_pc = saved.next_pc;
+    p_arm->read_mask = saved.read_mask;
+    p_arm->load_mask = saved.load_mask;
+    p_arm->load_latency = saved.load_latency;
+    return result;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxArmResultName
+ *-----------------------------------------------------------------------------*/
+const char * FtxArmResultName
+(
+    UINT32 result
+)
+{
+    switch (result)
+    {
+        case FTX_ARM_OK:            return "ok";
+        case FTX_ARM_ERR_FETCH:     return "instruction fetch outside of the memory";
+        case FTX_ARM_ERR_ACCESS:    return "data access outside of the memory";
+        case FTX_ARM_ERR_UNDEF:     return "instruction not supported";
+        case FTX_ARM_ERR_THUMB:     return "switch to the Thumb state";
+        case FTX_ARM_ERR_LIMIT:     return "instruction limit reached";
+        case FTX_ARM_ERR_TRAP:      return "firmware call failed";
+        default:                    return "unknown error";
+    }
+}
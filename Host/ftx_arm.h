@@ -0,0 +1,189 @@
+//=============================================================================
+// Header file of the ARM instruction set interpreter.
+// Executes the ARM state instruction set of the ARMv5TE architecture (the
+// ARM9E core of the ROBO TX Controller) in user mode, to run program images
+// built by the Demo makefiles on the PC. No Thumb state, no coprocessors,
+// no exceptions: an instruction which needs them stops the execution.
+//
+// The memory consists of regions of host memory mapped to guest addresses.
+// Calls of addresses from FTX_ARM_TRAP_BASE on are not executed but handed
+// over to the trap function (the hook functions of the firmware), which
+// gets the arguments with FtxArmArg and returns to the caller.
+//
+// The interpreter counts the executed instructions, the data memory
+// accesses and an estimate of the core cycles from the instruction timing
+// of the ARM9E-S: memory without wait states (caches always hit), interlocks
+// only for the result latency of loads and multiplies.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __FTX_ARM_H__
+#define __FTX_ARM_H__
+
+#include <stdint.h>
+
+#include "ROBO_TX_PRG.h"
+
+#define FTX_ARM_REGIONS_MAX     8
+#define FTX_ARM_TRAP_BASE       0xFFFF0000  // first trap address
+#define FTX_ARM_RETURN          0xFFFFFFF0  // return address of FtxArmCall
+
+#define FTX_ARM_SP              13
+#define FTX_ARM_LR              14
+#define FTX_ARM_PC              15
+
+
+// Results of the execution
+enum ftx_arm_result_e
+{
+    FTX_ARM_OK = 0,
+    FTX_ARM_ERR_FETCH,          // instruction fetch outside of the memory
+    FTX_ARM_ERR_ACCESS,         // data access outside of the memory or to read-only memory
+    FTX_ARM_ERR_UNDEF,          // instruction not supported
+    FTX_ARM_ERR_THUMB,          // switch to the Thumb state
+    FTX_ARM_ERR_LIMIT,          // too many instructions in one call
+    FTX_ARM_ERR_TRAP            // trap function failed
+};
+
+
+// Memory region
+typedef struct
+{
+    UINT32          base;           // guest address
+    UINT32          size;
+    UCHAR8        * p_mem;
+    BOOL32          writable;
+} FTX_ARM_REGION;
+
+
+// Counters
+typedef struct
+{
+    uint64_t        insns;          // executed instructions, including those with a failed condition
+    uint64_t        cycles;         // estimated core cycles
+    uint64_t        loads;          // data reads, one per transferred register
+    uint64_t        stores;         // data writes, one per transferred register
+    uint64_t        traps;          // calls of the trap function
+} FTX_ARM_COUNT;
+
+
+struct ftx_arm_s;
+
+// Trap function: called for a call of FTX_ARM_TRAP_BASE + 4 * idx, sets r0 to
+// the return value. Returns FTX_ARM_OK or a result code which stops the execution.
+typedef UINT32 (*FTX_ARM_TRAP)(struct ftx_arm_s * p_arm, UINT32 idx);
+
+
+// Interpreter
+typedef struct ftx_arm_s
+{
+    UINT32          r[16];          // r15 holds the address of the next instruction between instructions
+    UINT32          n, z, c, v, q;  // condition flags (0 or 1)
+
+    FTX_ARM_REGION  region[FTX_ARM_REGIONS_MAX];
+    UINT32          n_regions;
+
+    FTX_ARM_TRAP    Trap;
+    void          * p_user;
+
+    uint64_t        insn_limit;     // max. number of instructions in one FtxArmCall (0 = no limit)
+    FTX_ARM_COUNT   count;
+
+    UINT32          fault_addr;     // address of the failed access
+    UINT32          fault_pc;       // address of the instruction which stopped the execution
+
+    // State of the execution
+    UINT32          result;
+    UINT32          next_pc;
+    UINT32          read_mask;      // registers read by the current instruction
+    UINT32          load_mask;      // registers written by the previous load or multiply
+    UINT32          load_latency;   // cycles until these registers are available
+    const FTX_ARM_REGION * p_fetch; // region of the last instruction fetch
+    const FTX_ARM_REGION * p_data;  // region of the last data access
+} FTX_ARM;
+
+
+// Initializes the interpreter without memory
+void FtxArmInit
+(
+    FTX_ARM * p_arm,
+    FTX_ARM_TRAP p_trap,
+    void * p_user
+);
+
+
+// Maps size bytes of host memory to the guest address base. Returns FALSE if
+// there are too many regions or the region overlaps another one.
+BOOL32 FtxArmMap
+(
+    FTX_ARM * p_arm,
+    UINT32 base,
+    UINT32 size,
+    void * p_mem,
+    BOOL32 writable
+);
+
+
+// Returns the host pointer to len bytes at the guest address addr, or NULL
+// if they are not inside one region
+void * FtxArmPtr
+(
+    FTX_ARM * p_arm,
+    UINT32 addr,
+    UINT32 len
+);
+
+
+// Returns the host pointer to the string at the guest address addr, or NULL
+// if it does not end inside the region
+char * FtxArmStr
+(
+    FTX_ARM * p_arm,
+    UINT32 addr
+);
+
+
+// Returns the guest address of a host pointer into the memory, 0 if there is none
+UINT32 FtxArmAddr
+(
+    FTX_ARM * p_arm,
+    const void * p
+);
+
+
+// Returns the 32-bit argument idx of the called function (r0...r3, then the stack)
+UINT32 FtxArmArg
+(
+    FTX_ARM * p_arm,
+    UINT32 idx
+);
+
+
+// Calls the function at the guest address addr with up to 4 arguments on the
+// current stack and runs until it returns. The registers are restored
+// afterwards, so calls may be nested in a trap function. Returns the result
+// of the execution, *p_ret is r0 returned by the function.
+UINT32 FtxArmCall
+(
+    FTX_ARM * p_arm,
+    UINT32 addr,
+    const UINT32 * p_args,
+    UINT32 n_args,
+    UINT32 * p_ret
+);
+
+
+// Returns the name of a result code
+const char * FtxArmResultName
+(
+    UINT32 result
+);
+
+
+#endif // __FTX_ARM_H__
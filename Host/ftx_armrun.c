@@ -0,0 +1,913 @@
+//=============================================================================
+// ARM image runner: runs a program image (.bin file made by the Demo
+// makefiles for the ROBO TX Controller) in the ARM interpreter of ftx_arm.c
+// and counts the instructions, memory accesses and estimated core cycles of
+// every program call, so the cost of a tick on the ARM9 of the Controller
+// can be measured without the hardware.
+//
+// The firmware is the simulator of ftx_sim.c with the model of the free run
+// of ftx_simrun.c (default model, I2C bus with a TPA81 at 0x68, LM75 sensors
+// at 0x48 and 0x49 and a DS1631 at 0x4F). The Transfer Areas are in the
+// memory of the interpreter in the firmware layout (TA_WIRE) and are copied
+// from and to the simulator around every call of the program. The hook table
+// points to trap addresses, the hook functions run on the host and are not
+// counted. Callbacks are counted separately from the ticks.
+//
+// Memory of the interpreter:
+//   PRG_MEM_START      program memory (image, data, bss), PRG_MEM_SIZE
+//   ARM_FW_BASE        Transfer Areas, argument of the callbacks, program name
+//   ARM_STACK_BASE     stack, ARM_STACK_SIZE
+//
+//   ftx_armrun [-t duration ms] [-n name] [-p file] [-j] [-v] program.bin
+//
+//   -n   name of the program in the benchmark results (default: file name)
+//   -p   writes the counters of every tick to the file, one line per tick:
+//        tick instructions cycles loads stores firmware-calls
+//   -j   prints the counters as benchmark results (bench_report.h)
+//   -v   prints the pop-up messages of the program
+//
+// Returns 1 if the interpreter stops on an error or the program stops with
+// an error code (neither 0 nor 0x7FFF).
+//
+// sprintf of the firmware is implemented for the integer, character and
+// string conversions; floating point conversions are copied as they are.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench_report.h"
+#include "ftx_arm.h"
+#include "ftx_sim.h"
+#include "ftx_simdev.h"
+#include "ta_wire.h"
+
+#define ARM_FW_BASE         0x20000000
+#define ARM_STACK_BASE      0x20100000
+#define ARM_STACK_SIZE      0x10000
+#define ARM_INSN_LIMIT      50000000    // max. number of instructions of one call (endless loop)
+#define ARM_PGM_NAME_LEN    64
+#define ARM_SPRINTF_MAX     1024        // max. length of a sprintf result
+
+#define HOOK_IDX(name)      (TA_ABI_OFFSETOF(TA_HOOK_TABLE, name) / sizeof(void *))
+#define FW_ADDR(member)     (ARM_FW_BASE + (UINT32)TA_ABI_OFFSETOF(ARM_FW, member))
+
+// Memory of the firmware in the interpreter
+typedef struct
+{
+    TA_WIRE         ta[TA_COUNT];
+    union
+    {
+        BT_CB       bt;
+        BT_RECV_CB  bt_recv;
+        I2C_CB      i2c;
+    } cb_data;                                  // argument of the callbacks
+    char            pgm_name[ARM_PGM_NAME_LEN];
+} ARM_FW;
+
+// Counters of one tick
+typedef struct
+{
+    UINT32          insns;
+    UINT32          cycles;
+    UINT32          loads;
+    UINT32          stores;
+    UINT32          traps;
+} ARM_TICK;
+
+// The native program entry of the simulator is not used, the program runs in
+// the interpreter (FTX_SIM.RunProgram)
+const struct prg_code_intro_s prg_code_intro =
+{
+    /* magic            */ PRG_MAGIC,
+    /* ta_version       */ {TA_VERSION},
+    /* entry            */ 0
+};
+
+static FTX_SIM sim;
+static FTX_SIM_BUS bus;
+static FTX_ARM arm;
+static UCHAR8 prg_mem[PRG_MEM_SIZE];
+static ARM_FW fw;
+static UINT32 stack_mem[ARM_STACK_SIZE / sizeof(UINT32)];
+static UINT32 entry;
+static UINT32 arm_result = FTX_ARM_OK;
+
+// Callbacks of the program (guest addresses)
+static UINT32 bt_cb[BT_CHAN_IDX_MAX + 1];
+static UINT32 bt_recv_cb[BT_CHAN_IDX_MAX + 1];
+static UINT32 i2c_cb[FTX_SIM_I2C_QUEUE];
+static UINT32 n_i2c;
+
+static ARM_TICK * p_ticks;
+static UINT32 max_ticks;
+static FTX_ARM_COUNT cb_count;
+static UINT32 n_callbacks;
+
+static const FTX_SIM_MODEL arm_model =
+{
+    /* UpdateInputs */ FtxSimDefaultInputs,
+    /* BtCommand    */ FtxSimDefaultBtCommand,
+    /* I2cTransfer  */ FtxSimBusTransfer
+};
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : SyncToGuest / SyncFromGuest
+ *
+ * Copies the Transfer Areas between the simulator and the memory of the
+ * interpreter. The pointers of the TA are set to the guest addresses.
+ *-----------------------------------------------------------------------------*/
+static void SyncToGuest(void)
+{
+    UINT32 idx, i;
+
+    TaArrayToWire(fw.ta, sim.ta, TA_COUNT);
+    for (idx = 0; idx < TA_COUNT; idx++)
+    {
+        fw.ta[idx].state.local_pgm.name = FW_ADDR(pgm_name);
+        for (i = 0; i < TA_WIRE_HOOK_COUNT; i++)
+        {
+            fw.ta[idx].hook_table[i] = FTX_ARM_TRAP_BASE + 4 * i;
+        }
+    }
+}
+
+static void SyncFromGuest(void)
+{
+    TaArrayFromWire(sim.ta, fw.ta, TA_COUNT);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : AddCount
+ *-----------------------------------------------------------------------------*/
+static void AddCount
+(
+    FTX_ARM_COUNT * p_sum,
+    const FTX_ARM_COUNT * p_start,
+    const FTX_ARM_COUNT * p_end
+)
+{
+    p_sum->insns += p_end->insns - p_start->insns;
+    p_sum->cycles += p_end->cycles - p_start->cycles;
+    p_sum->loads += p_end->loads - p_start->loads;
+    p_sum->stores += p_end->stores - p_start->stores;
+    p_sum->traps += p_end->traps - p_start->traps;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : ReportFault
+ *-----------------------------------------------------------------------------*/
+static void ReportFault
+(
+    const char * p_what,
+    UINT32 result
+)
+{
+    fprintf(stderr, "tick %u, %s: %s at pc 0x%08x (address 0x%08x)\n", (unsigned)sim.n_ticks, p_what,
+        FtxArmResultName(result), (unsigned)arm.fault_pc, (unsigned)arm.fault_addr);
+    arm_result = result;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Callbacks: the simulator calls the host functions, they call the program
+ *-----------------------------------------------------------------------------*/
+static void Deliver
+(
+    UINT32 addr,
+    const void * p_data,
+    UINT32 len
+)
+{
+    FTX_ARM_COUNT start = arm.count;
+    UINT32 args[2] = {FW_ADDR(ta), FW_ADDR(cb_data)};
+    UINT32 result;
+
+    if (!addr || arm_result != FTX_ARM_OK)
+    {
+        return;
+    }
+    SyncToGuest();
+    memcpy(&fw.cb_data, p_data, len);
+    result = FtxArmCall(&arm, addr, args, 2, NULL);
+    SyncFromGuest();
+    AddCount(&cb_count, &start, &arm.count);
+    n_callbacks++;
+    if (result != FTX_ARM_OK)
+    {
+        ReportFault("callback", result);
+    }
+}
+
+static void ArmBtCallback(TA * p_ta_array, BT_CB * p_data)
+{
+    if (p_data->chan_idx >= BT_CHAN_IDX_MIN && p_data->chan_idx <= BT_CHAN_IDX_MAX)
+    {
+        Deliver(bt_cb[p_data->chan_idx], p_data, sizeof(*p_data));
+    }
+}
+
+static void ArmBtRecvCallback(TA * p_ta_array, BT_RECV_CB * p_data)
+{
+    if (p_data->chan_idx >= BT_CHAN_IDX_MIN && p_data->chan_idx <= BT_CHAN_IDX_MAX)
+    {
+        Deliver(bt_recv_cb[p_data->chan_idx], p_data, sizeof(*p_data));
+    }
+}
+
+static void ArmI2cCallback(TA * p_ta_array, I2C_CB * p_data)
+{
+    UINT32 addr;
+
+    if (n_i2c)
+    {
+        addr = i2c_cb[0];
+        n_i2c--;
+        memmove(&i2c_cb[0], &i2c_cb[1], n_i2c * sizeof(i2c_cb[0]));
+        Deliver(addr, p_data, sizeof(*p_data));
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Format
+ *
+ * sprintf with the arguments of the program, starting with argument arg.
+ * Returns the length of the result.
+ *-----------------------------------------------------------------------------*/
+// snprintf of one conversion with the width and precision arguments given by '*'
+#define FORMAT_ARG(value) \
+    ((n_star == 0) ? snprintf(p_out + len, ARM_SPRINTF_MAX + 1 - len, spec, value) : \
+     (n_star == 1) ? snprintf(p_out + len, ARM_SPRINTF_MAX + 1 - len, spec, star[0], value) : \
+                     snprintf(p_out + len, ARM_SPRINTF_MAX + 1 - len, spec, star[0], star[1], value))
+
+static int Format
+(
+    char * p_out,
+    const char * p_format,
+    UINT32 arg
+)
+{
+    char spec[32];
+    int len = 0, n;
+
+    while (*p_format && len < ARM_SPRINTF_MAX)
+    {
+        const char * p_start = p_format;
+        UINT32 spec_len;
+        int star[2] = {0, 0}, n_star = 0;
+        char conv;
+
+        if (*p_format != '%')
+        {
+            p_out[len++] = *p_format++;
+            continue;
+        }
+
+        // Flags, width, precision and length
+        p_format++;
+        p_format += strspn(p_format, "-+ #0");
+        if (*p_format == '*')
+        {
+            star[n_star++] = (int)FtxArmArg(&arm, arg++);
+            p_format++;
+        }
+        p_format += strspn(p_format, "0123456789");
+        if (*p_format == '.')
+        {
+            p_format++;
+            if (*p_format == '*')
+            {
+                star[n_star++] = (int)FtxArmArg(&arm, arg++);
+                p_format++;
+            }
+            p_format += strspn(p_format, "0123456789");
+        }
+        p_format += strspn(p_format, "hlL");
+        conv = *p_format;
+        if (conv)
+        {
+            p_format++;
+        }
+
+        // Conversion without the length, all integers are 32 bits
+        spec_len = (UINT32)(p_format - p_start);
+        if (spec_len >= sizeof(spec))
+        {
+            spec_len = sizeof(spec) - 1;
+        }
+        memcpy(spec, p_start, spec_len);
+        spec[spec_len] = '\0';
+        if (strchr("diouxXcsp", conv))
+        {
+            char * p = spec + strcspn(spec, "hlL");
+
+            if (*p)
+            {
+                p[0] = conv;
+                p[1] = '\0';
+            }
+        }
+
+        switch (conv)
+        {
+            case 'd': case 'i': case 'c':
+                n = FORMAT_ARG((int)FtxArmArg(&arm, arg++));
+                break;
+            case 'o': case 'u': case 'x': case 'X':
+                n = FORMAT_ARG((unsigned)FtxArmArg(&arm, arg++));
+                break;
+            case 's':
+            {
+                const char * p_str = FtxArmStr(&arm, FtxArmArg(&arm, arg++));
+
+                n = FORMAT_ARG((p_str) ? p_str : "(null)");
+                break;
+            }
+            case 'p':
+                n = snprintf(p_out + len, ARM_SPRINTF_MAX + 1 - len, "0x%08x", (unsigned)FtxArmArg(&arm, arg++));
+                break;
+            case '%':
+                n = snprintf(p_out + len, ARM_SPRINTF_MAX + 1 - len, "%%");
+                break;
+            default:
+                n = snprintf(p_out + len, ARM_SPRINTF_MAX + 1 - len, "%s", spec);
+                break;
+        }
+        len += (n > 0) ? n : 0;
+    }
+    if (len > ARM_SPRINTF_MAX)
+    {
+        len = ARM_SPRINTF_MAX;
+    }
+    p_out[len] = '\0';
+    return len;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : ArmTrap
+ *
+ * Hook functions of the firmware: the arguments are translated to the host
+ * and the hook functions of the simulator are called. The Bluetooth and I2C
+ * hook functions go to the model, which may change the Transfer Areas, so
+ * these are copied around them.
+ *-----------------------------------------------------------------------------*/
+#define ARG(idx)            FtxArmArg(p_arm, idx)
+#define PTR(idx, len)       FtxArmPtr(p_arm, ARG(idx), len)
+#define STR(idx)            FtxArmStr(p_arm, ARG(idx))
+#define CHECK(p)            do { if (!(p)) return FTX_ARM_ERR_TRAP; } while (0)
+
+static UINT32 ArmTrap
+(
+    FTX_ARM * p_arm,
+    UINT32 idx
+)
+{
+    const TA_HOOK_TABLE * p_hooks = &sim.ta[TA_LOCAL].hook_table;
+    char buf[ARM_SPRINTF_MAX + 1];
+    UINT32 ta_idx, chan, rc;
+    char * s1;
+    char * s2;
+    void * p1;
+    void * p2;
+    UINT32 ret = 0;
+
+    switch (idx)
+    {
+        case HOOK_IDX(IsRunAllowed):
+            ret = p_hooks->IsRunAllowed();
+            break;
+
+        case HOOK_IDX(GetSystemTime):
+            ret = p_hooks->GetSystemTime((enum TimerUnit)ARG(0));
+            break;
+
+        case HOOK_IDX(DisplayMsg):
+        case HOOK_IDX(IsDisplayBeingRefreshed):
+            ta_idx = (ARG(0) - FW_ADDR(ta)) / sizeof(TA_WIRE);
+            CHECK(ta_idx < TA_COUNT);
+            if (idx == HOOK_IDX(IsDisplayBeingRefreshed))
+            {
+                ret = p_hooks->IsDisplayBeingRefreshed(&sim.ta[ta_idx]);
+                break;
+            }
+            s1 = (ARG(1)) ? STR(1) : NULL;
+            CHECK(s1 || !ARG(1));
+            p_hooks->DisplayMsg(&sim.ta[ta_idx], s1);
+            break;
+
+        case HOOK_IDX(BtConnect):
+        case HOOK_IDX(BtStartListen):
+        case HOOK_IDX(BtSend):
+        case HOOK_IDX(BtDisconnect):
+        case HOOK_IDX(BtStopListen):
+        case HOOK_IDX(BtStartReceive):
+        case HOOK_IDX(BtStopReceive):
+            chan = ARG(0);
+            if (chan < BT_CHAN_IDX_MIN || chan > BT_CHAN_IDX_MAX)
+            {
+                break; // ignored by the firmware
+            }
+            SyncFromGuest();
+            if (idx == HOOK_IDX(BtConnect) || idx == HOOK_IDX(BtStartListen))
+            {
+                CHECK(p1 = PTR(1, BT_ADDR_LEN));
+                bt_cb[chan] = ARG(2);
+                if (idx == HOOK_IDX(BtConnect))
+                {
+                    p_hooks->BtConnect(chan, p1, (bt_cb[chan]) ? ArmBtCallback : NULL);
+                }
+                else
+                {
+                    p_hooks->BtStartListen(chan, p1, (bt_cb[chan]) ? ArmBtCallback : NULL);
+                }
+            }
+            else if (idx == HOOK_IDX(BtSend))
+            {
+                CHECK(p1 = PTR(2, ARG(1)));
+                bt_cb[chan] = ARG(3);
+                p_hooks->BtSend(chan, ARG(1), p1, (bt_cb[chan]) ? ArmBtCallback : NULL);
+            }
+            else if (idx == HOOK_IDX(BtDisconnect) || idx == HOOK_IDX(BtStopListen))
+            {
+                bt_cb[chan] = ARG(1);
+                if (idx == HOOK_IDX(BtDisconnect))
+                {
+                    p_hooks->BtDisconnect(chan, (bt_cb[chan]) ? ArmBtCallback : NULL);
+                }
+                else
+                {
+                    p_hooks->BtStopListen(chan, (bt_cb[chan]) ? ArmBtCallback : NULL);
+                }
+            }
+            else
+            {
+                bt_recv_cb[chan] = ARG(1);
+                if (idx == HOOK_IDX(BtStartReceive))
+                {
+                    p_hooks->BtStartReceive(chan, (bt_recv_cb[chan]) ? ArmBtRecvCallback : NULL);
+                }
+                else
+                {
+                    p_hooks->BtStopReceive(chan, (bt_recv_cb[chan]) ? ArmBtRecvCallback : NULL);
+                }
+            }
+            SyncToGuest();
+            break;
+
+        case HOOK_IDX(BtAddrToStr):
+            CHECK(p1 = PTR(0, BT_ADDR_LEN));
+            CHECK(s2 = PTR(1, BT_ADDR_STR_LEN + 1));
+            p_hooks->BtAddrToStr(p1, s2);
+            ret = ARG(1);
+            break;
+
+        case HOOK_IDX(I2cRead):
+        case HOOK_IDX(I2cWrite):
+            // The callback of the simulator is always set, so its queue and
+            // the queue of the program callbacks stay in step
+            SyncFromGuest();
+            if (idx == HOOK_IDX(I2cRead))
+            {
+                rc = p_hooks->I2cRead((UCHAR8)ARG(0), ARG(1), (UCHAR8)ARG(2), ArmI2cCallback);
+                chan = ARG(3);
+            }
+            else
+            {
+                rc = p_hooks->I2cWrite((UCHAR8)ARG(0), ARG(1), (UINT16)ARG(2), (UCHAR8)ARG(3), ArmI2cCallback);
+                chan = ARG(4);
+            }
+            if (rc == 0 && n_i2c < FTX_SIM_I2C_QUEUE)
+            {
+                i2c_cb[n_i2c++] = chan; // callback of the program
+            }
+            SyncToGuest();
+            ret = rc;
+            break;
+
+        case HOOK_IDX(sprintf):
+            CHECK(s2 = STR(1));
+            rc = Format(buf, s2, 2);
+            CHECK(s1 = PTR(0, rc + 1));
+            memcpy(s1, buf, rc + 1);
+            ret = rc;
+            break;
+
+        case HOOK_IDX(memcmp):
+            CHECK(p1 = PTR(0, ARG(2)));
+            CHECK(p2 = PTR(1, ARG(2)));
+            ret = p_hooks->memcmp(p1, p2, ARG(2));
+            break;
+
+        case HOOK_IDX(memcpy):
+        case HOOK_IDX(memmove):
+            CHECK(p1 = PTR(0, ARG(2)));
+            CHECK(p2 = PTR(1, ARG(2)));
+            p_hooks->memmove(p1, p2, ARG(2));
+            ret = ARG(0);
+            break;
+
+        case HOOK_IDX(memset):
+            CHECK(p1 = PTR(0, ARG(2)));
+            p_hooks->memset(p1, ARG(1), ARG(2));
+            ret = ARG(0);
+            break;
+
+        case HOOK_IDX(strcat):
+        case HOOK_IDX(strcpy):
+            CHECK(s1 = STR(0));
+            CHECK(s2 = STR(1));
+            CHECK(PTR(0, ((idx == HOOK_IDX(strcat)) ? strlen(s1) : 0) + strlen(s2) + 1));
+            if (idx == HOOK_IDX(strcat))
+            {
+                p_hooks->strcat(s1, s2);
+            }
+            else
+            {
+                p_hooks->strcpy(s1, s2);
+            }
+            ret = ARG(0);
+            break;
+
+        case HOOK_IDX(strncat):
+            CHECK(s1 = STR(0));
+            CHECK(s2 = PTR(1, 1));
+            CHECK(PTR(0, strlen(s1) + strnlen(s2, ARG(2)) + 1));
+            p_hooks->strncat(s1, s2, ARG(2));
+            ret = ARG(0);
+            break;
+
+        case HOOK_IDX(strncpy):
+            CHECK(s1 = PTR(0, ARG(2)));
+            CHECK(s2 = PTR(1, 1));
+            p_hooks->strncpy(s1, s2, ARG(2));
+            ret = ARG(0);
+            break;
+
+        case HOOK_IDX(strchr):
+        case HOOK_IDX(strrchr):
+            CHECK(s1 = STR(0));
+            s2 = (idx == HOOK_IDX(strchr)) ? p_hooks->strchr(s1, ARG(1)) : p_hooks->strrchr(s1, ARG(1));
+            ret = (s2) ? FtxArmAddr(p_arm, s2) : 0;
+            break;
+
+        case HOOK_IDX(strcmp):
+        case HOOK_IDX(stricmp):
+            CHECK(s1 = STR(0));
+            CHECK(s2 = STR(1));
+            ret = (idx == HOOK_IDX(strcmp)) ? p_hooks->strcmp(s1, s2) : p_hooks->stricmp(s1, s2);
+            break;
+
+        case HOOK_IDX(strncmp):
+        case HOOK_IDX(strnicmp):
+            CHECK(s1 = PTR(0, 1));
+            CHECK(s2 = PTR(1, 1));
+            ret = (idx == HOOK_IDX(strncmp)) ? p_hooks->strncmp(s1, s2, ARG(2)) :
+                p_hooks->strnicmp(s1, s2, ARG(2));
+            break;
+
+        case HOOK_IDX(strlen):
+            CHECK(s1 = STR(0));
+            ret = p_hooks->strlen(s1);
+            break;
+
+        case HOOK_IDX(strstr):
+            CHECK(s1 = STR(0));
+            CHECK(s2 = STR(1));
+            s1 = p_hooks->strstr(s1, s2);
+            ret = (s1) ? FtxArmAddr(p_arm, s1) : 0;
+            break;
+
+        case HOOK_IDX(strtok):
+            s1 = (ARG(0)) ? STR(0) : NULL;
+            CHECK(s1 || !ARG(0));
+            CHECK(s2 = STR(1));
+            s1 = p_hooks->strtok(s1, s2);
+            ret = (s1) ? FtxArmAddr(p_arm, s1) : 0;
+            break;
+
+        case HOOK_IDX(strupr):
+        case HOOK_IDX(strlwr):
+            CHECK(s1 = STR(0));
+            if (idx == HOOK_IDX(strupr))
+            {
+                p_hooks->strupr(s1);
+            }
+            else
+            {
+                p_hooks->strlwr(s1);
+            }
+            ret = ARG(0);
+            break;
+
+        case HOOK_IDX(atoi):
+            CHECK(s1 = STR(0));
+            ret = p_hooks->atoi(s1);
+            break;
+
+        default:
+            return FTX_ARM_ERR_TRAP;
+    }
+
+    p_arm->r[0] = ret;
+    return FTX_ARM_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : ArmRunProgram
+ *
+ * FTX_SIM.RunProgram: one call of the program entry in the interpreter.
+ *-----------------------------------------------------------------------------*/
+static INT32 ArmRunProgram
+(
+    FTX_SIM * p_sim
+)
+{
+    FTX_ARM_COUNT start = arm.count;
+    UINT32 args[2] = {FW_ADDR(ta), TA_COUNT};
+    UINT32 result, rc = 0;
+
+    if (arm_result != FTX_ARM_OK)
+    {
+        return -1;
+    }
+
+    SyncToGuest();
+    result = FtxArmCall(&arm, entry, args, 2, &rc);
+    SyncFromGuest();
+    if (result != FTX_ARM_OK)
+    {
+        ReportFault("program", result);
+        return -1;
+    }
+
+    if (p_sim->n_ticks < max_ticks)
+    {
+        ARM_TICK * p_tick = &p_ticks[p_sim->n_ticks];
+
+        p_tick->insns = (UINT32)(arm.count.insns - start.insns);
+        p_tick->cycles = (UINT32)(arm.count.cycles - start.cycles);
+        p_tick->loads = (UINT32)(arm.count.loads - start.loads);
+        p_tick->stores = (UINT32)(arm.count.stores - start.stores);
+        p_tick->traps = (UINT32)(arm.count.traps - start.traps);
+    }
+    return (INT32)rc;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : LoadImage
+ *
+ * Reads the program image into the program memory and checks its header.
+ *-----------------------------------------------------------------------------*/
+static BOOL32 LoadImage
+(
+    const char * path
+)
+{
+    FILE * p_file = fopen(path, "rb");
+    size_t size;
+    UINT32 magic, version;
+
+    if (!p_file)
+    {
+        perror(path);
+        return FALSE;
+    }
+    size = fread(prg_mem, 1, sizeof(prg_mem), p_file);
+    if (fgetc(p_file) != EOF)
+    {
+        fprintf(stderr, "%s: image larger than the program memory\n", path);
+        fclose(p_file);
+        return FALSE;
+    }
+    fclose(p_file);
+
+    magic = prg_mem[0] | (prg_mem[1] << 8) | (prg_mem[2] << 16) | ((UINT32)prg_mem[3] << 24);
+    version = prg_mem[4] | (prg_mem[5] << 8) | (prg_mem[6] << 16) | ((UINT32)prg_mem[7] << 24);
+    entry = prg_mem[8] | (prg_mem[9] << 8) | (prg_mem[10] << 16) | ((UINT32)prg_mem[11] << 24);
+    if (size < 12 || magic != PRG_MAGIC)
+    {
+        fprintf(stderr, "%s: no program header\n", path);
+        return FALSE;
+    }
+    if (version != TA_VERSION)
+    {
+        fprintf(stderr, "%s: program made for Transfer Area version 0x%08x\n", path, (unsigned)version);
+        return FALSE;
+    }
+    if (entry - PRG_MEM_START >= size)
+    {
+        fprintf(stderr, "%s: entry 0x%08x outside of the image\n", path, (unsigned)entry);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : CompareU32 / Report
+ *
+ * Prints the average, the 99th percentile and the maximum of the counters
+ * of the ticks (the first tick includes PrgInit).
+ *-----------------------------------------------------------------------------*/
+static int CompareU32
+(
+    const void * p_a,
+    const void * p_b
+)
+{
+    UINT32 a = *(const UINT32 *)p_a, b = *(const UINT32 *)p_b;
+
+    return (a > b) - (a < b);
+}
+
+static void Report
+(
+    const char * p_name,
+    UINT32 n,
+    BOOL32 bench
+)
+{
+    static const struct
+    {
+        const char    * p_label;
+        const char    * p_key;
+        const char    * p_unit;
+        size_t          offset;
+    } counters[] =
+    {
+        { "instructions",       "insns",    "insns",    TA_ABI_OFFSETOF(ARM_TICK, insns)  },
+        { "cycles (estimate)",  "cycles",   "cycles",   TA_ABI_OFFSETOF(ARM_TICK, cycles) },
+        { "loads",              "loads",    "accesses", TA_ABI_OFFSETOF(ARM_TICK, loads)  },
+        { "stores",             "stores",   "accesses", TA_ABI_OFFSETOF(ARM_TICK, stores) },
+        { "firmware calls",     "calls",    "calls",    TA_ABI_OFFSETOF(ARM_TICK, traps)  }
+    };
+    char key[BENCH_NAME_LEN_MAX];
+    UINT32 * p_values;
+    uint64_t sum;
+    double avg;
+    UINT32 c, i, first;
+
+    if (!n || (p_values = malloc(n * sizeof(p_values[0]))) == NULL)
+    {
+        return;
+    }
+
+    printf("%-20s %12s %12s %12s %12s\n", "per tick", "average", "p99", "max", "first tick");
+    for (c = 0; c < sizeof(counters) / sizeof(counters[0]); c++)
+    {
+        for (i = 0, sum = 0; i < n; i++)
+        {
+            p_values[i] = *(const UINT32 *)((const UCHAR8 *)&p_ticks[i] + counters[c].offset);
+            sum += p_values[i];
+        }
+        avg = (double)sum / n;
+        printf("%-20s %12.1f", counters[c].p_label, avg);
+        first = p_values[0];
+        qsort(p_values, n, sizeof(p_values[0]), CompareU32);
+        printf(" %12u %12u %12u\n", (unsigned)p_values[(UINT32)((n - 1) * 0.99)], (unsigned)p_values[n - 1],
+            (unsigned)first);
+
+        if (bench && c < 3)
+        {
+            snprintf(key, sizeof(key), "arm.%s.%s.avg", p_name, counters[c].p_key);
+            BENCH_RESULT(key, counters[c].p_unit, avg);
+            snprintf(key, sizeof(key), "arm.%s.%s.max", p_name, counters[c].p_key);
+            BENCH_RESULT(key, counters[c].p_unit, p_values[n - 1]);
+        }
+    }
+    free(p_values);
+
+    if (n_callbacks)
+    {
+        printf("%u callbacks: %.1f instructions, %.1f cycles, %.1f loads, %.1f stores per callback\n",
+            (unsigned)n_callbacks, (double)cb_count.insns / n_callbacks, (double)cb_count.cycles / n_callbacks,
+            (double)cb_count.loads / n_callbacks, (double)cb_count.stores / n_callbacks);
+    }
+}
+
+
+int main
+(
+    int argc,
+    char ** argv
+)
+{
+    UINT32 duration_ms = 10000;
+    const char * p_name = NULL;
+    const char * p_ticks_path = NULL;
+    BOOL32 bench = FALSE, verbose = FALSE;
+    FILE * p_file;
+    UINT32 n, i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:n:p:jv")) != -1)
+    {
+        switch (opt)
+        {
+            case 't': duration_ms = strtoul(optarg, NULL, 0); break;
+            case 'n': p_name = optarg; break;
+            case 'p': p_ticks_path = optarg; break;
+            case 'j': bench = TRUE; break;
+            case 'v': verbose = TRUE; break;
+            default:
+                fprintf(stderr, "usage: %s [-t duration ms] [-n name] [-p file] [-j] [-v] program.bin\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind != argc - 1)
+    {
+        fprintf(stderr, "usage: %s [-t duration ms] [-n name] [-p file] [-j] [-v] program.bin\n", argv[0]);
+        return 2;
+    }
+    if (!LoadImage(argv[optind]))
+    {
+        return 1;
+    }
+    if (!p_name)
+    {
+        char * p_dot;
+
+        p_name = strrchr(argv[optind], '/') ? strrchr(argv[optind], '/') + 1 : argv[optind];
+        if ((p_dot = strrchr(p_name, '.')) != NULL)
+        {
+            *p_dot = '\0';
+        }
+    }
+
+    max_ticks = duration_ms / CALL_CYCLE_MS;
+    if ((p_ticks = calloc(max_ticks + 1, sizeof(p_ticks[0]))) == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    FtxArmInit(&arm, ArmTrap, NULL);
+    FtxArmMap(&arm, PRG_MEM_START, sizeof(prg_mem), prg_mem, TRUE);
+    FtxArmMap(&arm, ARM_FW_BASE, sizeof(fw), &fw, TRUE);
+    FtxArmMap(&arm, ARM_STACK_BASE, sizeof(stack_mem), stack_mem, TRUE);
+    arm.r[FTX_ARM_SP] = ARM_STACK_BASE + sizeof(stack_mem);
+    arm.insn_limit = ARM_INSN_LIMIT;
+    snprintf(fw.pgm_name, sizeof(fw.pgm_name), "/ramdisk/%s.bin", p_name);
+
+    FtxSimBusInit(&bus);
+    FtxSimBusAdd(&bus, FTX_SIMDEV_TPA81, 0x68);
+    FtxSimBusAdd(&bus, FTX_SIMDEV_LM75, 0x48);
+    FtxSimBusAdd(&bus, FTX_SIMDEV_LM75, 0x49);
+    FtxSimBusAdd(&bus, FTX_SIMDEV_DS1631, 0x4F);
+    FtxSimInit(&sim, &arm_model, &bus);
+    sim.print_display = verbose;
+    sim.RunProgram = ArmRunProgram;
+
+    while (sim.time_us < (uint64_t)duration_ms * 1000)
+    {
+        FtxSimTick(&sim);
+        if (sim.rc != FTX_SIM_RC_RUN)
+        {
+            break;
+        }
+    }
+
+    n = (sim.n_ticks < max_ticks) ? sim.n_ticks : max_ticks;
+    if (arm_result != FTX_ARM_OK && n)
+    {
+        n--; // the failed tick has no counters
+    }
+    printf("%u ticks (%.3f s), program rc %d, %u pop-up messages\n", (unsigned)sim.n_ticks, sim.time_us / 1e6,
+        (int)sim.rc, (unsigned)sim.n_display_msgs);
+    Report(p_name, n, bench);
+
+    if (p_ticks_path)
+    {
+        if ((p_file = fopen(p_ticks_path, "w")) == NULL)
+        {
+            perror(p_ticks_path);
+            return 1;
+        }
+        fprintf(p_file, "# tick instructions cycles loads stores firmware-calls\n");
+        for (i = 0; i < n; i++)
+        {
+            fprintf(p_file, "%u %u %u %u %u %u\n", (unsigned)i, (unsigned)p_ticks[i].insns,
+                (unsigned)p_ticks[i].cycles, (unsigned)p_ticks[i].loads, (unsigned)p_ticks[i].stores,
+                (unsigned)p_ticks[i].traps);
+        }
+        fclose(p_file);
+    }
+    free(p_ticks);
+    return (arm_result != FTX_ARM_OK || (sim.rc != FTX_SIM_RC_RUN && sim.rc != 0)) ? 1 : 0;
+}
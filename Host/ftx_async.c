@@ -0,0 +1,269 @@
+//=============================================================================
+// Asynchronous online mode runtime (I/O thread, sequence lock, triple buffer).
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <string.h>
+#include <time.h>
+
+#include "ftx_async.h"
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxAsyncTakeOutputs
+ *
+ * Takes the newest published outputs of all selected areas (I/O thread).
+ *-----------------------------------------------------------------------------*/
+static void FtxAsyncTakeOutputs
+(
+    FTX_ASYNC * p_async
+)
+{
+    UINT32 idx;
+
+    for (idx = 0; idx < TA_COUNT; idx++)
+    {
+        FTX_OUTPUT_BUFFER * p_buf = &p_async->output[idx];
+
+        if (!(p_async->area_mask & FTX_AREA_MASK(idx)))
+        {
+            continue;
+        }
+        if (atomic_load_explicit(&p_buf->middle, memory_order_relaxed) & FTX_TRIPLE_DIRTY)
+        {
+            p_buf->front = atomic_exchange_explicit(&p_buf->middle, p_buf->front, memory_order_acq_rel) & 3;
+            p_async->online.ta[idx].output = p_buf->buf[p_buf->front];
+        }
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxAsyncPublishInputs
+ *
+ * Writes the snapshot of the finished I/O cycle under the sequence lock
+ * (I/O thread).
+ *-----------------------------------------------------------------------------*/
+static void FtxAsyncPublishInputs
+(
+    FTX_ASYNC * p_async,
+    int rc
+)
+{
+    FTX_SNAPSHOT * p_snap = &p_async->snapshot;
+    unsigned seq = atomic_load_explicit(&p_async->seq, memory_order_relaxed);
+    UINT32 idx;
+
+    atomic_store_explicit(&p_async->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    p_snap->cycle++;
+    p_snap->rc = rc;
+    for (idx = 0; idx < TA_COUNT; idx++)
+    {
+        TA * p_ta = &p_async->online.ta[idx];
+
+        p_snap->input[idx] = p_ta->input;
+        p_snap->change[idx] = p_ta->change;
+        p_snap->status[idx] = p_ta->status;
+        memset(&p_ta->change, 0, sizeof(p_ta->change));
+    }
+
+    atomic_store_explicit(&p_async->seq, seq + 2, memory_order_release);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxAsyncThread
+ *
+ * I/O loop: take outputs, exchange, publish inputs.
+ *-----------------------------------------------------------------------------*/
+static void * FtxAsyncThread
+(
+    void * arg
+)
+{
+    FTX_ASYNC * p_async = arg;
+    struct timespec next;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (!atomic_load_explicit(&p_async->stop, memory_order_relaxed))
+    {
+        int rc;
+
+        FtxAsyncTakeOutputs(p_async);
+        rc = FtxOnlineExchange(&p_async->online, p_async->area_mask);
+        FtxAsyncPublishInputs(p_async, rc);
+
+        atomic_fetch_add_explicit(&p_async->n_cycles, 1, memory_order_relaxed);
+        if (rc != FTX_OK)
+        {
+            atomic_fetch_add_explicit(&p_async->n_errors, 1, memory_order_relaxed);
+        }
+
+        if (p_async->period_us)
+        {
+            next.tv_nsec += p_async->period_us * 1000L;
+            while (next.tv_nsec >= 1000000000L)
+            {
+                next.tv_nsec -= 1000000000L;
+                next.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        }
+    }
+    return NULL;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxAsyncOpen
+ *
+ * Opens the link. The configuration can be set up in online.ta[].config
+ * until FtxAsyncStart is called.
+ *-----------------------------------------------------------------------------*/
+int FtxAsyncOpen
+(
+    FTX_ASYNC * p_async,
+    const char * dev,
+    UINT32 baud,
+    UINT32 area_mask,
+    UINT32 period_us
+)
+{
+    UINT32 idx;
+
+    memset(p_async, 0, sizeof(*p_async));
+    p_async->area_mask = (area_mask & FTX_AREA_MASK_ALL) | FTX_AREA_MASK(TA_LOCAL);
+    p_async->period_us = period_us;
+
+    for (idx = 0; idx < TA_COUNT; idx++)
+    {
+        FTX_OUTPUT_BUFFER * p_buf = &p_async->output[idx];
+
+        p_buf->front = 0;
+        atomic_init(&p_buf->middle, 1);
+        p_buf->back = 2;
+    }
+    atomic_init(&p_async->seq, 0);
+    atomic_init(&p_async->stop, FALSE);
+
+    return FtxOnlineOpen(&p_async->online, dev, baud);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxAsyncStart
+ *
+ * Sends the configuration and starts the I/O thread.
+ *-----------------------------------------------------------------------------*/
+int FtxAsyncStart
+(
+    FTX_ASYNC * p_async
+)
+{
+    int rc = FtxOnlineSetConfig(&p_async->online, p_async->area_mask);
+
+    if (rc != FTX_OK)
+    {
+        return rc;
+    }
+    if (pthread_create(&p_async->thread, NULL, FtxAsyncThread, p_async) != 0)
+    {
+        return FTX_ERR_OPEN;
+    }
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxAsyncClose
+ *
+ * Stops the I/O thread and closes the link.
+ *-----------------------------------------------------------------------------*/
+void FtxAsyncClose
+(
+    FTX_ASYNC * p_async
+)
+{
+    if (p_async->thread)
+    {
+        atomic_store(&p_async->stop, TRUE);
+        pthread_join(p_async->thread, NULL);
+        p_async->thread = 0;
+    }
+    FtxOnlineClose(&p_async->online);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxAsyncReadInput
+ *
+ * Copies the newest consistent input snapshot.
+ *-----------------------------------------------------------------------------*/
+void FtxAsyncReadInput
+(
+    FTX_ASYNC * p_async,
+    FTX_SNAPSHOT * p_snapshot
+)
+{
+    unsigned seq_1, seq_2;
+
+    do
+    {
+        seq_1 = atomic_load_explicit(&p_async->seq, memory_order_acquire);
+        if (seq_1 & 1)
+        {
+            continue; // I/O thread is writing the snapshot
+        }
+        memcpy(p_snapshot, &p_async->snapshot, sizeof(*p_snapshot));
+        atomic_thread_fence(memory_order_acquire);
+        seq_2 = atomic_load_explicit(&p_async->seq, memory_order_relaxed);
+    } while ((seq_1 & 1) || seq_1 != seq_2);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxAsyncOutput
+ *
+ * Returns the output buffer of the Transfer Area to be filled by its writer.
+ *-----------------------------------------------------------------------------*/
+TA_OUTPUT * FtxAsyncOutput
+(
+    FTX_ASYNC * p_async,
+    UINT32 ta_idx
+)
+{
+    FTX_OUTPUT_BUFFER * p_buf = &p_async->output[ta_idx];
+
+    return &p_buf->buf[p_buf->back];
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxAsyncPublish
+ *
+ * Publishes the output buffer of the Transfer Area.
+ *-----------------------------------------------------------------------------*/
+void FtxAsyncPublish
+(
+    FTX_ASYNC * p_async,
+    UINT32 ta_idx
+)
+{
+    FTX_OUTPUT_BUFFER * p_buf = &p_async->output[ta_idx];
+    UINT32 published = p_buf->back;
+
+    p_buf->back = atomic_exchange_explicit(&p_buf->middle, published | FTX_TRIPLE_DIRTY,
+        memory_order_acq_rel) & 3;
+
+    // Continue with the published values, so that the writer can change single fields
+    p_buf->buf[p_buf->back] = p_buf->buf[published];
+}
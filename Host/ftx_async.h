@@ -0,0 +1,124 @@
+//=============================================================================
+// Header file of the asynchronous online mode runtime.
+// A dedicated I/O thread owns the serial link and exchanges the Transfer
+// Areas with the Controller in a loop. Application threads never block on
+// the link:
+//  - the I/O thread publishes the inputs of each cycle as one snapshot
+//    protected by a sequence lock; readers copy the snapshot and retry if
+//    the I/O thread has changed it in the meantime;
+//  - outputs are passed through a triple buffer per Transfer Area; the
+//    writer of an area fills its back buffer and publishes it with one
+//    atomic exchange, the I/O thread always sends the newest published one.
+// Each Transfer Area may have its own writer thread, but only one.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __FTX_ASYNC_H__
+#define __FTX_ASYNC_H__
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "ftx_online.h"
+
+#define FTX_TRIPLE_DIRTY    4   // flag in the middle index: buffer was published and not yet taken
+
+
+// Input snapshot of one I/O cycle
+typedef struct
+{
+    UINT32          cycle;                  // number of the I/O cycle, incremented on each exchange
+    INT32           rc;                     // return code of the exchange, see enum ftx_error_e
+    TA_INPUT        input[TA_COUNT];
+    TA_CHANGE       change[TA_COUNT];       // changes since the previous snapshot
+    TA_STATUS       status[TA_COUNT];
+} FTX_SNAPSHOT;
+
+
+// Triple buffer of the outputs of one Transfer Area
+typedef struct
+{
+    TA_OUTPUT       buf[3];
+    atomic_uint     middle;                 // index of the middle buffer | FTX_TRIPLE_DIRTY
+    UINT32          back;                   // index of the buffer being written (writer only)
+    UINT32          front;                  // index of the buffer being sent (I/O thread only)
+} FTX_OUTPUT_BUFFER;
+
+
+// Asynchronous runtime
+typedef struct
+{
+    FTX_ONLINE          online;             // used by the I/O thread only after start
+    pthread_t           thread;
+    atomic_bool         stop;
+    UINT32              area_mask;          // Transfer Areas to exchange
+    UINT32              period_us;          // min. period of an I/O cycle, 0 = back-to-back
+
+    atomic_uint         seq;                // sequence lock of the snapshot, odd while writing
+    FTX_SNAPSHOT        snapshot;
+
+    FTX_OUTPUT_BUFFER   output[TA_COUNT];
+
+    atomic_uint         n_cycles;
+    atomic_uint         n_errors;
+} FTX_ASYNC;
+
+
+// Opens the link to the device and initializes the snapshot and the output buffers.
+// Nothing is sent yet: online.ta[].config of the selected areas can be set up until
+// FtxAsyncStart is called.
+int FtxAsyncOpen
+(
+    FTX_ASYNC * p_async,
+    const char * dev,
+    UINT32 baud,
+    UINT32 area_mask,
+    UINT32 period_us
+);
+
+// Sends TA_CONFIG of all selected areas (from online.ta[].config) and starts the I/O thread
+int FtxAsyncStart
+(
+    FTX_ASYNC * p_async
+);
+
+
+// Stops the I/O thread and closes the link
+void FtxAsyncClose
+(
+    FTX_ASYNC * p_async
+);
+
+
+// Copies the newest consistent input snapshot. Never blocks the I/O thread.
+void FtxAsyncReadInput
+(
+    FTX_ASYNC * p_async,
+    FTX_SNAPSHOT * p_snapshot
+);
+
+
+// Returns the output buffer of the Transfer Area to be filled by its writer thread.
+// The buffer contains the outputs published last by this writer.
+TA_OUTPUT * FtxAsyncOutput
+(
+    FTX_ASYNC * p_async,
+    UINT32 ta_idx
+);
+
+
+// Publishes the output buffer of the Transfer Area; it is sent in the next I/O cycle
+void FtxAsyncPublish
+(
+    FTX_ASYNC * p_async,
+    UINT32 ta_idx
+);
+
+
+#endif // __FTX_ASYNC_H__
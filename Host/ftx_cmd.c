@@ -0,0 +1,267 @@
+//=============================================================================
+// Prototype of a program start/stop tool for Linux, run against loopback
+// stand-ins.
+//
+// The requests FTX_CMD_STATE and FTX_CMD_PROGRAM are defined by this library
+// and answered by ftx_loopback.c; the ROBO TX firmware does not implement
+// them. The tool is a test bed for the fan-out to many Controllers, not a
+// replacement for 4cmd_ft.exe and the batch files in Bin.
+//
+// Starts or stops the program in the program memory of one or more ROBO TX
+// Controllers, or shows the program state. All Controllers are connected
+// first, one thread per tty; then the state change is requested on all of
+// them at the same time and the tool waits until every Controller reports
+// the new state in TA_STATE.local_pgm (or the timeout expires). With -l n
+// the command is executed on n loopback stand-ins instead of ttys; -p sets
+// the time they need to start or stop a program.
+//
+//   ftx_cmd [-b baud] [-t timeout ms] [-l n] [-p ms] run|stop|state [tty ...]
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ftx_online.h"
+#include "ftx_loopback.h"
+
+#define LOOPBACK_MAX        16
+#define POLL_US             1000        // poll period of the program state
+#define DEFAULT_TIMEOUT_MS  5000
+
+
+// Command execution on one Controller
+typedef struct
+{
+    const char    * dev;
+    pthread_t       thread;
+    int             rc;
+    double          t_request;      // s
+    double          t_done;
+    FTX_ONLINE      ftx;
+} CMD_JOB;
+
+static UINT32 baud;
+static UINT32 timeout_ms = DEFAULT_TIMEOUT_MS;
+static UINT8 pgm_state;             // requested state, PGM_STATE_INVALID: show the state only
+static pthread_barrier_t barrier;
+
+static FTX_LOOPBACK loopback[LOOPBACK_MAX];
+
+static const char * const state_names[] = { "-", "running", "stopped" };
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : NowS
+ *-----------------------------------------------------------------------------*/
+static double NowS(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : CmdThread
+ *
+ * Connects to a Controller, waits until all Controllers are connected and
+ * executes the command.
+ *-----------------------------------------------------------------------------*/
+static void * CmdThread
+(
+    void * arg
+)
+{
+    CMD_JOB * p_job = arg;
+    FTX_ONLINE * p_ftx = &p_job->ftx;
+    PGM_INFO * p_pgm = &p_ftx->ta[TA_LOCAL].state.local_pgm;
+
+    p_job->rc = FtxOnlineOpen(p_ftx, p_job->dev, baud);
+    if (p_job->rc == FTX_OK)
+    {
+        p_job->rc = FtxOnlineGetInfo(p_ftx);
+    }
+    if (p_job->rc == FTX_OK)
+    {
+        p_job->rc = FtxOnlineGetState(p_ftx);
+    }
+
+    // All Controllers change their state in the same moment
+    pthread_barrier_wait(&barrier);
+
+    if (p_job->rc == FTX_OK && pgm_state != PGM_STATE_INVALID)
+    {
+        p_job->t_request = NowS();
+        p_job->rc = FtxOnlineSetPgmState(p_ftx, pgm_state);
+        while (p_job->rc == FTX_OK && p_pgm->state != pgm_state)
+        {
+            if (NowS() - p_job->t_request > timeout_ms / 1e3)
+            {
+                p_job->rc = FTX_ERR_TIMEOUT;
+                break;
+            }
+            usleep(POLL_US);
+            p_job->rc = FtxOnlineGetState(p_ftx);
+        }
+        p_job->t_done = NowS();
+    }
+    FtxOnlineClose(p_ftx);
+    return NULL;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Usage
+ *-----------------------------------------------------------------------------*/
+static int Usage
+(
+    const char * prog
+)
+{
+    fprintf(stderr, "usage: %s [-b baud] [-t timeout ms] [-l n] [-p ms] run|stop|state [tty ...]\n", prog);
+    return 2;
+}
+
+
+int main
+(
+    int argc,
+    char ** argv
+)
+{
+    CMD_JOB * p_jobs;
+    int n_loopback = 0, n_jobs, n_failed = 0, idx, opt;
+    UINT32 pgm_delay_ms = 0;
+    double t_first = 0, t_last = 0, t_done = 0;
+    const char * cmd;
+
+    while ((opt = getopt(argc, argv, "b:t:l:p:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b': baud = atoi(optarg); break;
+            case 't': timeout_ms = atoi(optarg); break;
+            case 'l': n_loopback = atoi(optarg); break;
+            case 'p': pgm_delay_ms = atoi(optarg); break;
+            default:
+                return Usage(argv[0]);
+        }
+    }
+    cmd = (optind < argc) ? argv[optind++] : "";
+    if (!strcmp(cmd, "run"))
+    {
+        pgm_state = PGM_STATE_RUN;
+    }
+    else if (!strcmp(cmd, "stop"))
+    {
+        pgm_state = PGM_STATE_STOP;
+    }
+    else if (strcmp(cmd, "state") != 0)
+    {
+        return Usage(argv[0]);
+    }
+    if (n_loopback < 0 || n_loopback > LOOPBACK_MAX)
+    {
+        fprintf(stderr, "0...%d loopback devices\n", LOOPBACK_MAX);
+        return 2;
+    }
+    n_jobs = argc - optind + n_loopback;
+    if (!n_jobs)
+    {
+        fprintf(stderr, "no tty\n");
+        return 2;
+    }
+
+    p_jobs = calloc(n_jobs, sizeof(CMD_JOB));
+    if (!p_jobs || pthread_barrier_init(&barrier, NULL, n_jobs) != 0)
+    {
+        return 1;
+    }
+    for (idx = 0; idx < n_loopback; idx++)
+    {
+        if (FtxLoopbackStart(&loopback[idx], 0, 0) != FTX_OK)
+        {
+            fprintf(stderr, "cannot start loopback device\n");
+            return 1;
+        }
+        loopback[idx].pgm_delay_ms = pgm_delay_ms;
+        p_jobs[idx].dev = loopback[idx].dev;
+    }
+    for (; idx < n_jobs; idx++)
+    {
+        p_jobs[idx].dev = argv[optind++];
+    }
+
+    // One thread per Controller, the barrier needs all of them
+    for (idx = 0; idx < n_jobs; idx++)
+    {
+        if (pthread_create(&p_jobs[idx].thread, NULL, CmdThread, &p_jobs[idx]) != 0)
+        {
+            fprintf(stderr, "cannot create thread\n");
+            return 1;
+        }
+    }
+    for (idx = 0; idx < n_jobs; idx++)
+    {
+        pthread_join(p_jobs[idx].thread, NULL);
+    }
+
+    for (idx = 0; idx < n_jobs; idx++)
+    {
+        CMD_JOB * p_job = &p_jobs[idx];
+        const TA * p_ta = &p_job->ftx.ta[TA_LOCAL];
+        UINT8 state = p_ta->state.local_pgm.state;
+
+        if (p_job->rc != FTX_OK)
+        {
+            printf("%-14s error %d\n", p_job->dev, p_job->rc);
+            n_failed++;
+            continue;
+        }
+        printf("%-14s %-16s %-24s %s", p_job->dev, p_ta->info.device_name,
+            (p_ta->state.local_pgm.name) ? p_ta->state.local_pgm.name : "",
+            (state <= PGM_STATE_STOP) ? state_names[state] : "?");
+        if (pgm_state != PGM_STATE_INVALID)
+        {
+            printf(" after %.1f ms", (p_job->t_done - p_job->t_request) * 1e3);
+            if (!t_first || p_job->t_request < t_first)
+            {
+                t_first = p_job->t_request;
+            }
+            if (p_job->t_request > t_last)
+            {
+                t_last = p_job->t_request;
+            }
+            if (p_job->t_done > t_done)
+            {
+                t_done = p_job->t_done;
+            }
+        }
+        printf("\n");
+    }
+    if (pgm_state != PGM_STATE_INVALID && n_failed < n_jobs)
+    {
+        printf("%d of %d Controllers %s, requests within %.2f ms, all done after %.1f ms\n", n_jobs - n_failed,
+            n_jobs, state_names[pgm_state], (t_last - t_first) * 1e3, (t_done - t_first) * 1e3);
+    }
+
+    for (idx = 0; idx < n_loopback; idx++)
+    {
+        FtxLoopbackStop(&loopback[idx]);
+    }
+    pthread_barrier_destroy(&barrier);
+    free(p_jobs);
+    return (n_failed) ? 1 : 0;
+}
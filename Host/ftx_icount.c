@@ -0,0 +1,147 @@
+//=============================================================================
+// Instruction counter of the host, see ftx_icount.h.
+// The child signals the start and the stop of the counting with
+// ICOUNT_SIGNAL, which the tracer takes away. The tracer writes the count
+// into icount_result of the child at the stop. The instructions between
+// the signals which belong to FtxICountStart and FtxICountStop themselves
+// are counted once by FtxICountOpen and taken off every result.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/ptrace.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ftx_icount.h"
+
+#define ICOUNT_SIGNAL       SIGUSR2
+
+static BOOL32 icount_traced;
+static volatile long icount_result;     // written by the tracer
+static uint64_t icount_overhead;        // instructions of FtxICountStart and FtxICountStop
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Trace
+ *
+ * Loop of the tracer, does not return.
+ *-----------------------------------------------------------------------------*/
+static void Trace
+(
+    pid_t pid
+)
+{
+    BOOL32 counting = FALSE;
+    long count = 0;
+    int status, sig;
+
+    while (waitpid(pid, &status, 0) == pid)
+    {
+        if (WIFEXITED(status))
+        {
+            exit(WEXITSTATUS(status));
+        }
+        if (WIFSIGNALED(status))
+        {
+            exit(128 + WTERMSIG(status));
+        }
+
+        sig = WSTOPSIG(status);
+        if (sig == ICOUNT_SIGNAL)
+        {
+            if (counting)
+            {
+                ptrace(PTRACE_POKEDATA, pid, (void *)&icount_result, (void *)count);
+            }
+            counting = !counting;
+            count = 0;
+            sig = 0;
+        }
+        else if (sig == SIGTRAP && counting)
+        {
+            count++;
+            sig = 0;
+        }
+        else if (sig == SIGSTOP)
+        {
+            sig = 0;
+        }
+        ptrace((counting) ? PTRACE_SINGLESTEP : PTRACE_CONT, pid, NULL, (void *)(long)sig);
+    }
+    perror("waitpid");
+    exit(1);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxICountOpen
+ *-----------------------------------------------------------------------------*/
+int FtxICountOpen(void)
+{
+    pid_t pid;
+
+    if (icount_traced)
+    {
+        return FTX_OK;
+    }
+
+    fflush(NULL);
+    pid = fork();
+    if (pid < 0)
+    {
+        return FTX_ERR_OPEN;
+    }
+    if (pid > 0)
+    {
+        Trace(pid);
+    }
+
+    // Stopped until the tracer waits for the child
+    if (ptrace(PTRACE_TRACEME, 0, NULL, NULL) != 0)
+    {
+        perror("ptrace");
+        exit(1);
+    }
+    raise(SIGSTOP);
+    icount_traced = TRUE;
+
+    FtxICountStart();
+    icount_overhead = FtxICountStop();
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxICountStart
+ *-----------------------------------------------------------------------------*/
+void FtxICountStart(void)
+{
+    if (icount_traced)
+    {
+        raise(ICOUNT_SIGNAL);
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxICountStop
+ *-----------------------------------------------------------------------------*/
+uint64_t FtxICountStop(void)
+{
+    if (!icount_traced)
+    {
+        return 0;
+    }
+    raise(ICOUNT_SIGNAL);
+    return (uint64_t)icount_result - icount_overhead;
+}
@@ -0,0 +1,42 @@
+//=============================================================================
+// Header file of the instruction counter of the host.
+// Counts the instructions the process executes between FtxICountStart and
+// FtxICountStop, for benchmark results which do not depend on the load of
+// the machine. FtxICountOpen forks: the parent process becomes the tracer,
+// the child returns and runs on. The tracer single-steps the child while it
+// counts (ptrace) and lets it run at full speed otherwise, and ends with
+// the exit code of the child. Single-stepping costs some microseconds per
+// instruction, so only short code is counted.
+// Linux only; the child must have one thread.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __FTX_ICOUNT_H__
+#define __FTX_ICOUNT_H__
+
+#include <stdint.h>
+
+#include "ftx_link.h"
+
+
+// Starts the tracer, returns FTX_OK in the traced child or FTX_ERR_OPEN if
+// the process can not be traced; returns at once if it is traced already
+int FtxICountOpen(void);
+
+
+// Starts counting
+void FtxICountStart(void);
+
+
+// Stops counting, returns the number of instructions since FtxICountStart
+// (without the ones of FtxICountStart and FtxICountStop), 0 if not traced
+uint64_t FtxICountStop(void);
+
+
+#endif // __FTX_ICOUNT_H__
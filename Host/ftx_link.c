@@ -0,0 +1,357 @@
+//=============================================================================
+// Serial link to a ROBO TX Controller (framing, checksum, tty setup).
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "ftx_link.h"
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxBaudToSpeed
+ *
+ * Converts a baud rate to the termios speed constant.
+ *-----------------------------------------------------------------------------*/
+static speed_t FtxBaudToSpeed
+(
+    UINT32 baud
+)
+{
+    switch (baud)
+    {
+        case 9600:      return B9600;
+        case 19200:     return B19200;
+        case 38400:     return B38400;
+        case 57600:     return B57600;
+        case 115200:    return B115200;
+        case 230400:    return B230400;
+        case 460800:    return B460800;
+        case 921600:    return B921600;
+        default:        return B0;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxChecksum
+ *
+ * Two's complement of the 16-bit sum of the given bytes.
+ *-----------------------------------------------------------------------------*/
+static UINT16 FtxChecksum
+(
+    const UCHAR8 * p,
+    UINT32 len
+)
+{
+    UINT16 sum = 0;
+
+    while (len--)
+    {
+        sum += *p++;
+    }
+    return (UINT16)(0 - sum);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLinkOpen
+ *
+ * Opens a tty in raw mode with the given baud rate.
+ *-----------------------------------------------------------------------------*/
+int FtxLinkOpen
+(
+    FTX_LINK * p_link,
+    const char * dev,
+    UINT32 baud
+)
+{
+    struct termios tio;
+    speed_t speed = FtxBaudToSpeed(baud ? baud : FTX_DEFAULT_BAUD);
+    int fd;
+
+    if (speed == B0)
+    {
+        return FTX_ERR_PARAM;
+    }
+
+    fd = open(dev, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return FTX_ERR_OPEN;
+    }
+
+    if (tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cc[VMIN] = 1;
+        tio.c_cc[VTIME] = 0;
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+        if (tcsetattr(fd, TCSANOW, &tio) != 0)
+        {
+            close(fd);
+            return FTX_ERR_OPEN;
+        }
+        tcflush(fd, TCIOFLUSH);
+    }
+
+    FtxLinkAttach(p_link, fd);
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLinkAttach
+ *
+ * Uses an already opened file descriptor as the link.
+ *-----------------------------------------------------------------------------*/
+void FtxLinkAttach
+(
+    FTX_LINK * p_link,
+    int fd
+)
+{
+    p_link->fd = fd;
+    p_link->tid = 0;
+    p_link->timeout_ms = FTX_DEFAULT_TIMEOUT_MS;
+    p_link->rx_len = 0;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLinkClose
+ *-----------------------------------------------------------------------------*/
+void FtxLinkClose
+(
+    FTX_LINK * p_link
+)
+{
+    if (p_link->fd >= 0)
+    {
+        close(p_link->fd);
+        p_link->fd = -1;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLinkSend
+ *
+ * Sends one frame with a single write call.
+ *-----------------------------------------------------------------------------*/
+int FtxLinkSend
+(
+    FTX_LINK * p_link,
+    UINT8 cmd,
+    UINT8 flags,
+    UINT16 tid,
+    const void * p_payload,
+    UINT32 len
+)
+{
+    UCHAR8 * p = p_link->tx_buf;
+    UINT32 body_len = FTX_BODY_HEAD_LEN + len;
+    UINT32 frame_len = FTX_FRAME_HEAD_LEN + body_len + FTX_FRAME_TAIL_LEN;
+    UINT32 done = 0;
+    UINT16 cs;
+
+    if (len > FTX_PAYLOAD_MAX)
+    {
+        return FTX_ERR_PARAM;
+    }
+
+    p[0] = FTX_FRAME_STX;
+    p[1] = FTX_FRAME_SYNC;
+    p[2] = (UCHAR8)(body_len >> 8);
+    p[3] = (UCHAR8)body_len;
+    p[4] = cmd;
+    p[5] = flags;
+    p[6] = (UCHAR8)tid;
+    p[7] = (UCHAR8)(tid >> 8);
+    if (len)
+    {
+        memcpy(&p[8], p_payload, len);
+    }
+    cs = FtxChecksum(&p[2], 2 + body_len);
+    p[8 + len] = (UCHAR8)(cs >> 8);
+    p[9 + len] = (UCHAR8)cs;
+    p[10 + len] = FTX_FRAME_ETX;
+
+    while (done < frame_len)
+    {
+        ssize_t n = write(p_link->fd, p + done, frame_len - done);
+
+        if (n < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            return FTX_ERR_IO;
+        }
+        done += n;
+    }
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLinkParse
+ *
+ * Looks for a complete frame in the receive buffer. Returns FTX_OK if a
+ * frame was extracted, FTX_ERR_TIMEOUT if more bytes are needed.
+ *-----------------------------------------------------------------------------*/
+static int FtxLinkParse
+(
+    FTX_LINK * p_link,
+    FTX_FRAME * p_frame,
+    BOOL32 * p_bad_checksum
+)
+{
+    UCHAR8 * p = p_link->rx_buf;
+
+    while (p_link->rx_len >= 2)
+    {
+        UINT32 body_len, frame_len, skip = 1;
+
+        if (p[0] == FTX_FRAME_STX && p[1] == FTX_FRAME_SYNC)
+        {
+            if (p_link->rx_len < FTX_FRAME_HEAD_LEN)
+            {
+                return FTX_ERR_TIMEOUT;
+            }
+            body_len = ((UINT32)p[2] << 8) | p[3];
+            if (body_len >= FTX_BODY_HEAD_LEN && body_len <= FTX_BODY_HEAD_LEN + FTX_PAYLOAD_MAX)
+            {
+                frame_len = FTX_FRAME_HEAD_LEN + body_len + FTX_FRAME_TAIL_LEN;
+                if (p_link->rx_len < frame_len)
+                {
+                    return FTX_ERR_TIMEOUT;
+                }
+                if (p[frame_len - 1] == FTX_FRAME_ETX &&
+                    FtxChecksum(&p[2], 2 + body_len) ==
+                        (((UINT16)p[frame_len - 3] << 8) | p[frame_len - 2]))
+                {
+                    p_frame->cmd = p[4];
+                    p_frame->flags = p[5];
+                    p_frame->tid = p[6] | ((UINT16)p[7] << 8);
+                    p_frame->len = body_len - FTX_BODY_HEAD_LEN;
+                    memcpy(p_frame->payload, &p[8], p_frame->len);
+                    skip = frame_len;
+                    p_link->rx_len -= skip;
+                    memmove(p, p + skip, p_link->rx_len);
+                    return FTX_OK;
+                }
+                *p_bad_checksum = TRUE;
+            }
+        }
+
+        // Resynchronize on the next byte
+        p_link->rx_len -= skip;
+        memmove(p, p + skip, p_link->rx_len);
+    }
+    return FTX_ERR_TIMEOUT;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLinkReceive
+ *
+ * Receives one frame.
+ *-----------------------------------------------------------------------------*/
+int FtxLinkReceive
+(
+    FTX_LINK * p_link,
+    FTX_FRAME * p_frame
+)
+{
+    BOOL32 bad_checksum = FALSE;
+
+    while (1)
+    {
+        struct pollfd pfd;
+        ssize_t n;
+        int rc;
+
+        if (FtxLinkParse(p_link, p_frame, &bad_checksum) == FTX_OK)
+        {
+            return FTX_OK;
+        }
+
+        pfd.fd = p_link->fd;
+        pfd.events = POLLIN;
+        rc = poll(&pfd, 1, (int)p_link->timeout_ms);
+        if (rc < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return FTX_ERR_IO;
+        }
+        if (rc == 0)
+        {
+            return (bad_checksum) ? FTX_ERR_CHECKSUM : FTX_ERR_TIMEOUT;
+        }
+
+        n = read(p_link->fd, p_link->rx_buf + p_link->rx_len, sizeof(p_link->rx_buf) - p_link->rx_len);
+        if (n < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            return FTX_ERR_IO;
+        }
+        if (n == 0)
+        {
+            return FTX_ERR_IO;
+        }
+        p_link->rx_len += n;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLinkTransact
+ *
+ * Sends a request and waits for the reply with the same transaction id.
+ *-----------------------------------------------------------------------------*/
+int FtxLinkTransact
+(
+    FTX_LINK * p_link,
+    UINT8 cmd,
+    const void * p_payload,
+    UINT32 len,
+    FTX_FRAME * p_reply
+)
+{
+    UINT16 tid = ++p_link->tid;
+    int rc = FtxLinkSend(p_link, cmd, 0, tid, p_payload, len);
+
+    if (rc != FTX_OK)
+    {
+        return rc;
+    }
+
+    while ((rc = FtxLinkReceive(p_link, p_reply)) == FTX_OK)
+    {
+        if ((p_reply->flags & FTX_FLAG_REPLY) && p_reply->tid == tid)
+        {
+            if (p_reply->cmd != cmd || (p_reply->flags & FTX_FLAG_ERROR))
+            {
+                return FTX_ERR_REPLY;
+            }
+            return FTX_OK;
+        }
+        // stale reply of an earlier (timed out) request - skip it
+    }
+    return rc;
+}
@@ -0,0 +1,161 @@
+//=============================================================================
+// Header file for the serial link of the online mode prototype.
+// Used by Linux PC-programs which exchange the Transfer Areas with a ROBO TX
+// Controller stand-in over a tty (RS-232 or USB CDC port, or the pseudo
+// terminal of ftx_loopback.h).
+//
+// The framing and the requests below are a prototype protocol defined by
+// this library and answered by the loopback stand-in (ftx_loopback.c); the
+// ROBO TX firmware does not implement them.
+//
+// Every message is transferred as one frame:
+//
+//   0x02 0x55 | length (2, big endian) | body | checksum (2, big endian) | 0x03
+//
+// where body = command (1) | flags (1) | transaction id (2) | payload and
+// checksum is the two's complement of the 16-bit sum of the length and body
+// bytes.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __FTX_LINK_H__
+#define __FTX_LINK_H__
+
+#include "ROBO_TX_PRG.h"
+
+#define FTX_FRAME_STX           0x02
+#define FTX_FRAME_SYNC          0x55
+#define FTX_FRAME_ETX           0x03
+
+#define FTX_FRAME_HEAD_LEN      4       // STX, SYNC, length
+#define FTX_FRAME_TAIL_LEN      3       // checksum, ETX
+#define FTX_BODY_HEAD_LEN       4       // command, flags, transaction id
+#define FTX_PAYLOAD_MAX         4096    // max. payload length of one frame
+
+#define FTX_FRAME_MAX   (FTX_FRAME_HEAD_LEN + FTX_BODY_HEAD_LEN + FTX_PAYLOAD_MAX + FTX_FRAME_TAIL_LEN)
+
+#define FTX_DEFAULT_BAUD        38400
+#define FTX_DEFAULT_TIMEOUT_MS  1000
+
+// Flags of a frame
+#define FTX_FLAG_REPLY          0x01    // frame is a reply to the request with the same transaction id
+#define FTX_FLAG_ERROR          0x02    // request could not be executed, payload is one error byte
+
+
+// Commands
+enum ftx_cmd_e
+{
+    FTX_CMD_INFO = 1,       // read TA_INFO of the local Transfer Area
+    FTX_CMD_CONFIG,         // write TA_CONFIG of the selected Transfer Areas
+    FTX_CMD_EXCHANGE,       // write TA_OUTPUT and read TA_INPUT of the selected Transfer Areas
+    // Requests of the program loader and ftx_cmd
+    FTX_CMD_LOAD_BEGIN,     // start loading a program image, see ftx_loader.h
+    FTX_CMD_LOAD_DATA,      // one block of the program image
+    FTX_CMD_LOAD_END,       // verify and store the program image
+    FTX_CMD_STATE,          // read the public part of TA_STATE of the local Transfer Area
+    FTX_CMD_PROGRAM,        // program state change request (TA_CONFIG.pgm_state_req)
+    FTX_CMD_LOAD_COPY       // copy a part of the previous program image, see ftx_loader.h
+};
+
+
+// Return codes of the host library functions
+enum ftx_error_e
+{
+    FTX_OK = 0,
+    FTX_ERR_OPEN,           // cannot open or configure the port
+    FTX_ERR_IO,             // read or write error, see errno
+    FTX_ERR_TIMEOUT,        // no (complete) frame within the timeout
+    FTX_ERR_FRAME,          // wrong frame format or too long frame
+    FTX_ERR_CHECKSUM,       // wrong frame checksum
+    FTX_ERR_REPLY,          // unexpected reply or error reply of the device
+    FTX_ERR_PARAM,          // wrong parameter
+    FTX_ERR_END,            // no more data (end of a trace)
+    FTX_ERR_IMAGE           // not a program image or wrong Transfer Area version
+};
+
+
+// Serial link
+typedef struct
+{
+    int             fd;
+    UINT16          tid;                    // transaction id of the last request
+    UINT32          timeout_ms;             // receive timeout
+    UINT32          rx_len;                 // number of bytes in rx_buf
+    UCHAR8          rx_buf[2 * FTX_FRAME_MAX];
+    UCHAR8          tx_buf[FTX_FRAME_MAX];
+} FTX_LINK;
+
+
+// Received frame
+typedef struct
+{
+    UINT8           cmd;
+    UINT8           flags;
+    UINT16          tid;
+    UINT32          len;                    // payload length
+    UCHAR8          payload[FTX_PAYLOAD_MAX];
+} FTX_FRAME;
+
+
+// Opens a tty (for example "/dev/ttyACM0") in raw mode with the given baud rate
+int FtxLinkOpen
+(
+    FTX_LINK * p_link,
+    const char * dev,
+    UINT32 baud
+);
+
+
+// Uses an already opened file descriptor (for example a pty master) as the link
+void FtxLinkAttach
+(
+    FTX_LINK * p_link,
+    int fd
+);
+
+
+void FtxLinkClose
+(
+    FTX_LINK * p_link
+);
+
+
+// Sends one frame with a single write call
+int FtxLinkSend
+(
+    FTX_LINK * p_link,
+    UINT8 cmd,
+    UINT8 flags,
+    UINT16 tid,
+    const void * p_payload,
+    UINT32 len
+);
+
+
+// Receives one frame. Bytes before a frame start and frames with a wrong checksum
+// are skipped; FTX_ERR_CHECKSUM is only returned if no valid frame follows.
+int FtxLinkReceive
+(
+    FTX_LINK * p_link,
+    FTX_FRAME * p_frame
+);
+
+
+// Sends a request and waits for the reply with the same transaction id
+int FtxLinkTransact
+(
+    FTX_LINK * p_link,
+    UINT8 cmd,
+    const void * p_payload,
+    UINT32 len,
+    FTX_FRAME * p_reply
+);
+
+
+#endif // __FTX_LINK_H__
@@ -0,0 +1,250 @@
+//=============================================================================
+// Prototype of a program loader for Linux, run against loopback stand-ins.
+//
+// The load requests (FTX_CMD_LOAD_xxx, see ftx_loader.h) are defined by this
+// library and answered by ftx_loopback.c; the ROBO TX firmware does not
+// implement them. The tool is a test bed for the pipelined and differential
+// load, not a replacement for 4load_ft.exe and the batch files in Bin, which
+// remain the way to load a Controller.
+//
+// Loads a program image (.bin) into the RAM disk (default) or the flash
+// memory of one or more ROBO TX Controllers. The Controllers are loaded in
+// parallel, one thread per tty, unless -s is given. With -l n the image is
+// loaded into n loopback stand-ins instead of ttys; -d and -r set the
+// turnaround time and the speed of their links.
+// With -c dir only the chunks which differ from the image loaded last by
+// this tool are sent, chunks which moved are copied by the Controller; dir
+// keeps the chunk hashes of the loaded images per Controller (for example
+// ~/.cache/ftx_load). -k sets the max. data length of a request.
+//
+//   ftx_load [-f] [-s] [-c dir] [-b baud] [-k block] [-w window] [-l n] [-d us] [-r baud] file.bin [tty ...]
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ftx_loader.h"
+#include "ftx_loopback.h"
+
+#define LOOPBACK_MAX    16
+
+
+// Load of one Controller
+typedef struct
+{
+    const char    * dev;
+    pthread_t       thread;
+    int             rc;
+    FTX_LOAD_STAT   stat;
+    FTX_LINK        link;
+} LOAD_JOB;
+
+static const char * file_name;
+static const char * prg_name;           // file name without directory
+static UCHAR8 * p_image;
+static UINT32 image_size;
+static UINT32 baud;
+static FTX_LOAD_PARAM param;
+
+static FTX_LOOPBACK loopback[LOOPBACK_MAX];
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : NowS
+ *-----------------------------------------------------------------------------*/
+static double NowS(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : ReadImage
+ *-----------------------------------------------------------------------------*/
+static int ReadImage
+(
+    const char * path
+)
+{
+    FILE * fp = fopen(path, "rb");
+    long size;
+
+    if (!fp)
+    {
+        return FTX_ERR_OPEN;
+    }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size <= 0 || size > PRG_MEM_SIZE || !(p_image = malloc(size)) ||
+        fread(p_image, 1, size, fp) != (size_t)size)
+    {
+        fclose(fp);
+        return FTX_ERR_IMAGE;
+    }
+    fclose(fp);
+    image_size = (UINT32)size;
+    return FtxLoadCheckImage(p_image, image_size);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : LoadThread
+ *-----------------------------------------------------------------------------*/
+static void * LoadThread
+(
+    void * arg
+)
+{
+    LOAD_JOB * p_job = arg;
+
+    p_job->rc = FtxLinkOpen(&p_job->link, p_job->dev, baud);
+    if (p_job->rc == FTX_OK)
+    {
+        p_job->rc = FtxLoad(&p_job->link, prg_name, p_image, image_size, &param, &p_job->stat);
+        FtxLinkClose(&p_job->link);
+    }
+    return NULL;
+}
+
+
+int main
+(
+    int argc,
+    char ** argv
+)
+{
+    LOAD_JOB * p_jobs;
+    int n_loopback = 0, n_jobs, n_failed = 0, idx, opt;
+    UINT32 delay_us = 0, loopback_baud = 0;
+    BOOL32 sequential = FALSE;
+    double t0;
+
+    while ((opt = getopt(argc, argv, "fsc:b:k:w:l:d:r:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'f': param.target = FTX_LOAD_FLASH; break;
+            case 's': sequential = TRUE; break;
+            case 'c': param.cache_dir = optarg; break;
+            case 'b': baud = atoi(optarg); break;
+            case 'k': param.block_len = atoi(optarg); break;
+            case 'w': param.window = atoi(optarg); break;
+            case 'l': n_loopback = atoi(optarg); break;
+            case 'd': delay_us = atoi(optarg); break;
+            case 'r': loopback_baud = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-f] [-s] [-c dir] [-b baud] [-k block] [-w window] [-l n] [-d us] [-r baud] "
+                    "file.bin [tty ...]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind >= argc)
+    {
+        fprintf(stderr, "no program file\n");
+        return 2;
+    }
+    file_name = argv[optind++];
+    prg_name = (strrchr(file_name, '/')) ? strrchr(file_name, '/') + 1 : file_name;
+    if (n_loopback < 0 || n_loopback > LOOPBACK_MAX)
+    {
+        fprintf(stderr, "0...%d loopback devices\n", LOOPBACK_MAX);
+        return 2;
+    }
+    n_jobs = argc - optind + n_loopback;
+    if (!n_jobs)
+    {
+        fprintf(stderr, "no tty\n");
+        return 2;
+    }
+    if (ReadImage(file_name) != FTX_OK)
+    {
+        fprintf(stderr, "%s is not a program file for TA version %08X\n", file_name, TA_VERSION);
+        return 1;
+    }
+
+    p_jobs = calloc(n_jobs, sizeof(LOAD_JOB));
+    if (!p_jobs)
+    {
+        return 1;
+    }
+    for (idx = 0; idx < n_loopback; idx++)
+    {
+        if (FtxLoopbackStart(&loopback[idx], delay_us, 0) != FTX_OK)
+        {
+            fprintf(stderr, "cannot start loopback device\n");
+            return 1;
+        }
+        loopback[idx].baud = loopback_baud;
+        p_jobs[idx].dev = loopback[idx].dev;
+    }
+    for (; idx < n_jobs; idx++)
+    {
+        p_jobs[idx].dev = argv[optind++];
+    }
+
+    t0 = NowS();
+    for (idx = 0; idx < n_jobs; idx++)
+    {
+        if (sequential || pthread_create(&p_jobs[idx].thread, NULL, LoadThread, &p_jobs[idx]) != 0)
+        {
+            LoadThread(&p_jobs[idx]);
+            p_jobs[idx].thread = 0;
+        }
+    }
+    for (idx = 0; idx < n_jobs; idx++)
+    {
+        if (p_jobs[idx].thread)
+        {
+            pthread_join(p_jobs[idx].thread, NULL);
+        }
+    }
+    t0 = NowS() - t0;
+
+    for (idx = 0; idx < n_jobs; idx++)
+    {
+        LOAD_JOB * p_job = &p_jobs[idx];
+
+        if (p_job->rc != FTX_OK)
+        {
+            printf("%-14s error %d, device error %u\n", p_job->dev, p_job->rc, (unsigned)p_job->stat.dev_error);
+            n_failed++;
+            continue;
+        }
+        printf("%-14s %u bytes, %u of %u chunks sent, %u moved%s, %u bytes in %u requests, %u resent, %.3f s\n",
+            p_job->dev, (unsigned)image_size, (unsigned)p_job->stat.n_sent, (unsigned)p_job->stat.n_chunks,
+            (unsigned)p_job->stat.n_moved, (p_job->stat.is_diff) ? " (diff)" : "", (unsigned)p_job->stat.n_bytes,
+            (unsigned)p_job->stat.n_requests, (unsigned)p_job->stat.n_resent, p_job->stat.time_s);
+    }
+    printf("%d of %d Controllers loaded (%s) in %.3f s\n", n_jobs - n_failed, n_jobs,
+        (param.target == FTX_LOAD_FLASH) ? "flash" : "RAM disk", t0);
+
+    for (idx = 0; idx < n_loopback; idx++)
+    {
+        // The stand-ins are checked too, so a broken loader cannot pass the benchmark
+        if (loopback[idx].n_loads != 1 || strncmp(loopback[idx].load_name, prg_name, FTX_LOAD_NAME_LEN - 1) != 0 ||
+            memcmp(loopback[idx].p_prg_mem, p_image, image_size) != 0)
+        {
+            printf("%s: image not stored correctly\n", loopback[idx].dev);
+            n_failed++;
+        }
+        FtxLoopbackStop(&loopback[idx]);
+    }
+    free(p_jobs);
+    free(p_image);
+    return (n_failed) ? 1 : 0;
+}
@@ -0,0 +1,845 @@
+//=============================================================================
+// Program loader for Linux PC-programs.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "ftx_online.h"
+#include "ftx_loader.h"
+
+// Request states
+#define FTX_BLOCK_UNSENT        0
+#define FTX_BLOCK_SENT          1
+#define FTX_BLOCK_DONE          2
+
+#define FTX_OP_DATA             0xFFFFFFFF      // source of a request which sends the data
+
+#define FTX_CHUNK_MUL           0x9E3779B1      // spreads the byte values over the bits of the hash
+
+#define FTX_MANIFEST_MAGIC      0x4D585446      // "FTXM"
+#define FTX_MANIFEST_VERSION    2
+#define FTX_MANIFEST_HEAD_LEN   16
+#define FTX_MANIFEST_PATH_LEN   512
+
+
+// Chunk of an image
+typedef struct
+{
+    UINT32          offset;
+    UINT32          len;
+    UINT32          crc;            // CRC-32 of the chunk
+} FTX_CHUNK;
+
+
+// Manifest of a deployed image
+typedef struct
+{
+    UINT32          size;
+    UINT32          n_chunks;
+    FTX_CHUNK     * p_chunks;
+} FTX_MANIFEST;
+
+
+// Data or copy request of a load
+typedef struct
+{
+    UINT32          offset;
+    UINT32          len;
+    UINT32          src;            // offset in the old image, FTX_OP_DATA: the data is sent
+} FTX_LOAD_OP;
+
+
+// CRC-32 of the values of a nibble (reflected polynomial 0xEDB88320)
+static const UINT32 crc32_nibble[16] =
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxPutU32, FtxGetU32
+ *
+ * Little endian 32-bit values of the payloads.
+ *-----------------------------------------------------------------------------*/
+static void FtxPutU32
+(
+    UCHAR8 * p,
+    UINT32 value
+)
+{
+    p[0] = (UCHAR8)value;
+    p[1] = (UCHAR8)(value >> 8);
+    p[2] = (UCHAR8)(value >> 16);
+    p[3] = (UCHAR8)(value >> 24);
+}
+
+static UINT32 FtxGetU32
+(
+    const UCHAR8 * p
+)
+{
+    return p[0] | ((UINT32)p[1] << 8) | ((UINT32)p[2] << 16) | ((UINT32)p[3] << 24);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : NowS
+ *-----------------------------------------------------------------------------*/
+static double NowS(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxCrc32
+ *-----------------------------------------------------------------------------*/
+UINT32 FtxCrc32
+(
+    UINT32 crc,
+    const void * p_data,
+    UINT32 len
+)
+{
+    const UCHAR8 * p = p_data;
+
+    crc = ~crc & 0xFFFFFFFF;
+    while (len--)
+    {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ crc32_nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ crc32_nibble[crc & 0x0F];
+    }
+    return ~crc & 0xFFFFFFFF;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoadCheckImage
+ *-----------------------------------------------------------------------------*/
+int FtxLoadCheckImage
+(
+    const UCHAR8 * p_image,
+    UINT32 size
+)
+{
+    if (size < FTX_LOAD_HEADER_LEN || FtxGetU32(&p_image[0]) != PRG_MAGIC ||
+        FtxGetU32(&p_image[4]) != TA_VERSION)
+    {
+        return FTX_ERR_IMAGE;
+    }
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoadRequest
+ *
+ * Executes a request which is not pipelined and records the error code of
+ * the Controller.
+ *-----------------------------------------------------------------------------*/
+static int FtxLoadRequest
+(
+    FTX_LINK * p_link,
+    UINT8 cmd,
+    const void * p_payload,
+    UINT32 len,
+    FTX_FRAME * p_reply,
+    FTX_LOAD_STAT * p_stat
+)
+{
+    int rc = FtxLinkTransact(p_link, cmd, p_payload, len, p_reply);
+
+    if (rc == FTX_ERR_REPLY && (p_reply->flags & FTX_FLAG_ERROR) && p_reply->len)
+    {
+        p_stat->dev_error = p_reply->payload[0];
+    }
+    return rc;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoadSendOp
+ *-----------------------------------------------------------------------------*/
+static int FtxLoadSendOp
+(
+    FTX_LINK * p_link,
+    const UCHAR8 * p_image,
+    const FTX_LOAD_OP * p_op,
+    UCHAR8 * p_buf
+)
+{
+    FtxPutU32(p_buf, p_op->offset);
+    if (p_op->src != FTX_OP_DATA)
+    {
+        FtxPutU32(&p_buf[4], p_op->src);
+        FtxPutU32(&p_buf[8], p_op->len);
+        return FtxLinkSend(p_link, FTX_CMD_LOAD_COPY, 0, ++p_link->tid, p_buf, FTX_LOAD_COPY_LEN);
+    }
+    memcpy(&p_buf[4], &p_image[p_op->offset], p_op->len);
+    return FtxLinkSend(p_link, FTX_CMD_LOAD_DATA, 0, ++p_link->tid, p_buf, 4 + p_op->len);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoadFindOp
+ *
+ * Returns the index of the request for an offset, n_ops if there is none.
+ *-----------------------------------------------------------------------------*/
+static UINT32 FtxLoadFindOp
+(
+    const FTX_LOAD_OP * p_ops,
+    UINT32 n_ops,
+    UINT32 offset
+)
+{
+    UINT32 lo = 0, hi = n_ops, mid;
+
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        if (p_ops[mid].offset < offset)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return (lo < n_ops && p_ops[lo].offset == offset) ? lo : n_ops;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoadOps
+ *
+ * Sends the requests (sorted by offset) with up to `window` requests in
+ * flight. When no reply comes within the timeout of the link, all requests
+ * in flight are sent again; late replies of requests which are done already
+ * are ignored.
+ *-----------------------------------------------------------------------------*/
+static int FtxLoadOps
+(
+    FTX_LINK * p_link,
+    const UCHAR8 * p_image,
+    const FTX_LOAD_OP * p_ops,
+    UINT32 n_ops,
+    UINT32 window,
+    FTX_FRAME * p_reply,
+    FTX_LOAD_STAT * p_stat
+)
+{
+    UINT32 next = 0, n_done = 0, n_flight = 0, idx;
+    UCHAR8 * p_state = calloc(n_ops + 1, 2);
+    UCHAR8 * p_tries = p_state + n_ops;
+    UCHAR8 buf[FTX_PAYLOAD_MAX];
+    int rc = FTX_OK;
+
+    if (!p_state)
+    {
+        return FTX_ERR_PARAM;
+    }
+
+    while (n_done < n_ops && rc == FTX_OK)
+    {
+        while (n_flight < window && next < n_ops && rc == FTX_OK)
+        {
+            rc = FtxLoadSendOp(p_link, p_image, &p_ops[next], buf);
+            p_state[next] = FTX_BLOCK_SENT;
+            p_stat->n_requests++;
+            p_stat->n_bytes += (p_ops[next].src == FTX_OP_DATA) ? p_ops[next].len : 0;
+            next++;
+            n_flight++;
+        }
+        if (rc != FTX_OK)
+        {
+            break;
+        }
+
+        rc = FtxLinkReceive(p_link, p_reply);
+        if (rc == FTX_ERR_TIMEOUT || rc == FTX_ERR_CHECKSUM)
+        {
+            rc = FTX_OK;
+            for (idx = 0; idx < next && rc == FTX_OK; idx++)
+            {
+                if (p_state[idx] != FTX_BLOCK_SENT)
+                {
+                    continue;
+                }
+                if (++p_tries[idx] > FTX_LOAD_RETRY_MAX)
+                {
+                    rc = FTX_ERR_TIMEOUT;
+                    break;
+                }
+                rc = FtxLoadSendOp(p_link, p_image, &p_ops[idx], buf);
+                p_stat->n_resent++;
+            }
+            continue;
+        }
+        if (rc != FTX_OK)
+        {
+            break;
+        }
+
+        if (!(p_reply->flags & FTX_FLAG_REPLY) ||
+            (p_reply->cmd != FTX_CMD_LOAD_DATA && p_reply->cmd != FTX_CMD_LOAD_COPY))
+        {
+            // stale reply of an earlier request
+            continue;
+        }
+        if ((p_reply->flags & FTX_FLAG_ERROR) || p_reply->len != 4)
+        {
+            p_stat->dev_error = (p_reply->len) ? p_reply->payload[0] : FTX_LOAD_ERR_NONE;
+            rc = FTX_ERR_REPLY;
+            break;
+        }
+        idx = FtxLoadFindOp(p_ops, next, FtxGetU32(p_reply->payload));
+        if (idx < next && p_state[idx] == FTX_BLOCK_SENT)
+        {
+            p_state[idx] = FTX_BLOCK_DONE;
+            n_flight--;
+            n_done++;
+        }
+    }
+
+    free(p_state);
+    return rc;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxChunkEnd
+ *
+ * Returns the end of the chunk which starts at offset. The hash is shifted
+ * by one bit per byte, so its upper bits depend on the last 32 bytes only
+ * and the same content gives the same boundary at any offset.
+ *-----------------------------------------------------------------------------*/
+static UINT32 FtxChunkEnd
+(
+    const UCHAR8 * p_image,
+    UINT32 size,
+    UINT32 offset
+)
+{
+    UINT32 end = (size - offset > FTX_LOAD_CHUNK_MAX) ? offset + FTX_LOAD_CHUNK_MAX : size;
+    UINT32 hash = 0, pos;
+
+    for (pos = offset; pos < end; pos++)
+    {
+        hash = (hash << 1) + (p_image[pos] + 1) * FTX_CHUNK_MUL;
+        if (pos + 1 - offset >= FTX_LOAD_CHUNK_MIN && (hash >> (32 - FTX_LOAD_CHUNK_BITS)) == 0)
+        {
+            return pos + 1;
+        }
+    }
+    return end;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxManifestMake
+ *
+ * Splits an image into chunks and computes their CRC-32.
+ *-----------------------------------------------------------------------------*/
+static int FtxManifestMake
+(
+    FTX_MANIFEST * p_man,
+    const UCHAR8 * p_image,
+    UINT32 size
+)
+{
+    UINT32 offset, end;
+    FTX_CHUNK * p_chunk;
+
+    p_man->size = size;
+    p_man->n_chunks = 0;
+    p_man->p_chunks = malloc((size / FTX_LOAD_CHUNK_MIN + 1) * sizeof(FTX_CHUNK));
+    if (!p_man->p_chunks)
+    {
+        return FTX_ERR_PARAM;
+    }
+    for (offset = 0; offset < size; offset = end)
+    {
+        end = FtxChunkEnd(p_image, size, offset);
+        p_chunk = &p_man->p_chunks[p_man->n_chunks++];
+        p_chunk->offset = offset;
+        p_chunk->len = end - offset;
+        p_chunk->crc = FtxCrc32(0, &p_image[offset], p_chunk->len);
+    }
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : CompareChunk
+ *
+ * Order of the chunks of the old image for the search by content.
+ *-----------------------------------------------------------------------------*/
+static int CompareChunk
+(
+    const void * p_a,
+    const void * p_b
+)
+{
+    const FTX_CHUNK * a = p_a;
+    const FTX_CHUNK * b = p_b;
+
+    if (a->crc != b->crc)
+        return (a->crc < b->crc) ? -1 : 1;
+    if (a->len != b->len)
+        return (a->len < b->len) ? -1 : 1;
+    return (a->offset < b->offset) ? -1 : (a->offset > b->offset);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxChunkFind
+ *
+ * Returns the offset of a chunk with the same content in the old image
+ * (sorted by CompareChunk), preferably at the same offset, or FTX_OP_DATA.
+ *-----------------------------------------------------------------------------*/
+static UINT32 FtxChunkFind
+(
+    const FTX_CHUNK * p_old,
+    UINT32 n_old,
+    const FTX_CHUNK * p_chunk
+)
+{
+    UINT32 lo = 0, hi = n_old, mid;
+
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        if (CompareChunk(&p_old[mid], p_chunk) < 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    if (lo < n_old && p_old[lo].crc == p_chunk->crc && p_old[lo].len == p_chunk->len)
+    {
+        return p_old[lo].offset;
+    }
+    if (lo > 0 && p_old[lo - 1].crc == p_chunk->crc && p_old[lo - 1].len == p_chunk->len)
+    {
+        return p_old[lo - 1].offset;
+    }
+    return FTX_OP_DATA;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoadPlan
+ *
+ * Builds the requests of a load: the whole image (p_old == NULL) in blocks of
+ * up to block_len bytes, or only the chunks which differ from the old image.
+ * Adjacent data is merged into blocks, adjacent copies into one request.
+ *-----------------------------------------------------------------------------*/
+static int FtxLoadPlan
+(
+    const FTX_MANIFEST * p_new,
+    const FTX_MANIFEST * p_old,
+    UINT32 block_len,
+    FTX_LOAD_OP ** pp_ops,
+    UINT32 * p_n_ops,
+    FTX_LOAD_STAT * p_stat
+)
+{
+    FTX_CHUNK * p_sorted = NULL;
+    FTX_LOAD_OP * p_ops, * p_last;
+    UINT32 n_ops = 0, idx, src, offset, len;
+
+    // A chunk gives one copy or data requests of up to block_len bytes
+    p_ops = malloc((p_new->n_chunks + p_new->size / block_len + 1) * sizeof(FTX_LOAD_OP));
+    if (p_old)
+    {
+        p_sorted = malloc((p_old->n_chunks + 1) * sizeof(FTX_CHUNK));
+    }
+    if (!p_ops || (p_old && !p_sorted))
+    {
+        free(p_ops);
+        free(p_sorted);
+        return FTX_ERR_PARAM;
+    }
+    if (p_old)
+    {
+        memcpy(p_sorted, p_old->p_chunks, p_old->n_chunks * sizeof(FTX_CHUNK));
+        qsort(p_sorted, p_old->n_chunks, sizeof(FTX_CHUNK), CompareChunk);
+    }
+
+    // The requests and bytes of an earlier try remain counted
+    p_stat->n_chunks = p_new->n_chunks;
+    p_stat->n_sent = 0;
+    p_stat->n_moved = 0;
+    for (idx = 0; idx < p_new->n_chunks; idx++)
+    {
+        const FTX_CHUNK * p_chunk = &p_new->p_chunks[idx];
+
+        src = (p_old) ? FtxChunkFind(p_sorted, p_old->n_chunks, p_chunk) : FTX_OP_DATA;
+        if (src == p_chunk->offset)
+        {
+            // Kept by the Controller
+            continue;
+        }
+        p_last = (n_ops) ? &p_ops[n_ops - 1] : NULL;
+        if (src != FTX_OP_DATA)
+        {
+            p_stat->n_moved++;
+            if (p_last && p_last->src != FTX_OP_DATA && p_last->offset + p_last->len == p_chunk->offset &&
+                p_last->src + p_last->len == src)
+            {
+                p_last->len += p_chunk->len;
+                continue;
+            }
+            p_ops[n_ops].offset = p_chunk->offset;
+            p_ops[n_ops].len = p_chunk->len;
+            p_ops[n_ops++].src = src;
+            continue;
+        }
+
+        p_stat->n_sent++;
+        for (offset = p_chunk->offset; offset < p_chunk->offset + p_chunk->len; offset += len)
+        {
+            len = p_chunk->offset + p_chunk->len - offset;
+            p_last = (n_ops) ? &p_ops[n_ops - 1] : NULL;
+            if (p_last && p_last->src == FTX_OP_DATA && p_last->offset + p_last->len == offset &&
+                p_last->len < block_len)
+            {
+                len = (len < block_len - p_last->len) ? len : block_len - p_last->len;
+                p_last->len += len;
+                continue;
+            }
+            len = (len < block_len) ? len : block_len;
+            p_ops[n_ops].offset = offset;
+            p_ops[n_ops].len = len;
+            p_ops[n_ops++].src = FTX_OP_DATA;
+        }
+    }
+
+    free(p_sorted);
+    *pp_ops = p_ops;
+    *p_n_ops = n_ops;
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxManifestPath
+ *
+ * Builds the file name of the manifest of a Controller and target from the
+ * name and the Bluetooth address of the Controller.
+ *-----------------------------------------------------------------------------*/
+static void FtxManifestPath
+(
+    char * path,
+    UINT32 path_len,
+    const char * dir,
+    const TA_INFO * p_info,
+    UCHAR8 target
+)
+{
+    char name[DEV_NAME_LEN_MAX + 1 + BT_ADDR_STR_LEN + 1];
+    const char * p;
+    UINT32 len = 0;
+
+    for (p = p_info->device_name; *p && p < &p_info->device_name[DEV_NAME_LEN_MAX]; p++)
+    {
+        name[len++] = (isalnum((UCHAR8)*p) || *p == '-') ? *p : '_';
+    }
+    name[len++] = '_';
+    for (p = p_info->bt_addr; *p && p < &p_info->bt_addr[BT_ADDR_STR_LEN]; p++)
+    {
+        if (isxdigit((UCHAR8)*p))
+        {
+            name[len++] = *p;
+        }
+    }
+    name[len] = '\0';
+    snprintf(path, path_len, "%s/%s_%s.ftm", dir, name, (target == FTX_LOAD_FLASH) ? "flash" : "ram");
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxManifestRead
+ *
+ * File format: magic | version | size | number of chunks | length and CRC-32
+ * of each chunk, 32-bit little endian values.
+ *-----------------------------------------------------------------------------*/
+static int FtxManifestRead
+(
+    FTX_MANIFEST * p_man,
+    const char * path
+)
+{
+    FILE * fp = fopen(path, "rb");
+    UCHAR8 head[FTX_MANIFEST_HEAD_LEN], entry[8];
+    UINT32 idx, offset = 0;
+    int rc = FTX_ERR_FRAME;
+
+    p_man->p_chunks = NULL;
+    if (!fp)
+    {
+        return FTX_ERR_OPEN;
+    }
+    if (fread(head, 1, sizeof(head), fp) == sizeof(head) &&
+        FtxGetU32(&head[0]) == FTX_MANIFEST_MAGIC && FtxGetU32(&head[4]) == FTX_MANIFEST_VERSION)
+    {
+        p_man->size = FtxGetU32(&head[8]);
+        p_man->n_chunks = FtxGetU32(&head[12]);
+        if (p_man->size <= PRG_MEM_SIZE && p_man->n_chunks <= p_man->size / FTX_LOAD_CHUNK_MIN + 1 &&
+            (p_man->p_chunks = malloc((p_man->n_chunks + 1) * sizeof(FTX_CHUNK))) != NULL)
+        {
+            rc = FTX_OK;
+            for (idx = 0; idx < p_man->n_chunks && rc == FTX_OK; idx++)
+            {
+                if (fread(entry, 1, sizeof(entry), fp) != sizeof(entry))
+                {
+                    rc = FTX_ERR_FRAME;
+                }
+                p_man->p_chunks[idx].offset = offset;
+                p_man->p_chunks[idx].len = FtxGetU32(&entry[0]);
+                p_man->p_chunks[idx].crc = FtxGetU32(&entry[4]);
+                offset += p_man->p_chunks[idx].len;
+                if (offset > p_man->size)
+                {
+                    rc = FTX_ERR_FRAME;
+                }
+            }
+            if (rc == FTX_OK && offset != p_man->size)
+            {
+                rc = FTX_ERR_FRAME;
+            }
+        }
+    }
+    fclose(fp);
+    if (rc != FTX_OK)
+    {
+        free(p_man->p_chunks);
+        p_man->p_chunks = NULL;
+    }
+    return rc;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxManifestWrite
+ *
+ * Writes the manifest to a temporary file first, so that a concurrent
+ * reader never sees a partial manifest.
+ *-----------------------------------------------------------------------------*/
+static int FtxManifestWrite
+(
+    const FTX_MANIFEST * p_man,
+    const char * dir,
+    const char * path
+)
+{
+    char tmp[FTX_MANIFEST_PATH_LEN + 8];
+    UCHAR8 head[FTX_MANIFEST_HEAD_LEN], entry[8];
+    FILE * fp;
+    UINT32 idx;
+    BOOL32 is_ok;
+
+    mkdir(dir, 0777);
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    fp = fopen(tmp, "wb");
+    if (!fp)
+    {
+        return FTX_ERR_OPEN;
+    }
+    FtxPutU32(&head[0], FTX_MANIFEST_MAGIC);
+    FtxPutU32(&head[4], FTX_MANIFEST_VERSION);
+    FtxPutU32(&head[8], p_man->size);
+    FtxPutU32(&head[12], p_man->n_chunks);
+    is_ok = (fwrite(head, 1, sizeof(head), fp) == sizeof(head));
+    for (idx = 0; idx < p_man->n_chunks && is_ok; idx++)
+    {
+        FtxPutU32(&entry[0], p_man->p_chunks[idx].len);
+        FtxPutU32(&entry[4], p_man->p_chunks[idx].crc);
+        is_ok = (fwrite(entry, 1, sizeof(entry), fp) == sizeof(entry));
+    }
+    if (fclose(fp) != 0 || !is_ok || rename(tmp, path) != 0)
+    {
+        remove(tmp);
+        return FTX_ERR_IO;
+    }
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoadImage
+ *
+ * Loads an image completely (p_old == NULL) or only the chunks which differ
+ * from the old image.
+ *-----------------------------------------------------------------------------*/
+static int FtxLoadImage
+(
+    FTX_LINK * p_link,
+    const char * name,
+    const UCHAR8 * p_image,
+    const FTX_MANIFEST * p_new,
+    const FTX_MANIFEST * p_old,
+    const FTX_LOAD_PARAM * p_param,
+    UINT32 block_len,
+    UINT32 window,
+    FTX_FRAME * p_reply,
+    FTX_LOAD_STAT * p_stat
+)
+{
+    UCHAR8 begin[FTX_LOAD_BEGIN_LEN];
+    FTX_LOAD_OP * p_ops;
+    UINT32 n_ops;
+    int rc;
+
+    rc = FtxLoadPlan(p_new, p_old, block_len, &p_ops, &n_ops, p_stat);
+    if (rc != FTX_OK)
+    {
+        return rc;
+    }
+
+    memset(begin, 0, sizeof(begin));
+    begin[0] = p_param->target;
+    begin[1] = (p_old) ? FTX_LOAD_KEEP : 0;
+    FtxPutU32(&begin[4], p_new->size);
+    FtxPutU32(&begin[8], FtxCrc32(0, p_image, p_new->size));
+    strncpy((char *)&begin[12], name, FTX_LOAD_NAME_LEN - 1);
+    p_stat->is_diff = (p_old != NULL);
+
+    rc = FtxLoadRequest(p_link, FTX_CMD_LOAD_BEGIN, begin, sizeof(begin), p_reply, p_stat);
+    if (rc == FTX_OK)
+    {
+        rc = FtxLoadOps(p_link, p_image, p_ops, n_ops, window, p_reply, p_stat);
+    }
+    if (rc == FTX_OK)
+    {
+        rc = FtxLoadRequest(p_link, FTX_CMD_LOAD_END, NULL, 0, p_reply, p_stat);
+    }
+    free(p_ops);
+    return rc;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoad
+ *-----------------------------------------------------------------------------*/
+int FtxLoad
+(
+    FTX_LINK * p_link,
+    const char * name,
+    const UCHAR8 * p_image,
+    UINT32 size,
+    const FTX_LOAD_PARAM * p_param,
+    FTX_LOAD_STAT * p_stat
+)
+{
+    UINT32 block_len = (p_param->block_len) ? p_param->block_len : FTX_LOAD_BLOCK_MAX;
+    UINT32 window = (p_param->window) ? p_param->window : FTX_LOAD_WINDOW_DEFAULT;
+    FTX_MANIFEST old_man, new_man;
+    char path[FTX_MANIFEST_PATH_LEN];
+    BOOL32 is_diff = FALSE;
+    FTX_FRAME * p_reply;
+    TA_INFO info;
+    double t0 = NowS();
+    int rc;
+
+    memset(p_stat, 0, sizeof(*p_stat));
+    if (block_len < FTX_LOAD_BLOCK_MIN || block_len > FTX_LOAD_BLOCK_MAX || window > FTX_LOAD_WINDOW_MAX)
+    {
+        return FTX_ERR_PARAM;
+    }
+    rc = FtxLoadCheckImage(p_image, size);
+    if (rc != FTX_OK)
+    {
+        return rc;
+    }
+    p_reply = malloc(sizeof(*p_reply));
+    if (!p_reply)
+    {
+        return FTX_ERR_PARAM;
+    }
+    old_man.p_chunks = NULL;
+    new_man.p_chunks = NULL;
+
+    // The Controller must run the same Transfer Area version and have room for the image
+    rc = FtxLoadRequest(p_link, FTX_CMD_INFO, NULL, 0, p_reply, p_stat);
+    if (rc == FTX_OK && p_reply->len != FTX_INFO_WIRE_SIZE)
+    {
+        rc = FTX_ERR_REPLY;
+    }
+    if (rc == FTX_OK)
+    {
+        FtxInfoUnpack(&info, p_reply->payload);
+        if (info.version.ta.abcd != TA_VERSION)
+        {
+            p_stat->dev_error = FTX_LOAD_ERR_VERSION;
+            rc = FTX_ERR_IMAGE;
+        }
+        else if (size > info.pgm_area_size)
+        {
+            p_stat->dev_error = FTX_LOAD_ERR_SIZE;
+            rc = FTX_ERR_IMAGE;
+        }
+    }
+
+    // Chunks of the image and of the image which the Controller has already
+    if (rc == FTX_OK)
+    {
+        rc = FtxManifestMake(&new_man, p_image, size);
+    }
+    if (rc == FTX_OK && p_param->cache_dir)
+    {
+        FtxManifestPath(path, sizeof(path), p_param->cache_dir, &info, p_param->target);
+        is_diff = (FtxManifestRead(&old_man, path) == FTX_OK);
+    }
+
+    if (rc == FTX_OK)
+    {
+        rc = FtxLoadImage(p_link, name, p_image, &new_man, (is_diff) ? &old_man : NULL, p_param,
+            block_len, window, p_reply, p_stat);
+        if (rc == FTX_ERR_REPLY && is_diff && p_stat->dev_error == FTX_LOAD_ERR_CRC)
+        {
+            // The manifest was out of date
+            p_stat->dev_error = FTX_LOAD_ERR_NONE;
+            rc = FtxLoadImage(p_link, name, p_image, &new_man, NULL, p_param, block_len, window, p_reply, p_stat);
+        }
+    }
+    if (p_param->cache_dir && new_man.p_chunks)
+    {
+        if (rc == FTX_OK)
+        {
+            FtxManifestWrite(&new_man, p_param->cache_dir, path);
+        }
+        else
+        {
+            // The content of the program memory is not known
+            remove(path);
+        }
+    }
+
+    free(old_man.p_chunks);
+    free(new_man.p_chunks);
+    free(p_reply);
+    p_stat->time_s = NowS() - t0;
+    return rc;
+}
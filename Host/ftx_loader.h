@@ -0,0 +1,157 @@
+//=============================================================================
+// Header file of the program loader prototype for Linux PC-programs.
+// The load requests below are an extension of the online mode protocol of
+// this library, answered by the loopback stand-in (ftx_loopback.h); the
+// ROBO TX firmware does not implement them, Controllers are loaded with
+// 4load_ft.exe.
+//
+// Loads a program image (.bin file made by the Demo makefiles) into the RAM
+// disk or the flash memory of a ROBO TX Controller over the serial link of
+// ftx_link.c. The image is sent in blocks of up to FTX_LOAD_BLOCK_MAX bytes
+// without waiting for the reply of each block: up to `window` blocks are
+// in flight, so the turnaround time of the firmware is paid about once per
+// window instead of once per block. Every block is protected by the frame
+// checksum; a block whose reply is missing is sent again. At the end the
+// Controller verifies the CRC-32 of the whole image and the program header
+// (prg_code_intro: magic and Transfer Area version).
+//
+// Differential load: if a cache directory is given, the loader keeps a
+// manifest of the image it deployed last on each Controller and target,
+// named after TA_INFO device_name and bt_addr. The manifest lists the chunks
+// of the image (length and CRC-32). The chunk boundaries depend on the
+// content only: a chunk ends where a rolling hash of the last 32 bytes has
+// its upper FTX_LOAD_CHUNK_BITS bits clear (FTX_LOAD_CHUNK_MIN to
+// FTX_LOAD_CHUNK_MAX bytes). So code which grows or shrinks changes only the
+// chunks around the change, the chunks behind it keep their content at
+// another offset. The next load of the same Controller asks the Controller
+// to keep its program memory (FTX_LOAD_KEEP) and sends
+//   - nothing for the chunks which are unchanged at the same offset;
+//   - FTX_CMD_LOAD_COPY for the chunks found at another offset of the old
+//     image, adjacent chunks are copied with one request;
+//   - the data of all other chunks.
+// The CRC-32 of the whole image, which is checked at the end as usual, tells
+// whether the manifest was up to date; if not (the Controller was loaded by
+// someone else or the RAM disk was cleared), the image is loaded completely.
+//
+// Requests (payload, multi-byte values little endian):
+//   FTX_CMD_LOAD_BEGIN  target (1) | flags (1) | reserved (2) | size (4) | CRC-32 (4) | name (FTX_LOAD_NAME_LEN)
+//   FTX_CMD_LOAD_DATA   offset (4) | data
+//   FTX_CMD_LOAD_COPY   offset (4) | source offset (4) | length (4)
+//   FTX_CMD_LOAD_END    -
+// FTX_CMD_LOAD_COPY copies from the program memory as it was at
+// FTX_CMD_LOAD_BEGIN, so the order of the requests does not matter. The
+// reply of FTX_CMD_LOAD_DATA and FTX_CMD_LOAD_COPY contains the offset, an
+// error reply contains one of the FTX_LOAD_ERR_xxx codes.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __FTX_LOADER_H__
+#define __FTX_LOADER_H__
+
+#include "ftx_link.h"
+
+#define FTX_LOAD_NAME_LEN       32
+#define FTX_LOAD_BEGIN_LEN      (12 + FTX_LOAD_NAME_LEN)
+#define FTX_LOAD_BLOCK_MAX      (FTX_PAYLOAD_MAX - 4)
+#define FTX_LOAD_BLOCK_MIN      64
+#define FTX_LOAD_COPY_LEN       12      // payload of FTX_CMD_LOAD_COPY
+#define FTX_LOAD_WINDOW_MAX     32
+#define FTX_LOAD_WINDOW_DEFAULT 8
+#define FTX_LOAD_RETRY_MAX      5       // number of times a block is sent again
+
+#define FTX_LOAD_HEADER_LEN     8       // magic and Transfer Area version of prg_code_intro
+
+// Chunks of the differential load
+#define FTX_LOAD_CHUNK_MIN      64
+#define FTX_LOAD_CHUNK_MAX      1024
+#define FTX_LOAD_CHUNK_BITS     8       // about 1 boundary per 2^8 bytes
+
+// Flags of FTX_CMD_LOAD_BEGIN
+#define FTX_LOAD_KEEP           0x01    // keep the program memory, only changed chunks follow
+
+
+// Load targets
+enum ftx_load_target_e
+{
+    FTX_LOAD_RAM = 0,       // RAM disk
+    FTX_LOAD_FLASH          // flash memory
+};
+
+
+// Error codes of the Controller
+enum ftx_load_error_e
+{
+    FTX_LOAD_ERR_NONE = 0,
+    FTX_LOAD_ERR_SIZE,      // image does not fit into the program memory
+    FTX_LOAD_ERR_STATE,     // no load started
+    FTX_LOAD_ERR_RANGE,     // block outside of the image
+    FTX_LOAD_ERR_CRC,       // wrong CRC-32 of the image
+    FTX_LOAD_ERR_MAGIC,     // no program header
+    FTX_LOAD_ERR_VERSION    // program made for another Transfer Area version
+};
+
+
+// Load parameters
+typedef struct
+{
+    UCHAR8          target;         // see enum ftx_load_target_e
+    UINT32          block_len;      // 0: FTX_LOAD_BLOCK_MAX
+    UINT32          window;         // 0: FTX_LOAD_WINDOW_DEFAULT
+    const char    * cache_dir;      // manifests of the deployed images, NULL: always complete loads
+} FTX_LOAD_PARAM;
+
+
+// Result of a load
+typedef struct
+{
+    UINT32          n_chunks;       // chunks of the image
+    UINT32          n_sent;         // chunks sent as data
+    UINT32          n_moved;        // chunks copied from another offset of the old image
+    UINT32          n_bytes;        // data bytes sent, without the requests sent again
+    UINT32          n_requests;     // data and copy requests, without the requests sent again
+    UINT32          n_resent;       // requests sent again
+    BOOL32          is_diff;        // only the changed chunks were sent
+    UINT32          dev_error;      // FTX_LOAD_ERR_xxx of the Controller
+    double          time_s;
+} FTX_LOAD_STAT;
+
+
+// Computes the CRC-32 (IEEE 802.3) of a buffer, crc = 0 for the first buffer
+UINT32 FtxCrc32
+(
+    UINT32 crc,
+    const void * p_data,
+    UINT32 len
+);
+
+
+// Checks the program header of an image. Returns FTX_ERR_IMAGE if the image
+// is not a program for the Transfer Area version TA_VERSION.
+int FtxLoadCheckImage
+(
+    const UCHAR8 * p_image,
+    UINT32 size
+);
+
+
+// Loads an image. The Controller is asked for TA_INFO first, so the image is
+// not sent if it does not fit or was made for another Transfer Area version.
+// With a cache directory only the changed chunks are sent if possible.
+int FtxLoad
+(
+    FTX_LINK * p_link,
+    const char * name,
+    const UCHAR8 * p_image,
+    UINT32 size,
+    const FTX_LOAD_PARAM * p_param,
+    FTX_LOAD_STAT * p_stat
+);
+
+
+#endif // __FTX_LOADER_H__
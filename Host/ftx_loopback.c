@@ -0,0 +1,561 @@
+//=============================================================================
+// Loopback stand-in for a ROBO TX Controller.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ftx_online.h"
+#include "ftx_loopback.h"
+
+#define FTX_LOOPBACK_POLL_MS    100
+
+static UINT32 n_started;    // number of started devices, makes the Bluetooth addresses unique
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoopbackUpdateInput
+ *
+ * Models the inputs of one Transfer Area from its outputs.
+ *-----------------------------------------------------------------------------*/
+static void FtxLoopbackUpdateInput
+(
+    TA * p_ta
+)
+{
+    int i;
+
+    for (i = 0; i < N_UNI && i < N_PWM_CHAN; i++)
+    {
+        p_ta->input.uni[i] = p_ta->output.duty[i];
+    }
+    for (i = 0; i < N_MOTOR && i < N_CNT; i++)
+    {
+        if (p_ta->output.duty[2 * i] || p_ta->output.duty[2 * i + 1])
+        {
+            p_ta->input.counter[i]++;
+            p_ta->input.cnt_in[i] = p_ta->input.counter[i] & 1;
+        }
+        if (p_ta->output.distance[i] && p_ta->input.counter[i] >= p_ta->output.distance[i])
+        {
+            p_ta->input.motor_pos_reached[i] = TRUE;
+        }
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoopbackNowUs
+ *-----------------------------------------------------------------------------*/
+static unsigned long long FtxLoopbackNowUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoopbackUpdatePgm
+ *
+ * Executes a due program state change request.
+ *-----------------------------------------------------------------------------*/
+static void FtxLoopbackUpdatePgm
+(
+    FTX_LOOPBACK * p_dev
+)
+{
+    TA * p_ta = &p_dev->ta[TA_LOCAL];
+
+    if (p_ta->config.pgm_state_req != PGM_STATE_INVALID && FtxLoopbackNowUs() >= p_dev->pgm_due_us)
+    {
+        p_ta->state.local_pgm.state = p_ta->config.pgm_state_req;
+        p_ta->config.pgm_state_req = PGM_STATE_INVALID;
+        p_ta->state.id++;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoopbackLoad
+ *
+ * Executes a load request and returns the reply payload length or -1 if the
+ * request is invalid.
+ *-----------------------------------------------------------------------------*/
+static int FtxLoopbackLoad
+(
+    FTX_LOOPBACK * p_dev
+)
+{
+    FTX_FRAME * p_req = &p_dev->request;
+    const UCHAR8 * p = p_req->payload;
+    UINT32 offset, src, len;
+
+    p_dev->error = FTX_LOAD_ERR_STATE;
+    switch (p_req->cmd)
+    {
+        case FTX_CMD_LOAD_BEGIN:
+            if (p_req->len != FTX_LOAD_BEGIN_LEN)
+            {
+                p_dev->error = FTX_ERR_PARAM;
+                return -1;
+            }
+            p_dev->load_size = p[4] | ((UINT32)p[5] << 8) | ((UINT32)p[6] << 16) | ((UINT32)p[7] << 24);
+            p_dev->load_crc = p[8] | ((UINT32)p[9] << 8) | ((UINT32)p[10] << 16) | ((UINT32)p[11] << 24);
+            if (p_dev->load_size > PRG_MEM_SIZE)
+            {
+                p_dev->error = FTX_LOAD_ERR_SIZE;
+                return -1;
+            }
+            if (!(p[1] & FTX_LOAD_KEEP))
+            {
+                memset(p_dev->p_prg_mem, 0, PRG_MEM_SIZE);
+            }
+            memcpy(p_dev->p_old_mem, p_dev->p_prg_mem, PRG_MEM_SIZE);
+            p_dev->load_target = p[0];
+            memcpy(p_dev->load_name, &p[12], FTX_LOAD_NAME_LEN);
+            p_dev->load_name[FTX_LOAD_NAME_LEN - 1] = '\0';
+            p_dev->is_loading = TRUE;
+            return 0;
+
+        case FTX_CMD_LOAD_DATA:
+            if (!p_dev->is_loading || p_req->len < 4)
+            {
+                return -1;
+            }
+            offset = p[0] | ((UINT32)p[1] << 8) | ((UINT32)p[2] << 16) | ((UINT32)p[3] << 24);
+            if (offset > p_dev->load_size || p_req->len - 4 > p_dev->load_size - offset)
+            {
+                p_dev->error = FTX_LOAD_ERR_RANGE;
+                return -1;
+            }
+            memcpy(&p_dev->p_prg_mem[offset], &p[4], p_req->len - 4);
+            memcpy(p_dev->reply, p, 4);
+            return 4;
+
+        case FTX_CMD_LOAD_COPY:
+            if (!p_dev->is_loading || p_req->len != FTX_LOAD_COPY_LEN)
+            {
+                return -1;
+            }
+            offset = p[0] | ((UINT32)p[1] << 8) | ((UINT32)p[2] << 16) | ((UINT32)p[3] << 24);
+            src = p[4] | ((UINT32)p[5] << 8) | ((UINT32)p[6] << 16) | ((UINT32)p[7] << 24);
+            len = p[8] | ((UINT32)p[9] << 8) | ((UINT32)p[10] << 16) | ((UINT32)p[11] << 24);
+            if (offset > p_dev->load_size || len > p_dev->load_size - offset || src > PRG_MEM_SIZE ||
+                len > PRG_MEM_SIZE - src)
+            {
+                p_dev->error = FTX_LOAD_ERR_RANGE;
+                return -1;
+            }
+            memcpy(&p_dev->p_prg_mem[offset], &p_dev->p_old_mem[src], len);
+            memcpy(p_dev->reply, p, 4);
+            return 4;
+
+        case FTX_CMD_LOAD_END:
+            if (!p_dev->is_loading)
+            {
+                return -1;
+            }
+            p_dev->is_loading = FALSE;
+            if (FtxCrc32(0, p_dev->p_prg_mem, p_dev->load_size) != p_dev->load_crc)
+            {
+                p_dev->error = FTX_LOAD_ERR_CRC;
+                return -1;
+            }
+            p = p_dev->p_prg_mem;
+            if (p_dev->load_size < FTX_LOAD_HEADER_LEN ||
+                (p[0] | ((UINT32)p[1] << 8) | ((UINT32)p[2] << 16) | ((UINT32)p[3] << 24)) != PRG_MAGIC)
+            {
+                p_dev->error = FTX_LOAD_ERR_MAGIC;
+                return -1;
+            }
+            if (FtxLoadCheckImage(p, p_dev->load_size) != FTX_OK)
+            {
+                p_dev->error = FTX_LOAD_ERR_VERSION;
+                return -1;
+            }
+            snprintf(p_dev->pgm_name, sizeof(p_dev->pgm_name), "%s/%s",
+                (p_dev->load_target == FTX_LOAD_FLASH) ? "/flash" : "/ramdisk", p_dev->load_name);
+            p_dev->ta[TA_LOCAL].state.local_pgm.state = PGM_STATE_STOP;
+            p_dev->ta[TA_LOCAL].config.pgm_state_req = PGM_STATE_INVALID;
+            p_dev->ta[TA_LOCAL].state.id++;
+            p_dev->n_loads++;
+            return 0;
+
+        default:
+            return -1;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoopbackServe
+ *
+ * Executes one request and returns the reply payload length or -1 if the
+ * request is invalid.
+ *-----------------------------------------------------------------------------*/
+static int FtxLoopbackServe
+(
+    FTX_LOOPBACK * p_dev
+)
+{
+    FTX_FRAME * p_req = &p_dev->request;
+    UINT32 mask, len, idx, online = p_dev->ext_mask | FTX_AREA_MASK(TA_LOCAL);
+    const UCHAR8 * p_in = &p_req->payload[2];
+    UCHAR8 * p_out = &p_dev->reply[2];
+
+    FtxLoopbackUpdatePgm(p_dev);
+    switch (p_req->cmd)
+    {
+        case FTX_CMD_INFO:
+            FtxInfoPack(p_dev->reply, &p_dev->ta[TA_LOCAL].info);
+            return FTX_INFO_WIRE_SIZE;
+
+        case FTX_CMD_STATE:
+            FtxStatePack(p_dev->reply, &p_dev->ta[TA_LOCAL].state);
+            return FTX_STATE_WIRE_SIZE;
+
+        case FTX_CMD_PROGRAM:
+            if (p_req->len != 1 || (p_req->payload[0] != PGM_STATE_RUN && p_req->payload[0] != PGM_STATE_STOP) ||
+                p_dev->ta[TA_LOCAL].state.local_pgm.state == PGM_STATE_INVALID)
+            {
+                return -1;
+            }
+            p_dev->ta[TA_LOCAL].config.pgm_state_req = p_req->payload[0];
+            p_dev->pgm_due_us = FtxLoopbackNowUs() + p_dev->pgm_delay_ms * 1000ULL;
+            FtxLoopbackUpdatePgm(p_dev);
+            return 0;
+
+        case FTX_CMD_CONFIG:
+        case FTX_CMD_EXCHANGE:
+            if (p_req->len < 2)
+            {
+                return -1;
+            }
+            mask = (p_req->payload[0] | ((UINT32)p_req->payload[1] << 8)) & FTX_AREA_MASK_ALL;
+            len = 2;
+            for (idx = 0; idx < TA_COUNT; idx++)
+            {
+                if (mask & FTX_AREA_MASK(idx))
+                {
+                    len += (p_req->cmd == FTX_CMD_CONFIG) ? sizeof(TA_CONFIG) : sizeof(TA_OUTPUT);
+                }
+            }
+            if (p_req->len != len)
+            {
+                return -1;
+            }
+
+            for (idx = 0; idx < TA_COUNT; idx++)
+            {
+                TA * p_ta = &p_dev->ta[idx];
+
+                if (!(mask & FTX_AREA_MASK(idx)))
+                {
+                    continue;
+                }
+                if (p_req->cmd == FTX_CMD_CONFIG)
+                {
+                    memcpy(&p_ta->config, p_in, sizeof(TA_CONFIG));
+                    p_in += sizeof(TA_CONFIG);
+                    continue;
+                }
+                memcpy(&p_ta->output, p_in, sizeof(TA_OUTPUT));
+                p_in += sizeof(TA_OUTPUT);
+                if (online & FTX_AREA_MASK(idx))
+                {
+                    FtxLoopbackUpdateInput(p_ta);
+                    memcpy(p_out, &p_ta->input, sizeof(TA_INPUT));
+                    p_out += sizeof(TA_INPUT);
+                }
+            }
+            if (p_req->cmd == FTX_CMD_CONFIG)
+            {
+                return 0;
+            }
+            mask &= online;
+            p_dev->reply[0] = (UCHAR8)mask;
+            p_dev->reply[1] = (UCHAR8)(mask >> 8);
+            return p_out - p_dev->reply;
+
+        case FTX_CMD_LOAD_BEGIN:
+        case FTX_CMD_LOAD_DATA:
+        case FTX_CMD_LOAD_COPY:
+        case FTX_CMD_LOAD_END:
+            return FtxLoopbackLoad(p_dev);
+
+        default:
+            return -1;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoopbackReply
+ *
+ * Sends the reply to the current request, or queues it for the sender
+ * thread if replies are delayed.
+ *-----------------------------------------------------------------------------*/
+static void FtxLoopbackReply
+(
+    FTX_LOOPBACK * p_dev,
+    UINT8 flags,
+    UINT32 len
+)
+{
+    FTX_FRAME * p_reply;
+
+    if (!p_dev->reply_delay_us)
+    {
+        FtxLinkSend(&p_dev->link, p_dev->request.cmd, flags, p_dev->request.tid, p_dev->reply, len);
+        return;
+    }
+
+    pthread_mutex_lock(&p_dev->lock);
+    while (p_dev->q_count == FTX_LOOPBACK_QUEUE_LEN && !p_dev->stop)
+    {
+        pthread_cond_wait(&p_dev->cond, &p_dev->lock);
+    }
+    if (!p_dev->stop)
+    {
+        UINT32 idx = (p_dev->q_head + p_dev->q_count) % FTX_LOOPBACK_QUEUE_LEN;
+
+        p_reply = &p_dev->p_queue[idx];
+        p_reply->cmd = p_dev->request.cmd;
+        p_reply->flags = flags;
+        p_reply->tid = p_dev->request.tid;
+        p_reply->len = len;
+        memcpy(p_reply->payload, p_dev->reply, len);
+        p_dev->due_us[idx] = FtxLoopbackNowUs() + p_dev->reply_delay_us;
+        p_dev->q_count++;
+        pthread_cond_broadcast(&p_dev->cond);
+    }
+    pthread_mutex_unlock(&p_dev->lock);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoopbackSender
+ *
+ * Sends the delayed replies when they are due.
+ *-----------------------------------------------------------------------------*/
+static void * FtxLoopbackSender
+(
+    void * arg
+)
+{
+    FTX_LOOPBACK * p_dev = arg;
+    unsigned long long now;
+    FTX_FRAME * p_reply;
+
+    pthread_mutex_lock(&p_dev->lock);
+    while (!p_dev->stop)
+    {
+        if (!p_dev->q_count)
+        {
+            pthread_cond_wait(&p_dev->cond, &p_dev->lock);
+            continue;
+        }
+        p_reply = &p_dev->p_queue[p_dev->q_head];
+        now = FtxLoopbackNowUs();
+        pthread_mutex_unlock(&p_dev->lock);
+
+        // The entry stays in the queue until it is sent, so it is not overwritten
+        if (p_dev->due_us[p_dev->q_head] > now)
+        {
+            usleep(p_dev->due_us[p_dev->q_head] - now);
+        }
+        FtxLinkSend(&p_dev->link, p_reply->cmd, p_reply->flags, p_reply->tid, p_reply->payload, p_reply->len);
+
+        pthread_mutex_lock(&p_dev->lock);
+        p_dev->q_head = (p_dev->q_head + 1) % FTX_LOOPBACK_QUEUE_LEN;
+        p_dev->q_count--;
+        pthread_cond_broadcast(&p_dev->cond);
+    }
+    pthread_mutex_unlock(&p_dev->lock);
+    return NULL;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoopbackThread
+ *
+ * Serves the requests until the device is stopped.
+ *-----------------------------------------------------------------------------*/
+static void * FtxLoopbackThread
+(
+    void * arg
+)
+{
+    FTX_LOOPBACK * p_dev = arg;
+
+    while (!p_dev->stop)
+    {
+        int len, rc = FtxLinkReceive(&p_dev->link, &p_dev->request);
+
+        if (rc == FTX_ERR_TIMEOUT || rc == FTX_ERR_CHECKSUM)
+        {
+            continue;
+        }
+        if (rc != FTX_OK)
+        {
+            // slave side is not opened (yet) or was closed
+            usleep(FTX_LOOPBACK_POLL_MS * 1000);
+            continue;
+        }
+        if (p_dev->request.flags & FTX_FLAG_REPLY)
+        {
+            continue;
+        }
+
+        if (p_dev->baud)
+        {
+            // Transfer time of the request, 10 bits per byte
+            usleep((unsigned long long)(FTX_FRAME_HEAD_LEN + FTX_BODY_HEAD_LEN + p_dev->request.len +
+                FTX_FRAME_TAIL_LEN) * 10 * 1000000 / p_dev->baud);
+        }
+        p_dev->error = FTX_ERR_PARAM;
+        len = FtxLoopbackServe(p_dev);
+        if (len < 0)
+        {
+            p_dev->reply[0] = p_dev->error;
+            FtxLoopbackReply(p_dev, FTX_FLAG_REPLY | FTX_FLAG_ERROR, 1);
+        }
+        else
+        {
+            FtxLoopbackReply(p_dev, FTX_FLAG_REPLY, len);
+        }
+        p_dev->n_requests++;
+    }
+    return NULL;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoopbackStart
+ *
+ * Creates the pseudo terminal and starts the device thread.
+ *-----------------------------------------------------------------------------*/
+int FtxLoopbackStart
+(
+    FTX_LOOPBACK * p_dev,
+    UINT32 reply_delay_us,
+    UINT32 ext_mask
+)
+{
+    struct termios tio;
+    TA_INFO * p_info;
+    int fd, idx;
+
+    memset(p_dev, 0, sizeof(*p_dev));
+    p_dev->reply_delay_us = reply_delay_us;
+    p_dev->ext_mask = ext_mask & FTX_AREA_MASK_ALL;
+    p_dev->p_prg_mem = malloc(PRG_MEM_SIZE);
+    p_dev->p_old_mem = malloc(PRG_MEM_SIZE);
+    p_dev->p_queue = malloc(FTX_LOOPBACK_QUEUE_LEN * sizeof(FTX_FRAME));
+    if (!p_dev->p_prg_mem || !p_dev->p_old_mem || !p_dev->p_queue)
+    {
+        free(p_dev->p_prg_mem);
+        free(p_dev->p_old_mem);
+        free(p_dev->p_queue);
+        return FTX_ERR_OPEN;
+    }
+    pthread_mutex_init(&p_dev->lock, NULL);
+    pthread_cond_init(&p_dev->cond, NULL);
+
+    fd = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0 || ptsname_r(fd, p_dev->dev, sizeof(p_dev->dev)) != 0)
+    {
+        if (fd >= 0)
+            close(fd);
+        free(p_dev->p_prg_mem);
+        free(p_dev->p_old_mem);
+        free(p_dev->p_queue);
+        return FTX_ERR_OPEN;
+    }
+
+    // Raw mode on the master side too, so that no byte is translated
+    if (tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    FtxLinkAttach(&p_dev->link, fd);
+    p_dev->link.timeout_ms = FTX_LOOPBACK_POLL_MS;
+
+    for (idx = 0; idx < TA_COUNT; idx++)
+    {
+        p_info = &p_dev->ta[idx].info;
+        snprintf(p_info->device_name, sizeof(p_info->device_name), "ROBO TX-LOOP%d", idx);
+        snprintf(p_info->bt_addr, sizeof(p_info->bt_addr), "00:13:7b:00:%02x:%02x", (int)(n_started & 0xFF), idx);
+        p_info->version.hardware.part.a = 'C';
+        p_info->version.ta.abcd = TA_VERSION;
+        p_info->pgm_area_start_addr = PRG_MEM_START;
+        p_info->pgm_area_size = PRG_MEM_SIZE;
+    }
+
+    // A stopped program is in the program memory
+    snprintf(p_dev->pgm_name, sizeof(p_dev->pgm_name), "/ramdisk/Loopback");
+    p_dev->ta[TA_LOCAL].state.local_pgm.name = p_dev->pgm_name;
+    p_dev->ta[TA_LOCAL].state.local_pgm.state = PGM_STATE_STOP;
+
+    n_started++;
+
+    if (pthread_create(&p_dev->sender, NULL, FtxLoopbackSender, p_dev) != 0)
+    {
+        FtxLinkClose(&p_dev->link);
+        free(p_dev->p_prg_mem);
+        free(p_dev->p_old_mem);
+        free(p_dev->p_queue);
+        return FTX_ERR_OPEN;
+    }
+    if (pthread_create(&p_dev->thread, NULL, FtxLoopbackThread, p_dev) != 0)
+    {
+        FtxLoopbackStop(p_dev);
+        return FTX_ERR_OPEN;
+    }
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxLoopbackStop
+ *
+ * Stops the device thread and closes the pseudo terminal.
+ *-----------------------------------------------------------------------------*/
+void FtxLoopbackStop
+(
+    FTX_LOOPBACK * p_dev
+)
+{
+    pthread_mutex_lock(&p_dev->lock);
+    p_dev->stop = TRUE;
+    pthread_cond_broadcast(&p_dev->cond);
+    pthread_mutex_unlock(&p_dev->lock);
+    if (p_dev->thread)
+    {
+        pthread_join(p_dev->thread, NULL);
+    }
+    pthread_join(p_dev->sender, NULL);
+    FtxLinkClose(&p_dev->link);
+    free(p_dev->p_prg_mem);
+    free(p_dev->p_old_mem);
+    free(p_dev->p_queue);
+    p_dev->p_prg_mem = NULL;
+    p_dev->p_old_mem = NULL;
+    p_dev->p_queue = NULL;
+}
@@ -0,0 +1,99 @@
+//=============================================================================
+// Header file of the loopback stand-in for a ROBO TX Controller.
+// The loopback device opens a pseudo terminal and answers the online mode
+// requests of ftx_online.c from a thread, so that programs using the online
+// mode library can be run and benchmarked without hardware. Its Transfer
+// Areas behave like a Controller with all outputs wired back to the inputs:
+// TA_INPUT.uni[i] follows TA_OUTPUT.duty[i], and the counter of a motor
+// counts up while the motor is on.
+// The turnaround time of the firmware is emulated as latency: the replies are
+// sent by a second thread when they are due, so the device keeps receiving
+// requests in the meantime, like the firmware does with pipelined requests.
+// The device also accepts program images from ftx_loader.c into an emulated
+// program memory and checks them like the firmware does. The stand-in has
+// one program memory for both targets (RAM disk and flash), which is
+// cleared at the start of a load unless FTX_LOAD_KEEP is given; then a copy
+// of it is the source of FTX_CMD_LOAD_COPY. A program
+// state change request takes effect after pgm_delay_ms, like the start and
+// stop of a program by the firmware.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __FTX_LOOPBACK_H__
+#define __FTX_LOOPBACK_H__
+
+#include <pthread.h>
+
+#include "ftx_online.h"
+#include "ftx_loader.h"
+
+#define FTX_LOOPBACK_DEV_LEN    64
+#define FTX_LOOPBACK_QUEUE_LEN  32      // max. number of delayed replies
+
+
+// Loopback device
+typedef struct
+{
+    FTX_LINK        link;                           // pty master side
+    pthread_t       thread;
+    volatile BOOL32 stop;
+    UINT32          reply_delay_us;                 // emulated turnaround time of the firmware
+
+    // Delayed replies, only used with reply_delay_us
+    pthread_t       sender;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    FTX_FRAME     * p_queue;                        // FTX_LOOPBACK_QUEUE_LEN replies
+    unsigned long long due_us[FTX_LOOPBACK_QUEUE_LEN];
+    UINT32          q_head;
+    UINT32          q_count;
+
+    UINT32          ext_mask;                       // areas which are online (TA_LOCAL is always online)
+    UINT32          baud;                           // emulated speed of the link, 0 = no limit
+    UINT32          n_requests;                     // number of served requests
+    char            dev[FTX_LOOPBACK_DEV_LEN];      // pty slave path, to be opened by FtxLinkOpen
+    TA              ta[TA_COUNT];
+    FTX_FRAME       request;
+    UCHAR8          reply[FTX_PAYLOAD_MAX];
+    UCHAR8          error;                          // error code of an invalid request
+
+    // Program loading
+    UCHAR8        * p_prg_mem;                      // PRG_MEM_SIZE bytes
+    UCHAR8        * p_old_mem;                      // program memory at the start of the load, source of copies
+    BOOL32          is_loading;
+    UCHAR8          load_target;
+    UINT32          load_size;
+    UINT32          load_crc;
+    UINT32          n_loads;                        // number of completed loads
+    char            load_name[FTX_LOAD_NAME_LEN];   // name of the last loaded program
+
+    // Program state
+    UINT32          pgm_delay_ms;                   // time until a state change request takes effect
+    unsigned long long pgm_due_us;
+    char            pgm_name[FTX_PGM_NAME_LEN];     // ta[TA_LOCAL].state.local_pgm.name
+} FTX_LOOPBACK;
+
+
+// Creates the pseudo terminal and starts the device thread
+int FtxLoopbackStart
+(
+    FTX_LOOPBACK * p_dev,
+    UINT32 reply_delay_us,
+    UINT32 ext_mask
+);
+
+
+// Stops the device thread and closes the pseudo terminal
+void FtxLoopbackStop
+(
+    FTX_LOOPBACK * p_dev
+);
+
+
+#endif // __FTX_LOOPBACK_H__
@@ -0,0 +1,380 @@
+//=============================================================================
+// Online mode client library for Linux PC-programs.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <errno.h>
+#include <string.h>
+
+#include "ftx_online.h"
+
+
+// TA_INFO has the firmware layout on every build (ROBO_TX_ABI.h)
+TA_ABI_ASSERT(sizeof(TA_INFO) == FTX_INFO_WIRE_SIZE, ftx_info_wire);
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxInfoPack
+ *
+ * Converts TA_INFO to its firmware representation.
+ *-----------------------------------------------------------------------------*/
+void FtxInfoPack
+(
+    UCHAR8 * p_wire,
+    const TA_INFO * p_info
+)
+{
+    memcpy(p_wire, p_info, FTX_INFO_WIRE_SIZE);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxInfoUnpack
+ *
+ * Converts TA_INFO from its firmware representation.
+ *-----------------------------------------------------------------------------*/
+void FtxInfoUnpack
+(
+    TA_INFO * p_info,
+    const UCHAR8 * p_wire
+)
+{
+    memcpy(p_info, p_wire, FTX_INFO_WIRE_SIZE);
+    p_info->device_name[DEV_NAME_LEN_MAX] = '\0';
+    p_info->bt_addr[BT_ADDR_STR_LEN] = '\0';
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxStatePack
+ *
+ * Converts the public part of TA_STATE to its wire representation.
+ *-----------------------------------------------------------------------------*/
+void FtxStatePack
+(
+    UCHAR8 * p_wire,
+    const TA_STATE * p_state
+)
+{
+    memset(p_wire, 0, FTX_STATE_WIRE_SIZE);
+    p_wire[0] = p_state->dev_mode;
+    p_wire[1] = p_state->id;
+    p_wire[2] = p_state->info_id;
+    p_wire[3] = p_state->config_id;
+    memcpy(&p_wire[4], p_state->ext_dev_connect_state, N_EXT);
+    p_wire[4 + N_EXT] = p_state->local_pgm.state;
+    if (p_state->local_pgm.name)
+    {
+        strncpy((char *)&p_wire[8 + N_EXT], p_state->local_pgm.name, FTX_PGM_NAME_LEN - 1);
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxStateUnpack
+ *
+ * Converts the public part of TA_STATE from its wire representation.
+ *-----------------------------------------------------------------------------*/
+void FtxStateUnpack
+(
+    TA_STATE * p_state,
+    char * p_name,
+    const UCHAR8 * p_wire
+)
+{
+    p_state->dev_mode = p_wire[0];
+    p_state->id = p_wire[1];
+    p_state->info_id = p_wire[2];
+    p_state->config_id = p_wire[3];
+    memcpy(p_state->ext_dev_connect_state, &p_wire[4], N_EXT);
+    p_state->local_pgm.state = p_wire[4 + N_EXT];
+    memcpy(p_name, &p_wire[8 + N_EXT], FTX_PGM_NAME_LEN - 1);
+    p_name[FTX_PGM_NAME_LEN - 1] = '\0';
+    p_state->local_pgm.name = p_name;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxUpdateChange
+ *
+ * Compares two input structures and fills the change structure.
+ *-----------------------------------------------------------------------------*/
+void FtxUpdateChange
+(
+    TA_CHANGE * p_change,
+    const TA_INPUT * p_old,
+    const TA_INPUT * p_new
+)
+{
+    UINT8 uni = 0, cnt_in = 0, counter = 0;
+    int i;
+
+    for (i = 0; i < N_UNI; i++)
+    {
+        if (p_old->uni[i] != p_new->uni[i])
+            uni |= 1 << i;
+    }
+    for (i = 0; i < N_CNT; i++)
+    {
+        if (p_old->cnt_in[i] != p_new->cnt_in[i])
+            cnt_in |= 1 << i;
+        if (p_old->counter[i] != p_new->counter[i])
+            counter |= 1 << i;
+    }
+
+    // Bits are accumulated until the program clears them
+    p_change->ChangeUni |= uni;
+    p_change->ChangeCntIn |= cnt_in;
+    p_change->ChangeCounter |= counter;
+    if (uni | cnt_in | counter)
+    {
+        p_change->ChangeStatus = TRUE;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxSetStatus
+ *
+ * Updates TA_STATUS of the selected Transfer Areas after a transaction.
+ *-----------------------------------------------------------------------------*/
+static void FtxSetStatus
+(
+    FTX_ONLINE * p_ftx,
+    UINT32 area_mask,   // areas of the request
+    UINT32 run_mask,    // areas which answered
+    UINT8 iostatus,
+    int rc
+)
+{
+    UINT16 com_err = (rc == FTX_ERR_IO) ? (UINT16)errno : 0;
+    int idx;
+
+    for (idx = 0; idx < TA_COUNT; idx++)
+    {
+        if (area_mask & FTX_AREA_MASK(idx))
+        {
+            TA_STATUS * p_status = &p_ftx->ta[idx].status;
+
+            p_status->status = (rc == FTX_OK && (run_mask & FTX_AREA_MASK(idx))) ?
+                TA_STATUS_RUN : TA_STATUS_STOP;
+            p_status->iostatus = iostatus;
+            p_status->ComErr = com_err;
+        }
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxOnlineOpen
+ *
+ * Opens the connection over the given tty.
+ *-----------------------------------------------------------------------------*/
+int FtxOnlineOpen
+(
+    FTX_ONLINE * p_ftx,
+    const char * dev,
+    UINT32 baud
+)
+{
+    memset(p_ftx->ta, 0, sizeof(p_ftx->ta));
+    return FtxLinkOpen(&p_ftx->link, dev, baud);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxOnlineClose
+ *-----------------------------------------------------------------------------*/
+void FtxOnlineClose
+(
+    FTX_ONLINE * p_ftx
+)
+{
+    FtxLinkClose(&p_ftx->link);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxOnlineGetInfo
+ *
+ * Reads TA_INFO of the local Controller.
+ *-----------------------------------------------------------------------------*/
+int FtxOnlineGetInfo
+(
+    FTX_ONLINE * p_ftx
+)
+{
+    int rc = FtxLinkTransact(&p_ftx->link, FTX_CMD_INFO, NULL, 0, &p_ftx->reply);
+
+    if (rc != FTX_OK)
+    {
+        return rc;
+    }
+    if (p_ftx->reply.len != FTX_INFO_WIRE_SIZE)
+    {
+        return FTX_ERR_REPLY;
+    }
+    FtxInfoUnpack(&p_ftx->ta[TA_LOCAL].info, p_ftx->reply.payload);
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxOnlineGetState
+ *
+ * Reads the public part of TA_STATE of the local Controller.
+ *-----------------------------------------------------------------------------*/
+int FtxOnlineGetState
+(
+    FTX_ONLINE * p_ftx
+)
+{
+    int rc = FtxLinkTransact(&p_ftx->link, FTX_CMD_STATE, NULL, 0, &p_ftx->reply);
+
+    if (rc != FTX_OK)
+    {
+        return rc;
+    }
+    if (p_ftx->reply.len != FTX_STATE_WIRE_SIZE)
+    {
+        return FTX_ERR_REPLY;
+    }
+    FtxStateUnpack(&p_ftx->ta[TA_LOCAL].state, p_ftx->pgm_name, p_ftx->reply.payload);
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxOnlineSetPgmState
+ *
+ * Requests a program state change of the local Controller.
+ * Request payload: pgm_state_req (1).
+ *-----------------------------------------------------------------------------*/
+int FtxOnlineSetPgmState
+(
+    FTX_ONLINE * p_ftx,
+    UINT8 pgm_state
+)
+{
+    int rc;
+
+    if (pgm_state != PGM_STATE_RUN && pgm_state != PGM_STATE_STOP)
+    {
+        return FTX_ERR_PARAM;
+    }
+    rc = FtxLinkTransact(&p_ftx->link, FTX_CMD_PROGRAM, &pgm_state, 1, &p_ftx->reply);
+    if (rc == FTX_OK)
+    {
+        p_ftx->ta[TA_LOCAL].config.pgm_state_req = pgm_state;
+    }
+    return rc;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxOnlineSetConfig
+ *
+ * Sends TA_CONFIG of the selected Transfer Areas.
+ * Request payload: area mask (2) | TA_CONFIG of each selected area.
+ *-----------------------------------------------------------------------------*/
+int FtxOnlineSetConfig
+(
+    FTX_ONLINE * p_ftx,
+    UINT32 area_mask
+)
+{
+    UCHAR8 payload[2 + TA_COUNT * sizeof(TA_CONFIG)];
+    UINT32 len = 2;
+    int idx, rc;
+
+    area_mask &= FTX_AREA_MASK_ALL;
+    payload[0] = (UCHAR8)area_mask;
+    payload[1] = (UCHAR8)(area_mask >> 8);
+    for (idx = 0; idx < TA_COUNT; idx++)
+    {
+        if (area_mask & FTX_AREA_MASK(idx))
+        {
+            memcpy(&payload[len], &p_ftx->ta[idx].config, sizeof(TA_CONFIG));
+            len += sizeof(TA_CONFIG);
+        }
+    }
+
+    rc = FtxLinkTransact(&p_ftx->link, FTX_CMD_CONFIG, payload, len, &p_ftx->reply);
+    FtxSetStatus(p_ftx, area_mask, area_mask, SE_CONFIG_REQ, rc);
+    return rc;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxOnlineExchange
+ *
+ * Sends TA_OUTPUT and receives TA_INPUT of the selected Transfer Areas.
+ * Request payload: area mask (2) | TA_OUTPUT of each selected area.
+ * Reply payload:   area mask (2) | TA_INPUT of each area of the reply mask.
+ *-----------------------------------------------------------------------------*/
+int FtxOnlineExchange
+(
+    FTX_ONLINE * p_ftx,
+    UINT32 area_mask
+)
+{
+    UCHAR8 payload[2 + TA_COUNT * sizeof(TA_OUTPUT)];
+    const UCHAR8 * p_in;
+    UINT32 len = 2, reply_mask = 0;
+    int idx, rc;
+
+    area_mask &= FTX_AREA_MASK_ALL;
+    payload[0] = (UCHAR8)area_mask;
+    payload[1] = (UCHAR8)(area_mask >> 8);
+    for (idx = 0; idx < TA_COUNT; idx++)
+    {
+        if (area_mask & FTX_AREA_MASK(idx))
+        {
+            memcpy(&payload[len], &p_ftx->ta[idx].output, sizeof(TA_OUTPUT));
+            len += sizeof(TA_OUTPUT);
+        }
+    }
+
+    rc = FtxLinkTransact(&p_ftx->link, FTX_CMD_EXCHANGE, payload, len, &p_ftx->reply);
+    if (rc == FTX_OK)
+    {
+        reply_mask = p_ftx->reply.payload[0] | ((UINT32)p_ftx->reply.payload[1] << 8);
+        len = 2;
+        for (idx = 0; idx < TA_COUNT; idx++)
+        {
+            if (reply_mask & FTX_AREA_MASK(idx))
+            {
+                len += sizeof(TA_INPUT);
+            }
+        }
+        if (p_ftx->reply.len != len || (reply_mask & ~area_mask))
+        {
+            rc = FTX_ERR_REPLY;
+        }
+        else
+        {
+            p_in = &p_ftx->reply.payload[2];
+            for (idx = 0; idx < TA_COUNT; idx++)
+            {
+                if (reply_mask & FTX_AREA_MASK(idx))
+                {
+                    TA * p_ta = &p_ftx->ta[idx];
+                    TA_INPUT input;
+
+                    memcpy(&input, p_in, sizeof(TA_INPUT));
+                    FtxUpdateChange(&p_ta->change, &p_ta->input, &input);
+                    p_ta->input = input;
+                    p_in += sizeof(TA_INPUT);
+                }
+            }
+        }
+    }
+    FtxSetStatus(p_ftx, area_mask, reply_mask, SE_REMIO_REQ, rc);
+    return rc;
+}
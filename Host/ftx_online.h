@@ -0,0 +1,152 @@
+//=============================================================================
+// Header file of the online mode client library prototype for Linux
+// PC-programs.
+// The library keeps an array of TA_COUNT Transfer Areas in the PC memory and
+// synchronizes it with a Controller: one FtxOnlineExchange call sends
+// TA_OUTPUT and receives TA_INPUT of all selected Transfer Areas (local
+// Controller and extensions) in one round-trip and fills TA_CHANGE and
+// TA_STATUS of these Transfer Areas.
+// The requests (FTX_CMD_INFO, FTX_CMD_CONFIG and FTX_CMD_EXCHANGE over the
+// framing of ftx_link.h) are a prototype protocol answered by the loopback
+// stand-in (ftx_loopback.h); the ROBO TX firmware does not implement them.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __FTX_ONLINE_H__
+#define __FTX_ONLINE_H__
+
+#include "ftx_link.h"
+
+#define FTX_AREA_MASK_ALL   ((1 << TA_COUNT) - 1)   // all 9 Transfer Areas
+#define FTX_AREA_MASK(idx)  (1 << (idx))
+
+// Values of TA_STATUS.status
+#define TA_STATUS_STOP      0
+#define TA_STATUS_RUN       1
+#define TA_STATUS_SYNC      2
+
+// Values of TA_STATUS.iostatus
+#define SE_REMIO_REQ        0
+#define SE_CONFIG_REQ       1
+
+#define FTX_INFO_WIRE_SIZE  64  // size of TA_INFO as used by the firmware
+
+// Public part of TA_STATE: dev_mode (1) | id (1) | info_id (1) | config_id (1) |
+// ext_dev_connect_state (N_EXT) | local_pgm.state (1) | reserved (3) | local_pgm.name (FTX_PGM_NAME_LEN)
+#define FTX_PGM_NAME_LEN    64
+#define FTX_STATE_WIRE_SIZE (8 + N_EXT + FTX_PGM_NAME_LEN)
+
+
+// Online connection to a ROBO TX Controller
+typedef struct
+{
+    FTX_LINK        link;
+    TA              ta[TA_COUNT];   // Transfer Areas of the local Controller and its extensions
+    char            pgm_name[FTX_PGM_NAME_LEN];     // ta[TA_LOCAL].state.local_pgm.name
+    FTX_FRAME       reply;
+} FTX_ONLINE;
+
+
+// Opens the connection over the given tty
+int FtxOnlineOpen
+(
+    FTX_ONLINE * p_ftx,
+    const char * dev,
+    UINT32 baud
+);
+
+
+void FtxOnlineClose
+(
+    FTX_ONLINE * p_ftx
+);
+
+
+// Reads TA_INFO of the local Controller into ta[TA_LOCAL].info
+int FtxOnlineGetInfo
+(
+    FTX_ONLINE * p_ftx
+);
+
+
+// Reads the public part of TA_STATE of the local Controller into ta[TA_LOCAL].state
+int FtxOnlineGetState
+(
+    FTX_ONLINE * p_ftx
+);
+
+
+// Requests a program state change (PGM_STATE_RUN or PGM_STATE_STOP) of the
+// local Controller. Only TA_CONFIG.pgm_state_req is changed, the rest of the
+// configuration is kept. The program state follows asynchronously, see
+// FtxOnlineGetState.
+int FtxOnlineSetPgmState
+(
+    FTX_ONLINE * p_ftx,
+    UINT8 pgm_state
+);
+
+
+// Sends TA_CONFIG of the Transfer Areas selected by area_mask
+int FtxOnlineSetConfig
+(
+    FTX_ONLINE * p_ftx,
+    UINT32 area_mask
+);
+
+
+// Sends TA_OUTPUT and receives TA_INPUT of the Transfer Areas selected by area_mask
+// in one round-trip, then updates TA_CHANGE and TA_STATUS of these Transfer Areas
+int FtxOnlineExchange
+(
+    FTX_ONLINE * p_ftx,
+    UINT32 area_mask
+);
+
+
+// Compares two input structures and fills the change structure
+void FtxUpdateChange
+(
+    TA_CHANGE * p_change,
+    const TA_INPUT * p_old,
+    const TA_INPUT * p_new
+);
+
+
+// Converts TA_INFO to/from its firmware representation (FTX_INFO_WIRE_SIZE bytes)
+void FtxInfoPack
+(
+    UCHAR8 * p_wire,
+    const TA_INFO * p_info
+);
+
+void FtxInfoUnpack
+(
+    TA_INFO * p_info,
+    const UCHAR8 * p_wire
+);
+
+
+// Converts the public part of TA_STATE to/from its wire representation
+// (FTX_STATE_WIRE_SIZE bytes). local_pgm.name is copied from/to p_name.
+void FtxStatePack
+(
+    UCHAR8 * p_wire,
+    const TA_STATE * p_state
+);
+
+void FtxStateUnpack
+(
+    TA_STATE * p_state,
+    char * p_name,
+    const UCHAR8 * p_wire
+);
+
+
+#endif // __FTX_ONLINE_H__
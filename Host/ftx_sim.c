@@ -0,0 +1,643 @@
+//=============================================================================
+// Host simulator of the ROBO TX Controller firmware.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "ftx_sim.h"
+
+// Program header, defined by prg_disp.c of the simulated program
+extern const struct prg_code_intro_s prg_code_intro;
+
+typedef int (*P_PRG_ENTRY)(TA * p_ta_array, int ta_count);
+
+// Current simulator, used by the hook functions
+static FTX_SIM * p_sim_cur;
+
+
+/*-----------------------------------------------------------------------------
+ * Hook functions: system, display
+ *-----------------------------------------------------------------------------*/
+static BOOL32 SimIsRunAllowed(void)
+{
+    return !p_sim_cur->run_allowed_max || ++p_sim_cur->run_allowed_calls <= p_sim_cur->run_allowed_max;
+}
+
+static UINT32 SimGetSystemTime
+(
+    enum TimerUnit unit
+)
+{
+    switch (unit)
+    {
+        case TIMER_UNIT_SECONDS:        return (UINT32)(p_sim_cur->time_us / 1000000);
+        case TIMER_UNIT_MILLISECONDS:   return (UINT32)(p_sim_cur->time_us / 1000);
+        case TIMER_UNIT_MICROSECONDS:   return (UINT32)p_sim_cur->time_us;
+        default:                        return 0;
+    }
+}
+
+static void SimDisplayMsg
+(
+    struct ta_s * p_ta,
+    char * p_msg
+)
+{
+    if (!p_msg)
+    {
+        p_sim_cur->display[0] = '\0';
+        return;
+    }
+    strncpy(p_sim_cur->display, p_msg, DISPL_MSG_LEN_MAX);
+    p_sim_cur->n_display_msgs++;
+    if (p_sim_cur->print_display)
+    {
+        printf("[%10.3f s] %s\n", p_sim_cur->time_us / 1e6, p_sim_cur->display);
+    }
+}
+
+static BOOL32 SimIsDisplayBeingRefreshed
+(
+    struct ta_s * p_ta
+)
+{
+    return FALSE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Hook functions: Bluetooth
+ *-----------------------------------------------------------------------------*/
+static void SimBtCommand
+(
+    UINT32 cmd,
+    UINT32 channel,
+    P_CB_FUNC p_cb,
+    const UCHAR8 * p_data,
+    UINT32 len
+)
+{
+    if (channel < BT_CHAN_IDX_MIN || channel > BT_CHAN_IDX_MAX)
+    {
+        return;
+    }
+    p_sim_cur->bt_cb[channel] = p_cb;
+    if (!p_sim_cur->replay && p_sim_cur->p_model && p_sim_cur->p_model->BtCommand)
+    {
+        p_sim_cur->p_model->BtCommand(p_sim_cur, cmd, channel, p_data, len);
+    }
+}
+
+static void SimBtConnect(UINT32 channel, UCHAR8 * btaddr, P_CB_FUNC p_cb_func)
+{
+    SimBtCommand(CMD_CONNECT, channel, p_cb_func, btaddr, BT_ADDR_LEN);
+}
+
+static void SimBtDisconnect(UINT32 channel, P_CB_FUNC p_cb_func)
+{
+    SimBtCommand(CMD_DISCONNECT, channel, p_cb_func, NULL, 0);
+}
+
+static void SimBtSend(UINT32 channel, UINT32 len, UCHAR8 * p_msg, P_CB_FUNC p_cb_func)
+{
+    SimBtCommand(CMD_SEND, channel, p_cb_func, p_msg, len);
+}
+
+static void SimBtStartListen(UINT32 channel, UCHAR8 * btaddr, P_CB_FUNC p_cb_func)
+{
+    SimBtCommand(CMD_START_LISTEN, channel, p_cb_func, btaddr, BT_ADDR_LEN);
+}
+
+static void SimBtStopListen(UINT32 channel, P_CB_FUNC p_cb_func)
+{
+    SimBtCommand(CMD_STOP_LISTEN, channel, p_cb_func, NULL, 0);
+}
+
+static void SimBtStartReceive(UINT32 channel, P_RECV_CB_FUNC p_cb_func)
+{
+    if (channel >= BT_CHAN_IDX_MIN && channel <= BT_CHAN_IDX_MAX)
+    {
+        p_sim_cur->bt_recv_cb[channel] = p_cb_func;
+        SimBtCommand(CMD_START_RECEIVE, channel, p_sim_cur->bt_cb[channel], NULL, 0);
+    }
+}
+
+static void SimBtStopReceive(UINT32 channel, P_RECV_CB_FUNC p_cb_func)
+{
+    if (channel >= BT_CHAN_IDX_MIN && channel <= BT_CHAN_IDX_MAX)
+    {
+        p_sim_cur->bt_recv_cb[channel] = p_cb_func;
+        SimBtCommand(CMD_STOP_RECEIVE, channel, p_sim_cur->bt_cb[channel], NULL, 0);
+    }
+}
+
+static char * SimBtAddrToStr(UCHAR8 * btaddr, char * str)
+{
+    sprintf(str, "%02x:%02x:%02x:%02x:%02x:%02x",
+        btaddr[0], btaddr[1], btaddr[2], btaddr[3], btaddr[4], btaddr[5]);
+    return str;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Hook functions: I2C
+ *-----------------------------------------------------------------------------*/
+static UINT32 SimI2cTransfer
+(
+    BOOL32 is_write,
+    UCHAR8 devaddr,
+    UINT32 offset,
+    UINT16 data,
+    UCHAR8 protocol,
+    P_I2C_CB_FUNC p_cb_func
+)
+{
+    FTX_SIM_EVENT event;
+    UINT32 duration = FTX_SIM_I2C_DELAY_US;
+    uint64_t start;
+
+    if (p_sim_cur->n_i2c >= FTX_SIM_I2C_QUEUE)
+    {
+        return 1; // command is not accepted
+    }
+    p_sim_cur->i2c_cb[p_sim_cur->n_i2c++] = p_cb_func;
+
+    if (p_sim_cur->replay)
+    {
+        return 0;
+    }
+
+    memset(&event, 0, sizeof(event));
+    event.type = FTX_SIM_EV_I2C;
+    event.data.i2c.status = I2C_SUCCESS;
+    if (p_sim_cur->p_model && p_sim_cur->p_model->I2cTransfer)
+    {
+        duration = p_sim_cur->p_model->I2cTransfer(p_sim_cur, is_write, devaddr, offset, data,
+            protocol, &event.data.i2c);
+    }
+
+    // Transactions are executed one after another on the bus
+    start = (p_sim_cur->i2c_busy_until > p_sim_cur->time_us) ? p_sim_cur->i2c_busy_until : p_sim_cur->time_us;
+    p_sim_cur->i2c_busy_until = start + duration;
+    FtxSimSchedule(p_sim_cur, (UINT32)(p_sim_cur->i2c_busy_until - p_sim_cur->time_us), &event);
+    return 0;
+}
+
+static UINT32 SimI2cRead(UCHAR8 devaddr, UINT32 offset, UCHAR8 protocol, P_I2C_CB_FUNC p_cb_func)
+{
+    return SimI2cTransfer(FALSE, devaddr, offset, 0, protocol, p_cb_func);
+}
+
+static UINT32 SimI2cWrite(UCHAR8 devaddr, UINT32 offset, UINT16 data, UCHAR8 protocol, P_I2C_CB_FUNC p_cb_func)
+{
+    return SimI2cTransfer(TRUE, devaddr, offset, data, protocol, p_cb_func);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Hook functions: runtime library
+ *-----------------------------------------------------------------------------*/
+static INT32 SimSprintf(char * s, const char * format, ...)
+{
+    va_list args;
+    INT32 n;
+
+    va_start(args, format);
+    n = vsprintf(s, format, args);
+    va_end(args);
+    return n;
+}
+
+static INT32 SimMemcmp(const void * s1, const void * s2, UINT32 n)             { return memcmp(s1, s2, n); }
+static void * SimMemcpy(void * s1, const void * s2, UINT32 n)                 { return memcpy(s1, s2, n); }
+static void * SimMemmove(void * s1, const void * s2, UINT32 n)                { return memmove(s1, s2, n); }
+static void * SimMemset(void * s, INT32 c, UINT32 n)                          { return memset(s, c, n); }
+static char * SimStrcat(char * s1, const char * s2)                           { return strcat(s1, s2); }
+static char * SimStrncat(char * s1, const char * s2, UINT32 n)                { return strncat(s1, s2, n); }
+static char * SimStrchr(const char * s, INT32 c)                              { return strchr(s, c); }
+static char * SimStrrchr(const char * s, INT32 c)                             { return strrchr(s, c); }
+static INT32 SimStrcmp(const char * s1, const char * s2)                      { return strcmp(s1, s2); }
+static INT32 SimStrncmp(const char * s1, const char * s2, UINT32 n)           { return strncmp(s1, s2, n); }
+static INT32 SimStricmp(const char * s1, const char * s2)                     { return strcasecmp(s1, s2); }
+static INT32 SimStrnicmp(const char * s1, const char * s2, UINT32 n)          { return strncasecmp(s1, s2, n); }
+static char * SimStrcpy(char * s1, const char * s2)                           { return strcpy(s1, s2); }
+static char * SimStrncpy(char * s1, const char * s2, UINT32 n)                { return strncpy(s1, s2, n); }
+static UINT32 SimStrlen(const char * s)                                       { return strlen(s); }
+static char * SimStrstr(const char * s1, const char * s2)                     { return strstr(s1, s2); }
+static char * SimStrtok(char * s1, const char * s2)                           { return strtok(s1, s2); }
+static INT32 SimAtoi(const char * nptr)                                       { return atoi(nptr); }
+
+static char * SimStrupr(char * s)
+{
+    char * p;
+
+    for (p = s; *p; p++)
+        *p = toupper((unsigned char)*p);
+    return s;
+}
+
+static char * SimStrlwr(char * s)
+{
+    char * p;
+
+    for (p = s; *p; p++)
+        *p = tolower((unsigned char)*p);
+    return s;
+}
+
+
+static const TA_HOOK_TABLE sim_hook_table =
+{
+    /* IsRunAllowed             */ SimIsRunAllowed,
+    /* GetSystemTime            */ SimGetSystemTime,
+    /* DisplayMsg               */ SimDisplayMsg,
+    /* IsDisplayBeingRefreshed  */ SimIsDisplayBeingRefreshed,
+    /* BtConnect                */ SimBtConnect,
+    /* BtDisconnect             */ SimBtDisconnect,
+    /* BtSend                   */ SimBtSend,
+    /* BtStartReceive           */ SimBtStartReceive,
+    /* BtStopReceive            */ SimBtStopReceive,
+    /* BtStartListen            */ SimBtStartListen,
+    /* BtStopListen             */ SimBtStopListen,
+    /* BtAddrToStr              */ SimBtAddrToStr,
+    /* I2cRead                  */ SimI2cRead,
+    /* I2cWrite                 */ SimI2cWrite,
+    /* sprintf                  */ SimSprintf,
+    /* memcmp                   */ SimMemcmp,
+    /* memcpy                   */ SimMemcpy,
+    /* memmove                  */ SimMemmove,
+    /* memset                   */ SimMemset,
+    /* strcat                   */ SimStrcat,
+    /* strncat                  */ SimStrncat,
+    /* strchr                   */ SimStrchr,
+    /* strrchr                  */ SimStrrchr,
+    /* strcmp                   */ SimStrcmp,
+    /* strncmp                  */ SimStrncmp,
+    /* stricmp                  */ SimStricmp,
+    /* strnicmp                 */ SimStrnicmp,
+    /* strcpy                   */ SimStrcpy,
+    /* strncpy                  */ SimStrncpy,
+    /* strlen                   */ SimStrlen,
+    /* strstr                   */ SimStrstr,
+    /* strtok                   */ SimStrtok,
+    /* strupr                   */ SimStrupr,
+    /* strlwr                   */ SimStrlwr,
+    /* atoi                     */ SimAtoi
+};
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxSimInit
+ *
+ * Initializes the simulator and makes it the current one.
+ *-----------------------------------------------------------------------------*/
+void FtxSimInit
+(
+    FTX_SIM * p_sim,
+    const FTX_SIM_MODEL * p_model,
+    void * p_model_data
+)
+{
+    int idx;
+
+    memset(p_sim, 0, sizeof(*p_sim));
+    p_sim->p_model = p_model;
+    p_sim->p_model_data = p_model_data;
+    p_sim->rc = FTX_SIM_RC_RUN;
+
+    for (idx = 0; idx < TA_COUNT; idx++)
+    {
+        TA * p_ta = &p_sim->ta[idx];
+
+        snprintf(p_ta->info.device_name, sizeof(p_ta->info.device_name), "ROBO TX-SIM%d", idx);
+        snprintf(p_ta->info.bt_addr, sizeof(p_ta->info.bt_addr), "00:13:7b:5e:00:%02x", idx);
+        p_ta->info.pgm_area_start_addr = PRG_MEM_START;
+        p_ta->info.pgm_area_size = PRG_MEM_SIZE;
+        p_ta->info.version.hardware.part.a = 'C';
+        p_ta->info.version.ta.abcd = TA_VERSION;
+
+        p_ta->state.dev_mode = DEV_MODE_LOCAL;
+        p_ta->state.local_pgm.state = PGM_STATE_RUN;
+        p_ta->hook_table = sim_hook_table;
+    }
+    p_sim->ta[TA_LOCAL].state.local_pgm.name = "/ramdisk/Simulated";
+
+    p_sim_cur = p_sim;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxSimSchedule
+ *
+ * Schedules a callback delay_us after the current virtual time.
+ *-----------------------------------------------------------------------------*/
+BOOL32 FtxSimSchedule
+(
+    FTX_SIM * p_sim,
+    UINT32 delay_us,
+    const FTX_SIM_EVENT * p_event
+)
+{
+    uint64_t t = p_sim->time_us + delay_us;
+    UINT32 pos = p_sim->n_events;
+
+    if (p_sim->n_events >= FTX_SIM_EVENTS_MAX)
+    {
+        return FALSE;
+    }
+
+    // Insert behind all events of the same time to keep the order of scheduling
+    while (pos > 0 && p_sim->events[pos - 1].time_us > t)
+    {
+        p_sim->events[pos] = p_sim->events[pos - 1];
+        pos--;
+    }
+    p_sim->events[pos] = *p_event;
+    p_sim->events[pos].time_us = t;
+    p_sim->n_events++;
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxSimDeliver
+ *
+ * Delivers a callback to the callback function registered by the program.
+ *-----------------------------------------------------------------------------*/
+void FtxSimDeliver
+(
+    FTX_SIM * p_sim,
+    const FTX_SIM_EVENT * p_event
+)
+{
+    FTX_SIM_EVENT event = *p_event;
+    UINT32 chan;
+
+    switch (event.type)
+    {
+        case FTX_SIM_EV_BT:
+            chan = event.data.bt.chan_idx;
+            if (chan >= BT_CHAN_IDX_MIN && chan <= BT_CHAN_IDX_MAX && p_sim->bt_cb[chan])
+            {
+                p_sim->bt_cb[chan](p_sim->ta, &event.data.bt);
+            }
+            break;
+
+        case FTX_SIM_EV_BT_RECV:
+            chan = event.data.bt_recv.chan_idx;
+            if (chan >= BT_CHAN_IDX_MIN && chan <= BT_CHAN_IDX_MAX && p_sim->bt_recv_cb[chan])
+            {
+                p_sim->bt_recv_cb[chan](p_sim->ta, &event.data.bt_recv);
+            }
+            break;
+
+        case FTX_SIM_EV_I2C:
+            if (p_sim->n_i2c)
+            {
+                P_I2C_CB_FUNC p_cb = p_sim->i2c_cb[0];
+
+                p_sim->n_i2c--;
+                memmove(&p_sim->i2c_cb[0], &p_sim->i2c_cb[1], p_sim->n_i2c * sizeof(p_sim->i2c_cb[0]));
+                if (p_cb)
+                {
+                    p_cb(p_sim->ta, &event.data.i2c);
+                }
+            }
+            break;
+
+        default:
+            return;
+    }
+
+    if (p_sim->OnDeliver)
+    {
+        p_sim->OnDeliver(p_sim, p_event);
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxSimTick
+ *
+ * Delivers all due callbacks, runs one program tick and advances the
+ * virtual time.
+ *-----------------------------------------------------------------------------*/
+INT32 FtxSimTick
+(
+    FTX_SIM * p_sim
+)
+{
+    P_PRG_ENTRY p_entry = (P_PRG_ENTRY)prg_code_intro.entry;
+    uint64_t now = p_sim->time_us;
+
+    p_sim_cur = p_sim;
+
+    // The callbacks see the time of their event, so commands issued by a callback
+    // are scheduled from there and may complete before this tick as well
+    while (p_sim->n_events && p_sim->events[0].time_us <= now)
+    {
+        FTX_SIM_EVENT event = p_sim->events[0];
+
+        p_sim->n_events--;
+        memmove(&p_sim->events[0], &p_sim->events[1], p_sim->n_events * sizeof(p_sim->events[0]));
+        p_sim->time_us = event.time_us;
+        FtxSimDeliver(p_sim, &event);
+    }
+    p_sim->time_us = now;
+
+    if (!p_sim->replay && p_sim->p_model && p_sim->p_model->UpdateInputs)
+    {
+        p_sim->p_model->UpdateInputs(p_sim);
+    }
+    if (p_sim->OnTic)
+    {
+        p_sim->OnTic(p_sim);
+    }
+    p_sim->run_allowed_calls = 0;
+
+    if (p_sim->RunProgram)
+    {
+        p_sim->rc = p_sim->RunProgram(p_sim);
+    }
+    else
+    {
+        p_sim->rc = p_entry(p_sim->ta, TA_COUNT);
+    }
+    p_sim->n_ticks++;
+    p_sim->time_us += CALL_CYCLE_MS * 1000;
+    return p_sim->rc;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxSimDefaultInputs
+ *
+ * Default model of the inputs: counter resets, motor counters and the
+ * extended motor control.
+ *-----------------------------------------------------------------------------*/
+void FtxSimDefaultInputs
+(
+    FTX_SIM * p_sim
+)
+{
+    int idx, i;
+
+    for (idx = 0; idx < TA_COUNT; idx++)
+    {
+        TA * p_ta = &p_sim->ta[idx];
+
+        for (i = 0; i < N_CNT; i++)
+        {
+            if (p_ta->output.cnt_reset_cmd_id[i] != p_sim->cnt_reset_cmd_id[idx][i])
+            {
+                p_sim->cnt_reset_cmd_id[idx][i] = p_ta->output.cnt_reset_cmd_id[i];
+                p_ta->input.counter[i] = 0;
+                p_ta->input.cnt_resetted[i] = TRUE;
+                p_sim->cnt_accu[idx][i] = 0;
+            }
+        }
+
+        for (i = 0; i < N_MOTOR && i < N_CNT; i++)
+        {
+            INT32 duty = abs(p_ta->output.duty[2 * i]) + abs(p_ta->output.duty[2 * i + 1]);
+
+            if (p_ta->output.motor_ex_cmd_id[i] != p_sim->motor_ex_cmd_id[idx][i])
+            {
+                p_sim->motor_ex_cmd_id[idx][i] = p_ta->output.motor_ex_cmd_id[i];
+                p_sim->motor_ex_active[idx][i] = TRUE;
+                p_ta->input.counter[i] = 0;
+                p_sim->cnt_accu[idx][i] = 0;
+            }
+            if (p_sim->motor_ex_active[idx][i] && p_ta->input.counter[i] >= p_ta->output.distance[i])
+            {
+                p_sim->motor_ex_active[idx][i] = FALSE;
+                p_ta->input.motor_pos_reached[i] = TRUE;
+            }
+            if (p_ta->output.motor_ex_cmd_id[i] && !p_sim->motor_ex_active[idx][i])
+            {
+                duty = 0; // motor is stopped at the target position
+            }
+
+            // Pulses per tick as a fixed point fraction of 1000 ticks per second
+            p_sim->cnt_accu[idx][i] += duty * FTX_SIM_PULSES_PER_S / DUTY_MAX;
+            while (p_sim->cnt_accu[idx][i] >= 1000 / CALL_CYCLE_MS)
+            {
+                p_sim->cnt_accu[idx][i] -= 1000 / CALL_CYCLE_MS;
+                p_ta->input.counter[i]++;
+                p_ta->input.cnt_in[i] ^= 1;
+            }
+        }
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxSimDefaultBtCommand
+ *
+ * Default model of the Bluetooth commands: every command succeeds, a listen
+ * is followed by an incoming connection.
+ *-----------------------------------------------------------------------------*/
+void FtxSimDefaultBtCommand
+(
+    FTX_SIM * p_sim,
+    UINT32 cmd,
+    UINT32 channel,
+    const UCHAR8 * p_data,
+    UINT32 len
+)
+{
+    FTX_SIM_EVENT event;
+    BT_STATUS * p_status = &p_sim->ta[TA_LOCAL].state.btstatus[channel - BT_CHAN_IDX_MIN];
+
+    memset(&event, 0, sizeof(event));
+    event.type = (cmd == CMD_START_RECEIVE || cmd == CMD_STOP_RECEIVE) ? FTX_SIM_EV_BT_RECV : FTX_SIM_EV_BT;
+    event.data.bt.chan_idx = channel;
+    event.data.bt.status = BT_SUCCESS;
+    if (event.type == FTX_SIM_EV_BT_RECV)
+    {
+        event.data.bt_recv.chan_idx = channel;
+        event.data.bt_recv.status = BT_SUCCESS;
+    }
+    FtxSimSchedule(p_sim, FTX_SIM_BT_DELAY_US, &event);
+
+    switch (cmd)
+    {
+        case CMD_CONNECT:
+            p_status->conn_state = BT_STATE_CONNECTED;
+            break;
+        case CMD_DISCONNECT:
+            p_status->conn_state = BT_STATE_IDLE;
+            p_status->is_receive = FALSE;
+            break;
+        case CMD_START_LISTEN:
+            p_status->is_listen = TRUE;
+            p_status->conn_state = BT_STATE_CONNECTED;
+            event.data.bt.status = BT_CON_INDICATION;
+            FtxSimSchedule(p_sim, 2 * FTX_SIM_BT_DELAY_US, &event);
+            break;
+        case CMD_STOP_LISTEN:
+            p_status->is_listen = FALSE;
+            break;
+        case CMD_START_RECEIVE:
+            p_status->is_receive = TRUE;
+            break;
+        case CMD_STOP_RECEIVE:
+            p_status->is_receive = FALSE;
+            break;
+        default:
+            break;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxSimBtScan
+ *
+ * Scan-status model, the records of one inquiry scan.
+ *-----------------------------------------------------------------------------*/
+UINT32 FtxSimBtScan
+(
+    const FTX_SIM_BT_PEER * p_peers,
+    UINT32 n_peers,
+    UINT32 end_status,
+    BT_SCAN_STATUS * p_status,
+    UINT32 max
+)
+{
+    UINT32 n = 0, i;
+
+    if (max < 2)
+    {
+        return 0;
+    }
+    memset(p_status, 0, max * sizeof(p_status[0]));
+    p_status[n++].status = BT_INQUIRY_SCAN_START;
+    for (i = 0; i < n_peers && n < max - 1; i++, n++)
+    {
+        p_status[n].status = BT_INQUIRY_SCAN_RESULT;
+        memcpy(p_status[n].bt_addr, p_peers[i].bt_addr, BT_ADDR_LEN);
+        strncpy(p_status[n].bt_name, p_peers[i].name, DEV_NAME_LEN_MAX);
+    }
+    p_status[n++].status = end_status;
+    return n;
+}
+
+
+const FTX_SIM_MODEL ftx_sim_default_model =
+{
+    /* UpdateInputs */ FtxSimDefaultInputs,
+    /* BtCommand    */ FtxSimDefaultBtCommand,
+    /* I2cTransfer  */ NULL
+};
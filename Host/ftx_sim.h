@@ -0,0 +1,207 @@
+//=============================================================================
+// Header file of the host simulator of the ROBO TX Controller firmware.
+// The simulator runs an unmodified download (local) mode program on the PC:
+// it provides the array of Transfer Areas with a hook table implemented on
+// the host, calls the program through prg_code_intro.entry once per tick
+// of virtual time and delivers the Bluetooth and I2C callbacks between the
+// ticks, the same way the firmware does.
+//
+// Callbacks are produced by exchangeable models (FTX_SIM_MODEL). Without
+// a model the firmware answers every command successfully after a fixed
+// delay. In replay mode no callbacks are produced at all; they are injected
+// from a recorded trace with FtxSimDeliver.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __FTX_SIM_H__
+#define __FTX_SIM_H__
+
+#include <stdint.h>
+
+#include "ftx_link.h"
+
+#define FTX_SIM_EVENTS_MAX      64      // max. number of scheduled callbacks
+#define FTX_SIM_I2C_QUEUE       16      // max. number of outstanding I2C commands
+
+#define FTX_SIM_BT_DELAY_US     10000   // default delay of Bluetooth command callbacks
+#define FTX_SIM_I2C_DELAY_US    500     // default duration of an I2C transaction
+
+#define FTX_SIM_RC_RUN          0x7FFF  // program return code "call me again"
+
+#define FTX_SIM_PULSES_PER_S    100     // counter pulses per second of a motor at DUTY_MAX
+
+
+// Kinds of callbacks
+enum ftx_sim_event_e
+{
+    FTX_SIM_EV_NONE = 0,
+    FTX_SIM_EV_BT,              // P_CB_FUNC with BT_CB
+    FTX_SIM_EV_BT_RECV,         // P_RECV_CB_FUNC with BT_RECV_CB
+    FTX_SIM_EV_I2C              // P_I2C_CB_FUNC with I2C_CB
+};
+
+
+// Callback event
+typedef struct
+{
+    uint64_t        time_us;    // virtual time of the delivery
+    UINT32          type;       // see enum ftx_sim_event_e
+    union
+    {
+        BT_CB       bt;
+        BT_RECV_CB  bt_recv;
+        I2C_CB      i2c;
+    } data;
+} FTX_SIM_EVENT;
+
+
+struct ftx_sim_s;
+
+// Models of the environment; all functions are optional
+typedef struct
+{
+    // Called before each tick to update the inputs from the outputs
+    void    (*UpdateInputs)     (struct ftx_sim_s * p_sim);
+
+    // Called for each Bluetooth command, should schedule the callback(s) with FtxSimSchedule.
+    // cmd is one of enum bt_commands_e.
+    void    (*BtCommand)        (struct ftx_sim_s * p_sim, UINT32 cmd, UINT32 channel,
+                                 const UCHAR8 * p_data, UINT32 len);
+
+    // Called for each I2C command, returns the I2C_CB of the transaction and its duration
+    UINT32  (*I2cTransfer)      (struct ftx_sim_s * p_sim, BOOL32 is_write, UCHAR8 devaddr,
+                                 UINT32 offset, UINT16 data, UCHAR8 protocol, I2C_CB * p_result);
+} FTX_SIM_MODEL;
+
+
+// Simulator
+typedef struct ftx_sim_s
+{
+    TA              ta[TA_COUNT];
+    uint64_t        time_us;                        // virtual time
+    UINT32          n_ticks;
+    INT32           rc;                             // last return code of the program
+    BOOL32          replay;                         // TRUE = callbacks come from FtxSimDeliver only
+    const FTX_SIM_MODEL * p_model;
+    void          * p_model_data;
+
+    // Callbacks registered by the program
+    P_CB_FUNC       bt_cb[BT_CNT_MAX + 1];          // per channel, last command callback
+    P_RECV_CB_FUNC  bt_recv_cb[BT_CNT_MAX + 1];     // per channel, receive callback
+    P_I2C_CB_FUNC   i2c_cb[FTX_SIM_I2C_QUEUE];      // outstanding I2C commands, oldest first
+    UINT32          n_i2c;
+    uint64_t        i2c_busy_until;                 // end of the last scheduled I2C transaction
+
+    // Scheduled callbacks, sorted by time
+    FTX_SIM_EVENT   events[FTX_SIM_EVENTS_MAX];
+    UINT32          n_events;
+
+    // Called for each delivered callback (for example to record it)
+    void          (*OnDeliver)(struct ftx_sim_s * p_sim, const FTX_SIM_EVENT * p_event);
+
+    // Called right before the program tick, with the inputs as seen by the program
+    void          (*OnTic)(struct ftx_sim_s * p_sim);
+
+    // Runs the program tick instead of the native program (prg_code_intro.entry),
+    // returns the return code of the program
+    INT32         (*RunProgram)(struct ftx_sim_s * p_sim);
+
+    // State of the default model
+    UINT16          cnt_reset_cmd_id[TA_COUNT][N_CNT];
+    UINT16          motor_ex_cmd_id[TA_COUNT][N_MOTOR];
+    BOOL8           motor_ex_active[TA_COUNT][N_MOTOR];
+    UINT32          cnt_accu[TA_COUNT][N_CNT];
+
+    // IsRunAllowed returns FALSE after run_allowed_max calls in a tick (0 = always TRUE),
+    // to test programs which split their work over several ticks
+    UINT32          run_allowed_max;
+    UINT32          run_allowed_calls;
+
+    char            display[DISPL_MSG_LEN_MAX + 1]; // last pop-up message
+    UINT32          n_display_msgs;
+    BOOL32          print_display;                  // TRUE = print pop-up messages to stdout
+} FTX_SIM;
+
+
+// Initializes the simulator and makes it the current one (the hook functions
+// of the firmware have no context parameter, so only one simulator can run at a time)
+void FtxSimInit
+(
+    FTX_SIM * p_sim,
+    const FTX_SIM_MODEL * p_model,
+    void * p_model_data
+);
+
+
+// Delivers all due callbacks, runs one program tick and advances the virtual time
+// by CALL_CYCLE_MS. Returns the return code of the program.
+INT32 FtxSimTick
+(
+    FTX_SIM * p_sim
+);
+
+
+// Schedules a callback delay_us after the current virtual time
+BOOL32 FtxSimSchedule
+(
+    FTX_SIM * p_sim,
+    UINT32 delay_us,
+    const FTX_SIM_EVENT * p_event
+);
+
+
+// Delivers a callback immediately to the callback function registered by the program
+void FtxSimDeliver
+(
+    FTX_SIM * p_sim,
+    const FTX_SIM_EVENT * p_event
+);
+
+
+// Bluetooth device seen by an inquiry scan
+typedef struct
+{
+    UCHAR8          bt_addr[BT_ADDR_LEN];
+    char            name[DEV_NAME_LEN_MAX + 1];
+} FTX_SIM_BT_PEER;
+
+
+// Scan-status model: writes the BT_SCAN_STATUS records of one inquiry scan which
+// finds the devices in the given order to p_status (BT_INQUIRY_SCAN_START, one
+// result per device, then end_status). Returns the number of records, at most max.
+UINT32 FtxSimBtScan
+(
+    const FTX_SIM_BT_PEER * p_peers,
+    UINT32 n_peers,
+    UINT32 end_status,
+    BT_SCAN_STATUS * p_status,
+    UINT32 max
+);
+
+
+// Default model: counters follow the motors, counter resets and extended motor
+// commands are executed, Bluetooth commands succeed
+extern const FTX_SIM_MODEL ftx_sim_default_model;
+
+void FtxSimDefaultInputs
+(
+    FTX_SIM * p_sim
+);
+
+void FtxSimDefaultBtCommand
+(
+    FTX_SIM * p_sim,
+    UINT32 cmd,
+    UINT32 channel,
+    const UCHAR8 * p_data,
+    UINT32 len
+);
+
+
+#endif // __FTX_SIM_H__
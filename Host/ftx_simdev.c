@@ -0,0 +1,319 @@
+//=============================================================================
+// I2C bus model of the simulator.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <math.h>
+#include <string.h>
+
+#include "ftx_simdev.h"
+
+#define BITS_PER_BYTE       9       // 8 data bits and the acknowledge
+
+#define DS1631_POWER_UP     0xC400  // temperature register after power up (-60 C)
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxSimBusInit
+ *-----------------------------------------------------------------------------*/
+void FtxSimBusInit
+(
+    FTX_SIM_BUS * p_bus
+)
+{
+    memset(p_bus, 0, sizeof(*p_bus));
+    p_bus->overhead_us = FTX_SIM_BUS_OVERHEAD_US;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxSimBusAdd
+ *-----------------------------------------------------------------------------*/
+FTX_SIMDEV * FtxSimBusAdd
+(
+    FTX_SIM_BUS * p_bus,
+    UINT32 kind,
+    UCHAR8 devaddr
+)
+{
+    FTX_SIMDEV * p_dev;
+
+    if (p_bus->n_devs >= FTX_SIM_BUS_DEVS_MAX)
+    {
+        return NULL;
+    }
+    p_dev = &p_bus->devs[p_bus->n_devs++];
+    memset(p_dev, 0, sizeof(*p_dev));
+    p_dev->kind = kind;
+    p_dev->devaddr = devaddr;
+
+    switch (kind)
+    {
+        case FTX_SIMDEV_TPA81:
+            p_dev->u.tpa81.servo = 16;
+            p_dev->u.tpa81.ambient = 22.0;
+            p_dev->u.tpa81.hot_col = 17.3;
+            p_dev->u.tpa81.hot_row = 4.6;
+            p_dev->u.tpa81.hot_temp = 40.0;
+            break;
+        case FTX_SIMDEV_LM75:
+        case FTX_SIMDEV_DS1631:
+            p_dev->u.temp.base = 21.0 + 0.5 * (devaddr & 0x07);
+            p_dev->u.temp.high = 0x5000;
+            p_dev->u.temp.low = 0x4B00;
+            break;
+        default:
+            break;
+    }
+    return p_dev;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxSimBusDuration
+ *
+ * Start, address, offset bytes, for a read repeated start and address, data
+ * bytes and stop.
+ *-----------------------------------------------------------------------------*/
+UINT32 FtxSimBusDuration
+(
+    BOOL32 is_write,
+    UCHAR8 protocol
+)
+{
+    UINT32 offset_len = protocol & 0x03;
+    UINT32 data_len = (protocol >> 2) & 0x03;
+    UINT32 bits = 1 + BITS_PER_BYTE * (1 + offset_len + data_len) + 1;
+    UINT32 khz = (protocol & 0x20) ? 400 : 100;
+
+    if (!is_write && offset_len)
+    {
+        bits += 1 + BITS_PER_BYTE;
+    }
+    return (bits * 1000 + khz - 1) / khz;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Tpa81Transfer
+ *
+ * Registers 1 (ambient) and 2...9 (pixels) are computed from the heat source,
+ * writing register 0 moves the servo.
+ *-----------------------------------------------------------------------------*/
+static UINT16 Tpa81Transfer
+(
+    FTX_SIMDEV * p_dev,
+    BOOL32 is_write,
+    UINT32 offset,
+    UINT16 data
+)
+{
+    double dx, dy, temp;
+
+    if (is_write)
+    {
+        if (offset == 0 && data < 32)
+        {
+            p_dev->u.tpa81.servo = (UCHAR8)data;
+        }
+        return I2C_SUCCESS;
+    }
+    if (offset == 0)
+    {
+        return 1;   // software revision
+    }
+    if (offset == 1)
+    {
+        return (UINT16)(p_dev->u.tpa81.ambient + 0.5);
+    }
+    if (offset <= 9)
+    {
+        dx = p_dev->u.tpa81.hot_col - p_dev->u.tpa81.servo;
+        dy = p_dev->u.tpa81.hot_row - (offset - 2);
+        temp = p_dev->u.tpa81.ambient + p_dev->u.tpa81.hot_temp / (1.0 + dx * dx + dy * dy);
+        return (UINT16)(temp + 0.5);
+    }
+    return 0;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TempValue
+ *
+ * Temperature register value with the given resolution.
+ *-----------------------------------------------------------------------------*/
+static UINT16 TempValue
+(
+    FTX_SIM * p_sim,
+    FTX_SIMDEV * p_dev,
+    UINT32 resolution
+)
+{
+    double temp = p_dev->u.temp.base + 2.0 * sin(2.0 * M_PI * (double)p_sim->time_us / 60e6);
+    INT32 value = (INT32)floor(temp * 256.0);
+
+    return (UINT16)(value & ~((1 << (16 - resolution)) - 1));
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Lm75Transfer
+ *
+ * Registers: 0 temperature, 1 configuration, 2 THYST, 3 TOS.
+ *-----------------------------------------------------------------------------*/
+static UINT16 Lm75Transfer
+(
+    FTX_SIM * p_sim,
+    FTX_SIMDEV * p_dev,
+    BOOL32 is_write,
+    UINT32 offset,
+    UINT16 data
+)
+{
+    UINT16 * p_reg = (offset == 2) ? &p_dev->u.temp.low : (offset == 3) ? &p_dev->u.temp.high : NULL;
+
+    if (is_write)
+    {
+        if (offset == 1)
+        {
+            p_dev->u.temp.config = (UCHAR8)data;
+        }
+        else if (p_reg)
+        {
+            *p_reg = data & 0xFF80;
+        }
+        return 0;
+    }
+    switch (offset)
+    {
+        case 0:
+            // No new conversions in shutdown mode
+            return (p_dev->u.temp.config & 0x01) ? 0 : TempValue(p_sim, p_dev, 9);
+        case 1:
+            return p_dev->u.temp.config;
+        default:
+            return (p_reg) ? *p_reg : 0;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Ds1631Transfer
+ *
+ * Commands: 0xAA read temperature, 0xAC configuration, 0xA1 TH, 0xA2 TL,
+ * 0x51 start convert, 0x22 stop convert. Without an offset byte the written
+ * data byte is the command.
+ *-----------------------------------------------------------------------------*/
+static UINT16 Ds1631Transfer
+(
+    FTX_SIM * p_sim,
+    FTX_SIMDEV * p_dev,
+    BOOL32 is_write,
+    UINT32 offset,
+    UINT16 data,
+    UCHAR8 protocol
+)
+{
+    UINT16 * p_reg = (offset == 0xA1) ? &p_dev->u.temp.high : (offset == 0xA2) ? &p_dev->u.temp.low : NULL;
+
+    if (is_write)
+    {
+        UINT32 cmd = (protocol & 0x03) ? offset : data;
+
+        if (cmd == 0x51)
+        {
+            p_dev->u.temp.converting = TRUE;
+        }
+        else if (cmd == 0x22)
+        {
+            p_dev->u.temp.converting = FALSE;
+        }
+        else if (cmd == 0xAC && (protocol & 0x03))
+        {
+            p_dev->u.temp.config = (UCHAR8)data & 0x0F;
+        }
+        else if (p_reg && (protocol & 0x03))
+        {
+            *p_reg = data & 0xFFF0;
+        }
+        return 0;
+    }
+    switch (offset)
+    {
+        case 0xAA:
+            if (!p_dev->u.temp.converting)
+            {
+                return DS1631_POWER_UP;
+            }
+            return TempValue(p_sim, p_dev, 9 + ((p_dev->u.temp.config >> 2) & 0x03));
+        case 0xAC:
+            return p_dev->u.temp.config;
+        default:
+            return (p_reg) ? *p_reg : 0;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : FtxSimBusTransfer
+ *-----------------------------------------------------------------------------*/
+UINT32 FtxSimBusTransfer
+(
+    FTX_SIM * p_sim,
+    BOOL32 is_write,
+    UCHAR8 devaddr,
+    UINT32 offset,
+    UINT16 data,
+    UCHAR8 protocol,
+    I2C_CB * p_result
+)
+{
+    FTX_SIM_BUS * p_bus = (FTX_SIM_BUS *)p_sim->p_model_data;
+    UINT32 duration = FtxSimBusDuration(is_write, protocol);
+    UINT32 idx;
+
+    p_bus->n_transfers++;
+    p_result->value = 0;
+    p_result->status = (is_write) ? I2C_WRITE_ERROR : I2C_READ_ERROR;
+
+    for (idx = 0; idx < p_bus->n_devs; idx++)
+    {
+        FTX_SIMDEV * p_dev = &p_bus->devs[idx];
+
+        if (p_dev->devaddr != devaddr)
+        {
+            continue;
+        }
+        p_result->status = I2C_SUCCESS;
+        switch (p_dev->kind)
+        {
+            case FTX_SIMDEV_TPA81:
+                // Sequential reads: the register address is incremented after each byte
+                p_result->value = Tpa81Transfer(p_dev, is_write, offset, data);
+                if (!is_write && ((protocol >> 2) & 0x03) == 2)
+                {
+                    p_result->value = (p_result->value << 8) | Tpa81Transfer(p_dev, FALSE, offset + 1, 0);
+                }
+                break;
+            case FTX_SIMDEV_LM75:
+                p_result->value = Lm75Transfer(p_sim, p_dev, is_write, offset, data);
+                break;
+            case FTX_SIMDEV_DS1631:
+                p_result->value = Ds1631Transfer(p_sim, p_dev, is_write, offset, data, protocol);
+                break;
+            default:
+                break;
+        }
+        return p_bus->overhead_us + duration;
+    }
+
+    // Nobody acknowledges the address: the transaction ends after the address byte
+    p_bus->n_errors++;
+    return p_bus->overhead_us + FtxSimBusDuration(TRUE, protocol & ~0x0F);
+}
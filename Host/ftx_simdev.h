@@ -0,0 +1,111 @@
+//=============================================================================
+// Header file of the I2C bus model of the simulator.
+// The bus model is an FTX_SIM_MODEL.I2cTransfer function with a list of
+// simulated devices. A transaction to an address without a device fails
+// (the device does not acknowledge), the duration of a transaction follows
+// from the number of bytes on the bus, the bus speed of the protocol byte
+// and a fixed overhead of the firmware.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __FTX_SIMDEV_H__
+#define __FTX_SIMDEV_H__
+
+#include "ftx_sim.h"
+
+#define FTX_SIM_BUS_DEVS_MAX        16
+#define FTX_SIM_BUS_OVERHEAD_US     100     // default firmware overhead of a transaction
+
+
+// Kinds of simulated devices
+enum ftx_simdev_kind_e
+{
+    FTX_SIMDEV_NONE = 0,
+    FTX_SIMDEV_TPA81,               // thermopile array with a heat source
+    FTX_SIMDEV_LM75,                // temperature sensor, register based
+    FTX_SIMDEV_DS1631               // temperature sensor, command based
+};
+
+
+// Simulated device
+typedef struct
+{
+    UINT32          kind;           // see enum ftx_simdev_kind_e
+    UCHAR8          devaddr;
+    union
+    {
+        struct
+        {
+            UCHAR8  servo;          // servo position 0...31
+            double  ambient;        // C
+            double  hot_col;        // position of the heat source in servo steps
+            double  hot_row;        // position of the heat source in pixels (0 = pixel 1)
+            double  hot_temp;       // temperature of the heat source above ambient
+        } tpa81;
+        struct
+        {
+            UCHAR8  config;
+            BOOL8   converting;     // DS1631: after the start convert command
+            UINT16  high;
+            UINT16  low;
+            double  base;           // mean temperature, varies by +-2 C with a period of 60 s
+        } temp;
+    } u;
+} FTX_SIMDEV;
+
+
+// Bus
+typedef struct
+{
+    FTX_SIMDEV      devs[FTX_SIM_BUS_DEVS_MAX];
+    UINT32          n_devs;
+    UINT32          overhead_us;    // firmware overhead of each transaction
+    UINT32          n_transfers;
+    UINT32          n_errors;       // transactions without an acknowledging device
+} FTX_SIM_BUS;
+
+
+// Initializes an empty bus
+void FtxSimBusInit
+(
+    FTX_SIM_BUS * p_bus
+);
+
+
+// Adds a device, returns NULL if the bus is full
+FTX_SIMDEV * FtxSimBusAdd
+(
+    FTX_SIM_BUS * p_bus,
+    UINT32 kind,
+    UCHAR8 devaddr
+);
+
+
+// Returns the duration of a transaction on the bus without the overhead
+UINT32 FtxSimBusDuration
+(
+    BOOL32 is_write,
+    UCHAR8 protocol
+);
+
+
+// FTX_SIM_MODEL.I2cTransfer function, the bus is p_sim->p_model_data
+UINT32 FtxSimBusTransfer
+(
+    FTX_SIM * p_sim,
+    BOOL32 is_write,
+    UCHAR8 devaddr,
+    UINT32 offset,
+    UINT16 data,
+    UCHAR8 protocol,
+    I2C_CB * p_result
+);
+
+
+#endif // __FTX_SIMDEV_H__
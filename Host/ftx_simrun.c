@@ -0,0 +1,489 @@
+//=============================================================================
+// Simulation runner: runs a download (local) mode program on the PC.
+//
+// The runner is linked together with the program (see sim_% in the Makefile)
+// and works in one of three modes:
+//   - free run:  the program runs against the default model;
+//   - record:    as free run, and every tick is appended to a trace file
+//                together with the callbacks delivered before it (with their
+//                time) and the pop-up message shown in it;
+//   - replay:    the inputs and callbacks of a trace (recorded by the runner
+//                or by ta_record) are fed into the program as fast as
+//                possible, each callback at its recorded time, and its outputs
+//                are compared with the trace tick by tick, as well as its
+//                pop-up messages if the runner recorded them.
+//
+//   sim_<program> [-t duration ms] [-w trace] [-r trace] [-a n] [-i input] [-l us] [-b] [-j] [-v]
+//
+//   -a   IsRunAllowed returns FALSE after n calls in a tick
+//   -i   keeps the universal input I<input> (1...8) at 1, as a pressed button
+//   -l   firmware overhead of an I2C command in us (default
+//        FTX_SIM_BUS_OVERHEAD_US), added to the time of the bus transfer
+//   -b   sends the StopGo motor command (motor 1, duty toggled every second)
+//        to the program via Bluetooth once it receives on a channel
+//   -j   prints the average and the 99th percentile of the instructions of
+//        the program per tick of the free run as benchmark results
+//        (bench_report.h), counted by single-stepping the program calls
+//        (ftx_icount.h); the callbacks and the model are not counted
+//   -v   prints the pop-up messages of the program
+//
+// The free run model includes an I2C bus (ftx_simdev.c) with a TPA81 at 0x68,
+// LM75 sensors at 0x48 and 0x49 and a DS1631 at 0x4F.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench_report.h"
+#include "ftx_icount.h"
+#include "ftx_online.h"
+#include "ftx_sim.h"
+#include "ftx_simdev.h"
+#include "ta_trace.h"
+
+#define MISMATCHES_SHOWN    10      // max. number of reported mismatches
+
+// Event of the trace which holds the pop-up message shown in a tick (no callback)
+#define TRACE_EV_DISPLAY    0x100
+// Flag of the trace header: the pop-up messages are recorded as TRACE_EV_DISPLAY
+#define TRACE_FLAG_DISPLAY  0x0001
+
+typedef int (*P_PRG_ENTRY)(TA * p_ta_array, int ta_count);
+
+extern const struct prg_code_intro_s prg_code_intro;
+
+static FTX_SIM sim;
+static FTX_SIM_BUS bus;
+static TA_TRACE trace;
+static TA_TRACE_AREA areas[TA_COUNT];
+static TA tic_ta[TA_COUNT];         // inputs and state as seen by the program in the last tick
+static BOOL32 bt_inject;
+static UINT32 run_allowed_max;
+static UINT32 pressed_input;        // universal input kept at 1 (1...8), 0 = none
+static UINT32 i2c_overhead_us = FTX_SIM_BUS_OVERHEAD_US;
+static const char * bench_name;     // name of the program in the benchmark results, NULL = no results
+static uint64_t tick_insns;         // instructions of the last program call
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : NowUs
+ *-----------------------------------------------------------------------------*/
+static uint64_t NowUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : CountProgram
+ *
+ * Program tick of the benchmark: counts the instructions of the program
+ * call (without the callbacks and the model).
+ *-----------------------------------------------------------------------------*/
+static INT32 CountProgram
+(
+    FTX_SIM * p_sim
+)
+{
+    P_PRG_ENTRY p_entry = (P_PRG_ENTRY)prg_code_intro.entry;
+    INT32 rc;
+
+    FtxICountStart();
+    rc = p_entry(p_sim->ta, TA_COUNT);
+    tick_insns = FtxICountStop();
+    return rc;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : CompareCounts / ReportTicks
+ *
+ * Prints the average and the 99th percentile of the instructions of the
+ * program calls.
+ *-----------------------------------------------------------------------------*/
+static int CompareCounts
+(
+    const void * p_a,
+    const void * p_b
+)
+{
+    uint64_t a = *(const uint64_t *)p_a, b = *(const uint64_t *)p_b;
+
+    return (a > b) - (a < b);
+}
+
+static void ReportTicks
+(
+    uint64_t * p_insns,
+    UINT32 n
+)
+{
+    char name[BENCH_NAME_LEN_MAX];
+    uint64_t sum = 0;
+    UINT32 i;
+
+    if (!n)
+    {
+        return;
+    }
+    for (i = 0; i < n; i++)
+    {
+        sum += p_insns[i];
+    }
+    qsort(p_insns, n, sizeof(p_insns[0]), CompareCounts);
+
+    snprintf(name, sizeof(name), "tick.%s.avg", bench_name);
+    BENCH_RESULT(name, "insn", (double)sum / n);
+    snprintf(name, sizeof(name), "tick.%s.p99", bench_name);
+    BENCH_RESULT(name, "insn", (double)p_insns[(UINT32)((n - 1) * 0.99)]);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : RunInputs
+ *
+ * Model of the free run: the default model, optionally with a Bluetooth
+ * peer which sends a motor command every second.
+ *-----------------------------------------------------------------------------*/
+static void RunInputs
+(
+    FTX_SIM * p_sim
+)
+{
+    FtxSimDefaultInputs(p_sim);
+
+    if (pressed_input >= 1 && pressed_input <= N_UNI)
+    {
+        p_sim->ta[TA_LOCAL].input.uni[pressed_input - 1] = 1;
+    }
+
+    if (bt_inject && p_sim->time_us % 1000000 == 0)
+    {
+        FTX_SIM_EVENT event;
+        UINT32 chan;
+        INT16 duty = ((p_sim->time_us / 1000000) & 1) ? 0 : DUTY_MAX;
+
+        for (chan = BT_CHAN_IDX_MIN; chan <= BT_CHAN_IDX_MAX; chan++)
+        {
+            if (p_sim->ta[TA_LOCAL].state.btstatus[chan - BT_CHAN_IDX_MIN].is_receive)
+            {
+                memset(&event, 0, sizeof(event));
+                event.type = FTX_SIM_EV_BT_RECV;
+                event.data.bt_recv.chan_idx = chan;
+                event.data.bt_recv.status = BT_MSG_INDICATION;
+                event.data.bt_recv.msg_len = 3;
+                event.data.bt_recv.msg[0] = 1;
+                memcpy(&event.data.bt_recv.msg[1], &duty, sizeof(duty));
+                FtxSimSchedule(p_sim, 0, &event);
+            }
+        }
+    }
+}
+
+static const FTX_SIM_MODEL run_model =
+{
+    /* UpdateInputs */ RunInputs,
+    /* BtCommand    */ FtxSimDefaultBtCommand,
+    /* I2cTransfer  */ FtxSimBusTransfer
+};
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : RecordEvent / RecordTic
+ *-----------------------------------------------------------------------------*/
+static void RecordEvent
+(
+    FTX_SIM * p_sim,
+    const FTX_SIM_EVENT * p_event
+)
+{
+    UINT32 len = (p_event->type == FTX_SIM_EV_BT_RECV) ? sizeof(BT_RECV_CB) :
+                 (p_event->type == FTX_SIM_EV_I2C)     ? sizeof(I2C_CB) : sizeof(BT_CB);
+
+    if (TaTraceAppendEvent(&trace, p_event->time_us, p_event->type, &p_event->data, len) != FTX_OK)
+    {
+        fprintf(stderr, "too many callbacks in tick %u, callback dropped\n", (unsigned)p_sim->n_ticks);
+    }
+}
+
+static void RecordTic
+(
+    FTX_SIM * p_sim
+)
+{
+    int idx;
+
+    for (idx = 0; idx < TA_COUNT; idx++)
+    {
+        tic_ta[idx].input = p_sim->ta[idx].input;
+        tic_ta[idx].state = p_sim->ta[idx].state;
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Run
+ *
+ * Free run or record.
+ *-----------------------------------------------------------------------------*/
+static int Run
+(
+    const char * path,
+    UINT32 duration_ms,
+    BOOL32 verbose
+)
+{
+    uint64_t * p_tick_insns = NULL;
+    UINT32 max_ticks = duration_ms / CALL_CYCLE_MS, n_msgs;
+    uint64_t t0;
+    int idx, rc = FTX_OK;
+
+    FtxSimBusInit(&bus);
+    bus.overhead_us = i2c_overhead_us;
+    FtxSimBusAdd(&bus, FTX_SIMDEV_TPA81, 0x68);
+    FtxSimBusAdd(&bus, FTX_SIMDEV_LM75, 0x48);
+    FtxSimBusAdd(&bus, FTX_SIMDEV_LM75, 0x49);
+    FtxSimBusAdd(&bus, FTX_SIMDEV_DS1631, 0x4F);
+    FtxSimInit(&sim, &run_model, &bus);
+    sim.print_display = verbose;
+    sim.run_allowed_max = run_allowed_max;
+    if (path)
+    {
+        if (TaTraceCreate(&trace, path, FTX_AREA_MASK(TA_LOCAL), 0, 0) != FTX_OK)
+        {
+            fprintf(stderr, "cannot create trace file %s\n", path);
+            return 1;
+        }
+        TaTraceSetFlags(&trace, TRACE_FLAG_DISPLAY);
+        sim.OnDeliver = RecordEvent;
+        sim.OnTic = RecordTic;
+    }
+    if (bench_name && (p_tick_insns = malloc((max_ticks + 1) * sizeof(p_tick_insns[0]))) != NULL)
+    {
+        sim.RunProgram = CountProgram;
+    }
+
+    t0 = NowUs();
+    while (sim.time_us < (uint64_t)duration_ms * 1000)
+    {
+        uint64_t t = sim.time_us;
+
+        n_msgs = sim.n_display_msgs;
+        FtxSimTick(&sim);
+        if (path)
+        {
+            for (idx = 0; idx < TA_COUNT; idx++)
+            {
+                tic_ta[idx].output = sim.ta[idx].output;
+            }
+            if (sim.n_display_msgs != n_msgs &&
+                TaTraceAppendEvent(&trace, t, TRACE_EV_DISPLAY, sim.display, strlen(sim.display) + 1) != FTX_OK)
+            {
+                fprintf(stderr, "too many callbacks in tick %u, pop-up message dropped\n", (unsigned)sim.n_ticks);
+            }
+            if ((rc = TaTraceAppend(&trace, t, tic_ta)) != FTX_OK)
+            {
+                fprintf(stderr, "cannot append tick %u to %s, error %d\n", (unsigned)sim.n_ticks, path, rc);
+                break;
+            }
+        }
+        if (p_tick_insns && sim.n_ticks <= max_ticks)
+        {
+            p_tick_insns[sim.n_ticks - 1] = tick_insns;
+        }
+        if (sim.rc != FTX_SIM_RC_RUN)
+        {
+            break;
+        }
+    }
+    t0 = NowUs() - t0;
+
+    printf("%u ticks (%.3f s) in %.3f s, program rc %d, %u pop-up messages\n", (unsigned)sim.n_ticks,
+        sim.time_us / 1e6, t0 / 1e6, (int)sim.rc, (unsigned)sim.n_display_msgs);
+    if (bus.n_transfers)
+    {
+        printf("I2C: %u transfers, %u errors\n", (unsigned)bus.n_transfers, (unsigned)bus.n_errors);
+    }
+    if (p_tick_insns)
+    {
+        ReportTicks(p_tick_insns, (sim.n_ticks < max_ticks) ? sim.n_ticks : max_ticks);
+        free(p_tick_insns);
+    }
+    if (path)
+    {
+        TaTraceClose(&trace);
+    }
+    return (rc == FTX_OK) ? 0 : 1;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : Replay
+ *
+ * Feeds a trace into the program and compares its outputs with the trace.
+ *-----------------------------------------------------------------------------*/
+static int Replay
+(
+    const char * path,
+    BOOL32 verbose
+)
+{
+    UINT32 mismatches = 0, n_events = 0, n_msgs, i;
+    uint64_t t = 0, t0, t_first = 0;
+    const char * p_display;
+    BOOL32 display;
+    int rc, idx;
+
+    if (TaTraceOpen(&trace, path) != FTX_OK)
+    {
+        fprintf(stderr, "cannot open trace file %s\n", path);
+        return 1;
+    }
+
+    display = (trace.header.flags & TRACE_FLAG_DISPLAY) ? TRUE : FALSE;
+    FtxSimInit(&sim, NULL, NULL);
+    sim.replay = TRUE;
+    sim.print_display = verbose;
+    sim.run_allowed_max = run_allowed_max;
+
+    t0 = NowUs();
+    while ((rc = TaTraceNext(&trace, &t, areas)) == FTX_OK)
+    {
+        if (!sim.n_ticks)
+        {
+            t_first = t;
+        }
+        // Callbacks are delivered before the tick at their time, with the inputs of the previous tick
+        p_display = NULL;
+        for (i = 0; i < trace.n_events; i++)
+        {
+            FTX_SIM_EVENT event;
+
+            if (trace.events[i].type == TRACE_EV_DISPLAY)
+            {
+                trace.events[i].data[TA_TRACE_EVENT_DATA_MAX - 1] = '\0';
+                p_display = (const char *)trace.events[i].data;
+                continue;
+            }
+            sim.time_us = trace.events[i].t_us;
+            memset(&event, 0, sizeof(event));
+            event.type = trace.events[i].type;
+            memcpy(&event.data, trace.events[i].data,
+                (trace.events[i].len < sizeof(event.data)) ? trace.events[i].len : sizeof(event.data));
+            FtxSimDeliver(&sim, &event);
+            n_events++;
+        }
+
+        for (idx = 0; idx < TA_COUNT; idx++)
+        {
+            if (trace.header.area_mask & (1 << idx))
+            {
+                sim.ta[idx].input = areas[idx].input;
+                TaStateFromWire(&sim.ta[idx].state, &areas[idx].state);
+            }
+        }
+
+        sim.time_us = t;
+        n_msgs = sim.n_display_msgs;
+        FtxSimTick(&sim);
+
+        if (display && ((sim.n_display_msgs != n_msgs) != (p_display != NULL) ||
+            (p_display && strcmp(sim.display, p_display) != 0)))
+        {
+            if (mismatches++ < MISMATCHES_SHOWN)
+            {
+                printf("mismatch at %llu us (tick %u): display \"%s\"/\"%s\"\n", (unsigned long long)t,
+                    (unsigned)sim.n_ticks, (sim.n_display_msgs != n_msgs) ? sim.display : "",
+                    (p_display) ? p_display : "");
+            }
+        }
+        for (idx = 0; idx < TA_COUNT; idx++)
+        {
+            if ((trace.header.area_mask & (1 << idx)) &&
+                memcmp(&sim.ta[idx].output, &areas[idx].output, sizeof(TA_OUTPUT)) != 0)
+            {
+                if (mismatches++ < MISMATCHES_SHOWN)
+                {
+                    printf("mismatch at %llu us (tick %u), area %d: duty",
+                        (unsigned long long)t, (unsigned)sim.n_ticks, idx);
+                    for (i = 0; i < N_PWM_CHAN; i++)
+                        printf(" %d/%d", sim.ta[idx].output.duty[i], areas[idx].output.duty[i]);
+                    printf("\n");
+                }
+            }
+        }
+        if (sim.rc != FTX_SIM_RC_RUN)
+        {
+            break;
+        }
+    }
+    t0 = NowUs() - t0;
+    TaTraceClose(&trace);
+
+    if (rc != FTX_OK && rc != FTX_ERR_END)
+    {
+        fprintf(stderr, "trace file %s is corrupted\n", path);
+        return 1;
+    }
+    printf("%u ticks (%.3f s) with %u callbacks replayed in %.3f s (%.0fx real time), "
+        "%u mismatches, program rc %d\n", (unsigned)sim.n_ticks, (t - t_first) / 1e6 + CALL_CYCLE_MS / 1e3,
+        (unsigned)n_events, t0 / 1e6, t0 ? (t - t_first) / (double)t0 : 0.0, (unsigned)mismatches, (int)sim.rc);
+    return (mismatches) ? 3 : 0;
+}
+
+
+int main
+(
+    int argc,
+    char ** argv
+)
+{
+    const char * write_path = NULL;
+    const char * read_path = NULL;
+    UINT32 duration_ms = 10000;
+    BOOL32 verbose = FALSE;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:w:r:a:i:l:bjv")) != -1)
+    {
+        switch (opt)
+        {
+            case 't': duration_ms = strtoul(optarg, NULL, 0); break;
+            case 'w': write_path = optarg; break;
+            case 'r': read_path = optarg; break;
+            case 'a': run_allowed_max = strtoul(optarg, NULL, 0); break;
+            case 'i': pressed_input = strtoul(optarg, NULL, 0); break;
+            case 'l': i2c_overhead_us = strtoul(optarg, NULL, 0); break;
+            case 'b': bt_inject = TRUE; break;
+            case 'j':
+                if (FtxICountOpen() != FTX_OK)
+                {
+                    fprintf(stderr, "cannot count the instructions of the program\n");
+                    return 1;
+                }
+                bench_name = strrchr(argv[0], '/') ? strrchr(argv[0], '/') + 1 : argv[0];
+                bench_name += (strncmp(bench_name, "sim_", 4) == 0) ? 4 : 0;
+                break;
+            case 'v': verbose = TRUE; break;
+            default:
+                fprintf(stderr, "usage: %s [-t duration ms] [-w trace] [-r trace] [-a n] [-i input] [-l us]"
+                    " [-b] [-j] [-v]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    return (read_path) ? Replay(read_path, verbose) : Run(write_path, duration_ms, verbose);
+}
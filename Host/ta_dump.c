@@ -0,0 +1,100 @@
+//=============================================================================
+// Transfer Area trace dump.
+//
+// Prints the records of a trace file from the given start time on, one line
+// per record with the inputs and outputs of one Transfer Area, followed by
+// the events (callbacks) attached to the record.
+//
+//   ta_dump [-s start us] [-e end us] [-a area] file
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "ta_trace.h"
+
+static TA_TRACE trace;
+static TA_TRACE_AREA areas[TA_COUNT];
+
+
+int main
+(
+    int argc,
+    char ** argv
+)
+{
+    uint64_t t_start = 0, t_end = (uint64_t)-1, t_first, t_last, t;
+    UINT32 area = TA_LOCAL;
+    int opt, rc, i, j;
+
+    while ((opt = getopt(argc, argv, "s:e:a:")) != -1)
+    {
+        switch (opt)
+        {
+            case 's': t_start = strtoull(optarg, NULL, 0); break;
+            case 'e': t_end = strtoull(optarg, NULL, 0); break;
+            case 'a': area = strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-s start us] [-e end us] [-a area] file\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind >= argc || area >= TA_COUNT)
+    {
+        fprintf(stderr, "usage: %s [-s start us] [-e end us] [-a area] file\n", argv[0]);
+        return 2;
+    }
+
+    if (TaTraceOpen(&trace, argv[optind]) != FTX_OK)
+    {
+        fprintf(stderr, "cannot open trace file %s\n", argv[optind]);
+        return 1;
+    }
+    if (!(trace.header.area_mask & (1 << area)))
+    {
+        fprintf(stderr, "area %u is not traced\n", (unsigned)area);
+        return 1;
+    }
+    if (TaTraceRange(&trace, &t_first, &t_last) == FTX_OK)
+    {
+        printf("# trace %llu...%llu us, area %u\n", (unsigned long long)t_first,
+            (unsigned long long)t_last, (unsigned)area);
+    }
+
+    rc = TaTraceSeek(&trace, t_start);
+    while (rc == FTX_OK && (rc = TaTraceNext(&trace, &t, areas)) == FTX_OK && t <= t_end)
+    {
+        TA_TRACE_AREA * p = &areas[area];
+
+        printf("%10llu uni", (unsigned long long)t);
+        for (i = 0; i < N_UNI; i++)
+            printf(" %5d", p->input.uni[i]);
+        printf(" cnt");
+        for (i = 0; i < N_CNT; i++)
+            printf(" %5d", p->input.counter[i]);
+        printf(" duty");
+        for (i = 0; i < N_PWM_CHAN; i++)
+            printf(" %3d", p->output.duty[i]);
+        printf("\n");
+
+        for (i = 0; i < trace.n_events; i++)
+        {
+            printf("%10s event %u at %llu us:", "", (unsigned)trace.events[i].type,
+                (unsigned long long)trace.events[i].t_us);
+            for (j = 0; j < trace.events[i].len; j++)
+                printf(" %02x", trace.events[i].data[j]);
+            printf("\n");
+        }
+    }
+
+    TaTraceClose(&trace);
+    return (rc == FTX_OK || rc == FTX_ERR_END) ? 0 : 1;
+}
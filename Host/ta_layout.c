@@ -0,0 +1,114 @@
+//=============================================================================
+// Transfer Area layout dump.
+//
+// Prints the offset and size of every field of ROBO_TX_ABI.h in the firmware
+// layout and in the layout of this build, so the fields which cannot be
+// copied between a firmware image of the TA and the host structures as they
+// are (pointers and everything behind them) can be seen at one look.
+//
+//   ta_layout [-d]         -d: only the fields which differ
+//
+// Returns 1 if a field which is expected to be the same on every build
+// (TA_ABI_FIXED_xxx) differs.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "ROBO_TX_PRG.h"
+
+// One entry of the layout lists
+typedef struct
+{
+    const char    * type;
+    const char    * member;         // NULL for the size of the structure
+    BOOL32          is_fixed;       // same layout on every build expected
+    unsigned        fw_offset;
+    unsigned        fw_size;
+    unsigned        offset;
+    unsigned        size;
+} LAYOUT_ENTRY;
+
+#define FIXED_SIZE(type, size) \
+    { #type, NULL, TRUE, 0, size, 0, sizeof(type) },
+#define FIXED_FIELD(type, member, offset, size) \
+    { #type, #member, TRUE, offset, size, TA_ABI_OFFSETOF(type, member), TA_ABI_SIZEOF(type, member) },
+#define NATIVE_SIZE(type, size) \
+    { #type, NULL, FALSE, 0, size, 0, sizeof(type) },
+#define NATIVE_FIELD(type, member, offset, size) \
+    { #type, #member, FALSE, offset, size, TA_ABI_OFFSETOF(type, member), TA_ABI_SIZEOF(type, member) },
+
+static const LAYOUT_ENTRY layout[] =
+{
+    TA_ABI_FIXED_SIZES(FIXED_SIZE)
+    TA_ABI_FIXED_FIELDS(FIXED_FIELD)
+    TA_ABI_NATIVE_SIZES(NATIVE_SIZE)
+    TA_ABI_NATIVE_FIELDS(NATIVE_FIELD)
+};
+
+
+int main
+(
+    int argc,
+    char ** argv
+)
+{
+    BOOL32 only_diff = FALSE;
+    unsigned n_diff = 0, n_fixed_diff = 0;
+    unsigned i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d")) != -1)
+    {
+        switch (opt)
+        {
+            case 'd': only_diff = TRUE; break;
+            default:
+                fprintf(stderr, "usage: %s [-d]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    printf("# pointer %u bytes, UINT32 %u bytes, TA %u bytes (firmware %u)\n", (unsigned)sizeof(void *),
+        (unsigned)sizeof(UINT32), (unsigned)sizeof(TA), TA_ABI_SIZE);
+    printf("# %-40s %10s %10s\n", "field", "firmware", "this build");
+    for (i = 0; i < sizeof(layout) / sizeof(layout[0]); i++)
+    {
+        const LAYOUT_ENTRY * p = &layout[i];
+        BOOL32 is_diff = p->offset != p->fw_offset || p->size != p->fw_size;
+        char name[64];
+
+        if (is_diff)
+        {
+            n_diff++;
+            n_fixed_diff += (p->is_fixed) ? 1 : 0;
+        }
+        if (only_diff && !is_diff)
+        {
+            continue;
+        }
+
+        if (p->member)
+        {
+            snprintf(name, sizeof(name), "%s.%s", p->type, p->member);
+            printf("  %-40s %4u +%-4u %4u +%-4u", name, p->fw_offset, p->fw_size, p->offset, p->size);
+        }
+        else
+        {
+            snprintf(name, sizeof(name), "sizeof(%s)", p->type);
+            printf("  %-40s %10u %10u", name, p->fw_size, p->size);
+        }
+        printf("%s\n", (!is_diff) ? "" : (p->is_fixed) ? " DIFFERS (fixed layout!)" : " differs");
+    }
+    printf("# %u of %u entries differ, %u of them with a fixed layout\n", n_diff,
+        (unsigned)(sizeof(layout) / sizeof(layout[0])), n_fixed_diff);
+
+    return (n_fixed_diff) ? 1 : 0;
+}
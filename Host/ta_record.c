@@ -0,0 +1,151 @@
+//=============================================================================
+// Transfer Area recorder.
+//
+// Exchanges the Transfer Areas with a Controller in online mode with the
+// given period and appends a trace record per exchange. Without a tty the
+// loopback device is used, with motor M1 switched on and off every second,
+// so that the recorder can be tried and measured without hardware.
+//
+//   ta_record [-o file] [-m area mask] [-t duration ms] [-p period us]
+//             [-n blocks] [tty]
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ftx_online.h"
+#include "ftx_loopback.h"
+#include "ta_trace.h"
+
+static FTX_ONLINE ftx;
+static FTX_LOOPBACK loopback;
+static TA_TRACE trace;
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : NowUs
+ *-----------------------------------------------------------------------------*/
+static uint64_t NowUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+int main
+(
+    int argc,
+    char ** argv
+)
+{
+    const char * dev = NULL;
+    const char * path = "ta.trace";
+    UINT32 mask = FTX_AREA_MASK(TA_LOCAL), duration_ms = 1000, period_us = 1000, n_blocks = 0;
+    uint64_t t_start, t_next, t_append = 0, n_records = 0, n_kept = 0, used = 0;
+    struct timespec ts;
+    int opt, rc = FTX_OK, rc_append = FTX_OK;
+    UINT32 block;
+
+    while ((opt = getopt(argc, argv, "o:m:t:p:n:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'o': path = optarg; break;
+            case 'm': mask = strtoul(optarg, NULL, 0); break;
+            case 't': duration_ms = strtoul(optarg, NULL, 0); break;
+            case 'p': period_us = strtoul(optarg, NULL, 0); break;
+            case 'n': n_blocks = strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-o file] [-m area mask] [-t duration ms] [-p period us]"
+                    " [-n blocks] [tty]\n", argv[0]);
+                return 2;
+        }
+    }
+    if (optind < argc)
+    {
+        dev = argv[optind];
+    }
+    if (!dev)
+    {
+        if (FtxLoopbackStart(&loopback, 0, FTX_AREA_MASK_ALL) != FTX_OK)
+        {
+            fprintf(stderr, "cannot start loopback device\n");
+            return 1;
+        }
+        dev = loopback.dev;
+    }
+
+    if (TaTraceCreate(&trace, path, mask, n_blocks, 0) != FTX_OK)
+    {
+        fprintf(stderr, "cannot create trace file %s\n", path);
+        return 1;
+    }
+    rc = FtxOnlineOpen(&ftx, dev, 0);
+
+    t_start = t_next = NowUs();
+    while (rc == FTX_OK && NowUs() - t_start < (uint64_t)duration_ms * 1000)
+    {
+        uint64_t t0, t;
+
+        if (dev == loopback.dev)
+        {
+            ftx.ta[TA_LOCAL].output.duty[0] = (((NowUs() - t_start) / 1000000) & 1) ? 0 : DUTY_MAX;
+        }
+        rc = FtxOnlineExchange(&ftx, mask);
+        t = NowUs();
+
+        t0 = NowUs();
+        if ((rc_append = TaTraceAppend(&trace, t - t_start, ftx.ta)) != FTX_OK)
+        {
+            fprintf(stderr, "cannot append record %llu to %s, error %d\n", (unsigned long long)n_records,
+                path, rc_append);
+            break;
+        }
+        t_append += NowUs() - t0;
+        n_records++;
+
+        t_next += period_us;
+        ts.tv_sec = t_next / 1000000;
+        ts.tv_nsec = (t_next % 1000000) * 1000;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    }
+    if (rc != FTX_OK)
+    {
+        fprintf(stderr, "online mode error %d\n", rc);
+    }
+
+    for (block = 0; block < trace.header.n_blocks; block++)
+    {
+        TA_TRACE_BLOCK * p_blk = (TA_TRACE_BLOCK *)(trace.p_map + TA_TRACE_HEADER_SIZE +
+            (size_t)block * trace.header.block_size);
+
+        if (p_blk->seq)
+        {
+            used += p_blk->used;
+            n_kept += p_blk->n_records;
+        }
+    }
+    printf("%s: %llu records appended, %llu records in %llu bytes kept, %.1f bytes/record,"
+        " append %.2f us/record\n", path, (unsigned long long)n_records, (unsigned long long)n_kept,
+        (unsigned long long)used, n_kept ? (double)used / n_kept : 0.0,
+        n_records ? (double)t_append / n_records : 0.0);
+
+    TaTraceClose(&trace);
+    FtxOnlineClose(&ftx);
+    if (dev == loopback.dev)
+    {
+        FtxLoopbackStop(&loopback);
+    }
+    return (rc == FTX_OK && rc_append == FTX_OK) ? 0 : 1;
+}
@@ -0,0 +1,705 @@
+//=============================================================================
+// Binary Transfer Area trace (memory mapped ring file, delta records).
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ta_trace.h"
+
+#define TA_TRACE_VARINT_MAX     10
+
+#define TA_TRACE_EVENTS_SIZE    (TA_TRACE_VARINT_MAX + \
+                                 TA_TRACE_EVENTS_MAX * (3 * TA_TRACE_VARINT_MAX + TA_TRACE_EVENT_DATA_MAX))
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : PutVarint / GetVarint
+ *
+ * Unsigned LEB128 numbers.
+ *-----------------------------------------------------------------------------*/
+static UINT32 PutVarint
+(
+    UCHAR8 * p,
+    uint64_t value
+)
+{
+    UINT32 n = 0;
+
+    while (value >= 0x80)
+    {
+        p[n++] = (UCHAR8)(value | 0x80);
+        value >>= 7;
+    }
+    p[n++] = (UCHAR8)value;
+    return n;
+}
+
+static BOOL32 GetVarint
+(
+    const UCHAR8 * p,
+    UINT32 * p_offset,
+    UINT32 end,
+    uint64_t * p_value
+)
+{
+    uint64_t value = 0;
+    UINT32 shift = 0;
+
+    while (*p_offset < end && shift < 64)
+    {
+        UCHAR8 byte = p[(*p_offset)++];
+
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            *p_value = value;
+            return TRUE;
+        }
+        shift += 7;
+    }
+    return FALSE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaTraceBlock
+ *
+ * Returns the header of the block with the given index.
+ *-----------------------------------------------------------------------------*/
+static TA_TRACE_BLOCK * TaTraceBlock
+(
+    TA_TRACE * p_trace,
+    UINT32 block
+)
+{
+    return (TA_TRACE_BLOCK *)(p_trace->p_map + TA_TRACE_HEADER_SIZE +
+        (size_t)block * p_trace->header.block_size);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaTraceAllocImages
+ *-----------------------------------------------------------------------------*/
+static int TaTraceAllocImages
+(
+    TA_TRACE * p_trace
+)
+{
+    UINT32 idx, n_areas = 0;
+
+    for (idx = 0; idx < TA_COUNT; idx++)
+    {
+        if (p_trace->header.area_mask & (1 << idx))
+            n_areas++;
+    }
+    p_trace->image_size = n_areas * sizeof(TA_TRACE_AREA);
+
+    // The scratch buffer takes the current image and the encoded record
+    p_trace->p_image = calloc(1, p_trace->image_size);
+    p_trace->p_scratch = calloc(1, 3 * p_trace->image_size + 4 * TA_TRACE_VARINT_MAX + TA_TRACE_EVENTS_SIZE);
+    return (p_trace->p_image && p_trace->p_scratch) ? FTX_OK : FTX_ERR_PARAM;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaTraceCreate
+ *
+ * Creates (or truncates) a trace file and maps it.
+ *-----------------------------------------------------------------------------*/
+int TaTraceCreate
+(
+    TA_TRACE * p_trace,
+    const char * path,
+    UINT32 area_mask,
+    UINT32 n_blocks,
+    UINT32 block_size
+)
+{
+    memset(p_trace, 0, sizeof(*p_trace));
+    p_trace->fd = -1;
+
+    p_trace->header.magic = TA_TRACE_MAGIC;
+    p_trace->header.version = TA_TRACE_VERSION;
+    p_trace->header.area_mask = area_mask & ((1 << TA_COUNT) - 1);
+    p_trace->header.area_size = sizeof(TA_TRACE_AREA);
+    p_trace->header.block_size = (block_size) ? block_size : TA_TRACE_DEFAULT_BLOCK_SIZE;
+    p_trace->header.n_blocks = (n_blocks) ? n_blocks : TA_TRACE_DEFAULT_BLOCKS;
+
+    if (!p_trace->header.area_mask || TaTraceAllocImages(p_trace) != FTX_OK ||
+        p_trace->header.block_size < sizeof(TA_TRACE_BLOCK) + 3 * p_trace->image_size + TA_TRACE_EVENTS_SIZE)
+    {
+        TaTraceClose(p_trace);
+        return FTX_ERR_PARAM;
+    }
+
+    p_trace->map_size = TA_TRACE_HEADER_SIZE + (size_t)p_trace->header.n_blocks * p_trace->header.block_size;
+    p_trace->fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (p_trace->fd < 0 || ftruncate(p_trace->fd, p_trace->map_size) != 0)
+    {
+        TaTraceClose(p_trace);
+        return FTX_ERR_OPEN;
+    }
+    p_trace->p_map = mmap(NULL, p_trace->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, p_trace->fd, 0);
+    if (p_trace->p_map == MAP_FAILED)
+    {
+        p_trace->p_map = NULL;
+        TaTraceClose(p_trace);
+        return FTX_ERR_OPEN;
+    }
+
+    memcpy(p_trace->p_map, &p_trace->header, sizeof(p_trace->header));
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaTraceSetFlags
+ *-----------------------------------------------------------------------------*/
+int TaTraceSetFlags
+(
+    TA_TRACE * p_trace,
+    UINT32 flags
+)
+{
+    if (!p_trace->p_map)
+    {
+        return FTX_ERR_PARAM;
+    }
+    p_trace->header.flags = flags;
+    memcpy(p_trace->p_map, &p_trace->header, sizeof(p_trace->header));
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaTraceNextRun
+ *
+ * Finds the next run of changed bytes starting from the given position.
+ * Runs separated by not more than TA_TRACE_MERGE_GAP unchanged bytes are
+ * merged.
+ *-----------------------------------------------------------------------------*/
+static BOOL32 TaTraceNextRun
+(
+    const UCHAR8 * p_old,
+    const UCHAR8 * p_new,
+    UINT32 size,
+    UINT32 pos,
+    UINT32 * p_start,
+    UINT32 * p_len
+)
+{
+    UINT32 last;
+
+    while (pos < size && p_old[pos] == p_new[pos])
+    {
+        pos++;
+    }
+    if (pos >= size)
+    {
+        return FALSE;
+    }
+
+    *p_start = last = pos;
+    for (pos++; pos < size && pos - last <= TA_TRACE_MERGE_GAP; pos++)
+    {
+        if (p_old[pos] != p_new[pos])
+        {
+            last = pos;
+        }
+    }
+    *p_len = last - *p_start + 1;
+    return TRUE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaTraceAppendEvent
+ *
+ * Attaches an event to the next record.
+ *-----------------------------------------------------------------------------*/
+int TaTraceAppendEvent
+(
+    TA_TRACE * p_trace,
+    uint64_t t_us,
+    UINT32 type,
+    const void * p_data,
+    UINT32 len
+)
+{
+    TA_TRACE_EVENT * p_event;
+
+    if (p_trace->n_events >= TA_TRACE_EVENTS_MAX || len > TA_TRACE_EVENT_DATA_MAX)
+    {
+        return FTX_ERR_PARAM;
+    }
+    p_event = &p_trace->events[p_trace->n_events++];
+    p_event->t_us = t_us;
+    p_event->type = type;
+    p_event->len = len;
+    memcpy(p_event->data, p_data, len);
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaTracePutEvents
+ *
+ * Encodes the events attached to the record.
+ *-----------------------------------------------------------------------------*/
+static UINT32 TaTracePutEvents
+(
+    TA_TRACE * p_trace,
+    uint64_t t_us,
+    UCHAR8 * p
+)
+{
+    UINT32 len, i;
+
+    if (!p_trace->n_events)
+    {
+        return 0;
+    }
+    len = PutVarint(p, p_trace->n_events);
+    for (i = 0; i < p_trace->n_events; i++)
+    {
+        len += PutVarint(p + len, p_trace->events[i].type);
+        len += PutVarint(p + len, p_trace->events[i].len);
+        len += PutVarint(p + len, (p_trace->events[i].t_us < t_us) ? t_us - p_trace->events[i].t_us : 0);
+        memcpy(p + len, p_trace->events[i].data, p_trace->events[i].len);
+        len += p_trace->events[i].len;
+    }
+    return len;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaTraceAppend
+ *
+ * Appends the traced parts of the Transfer Area array as one record.
+ *-----------------------------------------------------------------------------*/
+int TaTraceAppend
+(
+    TA_TRACE * p_trace,
+    uint64_t t_us,
+    const TA * p_ta_array
+)
+{
+    UCHAR8 * p_cur = p_trace->p_scratch;
+    UCHAR8 * p_rec = p_cur + p_trace->image_size;
+    TA_TRACE_BLOCK * p_blk;
+    UINT32 idx, len, start, run_len, pos, n_runs;
+    UINT32 has_events = (p_trace->n_events) ? 2 : 0;
+    UCHAR8 * p;
+
+    if (!p_trace->p_map || t_us < p_trace->t_prev)
+    {
+        return FTX_ERR_PARAM;
+    }
+
+    // Build the current image
+    p = p_cur;
+    for (idx = 0; idx < TA_COUNT; idx++)
+    {
+        if (p_trace->header.area_mask & (1 << idx))
+        {
+            TA_TRACE_AREA * p_area = (TA_TRACE_AREA *)p;
+
+            memset(p_area, 0, sizeof(*p_area));
+            p_area->input = p_ta_array[idx].input;
+            p_area->output = p_ta_array[idx].output;
+            TaStateToWire(&p_area->state, &p_ta_array[idx].state);
+            p += sizeof(TA_TRACE_AREA);
+        }
+    }
+
+    // Encode a delta record
+    len = PutVarint(p_rec, ((t_us - p_trace->t_prev) << 2) | has_events);
+    len += TaTracePutEvents(p_trace, t_us, p_rec + len);
+    n_runs = 0;
+    for (pos = 0; TaTraceNextRun(p_trace->p_image, p_cur, p_trace->image_size, pos, &start, &run_len);
+         pos = start + run_len)
+    {
+        n_runs++;
+    }
+    len += PutVarint(p_rec + len, n_runs);
+    for (pos = 0; TaTraceNextRun(p_trace->p_image, p_cur, p_trace->image_size, pos, &start, &run_len);
+         pos = start + run_len)
+    {
+        len += PutVarint(p_rec + len, start - pos);
+        len += PutVarint(p_rec + len, run_len);
+        memcpy(p_rec + len, p_cur + start, run_len);
+        len += run_len;
+    }
+
+    p_blk = (p_trace->seq) ? TaTraceBlock(p_trace, p_trace->block) : NULL;
+    if (!p_blk || p_blk->used + len > p_trace->header.block_size)
+    {
+        // Start the next block with a key record
+        p_trace->block = (p_trace->seq) ? (p_trace->block + 1) % p_trace->header.n_blocks : 0;
+        p_blk = TaTraceBlock(p_trace, p_trace->block);
+
+        p_blk->seq = 0; // invalid while being rewritten
+        p_blk->magic = TA_TRACE_BLOCK_MAGIC;
+        p_blk->t_first = t_us;
+        p_blk->n_records = 0;
+        p_blk->used = sizeof(TA_TRACE_BLOCK);
+
+        len = PutVarint(p_rec, has_events | 1);
+        len += TaTracePutEvents(p_trace, t_us, p_rec + len);
+        memcpy(p_rec + len, p_cur, p_trace->image_size);
+        len += p_trace->image_size;
+
+        p_blk->seq = ++p_trace->seq;
+    }
+
+    memcpy((UCHAR8 *)p_blk + p_blk->used, p_rec, len);
+    p_blk->t_last = t_us;
+    p_blk->used += len;
+    p_blk->n_records++;
+
+    memcpy(p_trace->p_image, p_cur, p_trace->image_size);
+    p_trace->t_prev = t_us;
+    p_trace->n_events = 0;
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : CompareBlockSeq
+ *-----------------------------------------------------------------------------*/
+static int CompareBlockSeq
+(
+    const void * a,
+    const void * b,
+    void * p_trace
+)
+{
+    UINT32 seq_a = TaTraceBlock((TA_TRACE *)p_trace, *(const UINT32 *)a)->seq;
+    UINT32 seq_b = TaTraceBlock((TA_TRACE *)p_trace, *(const UINT32 *)b)->seq;
+
+    return (seq_a > seq_b) - (seq_a < seq_b);
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaTraceRewind
+ *
+ * Positions the reader at the start of the block with the given order index.
+ *-----------------------------------------------------------------------------*/
+static void TaTraceRewind
+(
+    TA_TRACE * p_trace,
+    UINT32 order_idx
+)
+{
+    p_trace->order_idx = order_idx;
+    p_trace->offset = sizeof(TA_TRACE_BLOCK);
+    p_trace->record = 0;
+    p_trace->pending = FALSE;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaTraceOpen
+ *
+ * Opens an existing trace file for reading.
+ *-----------------------------------------------------------------------------*/
+int TaTraceOpen
+(
+    TA_TRACE * p_trace,
+    const char * path
+)
+{
+    struct stat st;
+    UINT32 block;
+
+    memset(p_trace, 0, sizeof(*p_trace));
+    p_trace->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (p_trace->fd < 0 || fstat(p_trace->fd, &st) != 0 || st.st_size < TA_TRACE_HEADER_SIZE)
+    {
+        TaTraceClose(p_trace);
+        return FTX_ERR_OPEN;
+    }
+    p_trace->map_size = st.st_size;
+    p_trace->p_map = mmap(NULL, p_trace->map_size, PROT_READ, MAP_SHARED, p_trace->fd, 0);
+    if (p_trace->p_map == MAP_FAILED)
+    {
+        p_trace->p_map = NULL;
+        TaTraceClose(p_trace);
+        return FTX_ERR_OPEN;
+    }
+
+    memcpy(&p_trace->header, p_trace->p_map, sizeof(p_trace->header));
+    if (p_trace->header.magic != TA_TRACE_MAGIC || p_trace->header.version != TA_TRACE_VERSION ||
+        p_trace->header.area_size != sizeof(TA_TRACE_AREA) ||
+        p_trace->map_size < TA_TRACE_HEADER_SIZE +
+            (size_t)p_trace->header.n_blocks * p_trace->header.block_size ||
+        TaTraceAllocImages(p_trace) != FTX_OK)
+    {
+        TaTraceClose(p_trace);
+        return FTX_ERR_FRAME;
+    }
+
+    // Collect the valid blocks, oldest first
+    p_trace->p_order = malloc(p_trace->header.n_blocks * sizeof(UINT32));
+    if (!p_trace->p_order)
+    {
+        TaTraceClose(p_trace);
+        return FTX_ERR_PARAM;
+    }
+    for (block = 0; block < p_trace->header.n_blocks; block++)
+    {
+        TA_TRACE_BLOCK * p_blk = TaTraceBlock(p_trace, block);
+
+        if (p_blk->magic == TA_TRACE_BLOCK_MAGIC && p_blk->seq && p_blk->n_records &&
+            p_blk->used <= p_trace->header.block_size)
+        {
+            p_trace->p_order[p_trace->n_order++] = block;
+        }
+    }
+    qsort_r(p_trace->p_order, p_trace->n_order, sizeof(UINT32), CompareBlockSeq, p_trace);
+
+    TaTraceRewind(p_trace, 0);
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaTraceDecode
+ *
+ * Decodes the next record into the image. Returns FTX_ERR_END at the end
+ * of the trace.
+ *-----------------------------------------------------------------------------*/
+static int TaTraceDecode
+(
+    TA_TRACE * p_trace,
+    uint64_t * p_t_us
+)
+{
+    TA_TRACE_BLOCK * p_blk;
+    const UCHAR8 * p;
+    uint64_t v, n_runs, skip, len, n_events, type, dt;
+    UINT32 pos = 0, i;
+
+    while (1)
+    {
+        if (p_trace->order_idx >= p_trace->n_order)
+        {
+            return FTX_ERR_END;
+        }
+        p_blk = TaTraceBlock(p_trace, p_trace->p_order[p_trace->order_idx]);
+        if (p_trace->record < p_blk->n_records)
+        {
+            break;
+        }
+        TaTraceRewind(p_trace, p_trace->order_idx + 1);
+    }
+    p = (const UCHAR8 *)p_blk;
+
+    if (!GetVarint(p, &p_trace->offset, p_blk->used, &v))
+    {
+        return FTX_ERR_FRAME;
+    }
+    p_trace->n_events = 0;
+    if (v & 2)
+    {
+        if (!GetVarint(p, &p_trace->offset, p_blk->used, &n_events) || n_events > TA_TRACE_EVENTS_MAX)
+        {
+            return FTX_ERR_FRAME;
+        }
+        while (n_events--)
+        {
+            TA_TRACE_EVENT * p_event = &p_trace->events[p_trace->n_events++];
+
+            if (!GetVarint(p, &p_trace->offset, p_blk->used, &type) ||
+                !GetVarint(p, &p_trace->offset, p_blk->used, &len) ||
+                !GetVarint(p, &p_trace->offset, p_blk->used, &dt) ||
+                len > TA_TRACE_EVENT_DATA_MAX || p_trace->offset + len > p_blk->used)
+            {
+                return FTX_ERR_FRAME;
+            }
+            p_event->t_us = dt;     // made absolute when the time of the record is known
+            p_event->type = (UINT32)type;
+            p_event->len = (UINT32)len;
+            memcpy(p_event->data, p + p_trace->offset, len);
+            p_trace->offset += len;
+        }
+    }
+    if (v & 1)
+    {
+        // Key record
+        if (p_trace->offset + p_trace->image_size > p_blk->used)
+        {
+            return FTX_ERR_FRAME;
+        }
+        memcpy(p_trace->p_image, p + p_trace->offset, p_trace->image_size);
+        p_trace->offset += p_trace->image_size;
+        p_trace->t_prev = p_blk->t_first;
+    }
+    else
+    {
+        if (p_trace->record == 0 || !GetVarint(p, &p_trace->offset, p_blk->used, &n_runs))
+        {
+            return FTX_ERR_FRAME;
+        }
+        while (n_runs--)
+        {
+            if (!GetVarint(p, &p_trace->offset, p_blk->used, &skip) ||
+                !GetVarint(p, &p_trace->offset, p_blk->used, &len) ||
+                pos + skip + len > p_trace->image_size || p_trace->offset + len > p_blk->used)
+            {
+                return FTX_ERR_FRAME;
+            }
+            pos += skip;
+            memcpy(p_trace->p_image + pos, p + p_trace->offset, len);
+            pos += len;
+            p_trace->offset += len;
+        }
+        p_trace->t_prev += v >> 2;
+    }
+    p_trace->record++;
+    *p_t_us = p_trace->t_prev;
+    for (i = 0; i < p_trace->n_events; i++)
+    {
+        dt = p_trace->events[i].t_us;
+        p_trace->events[i].t_us = (dt < *p_t_us) ? *p_t_us - dt : 0;
+    }
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaTraceSeek
+ *
+ * Positions the reader at the first record with the time >= t_us.
+ *-----------------------------------------------------------------------------*/
+int TaTraceSeek
+(
+    TA_TRACE * p_trace,
+    uint64_t t_us
+)
+{
+    UINT32 lo = 0, hi = p_trace->n_order;
+    uint64_t t;
+    int rc;
+
+    // Last block which starts not later than t_us
+    while (hi - lo > 1)
+    {
+        UINT32 mid = (lo + hi) / 2;
+
+        if (TaTraceBlock(p_trace, p_trace->p_order[mid])->t_first <= t_us)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    TaTraceRewind(p_trace, lo);
+
+    while ((rc = TaTraceDecode(p_trace, &t)) == FTX_OK)
+    {
+        if (t >= t_us)
+        {
+            p_trace->pending = TRUE;
+            break;
+        }
+    }
+    return rc;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaTraceNext
+ *
+ * Reads the next record.
+ *-----------------------------------------------------------------------------*/
+int TaTraceNext
+(
+    TA_TRACE * p_trace,
+    uint64_t * p_t_us,
+    TA_TRACE_AREA * p_areas
+)
+{
+    const UCHAR8 * p = p_trace->p_image;
+    UINT32 idx;
+    int rc = FTX_OK;
+
+    if (p_trace->pending)
+    {
+        p_trace->pending = FALSE;
+        *p_t_us = p_trace->t_prev;
+    }
+    else
+    {
+        rc = TaTraceDecode(p_trace, p_t_us);
+    }
+    if (rc == FTX_OK)
+    {
+        for (idx = 0; idx < TA_COUNT; idx++)
+        {
+            if (p_trace->header.area_mask & (1 << idx))
+            {
+                memcpy(&p_areas[idx], p, sizeof(TA_TRACE_AREA));
+                p += sizeof(TA_TRACE_AREA);
+            }
+        }
+    }
+    return rc;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaTraceRange
+ *
+ * Returns the time range of the trace.
+ *-----------------------------------------------------------------------------*/
+int TaTraceRange
+(
+    TA_TRACE * p_trace,
+    uint64_t * p_t_first,
+    uint64_t * p_t_last
+)
+{
+    if (!p_trace->n_order)
+    {
+        return FTX_ERR_END;
+    }
+    *p_t_first = TaTraceBlock(p_trace, p_trace->p_order[0])->t_first;
+    *p_t_last = TaTraceBlock(p_trace, p_trace->p_order[p_trace->n_order - 1])->t_last;
+    return FTX_OK;
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaTraceClose
+ *-----------------------------------------------------------------------------*/
+void TaTraceClose
+(
+    TA_TRACE * p_trace
+)
+{
+    if (p_trace->p_map)
+    {
+        munmap(p_trace->p_map, p_trace->map_size);
+    }
+    if (p_trace->fd >= 0)
+    {
+        close(p_trace->fd);
+    }
+    free(p_trace->p_order);
+    free(p_trace->p_image);
+    free(p_trace->p_scratch);
+    memset(p_trace, 0, sizeof(*p_trace));
+    p_trace->fd = -1;
+}
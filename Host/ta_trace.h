@@ -0,0 +1,217 @@
+//=============================================================================
+// Header file of the binary Transfer Area trace.
+// A trace file is a ring of fixed size blocks, mapped into memory. Every
+// record holds the TA_INPUT, TA_OUTPUT and TA_STATE structures of the traced
+// Transfer Areas at one point of time, in the firmware layout (ta_wire.h), so
+// a trace is the same on 32-bit and 64-bit hosts. The first record of a block
+// is a key record with the full image, the following records only hold the
+// byte runs which changed since the previous record, so a tick without
+// changes costs three bytes. A record can also carry the firmware callbacks (Bluetooth, I2C)
+// which were delivered to the program before the record was taken, each with
+// its own time, so that a program can be replayed deterministically (see
+// ftx_simrun.c).
+// When the ring is full, the oldest block is overwritten.
+//
+// File layout:
+//   header (TA_TRACE_HEADER_SIZE bytes) | block 0 | block 1 | ... | block n-1
+// Block layout:
+//   TA_TRACE_BLOCK | records
+// Record layout (all numbers are unsigned LEB128 varints):
+//   (dt << 2) | (has_events << 1) | is_key,
+//                 dt = microseconds since the previous record of the block
+//   has_events:   number of events, then for each event: type, length, dt, bytes,
+//                 dt = microseconds from the event to the record
+//   key record:   full image
+//   delta record: number of runs, then for each run: skip, length, bytes
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __TA_TRACE_H__
+#define __TA_TRACE_H__
+
+#include <stdint.h>
+
+#include "ftx_link.h"
+#include "ta_wire.h"
+
+#define TA_TRACE_MAGIC              0x4543415254585446ULL   // "FTXTRACE"
+#define TA_TRACE_VERSION            4
+#define TA_TRACE_HEADER_SIZE        4096
+#define TA_TRACE_BLOCK_MAGIC        0x4B4C4254              // "TBLK"
+
+#define TA_TRACE_DEFAULT_BLOCK_SIZE (64 * 1024)
+#define TA_TRACE_DEFAULT_BLOCKS     256
+
+#define TA_TRACE_MERGE_GAP          2   // unchanged bytes between two changed runs which are
+                                        // stored instead of starting a new run
+
+#define TA_TRACE_EVENTS_MAX         16  // max. number of events per record
+#define TA_TRACE_EVENT_DATA_MAX     100 // max. data length of an event (a pop-up message fits)
+
+
+// Traced part of one Transfer Area
+typedef struct
+{
+    TA_INPUT        input;
+    TA_OUTPUT       output;
+    TA_WIRE_STATE   state;                  // local_pgm.name is not traced (always 0)
+} TA_TRACE_AREA;
+
+
+// Event attached to a record, type and data are defined by the writer
+typedef struct
+{
+    uint64_t        t_us;                   // time of the event, not later than the time of the record
+    UINT32          type;
+    UINT32          len;
+    UCHAR8          data[TA_TRACE_EVENT_DATA_MAX];
+} TA_TRACE_EVENT;
+
+
+// File header
+typedef struct
+{
+    uint64_t        magic;
+    uint32_t        version;
+    uint32_t        area_mask;              // traced Transfer Areas
+    uint32_t        area_size;              // sizeof(TA_TRACE_AREA) of the writer
+    uint32_t        block_size;
+    uint32_t        n_blocks;
+    uint32_t        flags;                  // defined by the writer, see TaTraceSetFlags
+} TA_TRACE_HEADER;
+
+
+// Block header
+typedef struct
+{
+    uint32_t        magic;
+    uint32_t        seq;                    // sequence number of the block, 0 = empty block
+    uint64_t        t_first;                // time of the key record [us]
+    uint64_t        t_last;                 // time of the last record [us]
+    uint32_t        n_records;
+    uint32_t        used;                   // number of used bytes (header included)
+} TA_TRACE_BLOCK;
+
+
+// Trace file, writer or reader
+typedef struct
+{
+    int             fd;
+    UCHAR8        * p_map;
+    size_t          map_size;
+    TA_TRACE_HEADER header;
+    UINT32          image_size;             // size of the traced image (all traced areas)
+
+    // writer
+    UINT32          block;                  // current block
+    UINT32          seq;                    // sequence number of the current block
+    uint64_t        t_prev;                 // time of the previous record
+
+    // reader
+    UINT32          n_order;                // number of valid blocks
+    UINT32        * p_order;                // valid blocks, oldest first
+    UINT32          order_idx;              // index into p_order of the current block
+    UINT32          offset;                 // offset of the next record in the current block
+    UINT32          record;                 // number of the next record in the current block
+    BOOL32          pending;                // decoded record is not yet returned by TaTraceNext
+
+    // events of the next record (writer) or of the last returned record (reader)
+    TA_TRACE_EVENT  events[TA_TRACE_EVENTS_MAX];
+    UINT32          n_events;
+
+    UCHAR8        * p_image;                // image of the previous record
+    UCHAR8        * p_scratch;
+} TA_TRACE;
+
+
+// Creates (or truncates) a trace file and maps it
+int TaTraceCreate
+(
+    TA_TRACE * p_trace,
+    const char * path,
+    UINT32 area_mask,
+    UINT32 n_blocks,
+    UINT32 block_size
+);
+
+
+// Appends the traced parts of the Transfer Area array as the record of time t_us.
+// Times must not decrease.
+int TaTraceAppend
+(
+    TA_TRACE * p_trace,
+    uint64_t t_us,
+    const TA * p_ta_array
+);
+
+
+// Attaches an event of the time t_us to the next record appended with TaTraceAppend.
+// An event later than the record is stored with the time of the record.
+int TaTraceAppendEvent
+(
+    TA_TRACE * p_trace,
+    uint64_t t_us,
+    UINT32 type,
+    const void * p_data,
+    UINT32 len
+);
+
+
+// Sets the flags of the header, which describe the content of the trace
+// (for example the kinds of events the writer records)
+int TaTraceSetFlags
+(
+    TA_TRACE * p_trace,
+    UINT32 flags
+);
+
+
+// Opens an existing trace file for reading, positioned at the oldest record
+int TaTraceOpen
+(
+    TA_TRACE * p_trace,
+    const char * path
+);
+
+
+// Positions the reader at the first record with the time >= t_us
+int TaTraceSeek
+(
+    TA_TRACE * p_trace,
+    uint64_t t_us
+);
+
+
+// Reads the next record into areas[TA_COUNT] (only traced areas are changed).
+// The events of the record are left in p_trace->events[0...n_events-1].
+// Returns FTX_ERR_END at the end of the trace.
+int TaTraceNext
+(
+    TA_TRACE * p_trace,
+    uint64_t * p_t_us,
+    TA_TRACE_AREA * p_areas
+);
+
+
+// Returns the time range of the trace
+int TaTraceRange
+(
+    TA_TRACE * p_trace,
+    uint64_t * p_t_first,
+    uint64_t * p_t_last
+);
+
+
+void TaTraceClose
+(
+    TA_TRACE * p_trace
+);
+
+
+#endif // __TA_TRACE_H__
@@ -0,0 +1,164 @@
+//=============================================================================
+// Wire representation of the Transfer Area.
+// The layout of the wire types is checked against the firmware layout of
+// ROBO_TX_ABI.h on every build: each type T of the TA_ABI_NATIVE_xxx lists
+// has its wire type WIRE_T here.
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#include <string.h>
+
+#include "ta_wire.h"
+
+typedef TA_WIRE_PGM_INFO        WIRE_PGM_INFO;
+typedef TA_WIRE_DISPLAY_FRAME   WIRE_DISPLAY_FRAME;
+typedef TA_WIRE_STATE           WIRE_TA_STATE;
+typedef TA_WIRE_DISPLAY         WIRE_TA_DISPLAY;
+typedef TA_WIRE                 WIRE_TA;
+typedef struct
+{
+    UINT32          hook[TA_WIRE_HOOK_COUNT];
+} WIRE_TA_HOOK_TABLE;
+
+#define WIRE_CHECK_SIZE(type, size) \
+    TA_ABI_ASSERT(sizeof(WIRE_##type) == (size), wire_##type);
+#define WIRE_CHECK_FIELD(type, member, offset, size) \
+    TA_ABI_ASSERT(TA_ABI_OFFSETOF(WIRE_##type, member) == (offset) && \
+        TA_ABI_SIZEOF(WIRE_##type, member) == (size), wire_##type##_##member);
+
+TA_ABI_NATIVE_SIZES(WIRE_CHECK_SIZE)
+TA_ABI_NATIVE_FIELDS(WIRE_CHECK_FIELD)
+
+// The fields in front of local_pgm are copied as one block. In TA_STATE of a
+// 64-bit host local_pgm is aligned to 8 bytes, so the block ends before it.
+#define WIRE_STATE_HEAD_SIZE    TA_ABI_OFFSETOF(TA_WIRE_STATE, local_pgm)
+
+TA_ABI_ASSERT(TA_ABI_OFFSETOF(TA_STATE, btstatus) == TA_ABI_OFFSETOF(TA_WIRE_STATE, btstatus) &&
+    TA_ABI_OFFSETOF(TA_STATE, reserved_2) + TA_ABI_SIZEOF(TA_STATE, reserved_2) == WIRE_STATE_HEAD_SIZE,
+    wire_state_head);
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaStateToWire
+ *-----------------------------------------------------------------------------*/
+void TaStateToWire
+(
+    TA_WIRE_STATE * p_wire,
+    const TA_STATE * p_state
+)
+{
+    memcpy(p_wire, p_state, WIRE_STATE_HEAD_SIZE);
+    p_wire->local_pgm.name = 0;
+    p_wire->local_pgm.state = p_state->local_pgm.state;
+    memcpy(p_wire->local_pgm.reserved, p_state->local_pgm.reserved, sizeof(p_wire->local_pgm.reserved));
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaStateFromWire
+ *-----------------------------------------------------------------------------*/
+void TaStateFromWire
+(
+    TA_STATE * p_state,
+    const TA_WIRE_STATE * p_wire
+)
+{
+    memcpy(p_state, p_wire, WIRE_STATE_HEAD_SIZE);
+    p_state->local_pgm.state = p_wire->local_pgm.state;
+    memcpy(p_state->local_pgm.reserved, p_wire->local_pgm.reserved, sizeof(p_state->local_pgm.reserved));
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaToWire
+ *-----------------------------------------------------------------------------*/
+void TaToWire
+(
+    TA_WIRE * p_wire,
+    const TA * p_ta
+)
+{
+    p_wire->info = p_ta->info;
+    TaStateToWire(&p_wire->state, &p_ta->state);
+    p_wire->config = p_ta->config;
+    p_wire->input = p_ta->input;
+    p_wire->output = p_ta->output;
+    p_wire->display.display_msg = p_ta->display.display_msg;
+    p_wire->display.display_frame.frame = 0;
+    p_wire->display.display_frame.id = p_ta->display.display_frame.id;
+    p_wire->display.display_frame.is_pgm_master_of_display = p_ta->display.display_frame.is_pgm_master_of_display;
+    p_wire->status = p_ta->status;
+    p_wire->change = p_ta->change;
+    p_wire->timer = p_ta->timer;
+    memcpy(p_wire->reserved_1, p_ta->reserved_1, sizeof(p_wire->reserved_1));
+    memset(p_wire->hook_table, 0, sizeof(p_wire->hook_table));
+    memset(p_wire->reserved_2, 0, sizeof(p_wire->reserved_2));
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaFromWire
+ *-----------------------------------------------------------------------------*/
+void TaFromWire
+(
+    TA * p_ta,
+    const TA_WIRE * p_wire
+)
+{
+    p_ta->info = p_wire->info;
+    TaStateFromWire(&p_ta->state, &p_wire->state);
+    p_ta->config = p_wire->config;
+    p_ta->input = p_wire->input;
+    p_ta->output = p_wire->output;
+    p_ta->display.display_msg = p_wire->display.display_msg;
+    p_ta->display.display_frame.id = p_wire->display.display_frame.id;
+    p_ta->display.display_frame.is_pgm_master_of_display = p_wire->display.display_frame.is_pgm_master_of_display;
+    p_ta->status = p_wire->status;
+    p_ta->change = p_wire->change;
+    p_ta->timer = p_wire->timer;
+    memcpy(p_ta->reserved_1, p_wire->reserved_1, sizeof(p_ta->reserved_1));
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaArrayToWire
+ *-----------------------------------------------------------------------------*/
+void TaArrayToWire
+(
+    TA_WIRE * p_wire,
+    const TA * p_ta_array,
+    UINT32 count
+)
+{
+    UINT32 idx;
+
+    for (idx = 0; idx < count; idx++)
+    {
+        TaToWire(&p_wire[idx], &p_ta_array[idx]);
+    }
+}
+
+
+/*-----------------------------------------------------------------------------
+ * Function Name       : TaArrayFromWire
+ *-----------------------------------------------------------------------------*/
+void TaArrayFromWire
+(
+    TA * p_ta_array,
+    const TA_WIRE * p_wire,
+    UINT32 count
+)
+{
+    UINT32 idx;
+
+    for (idx = 0; idx < count; idx++)
+    {
+        TaFromWire(&p_ta_array[idx], &p_wire[idx]);
+    }
+}
@@ -0,0 +1,166 @@
+//=============================================================================
+// Header file of the wire representation of the Transfer Area.
+// TA_WIRE is one element of the TA array exactly as in the memory of the
+// ROBO TX Controller (1024 bytes, little endian), with fixed-width fields on
+// every build: a captured TA image can be mapped or read into a TA_WIRE and
+// used without parsing. All blocks without pointers are the structures of
+// ROBO_TX_FW.h (their layout is checked in ROBO_TX_ABI.h); only the blocks
+// with pointers have their own types here, with the pointers as 32-bit
+// addresses of the Controller:
+//   TA_STATE       -> TA_WIRE_STATE    (local_pgm.name)
+//   TA_DISPLAY     -> TA_WIRE_DISPLAY  (display_frame.frame)
+//   TA_HOOK_TABLE  -> hook_table[]
+//
+// The conversion functions copy the blocks without pointers as they are and
+// the blocks with pointers up to the pointer. An address of the Controller
+// means nothing on the host and a host pointer nothing on the Controller:
+// to the wire the pointers are written as 0, from the wire they are left
+// unchanged in the TA (so a host TA keeps its program name, frame buffer and
+// hook table).
+//
+// Disclaimer - Exclusion of Liability
+//
+// This software is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. It can be used and modified by anyone
+// free of any license obligations or authoring rights.
+//=============================================================================
+
+#ifndef __TA_WIRE_H__
+#define __TA_WIRE_H__
+
+#include "ROBO_TX_PRG.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "the wire representation of the Transfer Area needs a little endian host"
+#endif
+
+#define TA_WIRE_HOOK_COUNT      (sizeof(TA_HOOK_TABLE) / sizeof(void *))    // number of hook functions
+#define TA_WIRE_RESERVED_2_SIZE \
+    (TA_ABI_SIZE - ( \
+    sizeof(TA_INFO)         + \
+    sizeof(TA_WIRE_STATE)   + \
+    sizeof(TA_CONFIG)       + \
+    sizeof(TA_INPUT)        + \
+    sizeof(TA_OUTPUT)       + \
+    sizeof(TA_WIRE_DISPLAY) + \
+    sizeof(TA_STATUS)       + \
+    sizeof(TA_CHANGE)       + \
+    sizeof(TA_TIMER)        + \
+    RESERVED_1_SIZE         + \
+    TA_WIRE_HOOK_COUNT * sizeof(UINT32) \
+    ))
+
+
+// Program information, 8 bytes
+typedef struct
+{
+    UINT32          name;           // address of the name on the Controller
+    UINT8           state;          // See enum pgm_state_e
+    char            reserved[3];
+} TA_WIRE_PGM_INFO;
+
+
+// State structure, 100 bytes, same fields as TA_STATE
+typedef struct
+{
+    BOOL8           pgm_initialized;
+    char            reserved_1[7];
+    BOOL8           dev_mode;
+    UINT8           id;
+    UINT8           info_id;
+    UINT8           config_id;
+    BOOL8           ext_dev_connect_state[N_EXT];
+    BT_STATUS       btstatus[BT_CNT_MAX];
+    char            reserved_2[8];
+    TA_WIRE_PGM_INFO local_pgm;
+} TA_WIRE_STATE;
+
+
+// Display frame, 8 bytes
+typedef struct
+{
+    UINT32          frame;          // address of the frame on the Controller
+    UINT16          id;
+    BOOL16          is_pgm_master_of_display;
+} TA_WIRE_DISPLAY_FRAME;
+
+
+// Display structure, 108 bytes
+typedef struct
+{
+    DISPLAY_MSG     display_msg;
+    TA_WIRE_DISPLAY_FRAME display_frame;
+} TA_WIRE_DISPLAY;
+
+
+// One element of the TA array, 1024 bytes
+typedef struct
+{
+    TA_INFO             info;
+    TA_WIRE_STATE       state;
+    TA_CONFIG           config;
+    TA_INPUT            input;
+    TA_OUTPUT           output;
+    TA_WIRE_DISPLAY     display;
+    TA_STATUS           status;
+    TA_CHANGE           change;
+    TA_TIMER            timer;
+    char                reserved_1[RESERVED_1_SIZE];
+    UINT32              hook_table[TA_WIRE_HOOK_COUNT];     // addresses of the hook functions on the Controller
+    char                reserved_2[TA_WIRE_RESERVED_2_SIZE];
+} TA_WIRE;
+
+
+// Converts TA_STATE to the wire representation
+void TaStateToWire
+(
+    TA_WIRE_STATE * p_wire,
+    const TA_STATE * p_state
+);
+
+
+// Converts TA_STATE from the wire representation, local_pgm.name is not changed
+void TaStateFromWire
+(
+    TA_STATE * p_state,
+    const TA_WIRE_STATE * p_wire
+);
+
+
+// Converts a Transfer Area to the wire representation
+void TaToWire
+(
+    TA_WIRE * p_wire,
+    const TA * p_ta
+);
+
+
+// Converts a Transfer Area from the wire representation, the pointers
+// (local_pgm.name, display_frame.frame, hook table) are not changed
+void TaFromWire
+(
+    TA * p_ta,
+    const TA_WIRE * p_wire
+);
+
+
+// Converts count elements of a TA array to the wire representation
+void TaArrayToWire
+(
+    TA_WIRE * p_wire,
+    const TA * p_ta_array,
+    UINT32 count
+);
+
+
+// Converts count elements of a TA array from the wire representation
+void TaArrayFromWire
+(
+    TA * p_ta_array,
+    const TA_WIRE * p_wire,
+    UINT32 count
+);
+
+
+#endif // __TA_WIRE_H__